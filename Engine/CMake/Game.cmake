@@ -14,6 +14,12 @@ set ( RECLUSE_ENGINE_COMPILE_FILES
     ${RECLUSE_GAME_INCLUDE_DIR}/GameEntity.hpp
 	${RECLUSE_GAME_SOURCE_DIR}/GameEntity.cpp
 	${RECLUSE_GAME_INCLUDE_DIR}/GameSystem.hpp
+    ${RECLUSE_GAME_INCLUDE_DIR}/Archetype.hpp
+    ${RECLUSE_GAME_SOURCE_DIR}/Archetype.cpp
+    ${RECLUSE_GAME_INCLUDE_DIR}/EntityTable.hpp
+    ${RECLUSE_GAME_SOURCE_DIR}/EntityTable.cpp
+    ${RECLUSE_GAME_INCLUDE_DIR}/SystemScheduler.hpp
+    ${RECLUSE_GAME_SOURCE_DIR}/SystemScheduler.cpp
     ${RECLUSE_GAME_INCLUDE_DIR}/ObjectSerializer.hpp
 	${RECLUSE_GAME_SYSTEMS_INCLUDE_DIR}/TransformSystem.hpp
 	${RECLUSE_GAME_SYSTEMS_INCLUDE_DIR}/RendererSystem.hpp
@@ -31,5 +37,7 @@ set ( RECLUSE_ENGINE_COMPILE_FILES
 	${RECLUSE_GAME_COMPONENTS_SOURCE_DIR}/Camera.cpp
 	${RECLUSE_ENGINE_INCLUDE_DIR}/Recluse/Application.hpp
 	${RECLUSE_ENGINE_SOURCE_DIR}/Application.cpp
+	${RECLUSE_ENGINE_INCLUDE_DIR}/Recluse/JobStreamer.hpp
+	${RECLUSE_ENGINE_SOURCE_DIR}/JobStreamer.cpp
 	${RECLUSE_ENGINE_INCLUDE_DIR}/Recluse/EngineModule.hpp
 )
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "Recluse/Memory/Allocator.hpp"
 #include "Recluse/Memory/MemoryPool.hpp"
 #include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/JobStreamer.hpp"
 
 #include "Recluse/MessageBus.hpp"
 #include <map>
@@ -31,21 +32,6 @@ namespace Recluse {
 class Window;
 class Application;
 
-enum JobType 
-{
-    JobType_Main = 0,      //< Main will always be 0
-    JobType_Simulation,
-    JobType_Renderer,
-    JobType_Physics,
-    JobType_Audio,
-    JobType_Animation,
-    JobType_AI,
-    JobType_Network
-};
-
-
-typedef U32 JobTypeFlags;
-
 // Application interface for your application.
 // This should, and would be integrated into your game, in order to 
 // connect to the engine components, as well as the editor system.
@@ -87,7 +73,11 @@ public:
         return result;
     }
 
+    // Starts a dedicated thread running func, for loops that run for the life of the app, such as
+    // the render thread. Shorter work should go to MainThreadLoop::getThreadPool(), or a JobGraph,
+    // instead of a thread of its own.
     ResultCode         loadJobThread(JobTypeFlags flags, ThreadFunction func);
+    // Returns the dedicated thread loaded for the job type, if any.
     Thread*         getJobThread(JobType jobType);
 
     Engine::Scene*  getScene() { return m_pScene; }
@@ -137,5 +127,12 @@ R_PUBLIC_API F32            getFixedTickRate();
 // This is operating system specific.
 R_PUBLIC_API Bool           isMainThread();
 R_PUBLIC_API MessageBus*    getMessageBus();
+
+// Shared worker pool, used for running job graphs and other engine work.
+R_PUBLIC_API ThreadPool*    getThreadPool();
+
+// Same as getThreadPool(), but returns null if the main loop was not initialized. For engine
+// code that may also run outside of the main loop, such as in tests.
+R_PUBLIC_API ThreadPool*    tryGetThreadPool();
 } // MainThreadLoop
 } // Recluse
\ No newline at end of file
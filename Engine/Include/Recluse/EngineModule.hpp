@@ -4,7 +4,7 @@
 #include "Recluse/Types.hpp"
 #include "Recluse/Application.hpp"
 #include "Recluse/Threading/Threading.hpp"
-#include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/Threading/Atomic.hpp"
 #include "Recluse/Memory/MemoryCommon.hpp"
 
 #include <map>
@@ -93,7 +93,7 @@ private:
     ResultCode initializeInstance(Application* pApp) 
     {
         m_sync = createMutex(R_STRINGIFY(ModuleImpl));
-        m_isActive = true;
+        m_isActive.store(true);
         return onInitializeModule(pApp); 
     }
 
@@ -102,7 +102,7 @@ private:
         ResultCode result = onCleanUpModule(pApp);
         if (result == RecluseResult_Ok) 
         {
-            m_isActive = false;
+            m_isActive.store(false);
             destroyMutex(m_sync);
         }
 
@@ -114,11 +114,11 @@ public:
     // Check if the engine module is active.
     Bool isActive() const 
     {
-        return m_isActive;
+        return m_isActive.load();
     }
 
-    Bool            isRunning() const { return m_isRunning; }
-    void            enableRunning(Bool enable) { ScopedLock lck(m_sync); m_isRunning = enable; }
+    Bool            isRunning() const { return m_isRunning.load(); }
+    void            enableRunning(Bool enable) { ScopedLock lck(m_sync); m_isRunning.store(enable); }
     Mutex           getMutex() { return m_sync; }
 
     ModulePlugin<ModuleImpl>* getPlugin(EnginePluginId id)
@@ -156,12 +156,10 @@ public:
     }
 
 private:
-    volatile Bool   m_isRunning = false;
-    volatile Bool   m_isActive  = false;
+    Atomic<Bool>    m_isRunning;
+    Atomic<Bool>    m_isActive;
     Mutex           m_sync;
 
-    // Thread pool which we can use to launch how many threads.
-    ThreadPool      m_threadPool;
     std::map<EnginePluginId, ModulePlugin<ModuleImpl>*> m_plugins;
 };
 } // Engine
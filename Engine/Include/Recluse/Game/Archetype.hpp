@@ -0,0 +1,412 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+#include "Recluse/RGUID.hpp"
+#include "Recluse/Serialization/Hasher.hpp"
+#include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Threading/Locks.hpp"
+#include "Recluse/Algorithms/Parallel.hpp"
+
+#include <new>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+namespace Recluse {
+namespace ECS {
+
+typedef Hash64 ComponentUUID;
+// Dense index of a component type, handed out the first time the type is looked up, so per type
+// lookups can index an array. Indices depend on the order types are first used, and are only
+// good for the run, serialize the ComponentUUID instead.
+typedef U32    ComponentTypeIndex;
+
+// Returns the index for the uuid, allocating the next one if it was not seen before. Indices are
+// kept by uuid, so every module gets the same index for the same type.
+R_PUBLIC_API ComponentTypeIndex getComponentTypeIndex(ComponentUUID uuid);
+
+
+// Per type cache of the hashed uuid and dense index, so neither is worked out more than once.
+template<typename ComponentType>
+struct ComponentTypeId
+{
+    static ComponentUUID uuid()
+    {
+        static const ComponentUUID typeUuid = ComponentType::classGUID();
+        return typeUuid;
+    }
+
+    static ComponentTypeIndex index()
+    {
+        static const ComponentTypeIndex typeIndex = getComponentTypeIndex(uuid());
+        return typeIndex;
+    }
+};
+
+
+// Type erased description of a component, so archetypes can construct, move and destroy
+// columns of it without knowing its type.
+struct ComponentTypeInfo
+{
+    ComponentUUID   uuid;
+    U32             sizeBytes;
+    U32             alignment;
+    void            (*construct)(void* pDst);
+    // Move constructs into pDst, then destroys pSrc.
+    void            (*relocate)(void* pDst, void* pSrc);
+    void            (*destruct)(void* pDst);
+
+    template<typename ComponentType>
+    static const ComponentTypeInfo* get()
+    {
+        static const ComponentTypeInfo info =
+            {
+                ComponentTypeId<ComponentType>::uuid(),
+                static_cast<U32>(sizeof(ComponentType)),
+                static_cast<U32>(alignof(ComponentType)),
+                [] (void* pDst) -> void { new (pDst) ComponentType(); },
+                [] (void* pDst, void* pSrc) -> void
+                {
+                    ComponentType* pSrcComponent = static_cast<ComponentType*>(pSrc);
+                    new (pDst) ComponentType(std::move(*pSrcComponent));
+                    pSrcComponent->~ComponentType();
+                },
+                [] (void* pDst) -> void { static_cast<ComponentType*>(pDst)->~ComponentType(); }
+            };
+        return &info;
+    }
+};
+
+
+// Storage for every entity with the exact same set of components. Entities are packed into
+// fixed size chunks, each chunk holding one column per component type, so a system walking
+// a few component types only touches memory it reads, in order.
+//
+// Rows are kept dense, freeing a row moves the last row into it. Pointers into an archetype
+// are only good until the next structural change, an add or remove of an entity or component.
+class R_PUBLIC_API Archetype
+{
+public:
+    static constexpr U64 kChunkSizeBytes    = R_KB(16);
+    // Chunks come from rlsAllocateBytes(), which keeps them 16 byte aligned.
+    static constexpr U32 kChunkAlignment    = 16u;
+
+    // Types must be sorted by uuid, see sortTypes().
+    Archetype(const std::vector<const ComponentTypeInfo*>& types);
+    ~Archetype();
+
+    static void                                         sortTypes(std::vector<const ComponentTypeInfo*>& types);
+    static U64                                          hashTypes(const std::vector<const ComponentTypeInfo*>& types);
+
+    const std::vector<const ComponentTypeInfo*>&        getTypes() const { return m_types; }
+    U64                                                 getSignatureHash() const { return m_signatureHash; }
+
+    // Column of the component type, -1 if this archetype does not have it.
+    I32                                                 findColumn(ComponentUUID uuid) const;
+    Bool                                                hasComponent(ComponentUUID uuid) const { return findColumn(uuid) >= 0; }
+
+    U32                                                 getNumEntities() const { return m_numEntities; }
+    U32                                                 getChunkCapacity() const { return m_chunkCapacity; }
+    U32                                                 getNumChunks() const { return static_cast<U32>(m_chunks.size()); }
+
+    // Rows in use in the chunk. Only the last chunk may be partly filled.
+    U32 getChunkSize(U32 chunkIndex) const
+    {
+        const U32 chunkStart = chunkIndex * m_chunkCapacity;
+        if (chunkStart >= m_numEntities)
+        {
+            return 0u;
+        }
+        return (m_numEntities - chunkStart) < m_chunkCapacity ? (m_numEntities - chunkStart) : m_chunkCapacity;
+    }
+
+    const RGUID* getEntities(U32 chunkIndex) const
+    {
+        return reinterpret_cast<const RGUID*>(m_chunks[chunkIndex]);
+    }
+
+    void* getColumn(U32 chunkIndex, U32 column) const
+    {
+        return m_chunks[chunkIndex] + m_columnOffsets[column];
+    }
+
+    const RGUID& getEntity(U32 row) const
+    {
+        return getEntities(row / m_chunkCapacity)[row % m_chunkCapacity];
+    }
+
+    void* getComponent(U32 row, U32 column) const
+    {
+        return static_cast<U8*>(getColumn(row / m_chunkCapacity, column)) + U64(row % m_chunkCapacity) * m_types[column]->sizeBytes;
+    }
+
+    // Appends a row for the entity, with its components left unconstructed. Returns the row.
+    U32                                                 allocateRow(const RGUID& entity);
+
+    // Destroys the components of the row, and moves the last row into it. Returns the entity
+    // that was moved into the row, or an invalid RGUID if the row was the last.
+    RGUID                                               freeRow(U32 row);
+
+    // Moves the components of a row into a newly allocated row of pDst. Components pDst has, that
+    // this archetype does not, are default constructed. Ones pDst does not have are destroyed.
+    // Returns the row in pDst, and the entity that was moved into the freed row in movedEntity.
+    U32                                                 moveRow(U32 row, Archetype* pDst, RGUID& movedEntity);
+
+    void                                                clear();
+
+    // Archetypes one component away, looked up when components are added or removed, so the
+    // move to the next archetype is a single lookup after the first.
+    Archetype*                                          getAddEdge(ComponentUUID uuid) const;
+    Archetype*                                          getRemoveEdge(ComponentUUID uuid) const;
+    void                                                setAddEdge(ComponentUUID uuid, Archetype* pArchetype) { m_addEdges[uuid] = pArchetype; }
+    void                                                setRemoveEdge(ComponentUUID uuid, Archetype* pArchetype) { m_removeEdges[uuid] = pArchetype; }
+
+private:
+    RGUID& getEntity(U32 row)
+    {
+        return reinterpret_cast<RGUID*>(m_chunks[row / m_chunkCapacity])[row % m_chunkCapacity];
+    }
+
+    // Moves the last row into the given row, without destroying what was in it.
+    RGUID                                               fillRow(U32 row);
+
+    std::vector<const ComponentTypeInfo*>               m_types;
+    // Byte offset of each column in a chunk. Entity ids are first, at offset 0.
+    std::vector<U32>                                    m_columnOffsets;
+    std::vector<U8*>                                    m_chunks;
+    U32                                                 m_chunkCapacity;
+    U32                                                 m_numEntities;
+    U64                                                 m_signatureHash;
+    std::unordered_map<ComponentUUID, Archetype*>       m_addEdges;
+    std::unordered_map<ComponentUUID, Archetype*>       m_removeEdges;
+};
+
+
+// Archetypes that have all of one set of component types, and none of another. Queries are
+// cached by the storage, and only check archetypes created since they were last used, so
+// matching is paid once per archetype instead of on every iteration.
+struct ArchetypeQuery
+{
+    std::vector<ComponentUUID>  includes;
+    std::vector<ComponentUUID>  excludes;
+    std::vector<Archetype*>     archetypes;
+    // Column of each included type in each matching archetype, includes.size() per archetype.
+    std::vector<I32>            columns;
+    // Archetypes of the storage checked against this query so far.
+    U32                         numArchetypesChecked;
+};
+
+
+template<typename... Components>
+class View;
+
+
+// Entities and their components, stored by archetype. Adding or removing a component moves the
+// entity to the archetype for its new set of components, lookups by entity are a single hash
+// lookup to find its archetype and row.
+class R_PUBLIC_API ArchetypeStorage
+{
+public:
+    ArchetypeStorage();
+    ~ArchetypeStorage();
+
+    // Default constructs the component. Returns the existing one, if the entity already had it.
+    template<typename ComponentType>
+    ComponentType* addComponent(const RGUID& entity)
+    {
+        return static_cast<ComponentType*>(addComponent(entity, ComponentTypeInfo::get<ComponentType>()));
+    }
+
+    template<typename ComponentType>
+    Bool removeComponent(const RGUID& entity)
+    {
+        return removeComponent(entity, ComponentTypeId<ComponentType>::uuid());
+    }
+
+    template<typename ComponentType>
+    ComponentType* getComponent(const RGUID& entity) const
+    {
+        return static_cast<ComponentType*>(getComponent(entity, ComponentTypeId<ComponentType>::uuid()));
+    }
+
+    void*                           addComponent(const RGUID& entity, const ComponentTypeInfo* pTypeInfo);
+    Bool                            removeComponent(const RGUID& entity, ComponentUUID uuid);
+    void*                           getComponent(const RGUID& entity, ComponentUUID uuid) const;
+
+    // Removes the entity, and destroys all of its components.
+    Bool                            destroyEntity(const RGUID& entity);
+    Bool                            hasEntity(const RGUID& entity) const { return m_entities.find(entity) != m_entities.end(); }
+    U32                             getNumEntities() const { return static_cast<U32>(m_entities.size()); }
+
+    const std::vector<Archetype*>&  getArchetypes() const { return m_archetypes; }
+
+    // Bumped on every add or remove of an entity or a component. Anything holding on to pointers
+    // into the storage can check it, to know when to refetch.
+    U64                             getStructureVersion() const { return m_structureVersion; }
+
+    // Entities that have all of the component types, see View.
+    template<typename... Components>
+    View<Components...> view() const
+    {
+        const ComponentUUID includes[] = { ComponentTypeId<Components>::uuid()..., 0 };
+        return View<Components...>(this, getQuery(includes, sizeof...(Components), nullptr, 0u));
+    }
+
+    // Calls fn(count, pEntities, pComponents...) for every chunk that has all of the component
+    // types, with one pointer per type to the start of its column.
+    template<typename... Components, typename Function>
+    void forEachChunk(Function fn) const
+    {
+        view<Components...>().forEachChunk(fn);
+    }
+
+    // Calls fn(entity, components&...) for every entity that has all of the component types.
+    template<typename... Components, typename Function>
+    void forEach(Function fn) const
+    {
+        view<Components...>().forEach(fn);
+    }
+
+    // Returns the cached query for the types, brought up to date with any archetypes created
+    // since it was last used. Queries live as long as the storage.
+    const ArchetypeQuery*           getQuery(const ComponentUUID* pIncludes, U32 numIncludes, const ComponentUUID* pExcludes, U32 numExcludes) const;
+
+    void                            clear();
+
+private:
+    struct EntityLocation
+    {
+        Archetype*  pArchetype;
+        U32         row;
+    };
+
+    static Bool                     findColumns(const Archetype* pArchetype, const ComponentUUID* pUuids, I32* pColumns, U32 count);
+    void                            updateQuery(ArchetypeQuery* pQuery) const;
+
+    Archetype*                      findOrCreateArchetype(std::vector<const ComponentTypeInfo*>& types);
+    void                            moveEntity(EntityLocation& location, Archetype* pDst);
+    void                            updateMovedEntity(const RGUID& movedEntity, Archetype* pArchetype, U32 row);
+
+    std::unordered_map<RGUID, EntityLocation, RGUID::Hash>  m_entities;
+    std::unordered_multimap<U64, Archetype*>                m_archetypesBySignature;
+    std::vector<Archetype*>                                 m_archetypes;
+    // Archetype with no components, where entities start.
+    Archetype*                                              m_pEmptyArchetype;
+    U64                                                     m_structureVersion;
+    // Queries by hash of their types. Views may be made from several threads at once.
+    mutable std::unordered_multimap<U64, ArchetypeQuery*>   m_queries;
+    mutable SpinLock                                        m_queryLock;
+};
+
+
+// Entities with all of the component types, iterated in place over the archetype chunks, with no
+// copies and no per entity lookups. Views are cheap to make, the matching archetypes come from a
+// query cached by the storage, so systems should make one each update rather than hold on to it.
+// Like pointers into the storage, a view is not good across adding or removing components.
+//
+//  registry->view<Transform, MoverComponent>().exclude<FrozenComponent>().forEach(...)
+template<typename... Components>
+class View
+{
+public:
+    View(const ArchetypeStorage* pStorage, const ArchetypeQuery* pQuery)
+        : m_pStorage(pStorage)
+        , m_pQuery(pQuery)
+    { }
+
+    // Returns the view, without entities that have any of the Excluded component types.
+    template<typename... Excluded>
+    View exclude() const
+    {
+        const ComponentUUID includes[]  = { ComponentTypeId<Components>::uuid()..., 0 };
+        std::vector<ComponentUUID> excludes(m_pQuery->excludes);
+        excludes.insert(excludes.end(), { ComponentTypeId<Excluded>::uuid()... });
+        return View(m_pStorage, m_pStorage->getQuery(includes, sizeof...(Components), excludes.data(), static_cast<U32>(excludes.size())));
+    }
+
+    // Calls fn(count, pEntities, pComponents...) for every chunk in the view, with one pointer per
+    // type to the start of its column.
+    template<typename Function>
+    void forEachChunk(Function fn) const
+    {
+        for (U32 archetypeIndex = 0; archetypeIndex < m_pQuery->archetypes.size(); ++archetypeIndex)
+        {
+            const Archetype* pArchetype = m_pQuery->archetypes[archetypeIndex];
+            for (U32 chunkIndex = 0; chunkIndex < pArchetype->getNumChunks(); ++chunkIndex)
+            {
+                visitChunk(fn, archetypeIndex, chunkIndex, std::index_sequence_for<Components...>());
+            }
+        }
+    }
+
+    // Same as forEachChunk(), but chunks are split between the pool workers and the calling
+    // thread, so fn must be safe to call from several threads at once.
+    template<typename Function>
+    void forEachChunkParallel(ThreadPool* pPool, Function fn) const
+    {
+        // Flattened, so the pool can split chunks of different archetypes evenly.
+        std::vector<std::pair<U32, U32>> chunks;
+        for (U32 archetypeIndex = 0; archetypeIndex < m_pQuery->archetypes.size(); ++archetypeIndex)
+        {
+            const Archetype* pArchetype = m_pQuery->archetypes[archetypeIndex];
+            for (U32 chunkIndex = 0; chunkIndex < pArchetype->getNumChunks(); ++chunkIndex)
+            {
+                if (pArchetype->getChunkSize(chunkIndex))
+                {
+                    chunks.push_back(std::make_pair(archetypeIndex, chunkIndex));
+                }
+            }
+        }
+
+        ParallelRange range = { 0ull, chunks.size() };
+        parallelFor(pPool, range, 1ull, [&] (U64 i) -> void
+            {
+                visitChunk(fn, chunks[i].first, chunks[i].second, std::index_sequence_for<Components...>());
+            });
+    }
+
+    // Calls fn(entity, components&...) for every entity in the view.
+    template<typename Function>
+    void forEach(Function fn) const
+    {
+        forEachChunk([&fn] (U32 count, const RGUID* pEntities, Components*... pColumns) -> void
+            {
+                for (U32 i = 0; i < count; ++i)
+                {
+                    fn(pEntities[i], pColumns[i]...);
+                }
+            });
+    }
+
+    U32 getNumEntities() const
+    {
+        U32 numEntities = 0u;
+        for (const Archetype* pArchetype : m_pQuery->archetypes)
+        {
+            numEntities += pArchetype->getNumEntities();
+        }
+        return numEntities;
+    }
+
+    const ArchetypeQuery*   getQuery() const { return m_pQuery; }
+
+private:
+    template<typename Function, std::size_t... Indices>
+    void visitChunk(Function& fn, U32 archetypeIndex, U32 chunkIndex, std::index_sequence<Indices...>) const
+    {
+        const Archetype* pArchetype = m_pQuery->archetypes[archetypeIndex];
+        const I32* columns          = m_pQuery->columns.data() + archetypeIndex * sizeof...(Components);
+        const U32 count             = pArchetype->getChunkSize(chunkIndex);
+        (void)columns;
+        if (count)
+        {
+            fn(count, pArchetype->getEntities(chunkIndex), static_cast<Components*>(pArchetype->getColumn(chunkIndex, columns[Indices]))...);
+        }
+    }
+
+    const ArchetypeStorage* m_pStorage;
+    const ArchetypeQuery*   m_pQuery;
+};
+} // ECS
+} // Recluse
@@ -6,6 +6,7 @@
 #include "Recluse/Serialization/Serializable.hpp"
 
 #include "Recluse/Game/GameSystem.hpp"
+#include "Recluse/Game/Archetype.hpp"
 #include "Recluse/RGUID.hpp"
 
 #include <vector>
@@ -215,6 +216,11 @@ public:
         return TypeComponent::classGUID();
     }
 
+    static ComponentTypeIndex componentTypeIndex()
+    {
+        return ComponentTypeId<TypeComponent>::index();
+    }
+
     // Allocates a component from the system pool.
     // Returns R_RESULT_OK if the system successfully allocated the component instance.
     ResultCode allocateComponent(const RGUID& owner)  
@@ -259,6 +265,71 @@ protected:
 };
 
 
+// Component registry backed by archetype storage, shared with the other archetype registries of
+// the same Registry. Components of one entity sit next to each other in the same chunk, so
+// systems can iterate several component types at once through ArchetypeStorage::forEach().
+// Component pointers are only good until the next component is added or removed.
+template<typename TypeComponent>
+class ArchetypeRegistry : public ComponentRegistry<TypeComponent>
+{
+public:
+    ArchetypeRegistry(ArchetypeStorage* pStorage)
+        : m_pStorage(pStorage)
+    { 
+        this->m_numberOfComponentsAllocated = 0;
+    }
+
+    virtual std::vector<TypeComponent*> getAllComponents() override
+    {
+        std::vector<TypeComponent*> components;
+        components.reserve(this->getTotalComponents());
+        m_pStorage->forEachChunk<TypeComponent>([&components] (U32 count, const RGUID*, TypeComponent* pComponents) -> void
+            {
+                for (U32 i = 0; i < count; ++i)
+                {
+                    components.push_back(&pComponents[i]);
+                }
+            });
+        return components;
+    }
+
+    virtual TypeComponent* getComponent(const RGUID& entityKey) override
+    {
+        return m_pStorage->getComponent<TypeComponent>(entityKey);
+    }
+
+protected:
+    virtual ResultCode onAllocateComponent(const RGUID& owner) override
+    {
+        if (m_pStorage->getComponent<TypeComponent>(owner))
+        {
+            return RecluseResult_AlreadyExists;
+        }
+        TypeComponent* pComponent = m_pStorage->addComponent<TypeComponent>(owner);
+        pComponent->setOwner(owner);
+        return RecluseResult_Ok;
+    }
+
+    virtual ResultCode onFreeComponent(const RGUID& owner) override
+    {
+        TypeComponent* pComponent = m_pStorage->getComponent<TypeComponent>(owner);
+        if (!pComponent)
+        {
+            return RecluseResult_NotFound;
+        }
+        pComponent->cleanUp();
+        m_pStorage->removeComponent<TypeComponent>(owner);
+        return RecluseResult_Ok;
+    }
+
+    // Components are destroyed along with the storage.
+    virtual ResultCode onCleanUp() override { return RecluseResult_Ok; }
+
+private:
+    ArchetypeStorage* m_pStorage;
+};
+
+
 // Global registry that holds all given component registries.
 class Registry
 {
@@ -266,37 +337,50 @@ public:
     template<typename ComponentType>
     ComponentRegistry<ComponentType>* getComponentRegistry() const
     {
-        ECS::ComponentUUID uuid = ComponentType::classGUID();
-        auto it = m_records.find(uuid);
-        if (it != m_records.end())
-        {
-            return static_cast<ECS::ComponentRegistry<ComponentType>*>(it->second);
-        }
-        return nullptr;
+        return static_cast<ECS::ComponentRegistry<ComponentType>*>(getRecord(ComponentTypeId<ComponentType>::index()));
     }
 
     template<typename RegistryType>
     ResultCode addComponentRegistry()
     {
-        ECS::ComponentUUID uuid = RegistryType::componentGUID();
-        auto it = m_records.find(uuid);
-        if (it == m_records.end())
+        ECS::ComponentTypeIndex index = RegistryType::componentTypeIndex();
+        if (!getRecord(index))
+        {
+            setRecord(index, ECS::AbstractRegistry::allocate<RegistryType>());
+            return RecluseResult_Ok;
+        }
+        return RecluseResult_Failed;
+    }
+
+    // Stores the component type in archetype storage, shared by all component types added this
+    // way, instead of a registry of its own.
+    template<typename ComponentType>
+    ResultCode addArchetypeRegistry()
+    {
+        ECS::ComponentTypeIndex index = ComponentTypeId<ComponentType>::index();
+        if (!getRecord(index))
         {
-            ECS::AbstractRegistry* registry = ECS::AbstractRegistry::allocate<RegistryType>();
-            m_records.insert(std::make_pair(uuid, registry));
+            setRecord(index, new ArchetypeRegistry<ComponentType>(&m_storage));
             return RecluseResult_Ok;
         }
         return RecluseResult_Failed;
     }
 
+    // Storage of the archetype registries, for systems that iterate several component types at once.
+    ArchetypeStorage&       getStorage() { return m_storage; }
+    const ArchetypeStorage& getStorage() const { return m_storage; }
+
+    // Entities with all of the component types, iterated in place, see ECS::View. Only component
+    // types added with addArchetypeRegistry() are seen.
+    template<typename... Components>
+    View<Components...>     view() const { return m_storage.view<Components...>(); }
+
     template<typename ComponentType>
     ResultCode makeComponent(const RGUID& entityId, Bool enableByDefault = false)
     {
-        ECS::ComponentUUID uuid = ComponentType::classGUID();
-        auto it = m_records.find(uuid);
-        if (it != m_records.end())
+        ECS::ComponentRegistry<ComponentType>* registry = getComponentRegistry<ComponentType>();
+        if (registry)
         {
-            ECS::ComponentRegistry<ComponentType>* registry = static_cast<ECS::ComponentRegistry<ComponentType>*>(it->second);
             registry->allocateComponent(entityId);
             // Get the component and set the default for it.
             ComponentType* component = registry->getComponent(entityId);
@@ -309,11 +393,9 @@ public:
     template<typename ComponentType>
     ResultCode removeComponent(const RGUID& entityId)
     {
-        ECS::ComponentUUID uuid = ComponentType::classGUID();
-        auto it = m_records.find(uuid);
-        if (it != m_records.end())
+        ECS::ComponentRegistry<ComponentType>* registry = getComponentRegistry<ComponentType>();
+        if (registry)
         {
-            ECS::ComponentRegistry<ComponentType>* registry = static_cast<ECS::ComponentRegistry<ComponentType>*>(it->second);
             registry->freeComponent(entityId);
             return RecluseResult_Ok;
         }
@@ -323,11 +405,9 @@ public:
     template<typename ComponentType>
     ComponentType* getComponent(const RGUID& guid) const
     {
-        ECS::ComponentUUID uuid = ComponentType::classGUID();
-        auto it = m_records.find(uuid);
-        if (it != m_records.end())
+        ECS::ComponentRegistry<ComponentType>* registry = getComponentRegistry<ComponentType>();
+        if (registry)
         {
-            ECS::ComponentRegistry<ComponentType>* registry = static_cast<ECS::ComponentRegistry<ComponentType>*>(it->second);
             return registry->getComponent(guid);
         }
         return nullptr;
@@ -335,16 +415,38 @@ public:
 
     void cleanUp()
     {
-        for (auto registry : m_records)
+        for (ECS::AbstractRegistry* registry : m_records)
         {
-            registry.second->cleanUp();
-            ECS::AbstractRegistry::free(registry.second);
+            if (registry)
+            {
+                registry->cleanUp();
+                ECS::AbstractRegistry::free(registry);
+            }
         }
         m_records.clear();
+        m_storage.clear();
     }
 private:
-    // Records kept, that hold Component registries.
-    std::map<ComponentUUID, ECS::AbstractRegistry*> m_records;
+    ECS::AbstractRegistry* getRecord(ComponentTypeIndex index) const
+    {
+        return (index < m_records.size()) ? m_records[index] : nullptr;
+    }
+
+    void setRecord(ComponentTypeIndex index, ECS::AbstractRegistry* registry)
+    {
+        if (index >= m_records.size())
+        {
+            m_records.resize(index + 1, nullptr);
+        }
+        m_records[index] = registry;
+    }
+
+    // Records kept, that hold Component registries, indexed by ComponentTypeIndex. Types with no
+    // registry in this Registry are left null.
+    std::vector<ECS::AbstractRegistry*>             m_records;
+
+    // Components of the archetype registries.
+    ArchetypeStorage                                m_storage;
 };
 } // ECS
 } // Recluse
\ No newline at end of file
@@ -0,0 +1,105 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+#include "Recluse/RGUID.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+#include "Recluse/Threading/Locks.hpp"
+
+#include <vector>
+
+namespace Recluse {
+namespace ECS {
+
+class GameEntity;
+
+
+// Handle to an entity slot in an EntityTable. The generation is bumped each time the slot is
+// created into or destroyed, so a handle to a destroyed entity no longer matches, even once the
+// slot is reused. Live slots always have an odd generation.
+struct EntityHandle
+{
+    static constexpr U32 kInvalidIndex  = ~0u;
+    // Kept in the minor half of the RGUID of table entities, to tell them apart from other RGUIDs.
+    static constexpr U64 kRGUIDTag      = 0x52454e5449545931ull;
+
+    U32     index;
+    U32     generation;
+
+    EntityHandle(U32 index = kInvalidIndex, U32 generation = 0u)
+        : index(index)
+        , generation(generation)
+    { }
+
+    Bool isValid() const { return index != kInvalidIndex; }
+
+    Bool operator==(const EntityHandle& rh) const { return (index == rh.index) && (generation == rh.generation); }
+    Bool operator!=(const EntityHandle& rh) const { return !(*this == rh); }
+
+    RGUID toRGUID() const
+    {
+        RGUID guid;
+        guid.ss.hash0           = index;
+        guid.ss.hash1           = generation;
+        guid.version.minor      = kRGUIDTag;
+        return guid;
+    }
+
+    // Returns an invalid handle if the RGUID did not come from an EntityTable.
+    static EntityHandle fromRGUID(const RGUID& guid)
+    {
+        if (guid.version.minor != kRGUIDTag)
+        {
+            return EntityHandle();
+        }
+        return EntityHandle(guid.ss.hash0, guid.ss.hash1);
+    }
+};
+
+
+// Dense table of game entities. Entities live in fixed size pages that never move, so pointers
+// to them stay good until they are destroyed, and a handle is looked up with an index and a
+// generation check, no hashing. Destroyed slots are recycled, most recently freed first, so
+// the table stays as small as the most entities alive at once.
+//
+// create() and destroy() may be called from any thread. find() takes no lock, and is safe
+// alongside them, so long as the entity looked up is not being destroyed at the same time.
+class R_PUBLIC_API EntityTable
+{
+public:
+    static constexpr U32 kEntitiesPerPage   = 1024u;
+    static constexpr U32 kMaxPages          = 4096u;
+    static constexpr U32 kMaxEntities       = kEntitiesPerPage * kMaxPages;
+
+    EntityTable();
+    ~EntityTable();
+
+    // Returns nullptr once the table is full.
+    GameEntity*                 create();
+    // Returns false if the entity was not from this table, or was already destroyed.
+    Bool                        destroy(GameEntity* pEntity);
+
+    // Returns nullptr if the handle is stale, or was never valid.
+    GameEntity*                 find(EntityHandle handle) const;
+    Bool                        isAlive(EntityHandle handle) const { return find(handle) != nullptr; }
+
+    U32                         getNumEntities() const { return m_numEntities; }
+    // Slots handed out so far, alive or free.
+    U32                         getNumSlots() const { return m_numSlots.load(MemoryOrder_Relaxed); }
+
+    // Table used by GameEntity::instantiate(), unless allocations are overridden.
+    static EntityTable&         getDefault();
+
+private:
+    struct Page;
+
+    GameEntity*                 getSlot(U32 index) const;
+
+    Page*                       m_pages[kMaxPages];
+    std::vector<U32>            m_freeIndices;
+    Atomic<U32>                 m_numSlots;
+    U32                         m_numEntities;
+    SpinLock                    m_lock;
+};
+} // ECS
+} // Recluse
@@ -10,6 +10,7 @@
 #include "Recluse/RGUID.hpp"
 
 #include "Recluse/Game/GameSystem.hpp"
+#include "Recluse/Game/EntityTable.hpp"
 
 #include <map>
 #include <vector>
@@ -171,6 +172,9 @@ public:
 
     R_PUBLIC_API RGUID                  getUUID() const { return m_guuid; }
 
+    // Handle into the entity table, invalid if the entity was allocated some other way.
+    EntityHandle                        getHandle() const { return EntityHandle::fromRGUID(m_guuid); }
+
     void setName(const std::string& newName) { m_name = newName; }
     void setTag(const std::string& newTag) { m_tag = newTag; }
 
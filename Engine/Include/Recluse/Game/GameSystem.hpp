@@ -8,7 +8,9 @@
 #include "Recluse/Serialization/Serializable.hpp"
 #include "Recluse/RGUID.hpp"
 #include "Recluse/Time.hpp"
+#include "Recluse/Game/Archetype.hpp"
 
+#include <initializer_list>
 #include <tuple>
 #include <vector>
 
@@ -47,6 +49,47 @@ class Registry;
     virtual const char* getName() const override { return systemName(); }
 
 
+// Component types a system touches in onUpdate(), so the SystemScheduler knows which systems may
+// run at the same time. A system that never declares its access is assumed to touch everything.
+//
+// Reads and writes only cover component data. Adding or removing components, or creating and
+// destroying entities, changes the archetype storage itself, which is not thread safe. Systems
+// that do so must not declare their access, so they stay serialized against every other system.
+struct SystemAccess
+{
+    std::vector<ComponentTypeIndex> reads;
+    std::vector<ComponentTypeIndex> writes;
+    Bool                            isDeclared = false;
+
+    // Systems conflict if either writes a type the other reads or writes.
+    Bool conflictsWith(const SystemAccess& other) const
+    {
+        if (!isDeclared || !other.isDeclared)
+        {
+            return true;
+        }
+        return overlaps(writes, other.reads) || overlaps(writes, other.writes) || overlaps(reads, other.writes);
+    }
+
+private:
+    static Bool overlaps(const std::vector<ComponentTypeIndex>& lh, const std::vector<ComponentTypeIndex>& rh)
+    {
+        // A handful of types each, a linear search is fine.
+        for (ComponentTypeIndex index : lh)
+        {
+            for (ComponentTypeIndex other : rh)
+            {
+                if (index == other)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+
 class R_PUBLIC_API AbstractSystem : public Serializable
 {
 public:
@@ -83,6 +126,8 @@ public:
 
     void                    drawDebug(Registry* registry, Engine::DebugRenderer* renderer) { onDrawDebug(registry, renderer); }
 
+    const SystemAccess&     getAccess() const { return m_access; }
+
     // Serialize the system and its components.
     virtual ResultCode      serialize(Archive* archive) const override { return RecluseResult_NoImpl; }
 
@@ -110,10 +155,29 @@ protected:
 
     virtual void            onDrawDebug(Registry* registry, Engine::DebugRenderer* context) { }
 
+    // Declare the component types onUpdate() reads, or reads and writes, usually from
+    // onInitialize(). Once declared, the system may run on a worker, at the same time as other
+    // systems it does not conflict with. Calling either with no types declares that the system
+    // touches no components.
+    template<typename... Components>
+    void                    readsComponents() { declareAccess(m_access.reads, { ComponentTypeId<Components>::index()... }); }
+
+    template<typename... Components>
+    void                    writesComponents() { declareAccess(m_access.writes, { ComponentTypeId<Components>::index()... }); }
+
 private:
+    void declareAccess(std::vector<ComponentTypeIndex>& access, std::initializer_list<ComponentTypeIndex> indices)
+    {
+        access.insert(access.end(), indices);
+        m_access.isDeclared = true;
+    }
+
     // Priority value of this abstract system. This will be used to determine the 
     // order of which this system will operate.
     U32                 m_priority;
+
+    // Components touched by onUpdate().
+    SystemAccess        m_access;
 };
 
 
@@ -0,0 +1,74 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+#include "Recluse/Time.hpp"
+#include "Recluse/JobStreamer.hpp"
+#include "Recluse/Game/GameSystem.hpp"
+
+#include <vector>
+
+namespace Recluse {
+namespace ECS {
+
+
+// Runs a scene's systems as a job graph, built from the component types each system declares it
+// reads and writes. A system waits on every earlier system it conflicts with, so conflicting
+// systems still run in the order they were added, and the rest run at the same time on the pool.
+// The graph is rebuilt only when the systems change.
+class R_PUBLIC_API SystemScheduler
+{
+public:
+    SystemScheduler();
+
+    // Systems to run, in the order they would run one after another.
+    void                            setSystems(const std::vector<AbstractSystem*>& systems);
+
+    // Rebuild the graph on the next update, if a system changed its declared access.
+    void                            invalidate() { m_isDirty = true; }
+
+    // Runs every system once, and waits for them to finish. Systems run one after another on the
+    // calling thread if there is no pool, or if none of them declared their access. Once any
+    // has, systems that did not are still kept in order, but may run on a worker.
+    void                            update(Registry* registry, const RealtimeTick& tick, ThreadPool* pPool);
+
+    U32                             getNumSystems() const { return static_cast<U32>(m_systems.size()); }
+    AbstractSystem*                 getSystem(U32 index) const { return m_systems[index]; }
+
+    // Systems the given one waits on, by index. Only direct dependencies are kept, a system
+    // already waited on through another is left out.
+    const std::vector<U32>&         getDependencies(U32 index) const { return m_dependencies[index]; }
+
+    // Whether the last update ran on the pool.
+    Bool                            isParallel() const { return m_isParallel; }
+
+    // Graph of the systems, with job times and stats of the last parallel update.
+    const JobGraph&                 getGraph() const { return m_graph; }
+
+    // Logs each system, what it waits on, and how long it took in the last parallel update.
+    void                            logSchedule() const;
+
+private:
+    struct SystemJob
+    {
+        SystemScheduler*    pScheduler;
+        AbstractSystem*     pSystem;
+    };
+
+    static U32                      runSystemJob(void* pData);
+
+    void                            build();
+
+    std::vector<AbstractSystem*>    m_systems;
+    std::vector<std::vector<U32>>   m_dependencies;
+    std::vector<SystemJob>          m_jobs;
+    JobGraph                        m_graph;
+    // Arguments of the update in flight, for the system jobs.
+    Registry*                       m_pRegistry;
+    const RealtimeTick*             m_pTick;
+    Bool                            m_anyDeclared;
+    Bool                            m_isParallel;
+    Bool                            m_isDirty;
+};
+} // ECS
+} // Recluse
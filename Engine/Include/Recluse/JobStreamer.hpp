@@ -0,0 +1,131 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+#include "Recluse/Time.hpp"
+#include "Recluse/Threading/ThreadPool.hpp"
+
+#include <vector>
+
+namespace Recluse {
+
+
+enum JobType
+{
+    JobType_Main = 0,      //< Main will always be 0
+    JobType_Simulation,
+    JobType_Renderer,
+    JobType_Physics,
+    JobType_Audio,
+    JobType_Animation,
+    JobType_AI,
+    JobType_Network
+};
+
+
+typedef U32 JobTypeFlags;
+
+// Identifies a job inside of a JobGraph.
+typedef U32 JobNodeId;
+
+static constexpr JobNodeId kInvalidJobNode = ~0u;
+
+struct JobGraphCounters;
+
+
+// Timings gathered from the last execution of a job graph.
+struct JobGraphStats
+{
+    // Time from kick() until the last job finished.
+    F32     wallTimeMs;
+    // Longest chain of dependent jobs. This is the lower bound on the wall time,
+    // no matter how many workers we throw at the graph.
+    F32     criticalPathMs;
+    // Sum of all job times.
+    F32     totalWorkMs;
+    // Ratio of total work to the time available on all threads (workers + the waiting thread.)
+    F32     utilization;
+    U32     numThreads;
+};
+
+
+// Job graph describes work as a DAG of jobs. Each job holds an atomic count of its
+// unfinished dependencies, and the job that finishes last releases its dependents. One
+// released dependent is run right away on the same thread as a continuation, the rest
+// are submitted to the pool. Job types are used as affinity hints, so jobs of the same
+// type prefer to run on the same worker.
+//
+// The graph is built once, and can be kicked again after it has finished, such as once
+// per frame.
+class R_PUBLIC_API JobGraph
+{
+public:
+    JobGraph();
+    ~JobGraph();
+
+    // Add a job to the graph. The name must outlive the graph.
+    JobNodeId       addJob(const char* name, ThreadJob func, void* pPayload = nullptr, JobType affinity = JobType_Main);
+
+    // Job after will not start until job before has finished.
+    ResultCode      addDependency(JobNodeId before, JobNodeId after);
+
+    // Start executing the graph on the given pool. Fails if the graph contains a cycle,
+    // or is still executing. The pool must outlive the graph until wait() returns, the
+    // destructor waits on it too if the graph was never waited on.
+    ResultCode      kick(ThreadPool* pPool);
+
+    // Wait for all jobs in the graph to finish. The calling thread helps execute jobs, or
+    // parks if it is a job running on a pool fiber.
+    ResultCode      wait();
+
+    Bool            isFinished() const;
+
+    // Removes all jobs from the graph.
+    void            reset();
+
+    U32             getNumJobs() const { return static_cast<U32>(m_nodes.size()); }
+    const char*     getJobName(JobNodeId id) const { return m_nodes[id].name; }
+
+    // Duration of the job, from the last execution.
+    F32             getJobTimeMs(JobNodeId id) const;
+
+    const JobGraphStats& getStats() const { return m_stats; }
+
+private:
+    struct JobNode
+    {
+        const char*             name;
+        ThreadJob               func;
+        void*                   pPayload;
+        JobType                 affinity;
+        U32                     numDependencies;
+        std::vector<JobNodeId>  successors;
+    };
+
+    struct JobNodeContext
+    {
+        JobGraph*               pGraph;
+        JobNodeId               id;
+        RealtimeStopWatch       startTime;
+        RealtimeStopWatch       endTime;
+    };
+
+    static U32      runJobNode(void* pData);
+
+    ResultCode      sortTopologically();
+    void            submitNode(JobNodeId id);
+    U32             getWorkerHint(JobType affinity) const;
+    void            gatherStats();
+
+    std::vector<JobNode>        m_nodes;
+    std::vector<JobNodeContext> m_contexts;
+    std::vector<JobNodeId>      m_topologicalOrder;
+    std::vector<F32>            m_pathTimesMs;
+    // Dependency counters for the current execution.
+    JobGraphCounters*           m_pCounters;
+    ThreadPool*                 m_pPool;
+    RealtimeStopWatch           m_kickTime;
+    JobGraphStats               m_stats;
+    Bool                        m_isDirty;
+};
+} // Recluse
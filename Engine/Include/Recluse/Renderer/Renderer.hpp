@@ -7,6 +7,8 @@
 #include "Recluse/Graphics/GraphicsCommon.hpp"
 #include "Recluse/Memory/MemoryPool.hpp"
 #include "Recluse/Memory/Allocator.hpp"
+#include "Recluse/Memory/LinearAllocator.hpp"
+#include "Recluse/Memory/StdAllocatorAdapter.hpp"
 #include "Recluse/Application.hpp"
 
 #include "Recluse/Structures/HashMap.hpp"
@@ -18,6 +20,7 @@
 
 #include "Recluse/System/DLLLoader.hpp"
 #include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Threading/Locks.hpp"
 
 #include <vector>
 #include <functional>
@@ -91,7 +94,8 @@ struct MaterialDescription
 };
 
 
-typedef MapContainer<U32, std::vector<U64>> CommandKeyContainer;
+typedef Arena::HashMap<U32, Arena::Vector<U64>>                    CommandKeyMap;
+typedef MapContainer<U32, Arena::Vector<U64>, CommandKeyMap>       CommandKeyContainer;
 
 // Top level rendering engine. Implements Render Hardware Interface, and 
 // manages all resources and states created in game graphics. This will usually
@@ -135,11 +139,10 @@ public:
     GraphicsContext*            getContext() { return m_pContext; }
 
     // Set the new configurations for the renderer. This won't be used until we call recreate().
-    // Call will be blocked if we are in the middle of recreating.
+    // Safe to call from any thread, and never blocks on the render thread.
     void                        setNewConfigurations(const RendererConfigs& newConfigs) 
     { 
-        ScopedLock lck(m_configLock); 
-        m_newRendererConfigs = newConfigs; 
+        m_newRendererConfigs.store(newConfigs); 
     }
 
     // Grabs the device that is performing the actual rendering. 
@@ -181,6 +184,7 @@ private:
     void                        freeSceneBuffers();
 
     void                        resetCommandKeys();
+    void                        resetFrameContainers(U32 frameIndex);
     void                        sortCommandKeys();
 
     ResultCode                  createTemporaryResourcePool(U32 bufferCount);
@@ -194,9 +198,8 @@ private:
     GraphicsContext*                    m_pContext;
 
     // Renderer configs.
-    Mutex                               m_configLock;
     RendererConfigs                     m_currentRendererConfigs;
-    RendererConfigs                     m_newRendererConfigs;
+    SeqLock<RendererConfigs>            m_newRendererConfigs;
     void*                               m_windowHandle;
 
     // Scene buffer objects.
@@ -239,8 +242,17 @@ private:
         std::vector<Allocator*> PerFrameAllocator;
     };
 
-    // command keys identify the index within the render command, to begin rendering for.
-    std::vector<std::unordered_map<U32, std::vector<U64>>>  m_commandKeys;
+    // Containers filled in over a frame, and thrown away once its buffer comes back around.
+    // They live in an arena of their own, one per frame buffer, instead of the global heap.
+    struct FrameContainers
+    {
+        MemoryPool          pool;
+        LinearAllocator     allocator;
+        // command keys identify the index within the render command, to begin rendering for.
+        CommandKeyMap*      pCommandKeys;
+    };
+
+    std::vector<FrameContainers*>                           m_frameContainers;
     RenderCommandList*                                      m_currentRenderCommands;
     CommandKeyContainer                                     m_currentCommandKeys;
     std::vector<DebugDrawFunction>                          m_debugDrawFunctions;
@@ -4,6 +4,7 @@
 #include "Recluse/Types.hpp"
 
 #include "Recluse/Game/GameEntity.hpp"
+#include "Recluse/Game/SystemScheduler.hpp"
 #include "Recluse/Serialization/Serializable.hpp"
 
 #include <vector>
@@ -49,7 +50,8 @@ public:
     // Deserialize the serialize.
     R_PUBLIC_API ResultCode                     load(Archive* pArchive);
 
-    // Update the scene systems. This can also be overridden to allow multithreading purposes.
+    // Update the scene systems. Systems that declare the components they read and write run at
+    // the same time on the engine thread pool, see ECS::SystemScheduler.
     virtual R_PUBLIC_API void                   update(ECS::Registry* registry, const RealtimeTick& tick);
 
     // add a camera to the scene.
@@ -61,6 +63,12 @@ public:
 
     void                                        drawDebug(ECS::Registry* registry, DebugRenderer* debugRenderer);
 
+    // Entities of the registry with all of the component types, iterated in place over their
+    // storage. Chain exclude<Types...>() to skip entities with any of the given types. Only sees
+    // component types added with Registry::addArchetypeRegistry().
+    template<typename... Components>
+    ECS::View<Components...>                    view(ECS::Registry* registry) const { return registry->view<Components...>(); }
+
     // Adds a system into this scene. Systems are usually global, but in our engine, they are 
     // only global to our respective scene. Therefore, it is essential that any new scenes must 
     // use any old systems, if we require transitions! 
@@ -73,6 +81,9 @@ public:
         registerSystem(system, bus);
     }
 
+    // Schedule of the scene systems, to inspect what runs in parallel.
+    const ECS::SystemScheduler&                 getScheduler() const { return m_scheduler; }
+
 protected:
 
     // Serialize the given scene. This should be used for 
@@ -107,6 +118,9 @@ private:
 
     // Systems to update.
     std::vector<ECS::AbstractSystem*>   m_systems;
+
+    // Runs the systems, in parallel where their components allow.
+    ECS::SystemScheduler                m_scheduler;
 };
 } // Engine
 } // Recluse
\ No newline at end of file
@@ -3,16 +3,27 @@
 #include "Recluse/System/Input.hpp"
 
 #include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/System/Process.hpp"
+#include "Recluse/System/Architecture.hpp"
+#include "Recluse/Memory/FrameAllocator.hpp"
+#include "Recluse/Memory/MemoryScan.hpp"
+#include "Recluse/Memory/MemoryBudget.hpp"
 
 #include "Recluse/Application.hpp"
 #include "Recluse/Messaging.hpp"
 
 namespace Recluse {
 
+// Physical cores kept for the main and render threads, when there are enough of them to go
+// around. Below that, threads are left for the OS to place.
+static const U32 kMinCoresForPinning        = 4u;
+// Logical processors of the core kept for the render thread. 0 leaves it unpinned.
+static U64 g_renderThreadProcessorMask      = 0ull;
+
 #define LOAD_JOB_THREAD(jobType, flags, thread, jobThreadADT) \
     { \
         if (flags & jobType) \
-            if (jobThreadADT.find(jobType) != jobThreadADT.end()) \
+            if (jobThreadADT.find(jobType) == jobThreadADT.end()) \
                 jobThreadADT[jobType] = thread; \
     }
 
@@ -26,6 +37,11 @@ ResultCode Application::loadJobThread(JobTypeFlags flags, ThreadFunction func)
     {
         m_threads.push_back(pThread);
 
+        if ((flags & JobType_Renderer) && g_renderThreadProcessorMask)
+        {
+            setThreadAffinity(&m_threads.back(), g_renderThreadProcessorMask);
+        }
+
         LOAD_JOB_THREAD(JobType_Renderer,      flags, &m_threads.back(), m_jobThreads);
         LOAD_JOB_THREAD(JobType_Simulation,    flags, &m_threads.back(), m_jobThreads);
         LOAD_JOB_THREAD(JobType_AI,            flags, &m_threads.back(), m_jobThreads);
@@ -63,6 +79,7 @@ MessageBus* k_pMessageBus   = nullptr;
 Mutex k_pMessageMutex       = MutexValue::kNull;
 F32 k_fixedTickRateSeconds  = 1.0f / 60.0f;
 Bool k_mainLoopInitialized  = false;
+U64 k_frameIndex            = 0ull;
 
 ResultCode loadApp(Application* pApp)
 {
@@ -88,9 +105,50 @@ ResultCode initialize()
 {
     R_ASSERT(k_pMessageMutex == MutexValue::kNull);
 
+    // Budgets are charged against the scanner's counters. Sampling stays off unless the app
+    // asked for it.
+    if (MemoryBudgets::hasBudgets() && !MemoryScanner::isTracking())
+    {
+        MemoryScanner::enableTracking(0u);
+    }
+
     k_pMessageMutex = createMutex();
     k_pMessageBus = new MessageBus();
-    k_pMessageBus->initialize();
+    k_pMessageBus->initialize(MemoryBudgets::getBudgetBytes(MemoryTag_Messaging, R_MB(2ull)));
+
+    // Frame N is still being read by the render thread while the sim thread builds frame N + 1.
+    FrameAllocator::initialize(2u);
+
+    // With enough cores, the main thread gets the first physical core, the render thread the
+    // second, and one worker is pinned to each of the rest. SMT siblings of a core mostly
+    // compete for the same execution units, so workers do not double up on them.
+    Process::CpuTopology topology;
+    const Bool pinThreads = (Process::queryCpuTopology(topology) == RecluseResult_Ok) && (topology.cores.size() >= kMinCoresForPinning);
+    U32 numWorkers = 1;
+    if (pinThreads)
+    {
+        numWorkers                      = static_cast<U32>(topology.cores.size()) - 2;
+        g_renderThreadProcessorMask     = topology.cores[1].processorMask;
+    }
+    else
+    {
+        // The main thread helps out while waiting on jobs, so leave a core for it.
+        Process::CpuInfo cpuInfo = { };
+        if (Process::queryCpuInfo(cpuInfo) == RecluseResult_Ok && cpuInfo.numberLogicalProcessors > 1)
+        {
+            numWorkers = cpuInfo.numberLogicalProcessors - 1;
+        }
+    }
+    k_pThreadPool = new ThreadPool(numWorkers);
+
+    if (pinThreads)
+    {
+        setCurrentThreadAffinity(topology.cores[0].processorMask);
+        for (U32 i = 0; i < numWorkers; ++i)
+        {
+            k_pThreadPool->setWorkerAffinity(i, topology.cores[i + 2].processorMask);
+        }
+    }
 
     k_pWindow = Window::create(u8"TestApp", 0, 0, 800, 600);
     k_pWindow->show();
@@ -112,6 +170,11 @@ ResultCode MainThreadLoop::run()
 
     while (!k_pWindow->shouldClose()) 
     {
+        // Transient allocations made two frames back are done with, wipe them.
+        FrameAllocator::beginFrame(k_frameIndex++);
+        // No-op, unless the app enabled allocation tracking before initializing the loop.
+        MemoryScanner::markFrame();
+        MemoryBudgets::update();
         RealtimeTick::updateWatch(getCurrentThreadId(), JobType_Main);
         RealtimeTick tick = RealtimeTick::getTick(JobType_Main);
         pollEvents();
@@ -149,6 +212,12 @@ ResultCode cleanUp()
     Window::destroy(k_pWindow);
     k_pWindow = nullptr;
 
+    delete k_pThreadPool;
+    k_pThreadPool = nullptr;
+
+    // Workers are joined by now, nothing allocates from the frame arenas anymore.
+    FrameAllocator::cleanUp();
+
     destroyMutex(k_pMessageMutex);
     k_pMessageMutex = MutexValue::kNull;
 
@@ -156,6 +225,9 @@ ResultCode cleanUp()
     k_pMessageBus->cleanUp();
     delete k_pMessageBus;
 
+    // Whatever is still live by now was never freed. Only reports if the app enabled tracking.
+    MemoryScanner::reportLeaks();
+
     k_mainLoopInitialized = false;
     return result;
 }
@@ -180,6 +252,19 @@ MessageBus* getMessageBus()
 }
 
 
+ThreadPool* getThreadPool()
+{
+    R_ASSERT_FORMAT(k_pThreadPool, "No thread pool was initialized! NULL!!");
+    return k_pThreadPool;
+}
+
+
+ThreadPool* tryGetThreadPool()
+{
+    return k_pThreadPool;
+}
+
+
 F32 getFixedTickRate()
 {
     return k_fixedTickRateSeconds;
@@ -0,0 +1,507 @@
+//
+#include "Recluse/Game/Archetype.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Threading/Locks.hpp"
+
+#include <algorithm>
+
+namespace Recluse {
+namespace ECS {
+
+
+static SpinLock g_componentTypeIndexLock;
+
+
+ComponentTypeIndex getComponentTypeIndex(ComponentUUID uuid)
+{
+    // Function local, so types looked up during static initialization still find it built. Only
+    // called the first time each type is looked up, ComponentTypeId caches the result.
+    static std::unordered_map<ComponentUUID, ComponentTypeIndex> indices;
+    ScopedSpinLock lock(g_componentTypeIndexLock);
+    auto it = indices.find(uuid);
+    if (it != indices.end())
+    {
+        return it->second;
+    }
+
+    const ComponentTypeIndex index = static_cast<ComponentTypeIndex>(indices.size());
+    indices.insert(std::make_pair(uuid, index));
+    return index;
+}
+
+
+static U32 alignUp(U32 value, U32 alignment)
+{
+    return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+
+Archetype::Archetype(const std::vector<const ComponentTypeInfo*>& types)
+    : m_types(types)
+    , m_chunkCapacity(0u)
+    , m_numEntities(0u)
+    , m_signatureHash(hashTypes(types))
+{
+    U32 rowSizeBytes = sizeof(RGUID);
+    for (const ComponentTypeInfo* pType : m_types)
+    {
+        R_ASSERT_FORMAT(pType->alignment <= kChunkAlignment, "Component alignment of %d is more than chunks are aligned to!", pType->alignment);
+        rowSizeBytes += pType->sizeBytes;
+    }
+
+    // Start from the most rows that could fit, and back off until the padding between columns
+    // fits as well.
+    m_columnOffsets.resize(m_types.size());
+    for (m_chunkCapacity = static_cast<U32>(kChunkSizeBytes / rowSizeBytes); m_chunkCapacity > 1u; --m_chunkCapacity)
+    {
+        U32 offsetBytes = sizeof(RGUID) * m_chunkCapacity;
+        for (U32 i = 0; i < m_types.size(); ++i)
+        {
+            offsetBytes         = alignUp(offsetBytes, m_types[i]->alignment);
+            m_columnOffsets[i]  = offsetBytes;
+            offsetBytes        += m_types[i]->sizeBytes * m_chunkCapacity;
+        }
+
+        if (offsetBytes <= kChunkSizeBytes)
+        {
+            break;
+        }
+    }
+
+    R_ASSERT_FORMAT(m_chunkCapacity > 1u, "Archetype with %d components does not fit in a chunk!", static_cast<U32>(m_types.size()));
+}
+
+
+Archetype::~Archetype()
+{
+    clear();
+    for (U8* pChunk : m_chunks)
+    {
+        rlsFreeBytes(pChunk);
+    }
+    m_chunks.clear();
+}
+
+
+void Archetype::sortTypes(std::vector<const ComponentTypeInfo*>& types)
+{
+    std::sort(types.begin(), types.end(), [] (const ComponentTypeInfo* lh, const ComponentTypeInfo* rh) -> bool { return lh->uuid < rh->uuid; });
+}
+
+
+U64 Archetype::hashTypes(const std::vector<const ComponentTypeInfo*>& types)
+{
+    U64 hash = 14695981039346656037ull;
+    for (const ComponentTypeInfo* pType : types)
+    {
+        hash = (hash ^ pType->uuid) * 1099511628211ull;
+    }
+    return hash;
+}
+
+
+I32 Archetype::findColumn(ComponentUUID uuid) const
+{
+    // Archetypes hold a handful of types, a linear search beats anything smarter.
+    for (U32 i = 0; i < m_types.size(); ++i)
+    {
+        if (m_types[i]->uuid == uuid)
+        {
+            return static_cast<I32>(i);
+        }
+    }
+    return -1;
+}
+
+
+U32 Archetype::allocateRow(const RGUID& entity)
+{
+    const U32 row = m_numEntities;
+    if (row == (getNumChunks() * m_chunkCapacity))
+    {
+        U8* pChunk = static_cast<U8*>(rlsAllocateBytes(kChunkSizeBytes, 1u, MemoryTag_Scene));
+        m_chunks.push_back(pChunk);
+    }
+
+    m_numEntities += 1;
+    new (&getEntity(row)) RGUID(entity);
+    return row;
+}
+
+
+RGUID Archetype::fillRow(U32 row)
+{
+    R_ASSERT(row < m_numEntities);
+    const U32 lastRow = m_numEntities - 1u;
+    RGUID movedEntity;
+    if (row != lastRow)
+    {
+        movedEntity = getEntity(lastRow);
+        getEntity(row) = movedEntity;
+        for (U32 i = 0; i < m_types.size(); ++i)
+        {
+            m_types[i]->relocate(getComponent(row, i), getComponent(lastRow, i));
+        }
+    }
+
+    m_numEntities -= 1;
+
+    // Keep one empty chunk around, so an entity going back and forth over a chunk boundary does
+    // not allocate each time.
+    const U32 chunksInUse = (m_numEntities + m_chunkCapacity - 1u) / m_chunkCapacity;
+    while (getNumChunks() > (chunksInUse + 1u))
+    {
+        rlsFreeBytes(m_chunks.back());
+        m_chunks.pop_back();
+    }
+
+    return movedEntity;
+}
+
+
+RGUID Archetype::freeRow(U32 row)
+{
+    R_ASSERT(row < m_numEntities);
+    for (U32 i = 0; i < m_types.size(); ++i)
+    {
+        m_types[i]->destruct(getComponent(row, i));
+    }
+    return fillRow(row);
+}
+
+
+U32 Archetype::moveRow(U32 row, Archetype* pDst, RGUID& movedEntity)
+{
+    R_ASSERT(row < m_numEntities);
+    const U32 dstRow = pDst->allocateRow(getEntity(row));
+
+    // Both type lists are sorted, so walk them together.
+    U32 srcColumn = 0;
+    U32 dstColumn = 0;
+    while ((srcColumn < m_types.size()) || (dstColumn < pDst->m_types.size()))
+    {
+        const ComponentTypeInfo* pSrcType = (srcColumn < m_types.size()) ? m_types[srcColumn] : nullptr;
+        const ComponentTypeInfo* pDstType = (dstColumn < pDst->m_types.size()) ? pDst->m_types[dstColumn] : nullptr;
+        if (pSrcType && pDstType && (pSrcType->uuid == pDstType->uuid))
+        {
+            pSrcType->relocate(pDst->getComponent(dstRow, dstColumn++), getComponent(row, srcColumn++));
+        }
+        else if (pDstType && (!pSrcType || (pDstType->uuid < pSrcType->uuid)))
+        {
+            pDstType->construct(pDst->getComponent(dstRow, dstColumn++));
+        }
+        else
+        {
+            pSrcType->destruct(getComponent(row, srcColumn++));
+        }
+    }
+
+    movedEntity = fillRow(row);
+    return dstRow;
+}
+
+
+void Archetype::clear()
+{
+    for (U32 row = 0; row < m_numEntities; ++row)
+    {
+        for (U32 i = 0; i < m_types.size(); ++i)
+        {
+            m_types[i]->destruct(getComponent(row, i));
+        }
+    }
+    m_numEntities = 0u;
+}
+
+
+Archetype* Archetype::getAddEdge(ComponentUUID uuid) const
+{
+    auto it = m_addEdges.find(uuid);
+    return (it != m_addEdges.end()) ? it->second : nullptr;
+}
+
+
+Archetype* Archetype::getRemoveEdge(ComponentUUID uuid) const
+{
+    auto it = m_removeEdges.find(uuid);
+    return (it != m_removeEdges.end()) ? it->second : nullptr;
+}
+
+
+ArchetypeStorage::ArchetypeStorage()
+    : m_pEmptyArchetype(nullptr)
+    , m_structureVersion(0ull)
+{
+    std::vector<const ComponentTypeInfo*> types;
+    m_pEmptyArchetype = findOrCreateArchetype(types);
+}
+
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+    for (auto& query : m_queries)
+    {
+        delete query.second;
+    }
+    m_queries.clear();
+
+    for (Archetype* pArchetype : m_archetypes)
+    {
+        delete pArchetype;
+    }
+    m_archetypes.clear();
+    m_archetypesBySignature.clear();
+    m_entities.clear();
+}
+
+
+Archetype* ArchetypeStorage::findOrCreateArchetype(std::vector<const ComponentTypeInfo*>& types)
+{
+    Archetype::sortTypes(types);
+    const U64 hash = Archetype::hashTypes(types);
+    auto range = m_archetypesBySignature.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const std::vector<const ComponentTypeInfo*>& archetypeTypes = it->second->getTypes();
+        const Bool matches = std::equal
+            (
+                archetypeTypes.begin(), archetypeTypes.end(), types.begin(), types.end(),
+                [] (const ComponentTypeInfo* lh, const ComponentTypeInfo* rh) -> bool { return lh->uuid == rh->uuid; }
+            );
+        if (matches)
+        {
+            return it->second;
+        }
+    }
+
+    Archetype* pArchetype = new Archetype(types);
+    m_archetypes.push_back(pArchetype);
+    m_archetypesBySignature.insert(std::make_pair(hash, pArchetype));
+    return pArchetype;
+}
+
+
+void ArchetypeStorage::updateMovedEntity(const RGUID& movedEntity, Archetype* pArchetype, U32 row)
+{
+    if (movedEntity.isValid())
+    {
+        EntityLocation& movedLocation = m_entities[movedEntity];
+        movedLocation.pArchetype    = pArchetype;
+        movedLocation.row           = row;
+    }
+}
+
+
+void ArchetypeStorage::moveEntity(EntityLocation& location, Archetype* pDst)
+{
+    Archetype* pSrc     = location.pArchetype;
+    const U32 srcRow    = location.row;
+    RGUID movedEntity;
+    location.row        = pSrc->moveRow(srcRow, pDst, movedEntity);
+    location.pArchetype = pDst;
+    updateMovedEntity(movedEntity, pSrc, srcRow);
+    m_structureVersion += 1;
+}
+
+
+void* ArchetypeStorage::addComponent(const RGUID& entity, const ComponentTypeInfo* pTypeInfo)
+{
+    auto it = m_entities.find(entity);
+    if (it == m_entities.end())
+    {
+        EntityLocation location = { m_pEmptyArchetype, m_pEmptyArchetype->allocateRow(entity) };
+        it = m_entities.insert(std::make_pair(entity, location)).first;
+    }
+
+    EntityLocation& location    = it->second;
+    Archetype* pSrc             = location.pArchetype;
+    I32 column                  = pSrc->findColumn(pTypeInfo->uuid);
+    if (column >= 0)
+    {
+        return pSrc->getComponent(location.row, column);
+    }
+
+    Archetype* pDst = pSrc->getAddEdge(pTypeInfo->uuid);
+    if (!pDst)
+    {
+        std::vector<const ComponentTypeInfo*> types = pSrc->getTypes();
+        types.push_back(pTypeInfo);
+        pDst = findOrCreateArchetype(types);
+        pSrc->setAddEdge(pTypeInfo->uuid, pDst);
+        pDst->setRemoveEdge(pTypeInfo->uuid, pSrc);
+    }
+
+    moveEntity(location, pDst);
+    return pDst->getComponent(location.row, pDst->findColumn(pTypeInfo->uuid));
+}
+
+
+Bool ArchetypeStorage::removeComponent(const RGUID& entity, ComponentUUID uuid)
+{
+    auto it = m_entities.find(entity);
+    if (it == m_entities.end())
+    {
+        return false;
+    }
+
+    EntityLocation& location    = it->second;
+    Archetype* pSrc             = location.pArchetype;
+    if (!pSrc->hasComponent(uuid))
+    {
+        return false;
+    }
+
+    Archetype* pDst = pSrc->getRemoveEdge(uuid);
+    if (!pDst)
+    {
+        std::vector<const ComponentTypeInfo*> types;
+        for (const ComponentTypeInfo* pType : pSrc->getTypes())
+        {
+            if (pType->uuid != uuid)
+            {
+                types.push_back(pType);
+            }
+        }
+        pDst = findOrCreateArchetype(types);
+        pSrc->setRemoveEdge(uuid, pDst);
+        pDst->setAddEdge(uuid, pSrc);
+    }
+
+    // Nothing left to store for the entity, drop it rather than keep an empty row around.
+    if (pDst == m_pEmptyArchetype)
+    {
+        return destroyEntity(entity);
+    }
+
+    moveEntity(location, pDst);
+    return true;
+}
+
+
+void* ArchetypeStorage::getComponent(const RGUID& entity, ComponentUUID uuid) const
+{
+    auto it = m_entities.find(entity);
+    if (it == m_entities.end())
+    {
+        return nullptr;
+    }
+
+    const EntityLocation& location  = it->second;
+    const I32 column                = location.pArchetype->findColumn(uuid);
+    return (column >= 0) ? location.pArchetype->getComponent(location.row, column) : nullptr;
+}
+
+
+Bool ArchetypeStorage::destroyEntity(const RGUID& entity)
+{
+    auto it = m_entities.find(entity);
+    if (it == m_entities.end())
+    {
+        return false;
+    }
+
+    Archetype* pArchetype   = it->second.pArchetype;
+    const U32 row           = it->second.row;
+    m_entities.erase(it);
+    updateMovedEntity(pArchetype->freeRow(row), pArchetype, row);
+    m_structureVersion += 1;
+    return true;
+}
+
+
+Bool ArchetypeStorage::findColumns(const Archetype* pArchetype, const ComponentUUID* pUuids, I32* pColumns, U32 count)
+{
+    for (U32 i = 0; i < count; ++i)
+    {
+        pColumns[i] = pArchetype->findColumn(pUuids[i]);
+        if (pColumns[i] < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+const ArchetypeQuery* ArchetypeStorage::getQuery(const ComponentUUID* pIncludes, U32 numIncludes, const ComponentUUID* pExcludes, U32 numExcludes) const
+{
+    U64 hash = 14695981039346656037ull;
+    for (U32 i = 0; i < numIncludes; ++i)
+    {
+        hash = (hash ^ pIncludes[i]) * 1099511628211ull;
+    }
+    // Keeps a type from hashing the same as an include or as an exclude.
+    hash = (hash ^ numIncludes) * 1099511628211ull;
+    for (U32 i = 0; i < numExcludes; ++i)
+    {
+        hash = (hash ^ pExcludes[i]) * 1099511628211ull;
+    }
+
+    ScopedSpinLock lock(m_queryLock);
+    ArchetypeQuery* pQuery = nullptr;
+    auto range = m_queries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const ArchetypeQuery* pCandidate = it->second;
+        if (std::equal(pCandidate->includes.begin(), pCandidate->includes.end(), pIncludes, pIncludes + numIncludes)
+            && std::equal(pCandidate->excludes.begin(), pCandidate->excludes.end(), pExcludes, pExcludes + numExcludes))
+        {
+            pQuery = it->second;
+            break;
+        }
+    }
+
+    if (!pQuery)
+    {
+        pQuery                          = new ArchetypeQuery();
+        pQuery->includes.assign(pIncludes, pIncludes + numIncludes);
+        pQuery->excludes.assign(pExcludes, pExcludes + numExcludes);
+        pQuery->numArchetypesChecked    = 0u;
+        m_queries.insert(std::make_pair(hash, pQuery));
+    }
+
+    updateQuery(pQuery);
+    return pQuery;
+}
+
+
+void ArchetypeStorage::updateQuery(ArchetypeQuery* pQuery) const
+{
+    // Archetypes are never removed, only added to the end, so only new ones need checking.
+    const U32 numIncludes = static_cast<U32>(pQuery->includes.size());
+    for (; pQuery->numArchetypesChecked < m_archetypes.size(); ++pQuery->numArchetypesChecked)
+    {
+        Archetype* pArchetype   = m_archetypes[pQuery->numArchetypesChecked];
+        const SizeT offset      = pQuery->columns.size();
+        pQuery->columns.resize(offset + numIncludes);
+
+        Bool matches = findColumns(pArchetype, pQuery->includes.data(), pQuery->columns.data() + offset, numIncludes);
+        for (U32 i = 0; matches && (i < pQuery->excludes.size()); ++i)
+        {
+            matches = !pArchetype->hasComponent(pQuery->excludes[i]);
+        }
+
+        if (matches)
+        {
+            pQuery->archetypes.push_back(pArchetype);
+        }
+        else
+        {
+            pQuery->columns.resize(offset);
+        }
+    }
+}
+
+
+void ArchetypeStorage::clear()
+{
+    for (Archetype* pArchetype : m_archetypes)
+    {
+        pArchetype->clear();
+    }
+    m_entities.clear();
+    m_structureVersion += 1;
+}
+} // ECS
+} // Recluse
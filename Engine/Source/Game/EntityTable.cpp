@@ -0,0 +1,140 @@
+//
+#include "Recluse/Game/EntityTable.hpp"
+#include "Recluse/Game/GameEntity.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+namespace Recluse {
+namespace ECS {
+
+
+struct EntityTable::Page
+{
+    U32                                         generations[kEntitiesPerPage];
+    std::aligned_storage<sizeof(GameEntity), alignof(GameEntity)>::type
+                                                entities[kEntitiesPerPage];
+};
+
+
+EntityTable::EntityTable()
+    : m_numEntities(0u)
+{
+    memset(m_pages, 0, sizeof(m_pages));
+}
+
+
+EntityTable::~EntityTable()
+{
+    if (m_numEntities)
+    {
+        R_WARN("EntityTable", "%d entities were never destroyed!", m_numEntities);
+    }
+
+    for (U32 i = 0; i < kMaxPages && m_pages[i]; ++i)
+    {
+        rlsFree(m_pages[i]);
+        m_pages[i] = nullptr;
+    }
+}
+
+
+EntityTable& EntityTable::getDefault()
+{
+    static EntityTable table;
+    return table;
+}
+
+
+GameEntity* EntityTable::getSlot(U32 index) const
+{
+    Page* pPage = m_pages[index / kEntitiesPerPage];
+    return reinterpret_cast<GameEntity*>(&pPage->entities[index % kEntitiesPerPage]);
+}
+
+
+GameEntity* EntityTable::create()
+{
+    U32 index = EntityHandle::kInvalidIndex;
+    U32 generation = 0u;
+    {
+        ScopedSpinLock lock(m_lock);
+        if (!m_freeIndices.empty())
+        {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        }
+        else if (m_numSlots.load(MemoryOrder_Relaxed) < kMaxEntities)
+        {
+            index = m_numSlots.load(MemoryOrder_Relaxed);
+            if ((index % kEntitiesPerPage) == 0)
+            {
+                // Value initialized, so generations start at 0.
+                m_pages[index / kEntitiesPerPage] = rlsMalloc<Page, MemoryTag_Scene>();
+            }
+            // Published after the page, for find() to read without the lock.
+            m_numSlots.store(index + 1u, MemoryOrder_Release);
+        }
+        else
+        {
+            R_ERROR("EntityTable", "Entity table is full! (max=%d)", kMaxEntities);
+            return nullptr;
+        }
+
+        // Odd while alive.
+        U32& slotGeneration = m_pages[index / kEntitiesPerPage]->generations[index % kEntitiesPerPage];
+        generation          = ++slotGeneration;
+        m_numEntities      += 1;
+    }
+
+    GameEntityAllocation allocation = { };
+    GameEntity* pEntity             = getSlot(index);
+    allocation.offsetAddress        = reinterpret_cast<U64>(pEntity);
+    allocation.szBytes              = sizeof(GameEntity);
+    allocation.allocType            = GameEntityMemoryAllocationType_Dynamic;
+    return new (pEntity) GameEntity(allocation, EntityHandle(index, generation).toRGUID());
+}
+
+
+Bool EntityTable::destroy(GameEntity* pEntity)
+{
+    if (!pEntity)
+    {
+        return false;
+    }
+
+    const EntityHandle handle = EntityHandle::fromRGUID(pEntity->getUUID());
+    if (find(handle) != pEntity)
+    {
+        return false;
+    }
+
+    pEntity->~GameEntity();
+
+    ScopedSpinLock lock(m_lock);
+    m_pages[handle.index / kEntitiesPerPage]->generations[handle.index % kEntitiesPerPage] += 1;
+    m_freeIndices.push_back(handle.index);
+    m_numEntities -= 1;
+    return true;
+}
+
+
+GameEntity* EntityTable::find(EntityHandle handle) const
+{
+    if (handle.index >= m_numSlots.load(MemoryOrder_Acquire))
+    {
+        return nullptr;
+    }
+
+    const Page* pPage = m_pages[handle.index / kEntitiesPerPage];
+    if (pPage->generations[handle.index % kEntitiesPerPage] != handle.generation)
+    {
+        return nullptr;
+    }
+
+    return getSlot(handle.index);
+}
+} // ECS
+} // Recluse
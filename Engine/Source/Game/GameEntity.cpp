@@ -1,5 +1,6 @@
 //
 #include "Recluse/Game/GameEntity.hpp"
+#include "Recluse/Game/EntityTable.hpp"
 #include "Recluse/Messaging.hpp"
 #include "Recluse/Filesystem/Archive.hpp"
 
@@ -7,26 +8,14 @@ namespace Recluse {
 namespace ECS {
 
 
+// Default allocations go to the default entity table. The entity RGUID holds its table handle.
 static GameEntity* defaultAlloc(U64 szBytes, GameEntityMemoryAllocationType type)
 {
-    GameEntityAllocation allocation = { };
-
     R_ASSERT(szBytes == sizeof(GameEntity));
 
     if (type == GameEntityMemoryAllocationType_Dynamic)
     {
-        allocation.offsetAddress    = (SizeT)malloc(szBytes);
-        allocation.szBytes          = szBytes;
-        allocation.allocType        = type;
-
-        // A probably not so good way of keeping the allocation, but it is indeed default.
-        RGUID guid      = { };
-        guid.ss.hash0   = (U32)((allocation.offsetAddress & 0x00000000FFFFFFFF)      );
-        guid.ss.hash1   = (U32)((allocation.offsetAddress & 0xFFFFFFFF00000000) >> 32);
-    
-        void* ptr       = reinterpret_cast<void*>(allocation.offsetAddress);
-
-        return new (ptr) GameEntity(allocation, guid);
+        return EntityTable::getDefault().create();
     }
     else
     {
@@ -41,22 +30,17 @@ static void defaultFree(GameEntity* pEntity)
 {
     R_ASSERT(pEntity != NULL);
 
-    GameEntityAllocation allocation = pEntity->getAllocation();
-    
-    free((void*)allocation.offsetAddress);
+    if (!EntityTable::getDefault().destroy(pEntity))
+    {
+        R_ERROR("GameEntity", "Entity was already freed, or not allocated from the entity table!");
+    }
 }
 
 
 static GameEntity* defaultGetEntity(const RGUID& rguid)
 {
-    // Invalid guid, will return nullptr.
-    if (rguid == RGUID::kInvalidValue)
-        return nullptr;
-
-    // Get the rguid hash.
-    SizeT address = U64(rguid.ss.hash0) | (U64(rguid.ss.hash1) << 32);
-    GameEntity* pEntity = reinterpret_cast<GameEntity*>(address);
-    return pEntity;
+    // Handles of destroyed entities, and invalid guids, will return nullptr.
+    return EntityTable::getDefault().find(EntityHandle::fromRGUID(rguid));
 }
 
 
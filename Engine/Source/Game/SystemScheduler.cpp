@@ -0,0 +1,137 @@
+//
+#include "Recluse/Game/SystemScheduler.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <string>
+
+namespace Recluse {
+namespace ECS {
+
+
+SystemScheduler::SystemScheduler()
+    : m_pRegistry(nullptr)
+    , m_pTick(nullptr)
+    , m_anyDeclared(false)
+    , m_isParallel(false)
+    , m_isDirty(true)
+{
+}
+
+
+void SystemScheduler::setSystems(const std::vector<AbstractSystem*>& systems)
+{
+    m_systems = systems;
+    m_isDirty = true;
+}
+
+
+void SystemScheduler::build()
+{
+    const U32 numSystems = getNumSystems();
+    m_dependencies.assign(numSystems, std::vector<U32>());
+    m_jobs.resize(numSystems);
+    m_graph.reset();
+    m_anyDeclared = false;
+
+    // Every system that runs before each one, directly or not, so dependencies already implied
+    // by another are left out.
+    std::vector<std::vector<Bool>> ancestors(numSystems, std::vector<Bool>(numSystems, false));
+    for (U32 i = 0; i < numSystems; ++i)
+    {
+        const SystemAccess& access  = m_systems[i]->getAccess();
+        m_anyDeclared               = m_anyDeclared || access.isDeclared;
+        m_jobs[i].pScheduler        = this;
+        m_jobs[i].pSystem           = m_systems[i];
+        m_graph.addJob(m_systems[i]->getName(), runSystemJob, &m_jobs[i], JobType_Simulation);
+
+        // Nearest first, so the ancestors of a dependency are known before reaching them.
+        for (U32 j = i; j-- > 0; )
+        {
+            if (ancestors[i][j] || !access.conflictsWith(m_systems[j]->getAccess()))
+            {
+                continue;
+            }
+
+            m_dependencies[i].push_back(j);
+            m_graph.addDependency(j, i);
+            ancestors[i][j] = true;
+            for (U32 k = 0; k < j; ++k)
+            {
+                ancestors[i][k] = ancestors[i][k] || ancestors[j][k];
+            }
+        }
+    }
+
+    m_isDirty = false;
+}
+
+
+U32 SystemScheduler::runSystemJob(void* pData)
+{
+    SystemJob* pJob = static_cast<SystemJob*>(pData);
+    pJob->pSystem->update(pJob->pScheduler->m_pRegistry, *pJob->pScheduler->m_pTick);
+    return 0;
+}
+
+
+void SystemScheduler::update(Registry* registry, const RealtimeTick& tick, ThreadPool* pPool)
+{
+    if (m_isDirty)
+    {
+        build();
+    }
+
+    m_isParallel = pPool && m_anyDeclared;
+    if (m_isParallel)
+    {
+        m_pRegistry = registry;
+        m_pTick     = &tick;
+        const ResultCode result = m_graph.kick(pPool);
+        if (result == RecluseResult_Ok)
+        {
+            m_graph.wait();
+        }
+        m_pRegistry = nullptr;
+        m_pTick     = nullptr;
+
+        if (result == RecluseResult_Ok)
+        {
+            return;
+        }
+
+        // Still want the systems to update this frame, just not in parallel.
+        R_ERROR("SystemScheduler", "Failed to kick the system graph! Result: %d. Updating systems serially.", result);
+        m_isParallel = false;
+    }
+
+    for (AbstractSystem* pSystem : m_systems)
+    {
+        pSystem->update(registry, tick);
+    }
+}
+
+
+void SystemScheduler::logSchedule() const
+{
+    R_INFO("SystemScheduler", "%d systems, %s", getNumSystems(), m_isParallel ? "parallel" : "serial");
+    for (U32 i = 0; i < getNumSystems(); ++i)
+    {
+        std::string waitsOn;
+        for (U32 dependency : m_dependencies[i])
+        {
+            waitsOn += waitsOn.empty() ? "" : ", ";
+            waitsOn += m_systems[dependency]->getName();
+        }
+        R_INFO("SystemScheduler", "  %2d %-24s %7.3f ms  waits on: %s", i, m_systems[i]->getName(), 
+            m_isParallel ? m_graph.getJobTimeMs(i) : 0.0f, waitsOn.empty() ? "-" : waitsOn.c_str());
+    }
+
+    if (m_isParallel)
+    {
+        const JobGraphStats& stats = m_graph.getStats();
+        R_INFO("SystemScheduler", "Wall: %.3f ms, critical path: %.3f ms, total work: %.3f ms, utilization: %.0f%% of %d threads", 
+            stats.wallTimeMs, stats.criticalPathMs, stats.totalWorkMs, stats.utilization * 100.0f, stats.numThreads);
+    }
+}
+} // ECS
+} // Recluse
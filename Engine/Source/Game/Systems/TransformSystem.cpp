@@ -4,6 +4,7 @@
 #include "Recluse/Messaging.hpp"
 #include "Recluse/Utility.hpp"
 #include "Recluse/Application.hpp"
+#include "Recluse/Algorithms/Parallel.hpp"
 #include "Recluse/Generated/Game/TranformEvents.hpp"
 
 #include "Recluse/Game/Components/Camera.hpp"
@@ -35,13 +36,15 @@ void TransformSystem::onUpdate(ECS::Registry* registry, const RealtimeTick& tick
     if (m_doUpdate)
     {
         std::vector<Transform*> transforms = obtainComponents(registry);
-        for (U64 i = 0; i < transforms.size(); ++i)
+        ParallelRange range = { 0ull, transforms.size() };
+        // Each transform only writes its own matrices, so they can be updated in any order.
+        parallelFor(MainThreadLoop::tryGetThreadPool(), range, kAutoGrainSize, [&] (U64 i) -> void
         {
             Transform* transform = transforms[i];
 
             // Check if the transform is disabled.
             if (!transform->isEnabled())
-                continue;
+                return;
 
             ECS::GameEntity* entity = ECS::GameEntity::findEntity(transform->getOwner());
             // Get the parent transform and transform locally on it.
@@ -53,7 +56,7 @@ void TransformSystem::onUpdate(ECS::Registry* registry, const RealtimeTick& tick
                 R_VERBOSE("Transform", "Owner: %s, Position: (%f, %f, %f)", tentity->getName().c_str(), 
                     transform->position.x, transform->position.y, transform->position.z);
             }
-        }
+        });
         m_doUpdate = false;
     }
 }
@@ -0,0 +1,334 @@
+//
+#include "Recluse/JobStreamer.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <atomic>
+
+namespace Recluse {
+
+
+struct JobGraphCounters
+{
+    JobGraphCounters(U32 numJobs)
+        : dependencies(numJobs)
+    {
+    }
+
+    std::vector<std::atomic<U32>>   dependencies;
+    JobCounter                      remainingJobs;
+};
+
+
+JobGraph::JobGraph()
+    : m_pCounters(nullptr)
+    , m_pPool(nullptr)
+    , m_stats()
+    , m_isDirty(true)
+{
+}
+
+
+JobGraph::~JobGraph()
+{
+    wait();
+
+    delete m_pCounters;
+    m_pCounters = nullptr;
+}
+
+
+JobNodeId JobGraph::addJob(const char* name, ThreadJob func, void* pPayload, JobType affinity)
+{
+    R_ASSERT(func != nullptr);
+    R_ASSERT(isFinished());
+
+    JobNode node            = { };
+    node.name               = name;
+    node.func               = func;
+    node.pPayload           = pPayload;
+    node.affinity           = affinity;
+    node.numDependencies    = 0;
+
+    m_nodes.push_back(node);
+    m_isDirty = true;
+
+    return static_cast<JobNodeId>(m_nodes.size() - 1);
+}
+
+
+ResultCode JobGraph::addDependency(JobNodeId before, JobNodeId after)
+{
+    R_ASSERT(isFinished());
+
+    if (before >= m_nodes.size() || after >= m_nodes.size() || before == after)
+    {
+        R_ERROR("JobGraph", "Invalid dependency between jobs %d -> %d", before, after);
+        return RecluseResult_InvalidArgs;
+    }
+
+    m_nodes[before].successors.push_back(after);
+    m_nodes[after].numDependencies += 1;
+    m_isDirty = true;
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode JobGraph::sortTopologically()
+{
+    const U32 numJobs = getNumJobs();
+    std::vector<U32> dependencies(numJobs);
+
+    m_topologicalOrder.clear();
+    m_topologicalOrder.reserve(numJobs);
+
+    for (U32 i = 0; i < numJobs; ++i)
+    {
+        dependencies[i] = m_nodes[i].numDependencies;
+        if (dependencies[i] == 0)
+        {
+            m_topologicalOrder.push_back(i);
+        }
+    }
+
+    for (U32 i = 0; i < m_topologicalOrder.size(); ++i)
+    {
+        const JobNode& node = m_nodes[m_topologicalOrder[i]];
+        for (U32 s = 0; s < node.successors.size(); ++s)
+        {
+            const JobNodeId successor = node.successors[s];
+            if (--dependencies[successor] == 0)
+            {
+                m_topologicalOrder.push_back(successor);
+            }
+        }
+    }
+
+    if (m_topologicalOrder.size() != numJobs)
+    {
+        R_ERROR("JobGraph", "Job graph contains a cycle! Only %d of %d jobs can run.", static_cast<U32>(m_topologicalOrder.size()), numJobs);
+        m_topologicalOrder.clear();
+        return RecluseResult_Failed;
+    }
+
+    m_isDirty = false;
+    return RecluseResult_Ok;
+}
+
+
+ResultCode JobGraph::kick(ThreadPool* pPool)
+{
+    R_ASSERT(pPool != nullptr);
+
+    if (!isFinished())
+    {
+        R_ERROR("JobGraph", "Can not kick a job graph that is still executing!");
+        return RecluseResult_Failed;
+    }
+
+    const U32 numJobs = getNumJobs();
+
+    if (m_isDirty)
+    {
+        ResultCode result = sortTopologically();
+        if (result != RecluseResult_Ok)
+        {
+            return result;
+        }
+
+        delete m_pCounters;
+        m_pCounters = new JobGraphCounters(numJobs);
+        m_contexts.resize(numJobs);
+        m_pathTimesMs.resize(numJobs);
+    }
+
+    m_pPool = pPool;
+    m_stats = { };
+
+    if (numJobs == 0)
+    {
+        return RecluseResult_Ok;
+    }
+
+    for (U32 i = 0; i < numJobs; ++i)
+    {
+        m_contexts[i].pGraph    = this;
+        m_contexts[i].id        = i;
+        m_pCounters->dependencies[i].store(m_nodes[i].numDependencies, std::memory_order_relaxed);
+    }
+
+    m_pCounters->remainingJobs.add(numJobs);
+    m_kickTime = RealtimeStopWatch();
+
+    // Root jobs are at the front of the topological order.
+    for (U32 i = 0; i < numJobs; ++i)
+    {
+        const JobNodeId id = m_topologicalOrder[i];
+        if (m_nodes[id].numDependencies != 0)
+        {
+            break;
+        }
+        submitNode(id);
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode JobGraph::wait()
+{
+    if (!m_pPool || !m_pCounters)
+    {
+        return RecluseResult_Ok;
+    }
+
+    // Parks the calling job if it is running on a pool fiber, otherwise helps execute jobs.
+    m_pPool->waitForCounter(&m_pCounters->remainingJobs);
+
+    gatherStats();
+
+    // Done with the pool until the next kick, so a finished graph never touches it again.
+    m_pPool = nullptr;
+
+    return RecluseResult_Ok;
+}
+
+
+Bool JobGraph::isFinished() const
+{
+    return (!m_pCounters || (m_pCounters->remainingJobs.getValue() == 0));
+}
+
+
+void JobGraph::reset()
+{
+    wait();
+
+    m_nodes.clear();
+    m_contexts.clear();
+    m_topologicalOrder.clear();
+    m_pathTimesMs.clear();
+
+    delete m_pCounters;
+    m_pCounters = nullptr;
+    m_pPool     = nullptr;
+    m_stats     = { };
+    m_isDirty   = true;
+}
+
+
+F32 JobGraph::getJobTimeMs(JobNodeId id) const
+{
+    RealtimeStopWatch endTime   = m_contexts[id].endTime;
+    RealtimeTick tick           = endTime - m_contexts[id].startTime;
+    return tick.delta() * 1000.0f;
+}
+
+
+U32 JobGraph::runJobNode(void* pData)
+{
+    JobNodeContext* pContext    = static_cast<JobNodeContext*>(pData);
+    JobGraph* pGraph            = pContext->pGraph;
+    JobNodeId id                = pContext->id;
+
+    while (id != kInvalidJobNode)
+    {
+        JobNodeContext& context     = pGraph->m_contexts[id];
+        const JobNode& node         = pGraph->m_nodes[id];
+        JobNodeId continuation      = kInvalidJobNode;
+
+        context.startTime = RealtimeStopWatch();
+        node.func(node.pPayload);
+        context.endTime = RealtimeStopWatch();
+
+        for (U32 i = 0; i < node.successors.size(); ++i)
+        {
+            const JobNodeId successor = node.successors[i];
+            if (pGraph->m_pCounters->dependencies[successor].fetch_sub(1u, std::memory_order_acq_rel) != 1u)
+            {
+                continue;
+            }
+
+            // We were the last dependency. Keep one released job with a matching affinity
+            // to run right here, and hand the others to the pool.
+            const JobType affinity = pGraph->m_nodes[successor].affinity;
+            if ((continuation == kInvalidJobNode) && (affinity == node.affinity || affinity == JobType_Main))
+            {
+                continuation = successor;
+            }
+            else
+            {
+                pGraph->submitNode(successor);
+            }
+        }
+
+        // This needs to be last, the graph may be reset by the waiting thread once it reaches 0.
+        pGraph->m_pPool->decrementCounter(&pGraph->m_pCounters->remainingJobs);
+        id = continuation;
+    }
+
+    return 0;
+}
+
+
+void JobGraph::submitNode(JobNodeId id)
+{
+    m_pPool->submitJob(runJobNode, &m_contexts[id], getWorkerHint(m_nodes[id].affinity));
+}
+
+
+U32 JobGraph::getWorkerHint(JobType affinity) const
+{
+    // Main jobs don't care which worker picks them up.
+    if (affinity == JobType_Main || m_pPool->getNumWorkers() == 0)
+    {
+        return kAnyThreadPoolWorker;
+    }
+
+    return static_cast<U32>(affinity) - 1u;
+}
+
+
+void JobGraph::gatherStats()
+{
+    const U32 numJobs           = getNumJobs();
+    RealtimeStopWatch lastEnd   = m_kickTime;
+    F32 totalWorkMs             = 0.0f;
+    F32 criticalPathMs          = 0.0f;
+
+    for (U32 i = 0; i < numJobs; ++i)
+    {
+        m_pathTimesMs[i] = 0.0f;
+    }
+
+    // Longest path through the graph, walking it in dependency order.
+    for (U32 i = 0; i < numJobs; ++i)
+    {
+        const JobNodeId id      = m_topologicalOrder[i];
+        const JobNode& node     = m_nodes[id];
+        const F32 jobTimeMs     = getJobTimeMs(id);
+        const F32 finishMs      = m_pathTimesMs[id] + jobTimeMs;
+
+        totalWorkMs            += jobTimeMs;
+        criticalPathMs          = (finishMs > criticalPathMs) ? finishMs : criticalPathMs;
+
+        for (U32 s = 0; s < node.successors.size(); ++s)
+        {
+            F32& successorMs    = m_pathTimesMs[node.successors[s]];
+            successorMs         = (finishMs > successorMs) ? finishMs : successorMs;
+        }
+
+        if (m_contexts[id].endTime.getCurrentTime() > lastEnd.getCurrentTime())
+        {
+            lastEnd = m_contexts[id].endTime;
+        }
+    }
+
+    RealtimeTick wallTick   = lastEnd - m_kickTime;
+    m_stats.wallTimeMs      = wallTick.delta() * 1000.0f;
+    m_stats.criticalPathMs  = criticalPathMs;
+    m_stats.totalWorkMs     = totalWorkMs;
+    m_stats.numThreads      = m_pPool->getNumWorkers() + 1;
+    m_stats.utilization     = (m_stats.wallTimeMs > 0.0f) ? totalWorkMs / (m_stats.wallTimeMs * F32(m_stats.numThreads)) : 0.0f;
+}
+} // Recluse
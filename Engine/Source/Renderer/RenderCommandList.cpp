@@ -15,21 +15,32 @@ namespace Engine {
 
 void RenderCommandList::initialize()
 {
-    // 2 MB for our render command list.
-    U64 szBytes = align(2 * R_1MB, pointerSizeBytes());
+    // Reserve 256 MB for our render command list, with 2 MB committed up front. Heavy frames grow
+    // the list in place, and never move the commands already pushed.
+    U64 szBytes = align(256 * R_1MB, pointerSizeBytes());
     if (!m_pool) 
     {
-        m_pool = new MemoryPool(szBytes);
-        m_pAllocator = new LinearAllocator();
+        m_pool = new MemoryPool();
+        m_pool->reserve(szBytes, 2 * R_1MB);
+
+        LinearAllocator* pAllocator = new LinearAllocator();
+        pAllocator->setBackingPool(m_pool);
+        pAllocator->setMemoryTag(MemoryTag_Renderer);
+        m_pAllocator = pAllocator;
 
         m_pAllocator->initialize(m_pool->getBaseAddress(), m_pool->getTotalSizeBytes());
     }
 
     if (!m_pointerPool) 
     {
-        szBytes = align(64 * R_1KB, pointerSizeBytes());
-        m_pointerPool = new MemoryPool(szBytes);
-        m_pointerAllocator = new LinearAllocator();
+        szBytes = align(8 * R_1MB, pointerSizeBytes());
+        m_pointerPool = new MemoryPool();
+        m_pointerPool->reserve(szBytes, 64 * R_1KB);
+
+        LinearAllocator* pPointerAllocator = new LinearAllocator();
+        pPointerAllocator->setBackingPool(m_pointerPool);
+        pPointerAllocator->setMemoryTag(MemoryTag_Renderer);
+        m_pointerAllocator = pPointerAllocator;
     
         m_pointerAllocator->initialize(m_pointerPool->getBaseAddress(), m_pointerPool->getTotalSizeBytes());
     }
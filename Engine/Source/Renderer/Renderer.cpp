@@ -10,6 +10,9 @@
 #include "Recluse/System/Limiter.hpp"
 #include "Recluse/Renderer/Debug/DebugRenderer.hpp"
 #include "Recluse/Memory/LinearAllocator.hpp"
+#include "Recluse/Memory/MemoryBudget.hpp"
+#include "Recluse/Algorithms/Parallel.hpp"
+#include "Recluse/Application.hpp"
 
 #include "Recluse/Messaging.hpp"
 
@@ -22,6 +25,7 @@
 #include "Recluse/Generated/RendererResources.hpp"
 
 #include <algorithm>
+#include <new>
 
 #define R_NULLIFY_RENDER 0
 
@@ -43,9 +47,9 @@ Renderer::~Renderer()
 
 void Renderer::initialize()
 {
-    R_ASSERT_FORMAT(m_newRendererConfigs.buffering >= 1, "Must at least be one buffer count!");
     // Immediately initialize the render configs to the current.
-    m_currentRendererConfigs = m_newRendererConfigs;
+    m_currentRendererConfigs = m_newRendererConfigs.load();
+    R_ASSERT_FORMAT(m_currentRendererConfigs.buffering >= 1, "Must at least be one buffer count!");
 
     LayerFeatureFlags flags  = m_currentRendererConfigs.enableGpuValidation ? (LayerFeatureFlag_GpuDebugValidation | LayerFeatureFlag_DebugValidation) : 0;
     ApplicationInfo info    = { };
@@ -92,12 +96,19 @@ void Renderer::initialize()
     m_pSwapchain = m_pDevice->createSwapchain(swapchainDescription, m_currentRendererConfigs.windowHandle);
 
     {
+        // Staging pools stay fixed, the rest of the graphics budget goes to gpu only memory,
+        // a third for buffers and the rest for textures. The pools are sized to fit the budget,
+        // so they are not charged against it as well, that would leave the tag at its limit from startup.
+        const U64 stagingBytes  = R_1MB * 64ull;
+        const U64 budgetBytes   = MemoryBudgets::getBudgetBytes(MemoryTag_Graphics, R_1MB * 512ull + R_1GB + stagingBytes);
+        const U64 gpuOnlyBytes  = budgetBytes > stagingBytes ? budgetBytes - stagingBytes : 0ull;
+
         MemoryReserveDescription reserveDesc = { };
         reserveDesc.bufferPools[ResourceMemoryUsage_CpuVisible] = R_1MB * 32ull;
         reserveDesc.bufferPools[ResourceMemoryUsage_CpuToGpu]   = R_1MB * 16ull;
         reserveDesc.bufferPools[ResourceMemoryUsage_GpuToCpu]   = R_1MB * 16ull;
-        reserveDesc.bufferPools[ResourceMemoryUsage_GpuOnly]    = R_1MB * 512ull;
-        reserveDesc.texturePoolGPUOnly                          = R_1GB * 1ull;
+        reserveDesc.bufferPools[ResourceMemoryUsage_GpuOnly]    = gpuOnlyBytes / 3ull;
+        reserveDesc.texturePoolGPUOnly                          = gpuOnlyBytes - reserveDesc.bufferPools[ResourceMemoryUsage_GpuOnly];
 
         // Memory reserves for engine.
         result = m_pDevice->reserveMemory(reserveDesc);
@@ -350,15 +361,55 @@ ResultCode Renderer::destroyGPUBuffer(GPUBuffer* pBuffer)
 void Renderer::resetCommandKeys()
 {
     m_currentFrameIndex = (m_currentFrameIndex + 1) % m_maxBufferCount;
+    resetFrameContainers(m_currentFrameIndex);
     
-    m_currentCommandKeys = CommandKeyContainer(&m_commandKeys[m_currentFrameIndex]);
+    m_currentCommandKeys = CommandKeyContainer(m_frameContainers[m_currentFrameIndex]->pCommandKeys);
     m_currentRenderCommands = m_renderCommands[m_currentFrameIndex];
     
     R_ASSERT(m_currentCommandKeys.isValid());
+}
 
-    for (auto& cmdLists : m_currentCommandKeys.get()) 
+
+void Renderer::resetFrameContainers(U32 frameIndex)
+{
+    static const U32 kCommandKeyPasses[] = 
+    { 
+        Render_PreZ, 
+        Render_Gbuffer, 
+        Render_Shadow, 
+        Render_Particles, 
+        Render_ForwardOpaque, 
+        Render_ForwardTransparent 
+    };
+    static const U32 kNumCommandKeyPasses = sizeof(kCommandKeyPasses) / sizeof(kCommandKeyPasses[0]);
+
+    FrameContainers* pContainers    = m_frameContainers[frameIndex];
+    LinearAllocator& allocator      = pContainers->allocator;
+
+    // Last time around is a good guess for how many keys each pass takes this time, so the
+    // lists don't have to grow, and leave their old copies behind in the arena.
+    U64 numKeys[kNumCommandKeyPasses] = { };
+    for (U32 i = 0; pContainers->pCommandKeys && (i < kNumCommandKeyPasses); ++i)
     {
-        cmdLists.second.clear();
+        auto it = pContainers->pCommandKeys->find(kCommandKeyPasses[i]);
+        numKeys[i] = (it != pContainers->pCommandKeys->end()) ? it->second.size() : 0ull;
+    }
+
+    // Everything the containers hold is in the arena, so they are dropped along with it, 
+    // without running their destructors.
+    allocator.reset();
+
+    Arena::Vector<U64>::allocator_type adapter(&allocator);
+    void* pCommandKeys          = reinterpret_cast<void*>(allocator.allocate(sizeof(CommandKeyMap), alignof(CommandKeyMap)));
+    R_ASSERT(pCommandKeys != nullptr);
+    pContainers->pCommandKeys   = new (pCommandKeys) CommandKeyMap(adapter);
+    pContainers->pCommandKeys->reserve(kNumCommandKeyPasses);
+
+    // Lists are put in up front, bound to the arena. operator[] would make them on the global heap.
+    for (U32 i = 0; i < kNumCommandKeyPasses; ++i)
+    {
+        Arena::Vector<U64>& keys = pContainers->pCommandKeys->emplace(kCommandKeyPasses[i], Arena::Vector<U64>(adapter)).first->second;
+        keys.reserve(numKeys[i]);
     }
 }
 
@@ -377,8 +428,8 @@ void Renderer::sortCommandKeys()
 
     for (auto& cmdLists : m_currentCommandKeys.get()) 
     {
-        std::vector<U64>& list = cmdLists.second;
-        std::sort(list.begin(), list.end(), pred);
+        Arena::Vector<U64>& list = cmdLists.second;
+        parallelSort(MainThreadLoop::tryGetThreadPool(), list.data(), list.size(), pred);
     }
 }
 
@@ -450,10 +501,22 @@ void Renderer::allocateSceneBuffers(const RendererConfigs& configs)
         m_renderCommands[i]->initialize();
     }
 
-    m_commandKeys.resize(m_maxBufferCount);
+    // Address space for the heaviest frames, but only what a frame actually uses gets committed.
+    m_frameContainers.resize(m_maxBufferCount);
+    for (U32 i = 0; i < m_maxBufferCount; ++i)
+    {
+        FrameContainers* pContainers = new FrameContainers();
+        pContainers->pool.reserve(align(32 * R_1MB, pointerSizeBytes()), 64 * R_1KB);
+        pContainers->allocator.setBackingPool(&pContainers->pool);
+        pContainers->allocator.setMemoryTag(MemoryTag_Renderer);
+        pContainers->allocator.initialize(pContainers->pool.getBaseAddress(), pContainers->pool.getTotalSizeBytes());
+        pContainers->pCommandKeys = nullptr;
+        m_frameContainers[i] = pContainers;
+        resetFrameContainers(i);
+    }
 
     m_currentRenderCommands = m_renderCommands[0];
-    m_currentCommandKeys = CommandKeyContainer(&m_commandKeys[0]);
+    m_currentCommandKeys = CommandKeyContainer(m_frameContainers[0]->pCommandKeys);
 }
 
 
@@ -473,6 +536,15 @@ void Renderer::freeSceneBuffers()
         delete m_renderCommands[i];
     }
     m_renderCommands.clear();
+
+    m_currentCommandKeys = CommandKeyContainer();
+    for (U64 i = 0; i < m_frameContainers.size(); ++i)
+    {
+        m_frameContainers[i]->allocator.cleanUp();
+        m_frameContainers[i]->pool.release();
+        delete m_frameContainers[i];
+    }
+    m_frameContainers.clear();
 }
 
 
@@ -509,7 +581,7 @@ static ResultCode kRendererJob(void* pData)
     Renderer* pRenderer                     = Renderer::getMain();
     Mutex renderMutex                       = pRenderer->getMutex();
     U64 threadId                            = getCurrentThreadId();
-    F32 counterFrameMs                      = 0.f;
+    FramePacer pacer;
 
         // Initialize the renderer watch.
     RealtimeTick::initializeWatch(threadId, JobType_Renderer);
@@ -527,7 +599,7 @@ static ResultCode kRendererJob(void* pData)
         {
             const RendererConfigs& renderConfigs    = pRenderer->getCurrentConfigs();
             const F32 desiredFrameRateMs = 1.0f / renderConfigs.maxFrameRate;
-            Limiter::limit(desiredFrameRateMs, threadId, JobType_Renderer);
+            pacer.pace(desiredFrameRateMs);
             pRenderer->update(tick.getCurrentTimeS(), tick.delta());
             pRenderer->render();
             pRenderer->present();
@@ -540,8 +612,6 @@ static ResultCode kRendererJob(void* pData)
 
 ResultCode Renderer::onInitializeModule(Application* pApp)
 {
-    m_configLock = createMutex();
-
     MainThreadLoop::getMessageBus()->addReceiver(
         "Renderer", [=] (EventMessage* pMsg) -> void 
             { 
@@ -596,8 +666,6 @@ ResultCode Renderer::onCleanUpModule(Application* pApp)
     ScopedLock lck(getMutex());
     cleanUp();
     enableRunning(false);
-    // be sure to destroy the final config lock.
-    destroyMutex(m_configLock);
     return RecluseResult_Ok;
 }
 
@@ -645,7 +713,9 @@ void Renderer::update(F32 currentTime, F32 deltaTime)
 
 void Renderer::recreate()
 {
-    ScopedLock lck(m_configLock);
+    // New configs may still come in while recreating, so only work off of this copy.
+    const RendererConfigs newConfigs = m_newRendererConfigs.load();
+    (void)newConfigs;
 
     R_NO_IMPL();
 }
@@ -1,6 +1,7 @@
 //
 #include "Recluse/Scene/Scene.hpp"
 #include "Recluse/Messaging.hpp"
+#include "Recluse/Application.hpp"
 #include "Recluse/Renderer/Renderer.hpp"
 
 #include "Recluse/Filesystem/Archive.hpp"
@@ -38,10 +39,7 @@ ResultCode Scene::addEntity(ECS::GameEntity* obj)
 
 void Scene::update(ECS::Registry* registry, const RealtimeTick& tick)
 {
-    for (auto& system : m_systems)
-    {
-        system->update(registry, tick);
-    }
+    m_scheduler.update(registry, tick, MainThreadLoop::tryGetThreadPool());
 }
 
 
@@ -163,6 +161,7 @@ void Scene::registerSystem(ECS::AbstractSystem* pSystem, MessageBus* bus)
     // Registering any system must Initialize first.
     pSystem->initialize(bus); 
     m_systems.push_back(pSystem); 
+    m_scheduler.setSystems(m_systems);
 }
 
 
@@ -175,6 +174,7 @@ void Scene::unregisterSystems()
     }
 
     m_systems.clear();
+    m_scheduler.setSystems(m_systems);
 }
 
 
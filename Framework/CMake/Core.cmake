@@ -39,6 +39,7 @@ if (WIN32)
         ${RECLUSE_WIN32}/Win32Common.hpp
         ${RECLUSE_WIN32}/Win32Counter.cpp
         ${RECLUSE_WIN32}/Win32DLLLoader.cpp
+        ${RECLUSE_WIN32}/Win32Memory.cpp
         ${RECLUSE_WIN32}/Win32Runtime.hpp
         ${RECLUSE_WIN32}/Win32Runtime.cpp
         ${RECLUSE_WIN32}/Win32Time.cpp
@@ -50,9 +51,30 @@ if (WIN32)
         ${RECLUSE_WIN32_IO}/Win32Window.cpp
         ${RECLUSE_WIN32_THREADING}/Win32Thread.hpp
         ${RECLUSE_WIN32_THREADING}/Win32Threading.cpp
+        ${RECLUSE_WIN32_THREADING}/Win32Sema.cpp
+        ${RECLUSE_WIN32_THREADING}/Win32Fiber.cpp
 		${RECLUSE_WIN32_THREADING}/Win32Process.cpp
         ${RECLUSE_WIN32}/Win32Filesystem.cpp
     )
+    # WaitOnAddress and WakeByAddress.
+    set ( RECLUSE_FRAMEWORK_LINK_BINARIES ${RECLUSE_FRAMEWORK_LINK_BINARIES} Synchronization.lib )
+elseif (UNIX)
+    set ( RECLUSE_LINUX ${RECLUSE_CORE_SOURCE}/Linux )
+    set ( RECLUSE_LINUX_THREADING ${RECLUSE_LINUX}/Threading )
+    set ( RECLUSE_CORE_SOURCE_SYSTEM
+        ${RECLUSE_LINUX}/LinuxCommon.hpp
+        ${RECLUSE_LINUX}/LinuxRuntime.hpp
+        ${RECLUSE_LINUX}/LinuxMemory.cpp
+        ${RECLUSE_LINUX}/LinuxRuntime.cpp
+        ${RECLUSE_LINUX}/LinuxTime.cpp
+        ${RECLUSE_LINUX_THREADING}/LinuxThread.hpp
+        ${RECLUSE_LINUX_THREADING}/LinuxThreading.cpp
+        ${RECLUSE_LINUX_THREADING}/LinuxSema.cpp
+        ${RECLUSE_LINUX_THREADING}/LinuxFiber.cpp
+        ${RECLUSE_LINUX_THREADING}/LinuxProcess.cpp
+        ${RECLUSE_LINUX}/LinuxFilesystem.cpp
+    )
+    set ( RECLUSE_FRAMEWORK_LINK_BINARIES ${RECLUSE_FRAMEWORK_LINK_BINARIES} pthread dl )
 endif()
 
 set ( RECLUSE_CORE_BUILD 
@@ -74,6 +96,7 @@ set ( RECLUSE_CORE_BUILD
 	${RECLUSE_CORE_INCLUDE_ALGORITHMS}/Radixsort.hpp
 	${RECLUSE_CORE_INCLUDE_ALGORITHMS}/Selectionsort.hpp
 	${RECLUSE_CORE_INCLUDE_ALGORITHMS}/Common.hpp
+	${RECLUSE_CORE_INCLUDE_ALGORITHMS}/Parallel.hpp
     ${RECLUSE_CORE_INCLUDE_SERIALIZATION}/Hasher.hpp
     ${RECLUSE_CORE_INCLUDE_SERIALIZATION}/Serializable.hpp
     ${RECLUSE_CORE_INCLUDE_SERIALIZATION}/SerialTypes.hpp
@@ -85,23 +108,40 @@ set ( RECLUSE_CORE_BUILD
     ${RECLUSE_CORE_INCLUDE_SYSTEM}/Window.hpp
 	${RECLUSE_CORE_INCLUDE_SYSTEM}/DateTime.hpp
 	${RECLUSE_CORE_INCLUDE_SYSTEM}/Process.hpp
+	${RECLUSE_CORE_INCLUDE_SYSTEM}/Architecture.hpp
 	${RECLUSE_CORE_INCLUDE_SYSTEM}/Limiter.hpp
     ${RECLUSE_CORE_SOURCE_LOGGING}/LogFramework.hpp
     ${RECLUSE_CORE_SOURCE_LOGGING}/Logger.cpp
 	${RECLUSE_CORE_SOURCE_LOGGING}/LogOverloads.cpp
     ${RECLUSE_CORE_INCLUDE_MEMORY}/Allocator.hpp
     ${RECLUSE_CORE_INCLUDE_MEMORY}/BuddyAllocator.hpp
+    ${RECLUSE_CORE_INCLUDE_MEMORY}/ConcurrentLinearAllocator.hpp
     ${RECLUSE_CORE_INCLUDE_MEMORY}/FreeListAllocator.hpp
+    ${RECLUSE_CORE_INCLUDE_MEMORY}/FrameAllocator.hpp
     ${RECLUSE_CORE_INCLUDE_MEMORY}/MemoryPool.hpp
     ${RECLUSE_CORE_INCLUDE_MEMORY}/MemoryScan.hpp
+    ${RECLUSE_CORE_INCLUDE_MEMORY}/MemoryBudget.hpp
     ${RECLUSE_CORE_INCLUDE_MEMORY}/PoolAllocator.hpp
+    ${RECLUSE_CORE_INCLUDE_MEMORY}/VirtualMemory.hpp
     ${RECLUSE_CORE_INCLUDE_MEMORY}/LinearAllocator.hpp
+    ${RECLUSE_CORE_INCLUDE_MEMORY}/StackAllocator.hpp
+    ${RECLUSE_CORE_INCLUDE_MEMORY}/StdAllocatorAdapter.hpp
     ${RECLUSE_CORE_INCLUDE_MEMORY}/MemoryCommon.hpp
     ${RECLUSE_CORE_SOURCE_MEMORY}/MemoryPool.cpp
+    ${RECLUSE_CORE_SOURCE_MEMORY}/MemoryScan.cpp
+    ${RECLUSE_CORE_SOURCE_MEMORY}/MemoryBudget.cpp
     ${RECLUSE_CORE_SOURCE_MEMORY}/BuddyAllocator.cpp
+    ${RECLUSE_CORE_SOURCE_MEMORY}/ConcurrentLinearAllocator.cpp
+    ${RECLUSE_CORE_SOURCE_MEMORY}/FreeListAllocator.cpp
+    ${RECLUSE_CORE_SOURCE_MEMORY}/FrameAllocator.cpp
+    ${RECLUSE_CORE_SOURCE_MEMORY}/PoolAllocator.cpp
+    ${RECLUSE_CORE_SOURCE_MEMORY}/StackAllocator.cpp
 	${RECLUSE_CORE_SOURCE_MEMORY}/AllocatorCommon.cpp
     ${RECLUSE_CORE_INCLUDE_THREADING}/Threading.hpp
+    ${RECLUSE_CORE_INCLUDE_THREADING}/Atomic.hpp
+    ${RECLUSE_CORE_INCLUDE_THREADING}/Locks.hpp
     ${RECLUSE_CORE_INCLUDE_THREADING}/ThreadPool.hpp
+    ${RECLUSE_CORE_INCLUDE_THREADING}/Fiber.hpp
 	${RECLUSE_CORE_INCLUDE}/Utility.hpp
     ${RECLUSE_CORE_INCLUDE}/Types.hpp
     ${RECLUSE_CORE_INCLUDE}/Array.hpp
@@ -160,6 +200,8 @@ set ( RECLUSE_CORE_BUILD
 	${RECLUSE_CORE_INCLUDE}/MessageBus.hpp
 	${RECLUSE_CORE_SOURCE}/RGUID.cpp
 	${RECLUSE_CORE_SOURCE}/ThreadPool.cpp
+	${RECLUSE_CORE_SOURCE}/Limiter.cpp
+	${RECLUSE_CORE_SOURCE}/Locks.cpp
 	${RECLUSE_CORE_SOURCE}/MessageBus.cpp
 	${RECLUSE_CORE_SOURCE}/GlobalCommand.cpp
 )
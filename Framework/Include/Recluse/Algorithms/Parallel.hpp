@@ -0,0 +1,335 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+#include "Recluse/Threading/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace Recluse {
+
+
+// Half open range of indices [begin, end).
+struct ParallelRange
+{
+    U64 begin;
+    U64 end;
+
+    U64 getSize() const { return (end > begin) ? (end - begin) : 0ull; }
+};
+
+
+// Pass as the grain size to let the algorithm pick one, based on the size of the range and
+// the number of workers in the pool.
+static constexpr U64 kAutoGrainSize = 0ull;
+
+
+namespace ParallelInternal {
+
+
+// Number of chunks handed to each thread when the grain size is picked automatically. More
+// than one, so threads that finish early can take work from slower ones.
+static constexpr U64 kChunksPerThread       = 4ull;
+// Smallest automatic grain size, so small loops are not swamped by job overhead.
+static constexpr U64 kMinAutoGrainSize      = 64ull;
+// Ranges smaller than this are sorted on the calling thread.
+static constexpr U64 kMinParallelSortSize   = 4096ull;
+
+
+inline U64 getNumThreads(ThreadPool* pPool)
+{
+    // The calling thread works on the range too.
+    return pPool ? (static_cast<U64>(pPool->getNumWorkers()) + 1ull) : 1ull;
+}
+
+
+inline U64 computeGrainSize(ThreadPool* pPool, U64 count, U64 grainSize)
+{
+    if (grainSize != kAutoGrainSize)
+    {
+        return grainSize;
+    }
+
+    const U64 grain = count / (getNumThreads(pPool) * kChunksPerThread);
+    return (grain > kMinAutoGrainSize) ? grain : kMinAutoGrainSize;
+}
+
+
+// Shared by all jobs of a parallel loop. Jobs, along with the calling thread, grab chunks until
+// there are none left, so a job that starts late simply finds nothing to do.
+template<typename ChunkFn>
+struct ParallelForContext
+{
+    const ChunkFn*      pChunkFn;
+    U64                 end;
+    U64                 grainSize;
+    std::atomic<U64>    nextChunk;
+};
+
+
+template<typename ChunkFn>
+static void runChunks(ParallelForContext<ChunkFn>* pContext)
+{
+    for (;;)
+    {
+        const U64 chunkBegin = pContext->nextChunk.fetch_add(pContext->grainSize, std::memory_order_relaxed);
+        if (chunkBegin >= pContext->end)
+        {
+            break;
+        }
+
+        const U64 chunkEnd = ((pContext->end - chunkBegin) > pContext->grainSize) ? (chunkBegin + pContext->grainSize) : pContext->end;
+        (*pContext->pChunkFn)(chunkBegin, chunkEnd);
+    }
+}
+
+
+template<typename ChunkFn>
+static U32 parallelChunkJob(void* pData)
+{
+    runChunks(static_cast<ParallelForContext<ChunkFn>*>(pData));
+    return 0;
+}
+
+
+// Calls chunkFn(chunkBegin, chunkEnd) on chunks of the range, until the whole range is done.
+template<typename ChunkFn>
+void parallelForChunks(ThreadPool* pPool, const ParallelRange& range, U64 grainSize, const ChunkFn& chunkFn)
+{
+    const U64 count = range.getSize();
+    if (count == 0ull)
+    {
+        return;
+    }
+
+    grainSize               = computeGrainSize(pPool, count, grainSize);
+    const U64 numChunks     = (count + grainSize - 1ull) / grainSize;
+
+    if (!pPool || (pPool->getNumWorkers() == 0u) || (numChunks <= 1ull))
+    {
+        chunkFn(range.begin, range.end);
+        return;
+    }
+
+    ParallelForContext<ChunkFn> context;
+    context.pChunkFn        = &chunkFn;
+    context.end             = range.end;
+    context.grainSize       = grainSize;
+    context.nextChunk.store(range.begin, std::memory_order_relaxed);
+
+    // No point in more jobs than workers, since every job runs chunks until none are left.
+    const U64 numJobs       = std::min<U64>(numChunks - 1ull, pPool->getNumWorkers());
+    JobCounter counter;
+
+    for (U64 i = 0; i < numJobs; ++i)
+    {
+        pPool->submitJob(parallelChunkJob<ChunkFn>, &context, kAnyThreadPoolWorker, &counter);
+    }
+
+    runChunks(&context);
+    pPool->waitForCounter(&counter);
+}
+
+
+// Finds how many elements of a come before the given diagonal of the merge of a and b. Ties
+// go to a, which keeps the merge stable.
+template<typename Data, typename Compare>
+U64 findMergeSplit(const Data* pA, U64 countA, const Data* pB, U64 countB, U64 diagonal, const Compare& comp)
+{
+    U64 lo = (diagonal > countB) ? (diagonal - countB) : 0ull;
+    U64 hi = (diagonal < countA) ? diagonal : countA;
+
+    while (lo < hi)
+    {
+        const U64 mid = lo + (hi - lo) / 2ull;
+        if (comp(pB[diagonal - mid - 1ull], pA[mid]))
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1ull;
+        }
+    }
+
+    return lo;
+}
+} // ParallelInternal
+
+
+// Calls fn(index) for every index in the range, split into chunks of grainSize over the pool.
+// The calling thread works on chunks as well, and returns once the whole range is done. Runs
+// on the calling thread if the pool is null, or has no workers.
+template<typename Fn>
+void parallelFor(ThreadPool* pPool, const ParallelRange& range, U64 grainSize, const Fn& fn)
+{
+    ParallelInternal::parallelForChunks
+        (
+            pPool,
+            range,
+            grainSize,
+            [&fn] (U64 chunkBegin, U64 chunkEnd) -> void
+            {
+                for (U64 i = chunkBegin; i < chunkEnd; ++i)
+                {
+                    fn(i);
+                }
+            }
+        );
+}
+
+
+// Maps every index in the range with mapFn(index), and combines the results with
+// reduceFn(lhs, rhs). Each chunk is reduced on its own, then the chunk results are combined
+// in order, so the result does not depend on how the chunks were scheduled.
+template<typename T, typename MapFn, typename ReduceFn>
+T parallelReduce(ThreadPool* pPool, const ParallelRange& range, U64 grainSize, const T& identity, const MapFn& mapFn, const ReduceFn& reduceFn)
+{
+    const U64 count = range.getSize();
+    if (count == 0ull)
+    {
+        return identity;
+    }
+
+    grainSize           = ParallelInternal::computeGrainSize(pPool, count, grainSize);
+    const U64 numChunks = (count + grainSize - 1ull) / grainSize;
+    std::vector<T> partials(numChunks, identity);
+
+    ParallelInternal::parallelForChunks
+        (
+            pPool,
+            range,
+            grainSize,
+            [&] (U64 chunkBegin, U64 chunkEnd) -> void
+            {
+                T value = identity;
+                for (U64 i = chunkBegin; i < chunkEnd; ++i)
+                {
+                    value = reduceFn(value, mapFn(i));
+                }
+                partials[(chunkBegin - range.begin) / grainSize] = value;
+            }
+        );
+
+    T result = identity;
+    for (U64 i = 0; i < numChunks; ++i)
+    {
+        result = reduceFn(result, partials[i]);
+    }
+    return result;
+}
+
+
+// Sorts the data with a parallel merge sort. Runs are sorted on their own first, and then
+// merged in rounds. Each merge is split along its merge path, so the last rounds still use
+// every thread. Not stable, since the runs are sorted with std::sort. Data must be default
+// constructible, for the scratch buffer.
+template<typename Data, typename Compare>
+void parallelSort(ThreadPool* pPool, Data* pData, U64 count, const Compare& comp)
+{
+    const U64 numThreads = ParallelInternal::getNumThreads(pPool);
+
+    if ((count < ParallelInternal::kMinParallelSortSize) || (numThreads <= 1ull))
+    {
+        std::sort(pData, pData + count, comp);
+        return;
+    }
+
+    // Power of two runs, so each round halves them evenly.
+    U64 numRuns = 1ull;
+    while (numRuns < numThreads)
+    {
+        numRuns <<= 1ull;
+    }
+    const U64 runSize = (count + numRuns - 1ull) / numRuns;
+
+    ParallelRange runRange = { 0ull, numRuns };
+    parallelFor
+        (
+            pPool,
+            runRange,
+            1ull,
+            [&] (U64 run) -> void
+            {
+                const U64 lo = std::min(run * runSize, count);
+                const U64 hi = std::min(lo + runSize, count);
+                std::sort(pData + lo, pData + hi, comp);
+            }
+        );
+
+    std::vector<Data> scratch(count);
+    Data* pSrc = pData;
+    Data* pDst = scratch.data();
+
+    for (U64 width = runSize; width < count; width *= 2ull)
+    {
+        const U64 numMerges     = (count + (2ull * width) - 1ull) / (2ull * width);
+        // Split the merges further when there are fewer of them than threads.
+        const U64 partsPerMerge = std::max<U64>(1ull, (numThreads * ParallelInternal::kChunksPerThread) / numMerges);
+
+        ParallelRange taskRange = { 0ull, numMerges * partsPerMerge };
+        parallelFor
+            (
+                pPool,
+                taskRange,
+                1ull,
+                [&] (U64 task) -> void
+                {
+                    const U64 merge         = task / partsPerMerge;
+                    const U64 part          = task % partsPerMerge;
+                    const U64 lo            = merge * 2ull * width;
+                    const U64 mid           = std::min(lo + width, count);
+                    const U64 hi            = std::min(lo + 2ull * width, count);
+                    const U64 countA        = mid - lo;
+                    const U64 countB        = hi - mid;
+                    const U64 total         = countA + countB;
+                    const U64 diagonalBegin = (total * part) / partsPerMerge;
+                    const U64 diagonalEnd   = (total * (part + 1ull)) / partsPerMerge;
+
+                    const U64 aBegin = ParallelInternal::findMergeSplit(pSrc + lo, countA, pSrc + mid, countB, diagonalBegin, comp);
+                    const U64 aEnd   = ParallelInternal::findMergeSplit(pSrc + lo, countA, pSrc + mid, countB, diagonalEnd, comp);
+                    const U64 bBegin = diagonalBegin - aBegin;
+                    const U64 bEnd   = diagonalEnd - aEnd;
+
+                    std::merge
+                        (
+                            std::make_move_iterator(pSrc + lo + aBegin),
+                            std::make_move_iterator(pSrc + lo + aEnd),
+                            std::make_move_iterator(pSrc + mid + bBegin),
+                            std::make_move_iterator(pSrc + mid + bEnd),
+                            pDst + lo + diagonalBegin,
+                            comp
+                        );
+                }
+            );
+
+        std::swap(pSrc, pDst);
+    }
+
+    if (pSrc != pData)
+    {
+        ParallelRange copyRange = { 0ull, count };
+        ParallelInternal::parallelForChunks
+            (
+                pPool,
+                copyRange,
+                kAutoGrainSize,
+                [&] (U64 chunkBegin, U64 chunkEnd) -> void
+                {
+                    std::move(pSrc + chunkBegin, pSrc + chunkEnd, pData + chunkBegin);
+                }
+            );
+    }
+}
+
+
+template<typename Data>
+void parallelSort(ThreadPool* pPool, Data* pData, U64 count)
+{
+    parallelSort(pPool, pData, count, std::less<Data>());
+}
+} // Recluse
@@ -17,6 +17,7 @@
     #define R_PUBLIC_API __declspec(dllexport)
     #define R_IMPORT __declspec(dllimport)
     #define R_FORCE_INLINE __forceinline
+    #define R_NO_INLINE __declspec(noinline)
     #define R_NOVTABLE __declspec(novtable)
     #define R_DEBUG_BREAK() do { __debugbreak(); } while(0)
     #define R_FORCE_CRASH(c) do { ExitProcess(c); } while(0)
@@ -28,16 +29,24 @@
         #define RECLUSE_32BIT
     #endif
 #elif defined(__linux__)
-    #error "Linux currently not supported for Recluse!"
-    #define RECLUSE_LINUX
-    #define R_PUBLIC_API
+    #include <signal.h>
+    #include <stdlib.h>
+    #define RECLUSE_LINUX 1
+    #define RECLUSE_POSIX 1
+    #define R_PUBLIC_API __attribute__((visibility("default")))
     #define R_IMPORT
-    #define R_FORCE_INLINE 
+    #define R_FORCE_INLINE inline __attribute__((always_inline))
+    #define R_NO_INLINE __attribute__((noinline))
     #define R_NOVTABLE
-    #define R_DEBUG_BREAK()
-    #define R_FORCE_CRASH(c)
-    #define R_LIKELY(exp)
-    #define R_UNLIKELY(exp)
+    #define R_DEBUG_BREAK() do { raise(SIGTRAP); } while(0)
+    #define R_FORCE_CRASH(c) do { _Exit(c); } while(0)
+    #define R_LIKELY(exp) __builtin_expect(!!(exp), 1)
+    #define R_UNLIKELY(exp) __builtin_expect(!!(exp), 0)
+    #if defined(__x86_64__) || defined(__aarch64__)
+        #define RECLUSE_64BIT
+    #else
+        #define RECLUSE_32BIT
+    #endif
 #else
     #error "Architecture not supported for Recluse!"
 #endif 
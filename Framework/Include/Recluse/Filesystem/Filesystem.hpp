@@ -41,7 +41,7 @@ struct R_PUBLIC_API File
     static ResultCode writeToAsync(FileBufferDataAsync* pBuffer, const std::string& filePath);
 
     // Opens the file with the given access permissions.
-    ResultCode open(const std::string& filePath, char* access);
+    ResultCode open(const std::string& filePath, const char* access);
 
     // Closes the file handle, this is required, otherwise the handle remains open!
     void    close();
@@ -59,6 +59,32 @@ static Bool isPowerOf2(T d)
 }
 
 
+// Index of the lowest set bit. Value must not be 0.
+static R_FORCE_INLINE U32 bitScanForward(U64 value)
+{
+#if defined(RECLUSE_WINDOWS)
+	unsigned long index = 0;
+	_BitScanForward64(&index, value);
+	return static_cast<U32>(index);
+#else
+	return static_cast<U32>(__builtin_ctzll(value));
+#endif
+}
+
+
+// Index of the highest set bit. Value must not be 0.
+static R_FORCE_INLINE U32 bitScanReverse(U64 value)
+{
+#if defined(RECLUSE_WINDOWS)
+	unsigned long index = 0;
+	_BitScanReverse64(&index, value);
+	return static_cast<U32>(index);
+#else
+	return static_cast<U32>(63 - __builtin_clzll(value));
+#endif
+}
+
+
 // Get the minimum of the two values.
 template<typename T>
 static T minimum(T a, T b)
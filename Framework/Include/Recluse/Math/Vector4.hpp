@@ -36,8 +36,11 @@ struct R_PUBLIC_API Float4
     {
         struct { F32 x, y, z, w; };
         struct { F32 r, g, b, a; };
-        struct { F32 s, t, r, q; };
-        struct { F32 u, v, w, c; };
+        // The third texture coordinate was r, and the third of u, v, w, c was w, which collided with
+        // rgba and xyzw. They only ever resolved to r and w of those, so the third is p here, and
+        // _w only pads c into place.
+        struct { F32 s, t, p, q; };
+        struct { F32 u, v, _w, c; };
         __m128 row;
     };
 
@@ -89,7 +92,7 @@ struct R_PUBLIC_API UInt4
     union 
     {
         struct { U32 x, y, z, w; };
-        struct { U32 s, t, r, q; };
+        struct { U32 s, t, p, q; };
         struct { U32 r, g, b, a; };
     };
 
@@ -131,7 +134,7 @@ struct R_PUBLIC_API Int4
     union
     {
         struct { I32 x, y, z, w; };
-        struct { I32 s, t, r, q; };
+        struct { I32 s, t, p, q; };
         struct { I32 r, g, b, a; };
     };
 
@@ -163,7 +166,7 @@ struct R_PUBLIC_API UByte4
     union
     {
         struct { U8 x, y, z, w; };
-        struct { U8 s, t, r, q; };
+        struct { U8 s, t, p, q; };
         struct { U8 r, g, b, a; };
     };
 
@@ -195,7 +198,7 @@ struct R_PUBLIC_API Byte4
     union
     {
         struct { I8 x, y, z, w; };
-        struct { I8 s, t, r, q; };
+        struct { I8 s, t, p, q; };
         struct { I8 r, g, b, a; };
     };
 
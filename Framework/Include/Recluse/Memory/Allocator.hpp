@@ -5,6 +5,8 @@
 
 #include "Recluse/Types.hpp"
 #include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Memory/MemoryScan.hpp"
+#include "Recluse/Threading/Atomic.hpp"
 
 namespace Recluse {
 
@@ -34,30 +36,48 @@ public:
         , m_totalSizeBytes(sizeBytes)
         , m_usedSizeBytes(0)
         , m_pMemoryBaseAddr(basePtr)
-        , m_initialized(false) { }
+        , m_lastError(RecluseResult_Ok)
+        , m_initialized(false)
+        , m_sharedStatistics(true)
+        , m_tracked(false)
+        , m_tag(MemoryTag_Unknown) { }
 
     //! Allocator mem size and page size (usually 4kb). 
     void initialize(UPtr pBasePtr, U64 sizeBytes) 
     {
         m_totalSizeBytes    = sizeBytes;
         m_pMemoryBaseAddr   = pBasePtr;
-        m_usedSizeBytes     = 0;
+        m_usedSizeBytes.store(0, MemoryOrder_Relaxed);
+        // Allocators made before tracking was enabled stay untracked, their frees would not add up.
+        m_tracked = MemoryScanner::isTracking();
         ResultCode result = onInitialize();
         if (result == RecluseResult_Ok)
             m_initialized = true;
     }
 
+    //! Subsystem the allocations are charged to, when tracking. Set before initialize().
+    void setMemoryTag(MemoryTag tag)
+    {
+        m_tag = tag;
+    }
+
+    MemoryTag getMemoryTag() const { return m_tag; }
+
     //! Allocation requirements.
     UPtr allocate(U64 requestSz, U16 alignment) 
     {
         Allocation allocation = { };
         ResultCode err = onAllocate(&allocation, requestSz, alignment);
-        if (err == RecluseResult_Ok) 
+        if (err == RecluseResult_Ok && m_sharedStatistics) 
+        {
+            m_totalAllocations.fetchAdd(1, MemoryOrder_Relaxed);
+            m_usedSizeBytes.fetchAdd(allocation.sizeBytes, MemoryOrder_Relaxed);
+        }
+        if (err == RecluseResult_Ok && m_tracked)
         {
-            m_totalAllocations  += 1;
-            m_usedSizeBytes     += allocation.sizeBytes;
+            MemoryScanner::recordAllocation(m_tag, allocation.baseAddress, allocation.sizeBytes);
         }
-        m_lastError = err;
+        m_lastError.store(err, MemoryOrder_Relaxed);
         return allocation.baseAddress;
     }
 
@@ -67,33 +87,39 @@ public:
         alloc.baseAddress = ptr;
         alloc.sizeBytes = ~0;
         ResultCode err = onFree(&alloc);
-        if (err == RecluseResult_Ok) 
+        if (err == RecluseResult_Ok && m_sharedStatistics) 
         {
-            m_usedSizeBytes     -= alloc.sizeBytes;
-            m_totalAllocations  -= 1;
+            m_usedSizeBytes.fetchSub(alloc.sizeBytes, MemoryOrder_Relaxed);
+            m_totalAllocations.fetchSub(1, MemoryOrder_Relaxed);
         }
-        m_lastError = err;
+        if (err == RecluseResult_Ok && m_tracked)
+        {
+            MemoryScanner::recordFree(m_tag, ptr, alloc.sizeBytes);
+        }
+        m_lastError.store(err, MemoryOrder_Relaxed);
     }
 
 
     // Reset the allocator. This is more colloquially known as Clear().
     void reset() 
     {
+        releaseTracked();
         onReset();
-        m_usedSizeBytes     = 0;
-        m_totalAllocations  = 0;
-        m_lastError = RecluseResult_Ok;
+        m_usedSizeBytes.store(0, MemoryOrder_Relaxed);
+        m_totalAllocations.store(0, MemoryOrder_Relaxed);
+        m_lastError.store(RecluseResult_Ok, MemoryOrder_Relaxed);
     }
 
     void cleanUp() 
     {
+        releaseTracked();
         ResultCode result = onCleanUp();
-        m_totalAllocations  = 0;
+        m_totalAllocations.store(0, MemoryOrder_Relaxed);
         m_totalSizeBytes    = 0;
-        m_usedSizeBytes     = 0;
+        m_usedSizeBytes.store(0, MemoryOrder_Relaxed);
         m_pMemoryBaseAddr   = 0ull;
         
-        m_lastError = result;
+        m_lastError.store(result, MemoryOrder_Relaxed);
         if (result == RecluseResult_Ok)
             m_initialized = false;
     }
@@ -103,14 +129,14 @@ public:
         return m_totalSizeBytes; 
     }
 
-    inline U64 getUsedSizeBytes() const 
+    virtual U64 getUsedSizeBytes() const 
     { 
-        return m_usedSizeBytes; 
+        return m_usedSizeBytes.load(MemoryOrder_Relaxed); 
     }
 
-    inline U64 getTotalAllocations() const 
+    virtual U64 getTotalAllocations() const 
     { 
-        return m_totalAllocations; 
+        return m_totalAllocations.load(MemoryOrder_Relaxed); 
     }
 
     inline UPtr getBaseAddr() 
@@ -118,10 +144,30 @@ public:
         return m_pMemoryBaseAddr; 
     }
 
-    ResultCode getLastError() const { return m_lastError; }
+    ResultCode getLastError() const { return m_lastError.load(MemoryOrder_Relaxed); }
 
 protected:
 
+    // For allocators shared between threads, that keep statistics of their own, per thread,
+    // instead of the shared counters every allocation would contend on. They report them by
+    // overriding getUsedSizeBytes() and getTotalAllocations().
+    void disableSharedStatistics()
+    {
+        m_sharedStatistics = false;
+    }
+
+    // For allocators that give back many allocations at once, outside of free(). They all
+    // lie in the sizeBytes starting at address.
+    void releaseUsage(UPtr address, U64 sizeBytes, U64 numAllocations)
+    {
+        m_usedSizeBytes.fetchSub(sizeBytes, MemoryOrder_Relaxed);
+        m_totalAllocations.fetchSub(numAllocations, MemoryOrder_Relaxed);
+        if (m_tracked)
+        {
+            MemoryScanner::recordRelease(m_tag, address, sizeBytes, sizeBytes, numAllocations);
+        }
+    }
+
     virtual ResultCode onInitialize() = 0;
     virtual ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) = 0;
     virtual ResultCode onFree(Allocation* pOutput) = 0;
@@ -129,12 +175,27 @@ protected:
     virtual ResultCode onCleanUp() = 0;
 
 private:
+    // Everything still allocated is given back, on reset and clean up.
+    void releaseTracked()
+    {
+        if (m_tracked)
+        {
+            MemoryScanner::recordRelease(m_tag, m_pMemoryBaseAddr, m_totalSizeBytes, getUsedSizeBytes(), getTotalAllocations());
+        }
+    }
+
     U64     m_totalSizeBytes;
     UPtr    m_pMemoryBaseAddr;
-    U64     m_usedSizeBytes;
-    U64     m_totalAllocations;
-    ResultCode m_lastError = RecluseResult_Ok;
+    // Statistics only, so relaxed ordering is enough. Allocators that are shared between threads
+    // can then report usage without locking.
+    Atomic<U64> m_usedSizeBytes;
+    Atomic<U64> m_totalAllocations;
+    // Last error of any thread using this allocator.
+    Atomic<ResultCode> m_lastError;
     Bool    m_initialized;
+    Bool    m_sharedStatistics;
+    Bool    m_tracked;
+    MemoryTag m_tag;
 };
 
 
@@ -151,11 +212,13 @@ public:
 
     virtual ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) override 
     {
-        U64 offset = alignment - 1 + sizeof(void*);
+        // Keep the original pointer, and the size for onFree(), right before the aligned address.
+        U64 offset = alignment - 1 + sizeof(void*) + sizeof(U64);
         U64 neededSzBytes = requestSz + offset;
         void* ptr = malloc(neededSzBytes);
         void** ptrr = (void**)(((UPtr)(ptr) + offset) & ~(alignment - 1));
         ptrr[-1] = ptr;
+        ((U64*)(ptrr - 1))[-1] = requestSz;
         pOutput->baseAddress = (U64)(void*)ptrr;
         pOutput->sizeBytes = requestSz;
         return RecluseResult_Ok;
@@ -164,6 +227,7 @@ public:
     virtual ResultCode onFree(Allocation* pOutput) override
     {
         void** ptrr = (void**)pOutput->baseAddress;
+        pOutput->sizeBytes = ((U64*)(ptrr - 1))[-1];
         ::free(ptrr[-1]);
         return RecluseResult_Ok;
     }
@@ -5,39 +5,53 @@
 
 #include "Recluse/Memory/Allocator.hpp"
 
-#include <vector>
-#include <map>
-
 namespace Recluse {
 
 
-struct BuddyBlock 
-{
-    U64     memSzBytes;     // Likely sizes of 64 KB
-    U64     addressBytes;    // Offset of the buddy block in virtual memory.
-    U64     blockId;        // block id.
-};
-
 // Buddy allocator implementation.
 //
-class R_PUBLIC_API BuddyAllocator : public Allocator 
+// Blocks are powers of 2 multiples of the min block size, aligned to their own size, and split
+// in halves until they fit the request. The state lives in a packed binary tree, one byte per
+// node, holding the order of the largest free block under that node. Allocating walks down
+// from the root, picking the tightest child that still fits, and freeing walks up from the
+// leaf, merging buddies on the way. Both are O(log n), and nothing is allocated after
+// initialize. The managed memory is never touched, so the base address may just as well be
+// an offset into a GPU heap. Not thread safe.
+class R_PUBLIC_API BuddyAllocator : public Allocator
 {
-private:
-    typedef Allocation BlockAllocation;
+public:
+    static constexpr U64 kDefaultMinBlockSizeBytes = 256ull;
 
+    // Min block size must be a power of 2. Smaller blocks waste less memory, but cost more
+    // bookkeeping: two bytes per min block.
+    BuddyAllocator(U64 minBlockSizeBytes = kDefaultMinBlockSizeBytes);
+    virtual ~BuddyAllocator();
+
+    U64 getMinBlockSizeBytes() const { return m_minBlockSizeBytes; }
+
+    // Largest block that can currently be allocated.
+    U64 getLargestFreeBlockBytes() const;
+
+private:
     ResultCode onInitialize() override;
     ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) override;
     ResultCode onFree(Allocation* pOutput) override;
     ResultCode onReset() override;
     ResultCode onCleanUp() override;
 
-    inline BlockAllocation makeBlockAllocation(U64 blockAddress, U64 blockSzBytes)
-    {
-        return { blockAddress, blockSzBytes };
-    }
-
-    std::vector<std::vector<BuddyBlock>>        m_freeList;
-    std::map<SizeT, BlockAllocation>            m_allocatedBlocks;
-    U32                                         m_maxOrder;
+    void        resetTree();
+    void        reserveTail(U64 nodeIndex, U32 order, U64 offsetBytes);
+    void        updateParents(U64 nodeIndex, U32 order);
+
+    // Per node, the order of the largest free block underneath, plus 1. 0 means nothing is free.
+    U8*         m_pTree;
+    U64         m_minBlockSizeBytes;
+    U32         m_minBlockSizeLog2;
+    // Order of the root block. Order n blocks are m_minBlockSizeBytes << n bytes.
+    U32         m_maxOrder;
+    // Bytes the blocks may use. Anything past this, up to the root block size, is reserved.
+    U64         m_usableSizeBytes;
+    // Largest alignment the base address itself guarantees.
+    U64         m_baseAlignmentBytes;
 };
-} // Recluse
\ No newline at end of file
+} // Recluse
@@ -0,0 +1,61 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+
+#include "Recluse/Memory/Allocator.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+
+namespace Recluse {
+
+
+struct ConcurrentLinearSlot;
+
+
+// Linear allocator that any number of threads can allocate from at once. Threads reserve a
+// chunk of the arena at a time, with one atomic add on the shared top, and bump through their
+// chunk without touching shared state. Requests too large for a chunk go straight to the shared
+// top. Statistics are kept per thread slot too, and added up when asked for.
+//
+// Like LinearAllocator, nothing is given back until reset(), which must not race with
+// allocations. Up to a chunk per thread slot may go unused at the end of the arena.
+class R_PUBLIC_API ConcurrentLinearAllocator : public Allocator
+{
+public:
+    static constexpr U64 kDefaultChunkSizeBytes = R_KB(16);
+    // Threads past this share slots, and their locks.
+    static constexpr U32 kMaxSlots              = 64u;
+
+    ConcurrentLinearAllocator(U64 chunkSizeBytes = kDefaultChunkSizeBytes);
+    virtual ~ConcurrentLinearAllocator();
+
+    ConcurrentLinearAllocator(const ConcurrentLinearAllocator&) = delete;
+    ConcurrentLinearAllocator& operator=(const ConcurrentLinearAllocator&) = delete;
+
+    U64 getChunkSizeBytes() const { return m_chunkSizeBytes; }
+
+    // Bytes taken off the arena so far, including unused chunk tails.
+    U64 getReservedSizeBytes() const;
+
+    U64 getUsedSizeBytes() const override;
+    U64 getTotalAllocations() const override;
+
+private:
+    ResultCode onInitialize() override;
+    ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) override;
+    ResultCode onFree(Allocation* pOutput) override;
+    ResultCode onReset() override;
+    ResultCode onCleanUp() override;
+
+    void        resetState();
+
+    U64                     m_chunkSizeBytes;
+    // Offset of the next free byte, from the base address.
+    Atomic<U64>             m_top;
+    // Frees only count down the allocations, from whichever thread, so the slots stay owned by
+    // their threads.
+    Atomic<U64>             m_numFreed;
+    U8*                     m_pMetadata;
+    ConcurrentLinearSlot*   m_pSlots;
+};
+} // Recluse
@@ -0,0 +1,62 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+
+#include "Recluse/Memory/Allocator.hpp"
+#include "Recluse/Memory/MemoryCommon.hpp"
+
+namespace Recluse {
+
+
+struct FrameAllocatorStats
+{
+    U64     frameIndex;
+    // Bytes handed out over the frame, alignment padding included.
+    U64     allocatedBytes;
+    U64     numAllocations;
+    // Threads that allocated anything over the frame.
+    U32     numThreads;
+};
+
+
+// Arenas for transient data that only needs to live until the frame that made it retires.
+// Render commands, messages, culling results, scratch arrays in systems and so on.
+//
+// Each thread gets its own bump arena per frame in flight, so allocating never locks, and
+// never frees. beginFrame() moves every thread over to the arenas of the new frame. Each thread
+// wipes its own arena wholesale on its first get() of the frame, since whatever it held belongs
+// to a frame numFramesInFlight back, which the caller has waited on by then. No thread ever
+// resets an arena it does not own. Arenas are reserved pools, they grow in place when a frame
+// needs more than usual, and keep what they committed for the frames after.
+//
+// Meant for long lived threads: the main, render and worker threads. Each thread that calls
+// get() takes one of kMaxThreads slots until cleanUp().
+class R_PUBLIC_API FrameAllocator
+{
+public:
+    static constexpr U32 kMaxFramesInFlight         = 4u;
+    static constexpr U32 kMaxThreads                = 128u;
+    // Address space only, pages are committed as a frame uses them.
+    static constexpr U64 kDefaultArenaSizeBytes     = R_MB(256);
+
+    static ResultCode           initialize(U32 numFramesInFlight = 2u, U64 arenaSizeBytes = kDefaultArenaSizeBytes);
+    static void                 cleanUp();
+
+    // Starts a new frame. Only call once the GPU and any other consumer are done with the data
+    // of frame (frameIndex - numFramesInFlight), its arenas are reset by their threads from here
+    // on. Call from one thread only.
+    static void                 beginFrame(U64 frameIndex);
+
+    // Arena of the calling thread, for the current frame. Do not hold on to it across frames.
+    static Allocator*           get();
+
+    // Totals for the current frame so far, added up from every thread that has called get() in it.
+    static FrameAllocatorStats  getFrameStats();
+
+    // Totals of the frame that was last retired by beginFrame(). Call from the same thread.
+    static FrameAllocatorStats  getRetiredFrameStats();
+
+    static U32                  getNumFramesInFlight();
+};
+} // Recluse
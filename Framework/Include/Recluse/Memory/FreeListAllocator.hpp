@@ -4,41 +4,71 @@
 #include "Recluse/Memory/Allocator.hpp"
 #include "Recluse/Memory/MemoryCommon.hpp"
 
-#include <list>
-
 namespace Recluse {
 
 
-class FreeListAllocator : public Allocator 
-{
-private:
+struct FreeListBlock;
 
-    struct MemBlock 
+
+// General purpose allocator for variable sized data, using two level segregated fit (TLSF).
+// Free blocks are binned by size, first into power of 2 ranges, then each range is split
+// linearly into kSecondLevelCount bins. Bitmaps track which bins hold blocks, so finding a
+// block that fits is a couple of bit scans. Every block carries a boundary tag pointing to the
+// block before it in memory, so freed blocks merge with free neighbors right away.
+// Allocate and free are O(1), with a bounded worst case. Not thread safe.
+class R_PUBLIC_API FreeListAllocator : public Allocator
+{
+public:
+    // Snapshot of the free space, for spotting fragmentation. Walks every block, so this is
+    // meant for debugging and tools, not per frame queries.
+    struct FragmentationReport
     {
-        U64         addressOffsetBytes;
-        U64         blockSizeBytes;
+        U64     totalFreeBytes;
+        U64     largestFreeBlockBytes;
+        U64     usedBytes;
+        U32     numFreeBlocks;
+        U32     numUsedBlocks;
+        // 0 when all free space is in one block, approaching 1 as free space is split into
+        // pieces too small to be useful.
+        F32     fragmentation;
     };
 
-public:
+    static constexpr U32 kBlockAlignmentLog2    = 4u;
+    static constexpr U32 kBlockAlignment        = 1u << kBlockAlignmentLog2;
+    static constexpr U32 kSecondLevelCountLog2  = 5u;
+    static constexpr U32 kSecondLevelCount      = 1u << kSecondLevelCountLog2;
+    // Sizes below this all go into the first level, split linearly.
+    static constexpr U32 kFirstLevelShift       = kSecondLevelCountLog2 + kBlockAlignmentLog2;
+    static constexpr U32 kMaxBlockSizeLog2      = 40u;
+    static constexpr U32 kFirstLevelCount       = kMaxBlockSizeLog2 - kFirstLevelShift + 1u;
 
-    FreeListAllocator()
-        : m_memBlockStart(nullptr) { }
+    FreeListAllocator();
 
-    virtual ~FreeListAllocator() 
+    virtual ~FreeListAllocator()
     {
-        m_memBlocks.clear();
     }
 
     virtual ResultCode onInitialize() override;
     virtual ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) override;
     virtual ResultCode onFree(Allocation* pOutput) override;
-    
+
     virtual ResultCode onReset() override;
     virtual ResultCode onCleanUp() override;
 
+    FragmentationReport getFragmentationReport() const;
+
 private:
-    
-    MemBlock*           m_memBlockStart;
-    std::list<MemBlock> m_memBlocks;
+    FreeListBlock*      findFreeBlock(U64 sizeBytes);
+    void                insertFreeBlock(FreeListBlock* pBlock);
+    void                removeFreeBlock(FreeListBlock* pBlock);
+    FreeListBlock*      splitBlock(FreeListBlock* pBlock, U64 sizeBytes);
+    void                resetBlocks();
+
+    U32                 m_firstLevelBitmap;
+    U32                 m_secondLevelBitmaps[kFirstLevelCount];
+    FreeListBlock*      m_freeLists[kFirstLevelCount][kSecondLevelCount];
+    FreeListBlock*      m_pFirstBlock;
+    // Zero sized block at the end of the pool, so every block has a block after it.
+    FreeListBlock*      m_pSentinel;
 };
-} // Recluse
\ No newline at end of file
+} // Recluse
@@ -3,6 +3,7 @@
 
 #include "Recluse/Memory/Allocator.hpp"
 #include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
 #include "Recluse/Math/MathCommons.hpp"
 
 #include "Recluse/Messaging.hpp"
@@ -12,22 +13,37 @@ namespace Recluse {
 
 // Stack allocator, or linear allocator, which handles 
 // temporary data to be used briefly.
+//
+// Given a reserved backing pool, the allocator grows in place, committing pages of the pool as
+// the top moves past them. Initialize it over the whole reserved range in that case.
 class R_PUBLIC_API LinearAllocator : public Allocator 
 {
 public:
     LinearAllocator()
-        : m_top(0ull) { }
+        : m_top(0ull)
+        , m_committedEnd(0ull)
+        , m_pBackingPool(nullptr) { }
+
+    // Set before initialize. The pool must contain the memory this allocator manages.
+    void setBackingPool(MemoryPool* pPool)
+    {
+        m_pBackingPool = pPool;
+    }
 
     ResultCode onInitialize() override 
     {
-        m_top = (UPtr)getBaseAddr();
+        m_top           = (UPtr)getBaseAddr();
+        m_committedEnd  = m_pBackingPool 
+                            ? (m_pBackingPool->getBaseAddress() + m_pBackingPool->getCommittedSizeBytes()) 
+                            : (getBaseAddr() + getTotalSizeBytes());
         return RecluseResult_Ok;
     }
 
     ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) override 
     {
         R_ASSERT(Math::isPowerOf2(alignment));
-        UPtr neededSzBytes   = requestSz + alignOffset(m_top, alignment);
+        // Padding up to the aligned address, not the misalignment itself.
+        UPtr neededSzBytes   = requestSz + (align(m_top, alignment) - m_top);
         U64 totalSzBytes     = getTotalSizeBytes();
         UPtr szAddr          = getBaseAddr() + totalSzBytes;
         UPtr endAddr         = m_top + neededSzBytes;
@@ -37,6 +53,15 @@ public:
             return RecluseResult_OutOfMemory;
         }
 
+        if (endAddr > m_committedEnd)
+        {
+            ResultCode result = commitUpTo(endAddr);
+            if (result != RecluseResult_Ok)
+            {
+                return result;
+            }
+        }
+
         pOutput->baseAddress        = align(m_top, alignment);
         pOutput->sizeBytes          = neededSzBytes;
         m_top                       = endAddr;
@@ -49,9 +74,14 @@ public:
         return m_top;
     }
 
+    // Reset after the backing pool decommits, since the committed range is only read back here.
     ResultCode onReset() override 
     { 
         m_top = (UPtr)getBaseAddr();
+        if (m_pBackingPool)
+        {
+            m_committedEnd = m_pBackingPool->getBaseAddress() + m_pBackingPool->getCommittedSizeBytes();
+        }
         return RecluseResult_Ok;
     }
 
@@ -62,10 +92,36 @@ public:
 
     ResultCode onFree(Allocation* pOutput) override
     {
+        // Nothing is given back until reset.
+        pOutput->sizeBytes = 0ull;
         return RecluseResult_Ok;
     }
 
+protected:
+    // Moves the top back down, for allocators that give memory back in stack order.
+    void setTop(UPtr top)
+    {
+        R_ASSERT((top >= getBaseAddr()) && (top <= m_top));
+        m_top = top;
+    }
+
 private:
-    UPtr m_top;
+    ResultCode commitUpTo(UPtr endAddr)
+    {
+        if (!m_pBackingPool)
+        {
+            return RecluseResult_OutOfMemory;
+        }
+
+        const UPtr poolBaseAddr = m_pBackingPool->getBaseAddress();
+        ResultCode result       = m_pBackingPool->commit(endAddr - poolBaseAddr);
+        m_committedEnd          = poolBaseAddr + m_pBackingPool->getCommittedSizeBytes();
+        return result;
+    }
+
+    UPtr        m_top;
+    // Past this, pages of the backing pool still need committing.
+    UPtr        m_committedEnd;
+    MemoryPool* m_pBackingPool;
 };
 } // Recluse
\ No newline at end of file
@@ -0,0 +1,74 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+
+#include "Recluse/Memory/MemoryScan.hpp"
+
+#include <functional>
+
+namespace Recluse {
+
+
+struct MemoryBudgetStatus
+{
+    MemoryTag   tag;
+    // 0 if the tag has no budget.
+    U64         budgetBytes;
+    U64         softLimitBytes;
+    // Live bytes reported by the allocators charged to the tag.
+    U64         allocatedBytes;
+    // Memory held up front outside of tracked allocators, GPU heaps for example.
+    U64         reservedBytes;
+    // Allocated plus reserved. This is what is held against the budget.
+    U64         usedBytes;
+    U64         peakBytes;
+    Bool        overSoftLimit;
+    Bool        overBudget;
+};
+
+
+// Called from update() while a tag is over its soft limit, on the thread that calls update().
+// Streaming systems can evict from here, then report back through reserve()/unreserve() or by
+// freeing from their allocators.
+typedef std::function<void(const MemoryBudgetStatus&)> MemoryBudgetCallback;
+
+
+// Budgets per subsystem, charged against the memory tags the MemoryScanner counts. Subsystems
+// size their pools off getBudgetBytes(), instead of hard coded constants, so a tighter
+// configuration is just a different set of budgets, set before the engine initializes.
+//
+// Usage is only counted while the MemoryScanner is tracking, the main loop enables it, without
+// callsite sampling, when any budget was set. Limits are checked on update(), once a frame,
+// never from inside an allocation.
+class R_PUBLIC_API MemoryBudgets
+{
+public:
+    // Soft limit defaults to the budget itself.
+    static ResultCode           setBudget(MemoryTag tag, U64 budgetBytes, U64 softLimitBytes = 0ull);
+    static void                 clearBudget(MemoryTag tag);
+    static Bool                 hasBudgets();
+
+    // Budget of the tag, or defaultBytes if it has none.
+    static U64                  getBudgetBytes(MemoryTag tag, U64 defaultBytes);
+
+    // For memory held outside of our allocators, that still counts against the budget.
+    static void                 reserve(MemoryTag tag, U64 sizeBytes);
+    static void                 unreserve(MemoryTag tag, U64 sizeBytes);
+
+    // Returns an id to remove the callback with.
+    static U32                  addOverBudgetCallback(MemoryTag tag, MemoryBudgetCallback callback);
+    static void                 removeOverBudgetCallback(U32 callbackId);
+
+    // Checks every tag against its limits, and calls back for those over their soft limit.
+    // Call once per frame, from one thread.
+    static void                 update();
+
+    // Live usage of every tag, in tag order. Returns how many were filled in.
+    static U32                  getSnapshot(MemoryBudgetStatus* pStatuses, U32 maxStatuses);
+    static MemoryBudgetStatus   getStatus(MemoryTag tag);
+
+    // Logs the snapshot, one line per tag that has a budget or any usage.
+    static void                 logSnapshot();
+};
+} // Recluse
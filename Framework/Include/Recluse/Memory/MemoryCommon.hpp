@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Recluse/Arch.hpp"
+#include "Recluse/Types.hpp"
 
 #include <memory>
 
@@ -28,6 +29,10 @@ namespace Recluse {
 
 static const UPtr kNullPtr = 0;
 
+// Size of a cache line on the platforms we target. Used to pad data shared between threads,
+// to keep them from false sharing.
+static constexpr U32 kCacheLineSizeBytes = 64u;
+
 template<class T, class S>
 T* rDynamicCast(S* obj)
 {
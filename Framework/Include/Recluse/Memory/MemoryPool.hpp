@@ -5,43 +5,99 @@
 #pragma once
 
 #include "Recluse/Types.hpp"
+#include "Recluse/Memory/MemoryScan.hpp"
+
+#include <new>
 
 namespace Recluse {
 
 
-template<typename Type, typename ...Arguments>
+// Sits in front of everything allocated with rlsMalloc(), so frees know what to report, and
+// arrays know how many elements to destroy. Keeps what follows it 16 byte aligned.
+struct alignas(16) RlsAllocationHeader
+{
+    U64     sizeBytes;
+    U32     count;
+    U16     tag;
+    // Allocated while tracking, so the free is reported too.
+    U16     tracked;
+};
+
+
+// Raw memory with a header in front, from the global heap. Reported to the MemoryScanner, when tracking.
+R_PUBLIC_API void*  rlsAllocateBytes(U64 sizeBytes, U32 count, MemoryTag tag);
+R_PUBLIC_API void   rlsFreeBytes(void* ptr);
+
+
+static inline RlsAllocationHeader* rlsGetHeader(void* ptr)
+{
+    return reinterpret_cast<RlsAllocationHeader*>(ptr) - 1;
+}
+
+
+template<typename Type, MemoryTag Tag = MemoryTag_Unknown, typename ...Arguments>
 static Type* rlsMalloc(Arguments... args)
 {
-    return new Type(args...);
+    void* ptr = rlsAllocateBytes(sizeof(Type), 1u, Tag);
+    return new (ptr) Type(args...);
 }
 
 
-template<typename Type>
+template<typename Type, MemoryTag Tag = MemoryTag_Unknown>
 static Type* rlsMalloc(U64 count)
 {
-    return new Type[count];
+    Type* ptr = reinterpret_cast<Type*>(rlsAllocateBytes(sizeof(Type) * count, static_cast<U32>(count), Tag));
+    for (U64 i = 0; i < count; ++i)
+    {
+        new (&ptr[i]) Type;
+    }
+    return ptr;
 }
 
 
 template<typename Type>
 static void rlsFree(Type* ptr)
 {
-    delete ptr;
+    if (ptr)
+    {
+        ptr->~Type();
+        rlsFreeBytes(ptr);
+    }
 }
 
 
 template<typename Type>
 static void rlsFreeArray(Type* ptr)
 {
-    delete[] ptr;
+    if (ptr)
+    {
+        const U32 count = rlsGetHeader(ptr)->count;
+        for (U32 i = 0; i < count; ++i)
+        {
+            ptr[i].~Type();
+        }
+        rlsFreeBytes(ptr);
+    }
 }
 
 
-class MemoryScanner;
+enum MemoryPoolFlag
+{
+    MemoryPoolFlag_None         = 0,
+    // Back a reserved pool with large pages, where the OS can commit them on demand. Fewer TLB
+    // misses when walking big arenas, at the cost of committing in large page steps.
+    MemoryPoolFlag_LargePages   = (1 << 0)
+};
+
+typedef U32 MemoryPoolFlags;
 
 
 // Memory Pool consists of an allocated space that will be used for suballocations, or committed space.
 // This arena is intended to be used with Allocators.
+//
+// A pool can also be reserved instead, which only takes address space up front. Pages are then
+// committed as the pool grows into them, so a large reservation costs nothing until it is used,
+// and an arena can grow in place, without copying, up to the reserved size.
 class R_PUBLIC_API MemoryPool 
 {
 public:
@@ -71,8 +127,26 @@ public:
     // Pre allocates the memory pool.
     void                preAllocate(U64 szBytes, U64 pageSize = 4096ull);
 
+    // Reserves szBytes of address space, and commits the first initialCommitSzBytes of it. The
+    // pool reports the whole reserved size, but only the committed part may be touched.
+    ResultCode          reserve(U64 szBytes, U64 initialCommitSzBytes = 0ull, MemoryPoolFlags flags = MemoryPoolFlag_None);
+
+    // Makes sure the first szBytes of a reserved pool are committed. Grows in whole pages, and
+    // in larger steps as the pool gets bigger, so steady growth does not mean a syscall each time.
+    // Returns OutOfMemory past the reserved size. Always Ok for pools that are not reserved.
+    ResultCode          commit(U64 szBytes);
+
+    // Hands the pages of a reserved pool, past the first keepSzBytes, back to the OS.
+    void                decommit(U64 keepSzBytes = 0ull);
+
+    // Get the size that can be touched right now, in bytes. Same as the total size, unless the pool is reserved.
+    U64                 getCommittedSizeBytes() const { return m_committedSzBytes; }
+
+    // Check if the pool was reserved, and commits its pages on demand.
+    Bool                isReserved() const { return !!m_isReserved; }
+
     // Clear the pool, wipe out the state and set to default value.
-    // This does not free the pool memory!
+    // This does not free the pool memory! Reserved pools decommit everything past their initial commit.
     void                clear(U32 defaultValue = 0);
 
     // Free the pool memory! This will delete the memory!
@@ -89,7 +163,11 @@ private:
     UPtr    m_baseAddr;
     U64     m_totalSzBytes;
     U64     m_pageSzBytes;
+    U64     m_committedSzBytes;
+    // Committed size a reserved pool shrinks back down to, on clear().
+    U64     m_initialCommitSzBytes;
     B32     m_isMalloc;
+    B32     m_isReserved;
 
     struct MemScanNodes 
     {
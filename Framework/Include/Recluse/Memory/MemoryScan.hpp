@@ -12,12 +12,121 @@ namespace Recluse {
 class MemoryPool;
 
 
-class MemoryScanner 
+// Subsystem an allocation is charged to. Allocators are tagged with setMemoryTag(), and
+// rlsMalloc() takes one as a template argument.
+enum MemoryTag
+{
+    MemoryTag_Unknown,
+    MemoryTag_Core,
+    MemoryTag_Logging,
+    MemoryTag_Messaging,
+    MemoryTag_Threading,
+    // Transient, per frame allocations.
+    MemoryTag_Frame,
+    MemoryTag_Renderer,
+    MemoryTag_Graphics,
+    MemoryTag_Scene,
+    MemoryTag_Game,
+    MemoryTag_Count
+};
+
+
+struct MemoryTagStats
+{
+    U64     liveBytes;
+    U64     liveAllocations;
+    // Most bytes live at once, since tracking started or resetPeaks() was last called. Only
+    // checked when stats are read, and on markFrame(), so peaks within a frame may be missed.
+    U64     peakBytes;
+    // Running totals, that never go down.
+    U64     totalBytes;
+    U64     totalAllocations;
+};
+
+
+// What was allocated between the last two calls to markFrame(), frees not counted.
+struct MemoryFrameStats
+{
+    U64     bytes;
+    U64     numAllocations;
+};
+
+
+// Where sampled allocations came from, told apart by a hash of their call stack. Counts are of
+// the sampled allocations only, multiply by the sample rate to estimate the real numbers.
+struct MemoryCallsite
+{
+    static constexpr U32 kMaxStackFrames = 16u;
+
+    U64         stackHash;
+    MemoryTag   tag;
+    U32         numStackFrames;
+    void*       stackFrames[kMaxStackFrames];
+    U64         sampledBytes;
+    U64         sampledAllocations;
+    // Sampled allocations that were not freed yet.
+    U64         liveSampledBytes;
+    U64         liveSampledAllocations;
+};
+
+
+// Opt in allocation tracking. Once enabled, allocators initialized from then on, and rlsMalloc(),
+// report every allocation and free to keep byte and count statistics per tag, along with high
+// water marks. Each thread counts into its own counters, without locked instructions, so
+// tracking can stay on in performance builds.
+//
+// 1 in sampleRate allocations also has its call stack captured, to tell which callsites allocate
+// the most, and which leak. Allocations are picked by address, so frees can tell whether they
+// were sampled without a lookup, and only sampled ones take the lock.
+class R_PUBLIC_API MemoryScanner
 {
 public:
-    void scanMemoryLeaks(const MemoryPool* pool) { }
+    // Capturing a stack takes microseconds, so it is kept rare enough to vanish in the average.
+    static constexpr U32 kDefaultSampleRate = 1024u;
+
+    // Sample rate is rounded up to a power of 2. 1 samples everything, 0 keeps the counters
+    // without sampling any callsites.
+    static ResultCode           enableTracking(U32 sampleRate = kDefaultSampleRate);
+
+    // Stops tracking, and drops everything tracked so far. Allocators that were tracked keep
+    // reporting, and are ignored.
+    static void                 disableTracking();
+
+    static Bool                 isTracking();
+    static U32                  getSampleRate();
+
+    // Hooks for allocators. sizeBytes may be 0 on free, for allocators that only give memory back
+    // on reset. Those report it all at once with recordRelease(), along with the address range
+    // that was given back.
+    static void                 recordAllocation(MemoryTag tag, UPtr address, U64 sizeBytes);
+    static void                 recordFree(MemoryTag tag, UPtr address, U64 sizeBytes);
+    static void                 recordRelease(MemoryTag tag, UPtr address, U64 rangeSizeBytes, U64 sizeBytes, U64 numAllocations);
+
+    static MemoryTagStats       getTagStats(MemoryTag tag);
+
+    // Call once per frame, from one thread.
+    static void                 markFrame();
+    static MemoryFrameStats     getLastFrameStats(MemoryTag tag);
+
+    // Fills in up to maxCallsites, the ones with the most sampled bytes first. Returns how many
+    // were filled in.
+    static U32                  getTopCallsites(MemoryCallsite* pCallsites, U32 maxCallsites);
+
+    static void                 resetPeaks();
+
+    // Logs sampled allocations that are still live inside the pool. Called when the pool is
+    // released, for scanners added to it. Returns the sampled bytes found.
+    static U64                  scanMemoryLeaks(const MemoryPool* pool);
+
+    // Looks up the callsite of a sampled allocation that is still live. Returns false if the
+    // allocation was not sampled.
+    static Bool                 getMemoryAllocationLocation(const void* ptr, MemoryCallsite& callsiteOut);
+
+    // Logs whatever is still live, per tag, and the callsites of the sampled leftovers. Meant for
+    // shutdown, once everything should have been freed. Returns the live bytes across all tags.
+    static U64                  reportLeaks();
 
-    void getMemoryAllocationLocation() { }
+    static const char*          getTagName(MemoryTag tag);
 };
 } // Recluse
-#endif // RECLUSE_MEMORY_SCAN_HPP
\ No newline at end of file
+#endif // RECLUSE_MEMORY_SCAN_HPP
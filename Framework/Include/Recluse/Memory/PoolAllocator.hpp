@@ -4,21 +4,84 @@
 
 #include "Recluse/Memory/Allocator.hpp"
 #include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+
+#include <vector>
 
 namespace Recluse {
 
 
+enum PoolAllocatorFlag
+{
+    PoolAllocatorFlag_None  = 0,
+    // Poison free blocks, and check for double frees, and for writes to freed blocks. Slower,
+    // meant for tracking down memory bugs.
+    PoolAllocatorFlag_Debug = (1 << 0)
+};
+
+typedef U32 PoolAllocatorFlags;
+
+
+struct PoolSizeClass;
+struct PoolMagazine;
+
+
+// Slab allocator, for small fixed size objects. The memory given on initialize is split into
+// slabs, and each slab is carved into blocks of a single size class the first time that class
+// needs more memory. Size classes are powers of 2, from kMinBlockSizeBytes up to the max block
+// size. Blocks are aligned to their size, so larger alignments just use a larger class.
+//
+// Allocating and freeing are O(1). Free blocks sit on intrusive free lists, and the size class
+// of a freed block is looked up from the slab it lives in. Each thread works out of its own
+// magazine, a small cache of free blocks per size class, and only touches the shared lists
+// to refill, or flush, half a magazine at a time. Safe to use from multiple threads, except
+// for initialize, reset and cleanUp.
 class R_PUBLIC_API PoolAllocator : public Allocator
 {
 public:
-    ResultCode onInitialize() override
-    {
-        return RecluseResult_NoImpl;
-    }
-
-    ResultCode onCleanUp() override
-    {
-        return RecluseResult_NoImpl;
-    }
+    static constexpr U32 kMinBlockSizeBytes     = 16u;
+    static constexpr U32 kMaxSizeClasses        = 16u;
+    static constexpr U64 kDefaultSlabSizeBytes  = R_KB(64);
+    // Free blocks each magazine may hold per size class, before half of them are flushed back.
+    static constexpr U32 kMagazineCapacity      = 64u;
+    // Threads beyond this share magazines, which is still safe, but contends.
+    static constexpr U32 kMaxMagazines          = 64u;
+
+    PoolAllocator(U32 maxBlockSizeBytes = 1024u, U64 slabSizeBytes = kDefaultSlabSizeBytes, PoolAllocatorFlags flags = PoolAllocatorFlag_None);
+    virtual ~PoolAllocator();
+
+    U32 getNumSizeClasses() const { return m_numSizeClasses; }
+    U32 getMaxBlockSizeBytes() const { return kMinBlockSizeBytes << (m_numSizeClasses - 1); }
+    U64 getSlabSizeBytes() const { return m_slabSizeBytes; }
+    // Slabs handed out to size classes so far.
+    U32 getNumUsedSlabs() const;
+
+private:
+    ResultCode onInitialize() override;
+    ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) override;
+    ResultCode onFree(Allocation* pOutput) override;
+    ResultCode onReset() override;
+    ResultCode onCleanUp() override;
+
+    Bool        refill(U32 sizeClass, PoolMagazine* pMagazine);
+    void        flush(U32 sizeClass, PoolMagazine* pMagazine, U32 count);
+    Bool        markAllocated(UPtr address, Bool allocated);
+    void        resetState();
+
+    U32                 m_numSizeClasses;
+    U64                 m_slabSizeBytes;
+    PoolAllocatorFlags  m_flags;
+    // Start of the first slab, aligned up from the base address.
+    UPtr                m_slabBase;
+    U32                 m_numSlabs;
+    Atomic<U32>         m_nextSlab;
+    // Size class of each slab, or kUnassignedSlab.
+    std::vector<U8>     m_slabSizeClasses;
+    U8*                 m_pMetadata;
+    PoolSizeClass*      m_pSizeClasses;
+    PoolMagazine*       m_pMagazines;
+    // Debug only, one bit per kMinBlockSizeBytes, set while a block is allocated.
+    Atomic<U64>*        m_pAllocatedBits;
+    U64                 m_numAllocatedBitWords;
 };
-} // Recluse
\ No newline at end of file
+} // Recluse
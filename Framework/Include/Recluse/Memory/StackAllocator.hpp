@@ -0,0 +1,73 @@
+//
+#pragma once
+
+#include "Recluse/Memory/LinearAllocator.hpp"
+
+namespace Recluse {
+
+
+// Point on the stack to free back down to.
+struct StackMarker
+{
+    UPtr    top;
+    U64     numAllocations;
+    // Most recent allocation when the marker was taken, 0 if none.
+    UPtr    lastAllocation;
+};
+
+
+// Linear allocator that gives memory back in stack order. Take a marker before some scratch
+// work, and free back down to it after, so nested work can share one arena, and the arena only
+// peaks at the deepest scope instead of the sum of all of them. free() only pops the most recent
+// allocation. Freeing any other allocation fails with CorruptMemory, and frees nothing, in every
+// build. Free to a marker to drop several at once.
+//
+// Every allocation keeps a small header in front, with where to rewind to. Debug builds add a
+// sentinel to it, to catch stale markers and writes past the end of the previous allocation.
+// Freed memory is poisoned in debug builds.
+class R_PUBLIC_API StackAllocator : public LinearAllocator
+{
+public:
+    StackAllocator();
+
+    StackMarker getMarker() const;
+
+    // Frees everything allocated since the marker was taken. Markers must be freed in the
+    // reverse order they were taken. Returns CorruptMemory, and frees nothing, for a marker
+    // that was already freed past.
+    ResultCode  freeToMarker(const StackMarker& marker);
+
+    ResultCode onInitialize() override;
+    ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) override;
+    ResultCode onFree(Allocation* pOutput) override;
+    ResultCode onReset() override;
+
+private:
+    // Most recent allocation still alive, 0 if none.
+    UPtr        m_lastAllocation;
+};
+
+
+// Frees the stack allocator back down to where it was, at the end of the scope.
+class ScopedStackMark
+{
+public:
+    ScopedStackMark(StackAllocator& allocator)
+        : m_allocator(allocator)
+        , m_marker(allocator.getMarker())
+    {
+    }
+
+    ~ScopedStackMark()
+    {
+        m_allocator.freeToMarker(m_marker);
+    }
+
+    ScopedStackMark(const ScopedStackMark&) = delete;
+    ScopedStackMark& operator=(const ScopedStackMark&) = delete;
+
+private:
+    StackAllocator& m_allocator;
+    StackMarker     m_marker;
+};
+} // Recluse
@@ -0,0 +1,201 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+
+#include "Recluse/Memory/Allocator.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <new>
+#include <limits>
+#include <string>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+
+namespace Recluse {
+
+
+template<typename T>
+static R_FORCE_INLINE T* allocateFromAdapter(Allocator* pAllocator, std::size_t n)
+{
+    if (n > (std::numeric_limits<std::size_t>::max)() / sizeof(T))
+    {
+        throw std::bad_alloc();
+    }
+
+    const UPtr ptr = pAllocator->allocate(static_cast<U64>(n * sizeof(T)), static_cast<U16>(alignof(T)));
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return reinterpret_cast<T*>(ptr);
+}
+
+
+// Lets std containers allocate from one of our allocators, without going to the global heap.
+// The allocator is shared by every copy and rebind of the adapter, and must outlive whatever
+// container uses it. Containers carry their allocator along when copied, moved or swapped.
+//
+// AllocatorType may be the concrete allocator, so calls into it can be resolved at compile time.
+// Failed allocations throw std::bad_alloc, since that is all std containers understand.
+template<typename T, typename AllocatorType = Allocator>
+class StdAllocatorAdapter
+{
+public:
+    typedef T               value_type;
+    typedef std::size_t     size_type;
+    typedef std::ptrdiff_t  difference_type;
+    typedef std::true_type  propagate_on_container_copy_assignment;
+    typedef std::true_type  propagate_on_container_move_assignment;
+    typedef std::true_type  propagate_on_container_swap;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef StdAllocatorAdapter<U, AllocatorType> other;
+    };
+
+    StdAllocatorAdapter(AllocatorType* pAllocator) noexcept
+        : m_pAllocator(pAllocator)
+    {
+        R_ASSERT(pAllocator != nullptr);
+    }
+
+    template<typename U>
+    StdAllocatorAdapter(const StdAllocatorAdapter<U, AllocatorType>& other) noexcept
+        : m_pAllocator(other.getAllocator())
+    {
+    }
+
+    T* allocate(size_type n)
+    {
+        return allocateFromAdapter<T>(m_pAllocator, n);
+    }
+
+    void deallocate(T* p, size_type) noexcept
+    {
+        m_pAllocator->free(reinterpret_cast<UPtr>(p));
+    }
+
+    AllocatorType* getAllocator() const noexcept { return m_pAllocator; }
+
+private:
+    AllocatorType* m_pAllocator;
+};
+
+
+template<typename T, typename U, typename AllocatorType>
+inline bool operator==(const StdAllocatorAdapter<T, AllocatorType>& a, const StdAllocatorAdapter<U, AllocatorType>& b) noexcept
+{
+    return a.getAllocator() == b.getAllocator();
+}
+
+
+template<typename T, typename U, typename AllocatorType>
+inline bool operator!=(const StdAllocatorAdapter<T, AllocatorType>& a, const StdAllocatorAdapter<U, AllocatorType>& b) noexcept
+{
+    return a.getAllocator() != b.getAllocator();
+}
+
+
+// Same as StdAllocatorAdapter, but over any Allocator, picked at runtime, so containers over
+// different allocators are the same type. Default constructed, it goes to the global heap.
+//
+// Follows std::pmr::polymorphic_allocator: a container keeps the allocator it was made with.
+// Assigning or swapping does not move it over to the other container's allocator, and copies
+// go to the global heap, unless given an allocator of their own. Swapping containers over
+// different allocators is not allowed.
+template<typename T>
+class PolymorphicStdAllocatorAdapter
+{
+public:
+    typedef T               value_type;
+    typedef std::size_t     size_type;
+    typedef std::ptrdiff_t  difference_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::false_type propagate_on_container_swap;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef PolymorphicStdAllocatorAdapter<U> other;
+    };
+
+    PolymorphicStdAllocatorAdapter(Allocator* pAllocator = nullptr) noexcept
+        : m_pAllocator(pAllocator)
+    {
+    }
+
+    template<typename U>
+    PolymorphicStdAllocatorAdapter(const PolymorphicStdAllocatorAdapter<U>& other) noexcept
+        : m_pAllocator(other.getAllocator())
+    {
+    }
+
+    T* allocate(size_type n)
+    {
+        if (!m_pAllocator)
+        {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return allocateFromAdapter<T>(m_pAllocator, n);
+    }
+
+    void deallocate(T* p, size_type) noexcept
+    {
+        if (!m_pAllocator)
+        {
+            ::operator delete(p);
+            return;
+        }
+        m_pAllocator->free(reinterpret_cast<UPtr>(p));
+    }
+
+    PolymorphicStdAllocatorAdapter select_on_container_copy_construction() const noexcept
+    {
+        return PolymorphicStdAllocatorAdapter();
+    }
+
+    Allocator* getAllocator() const noexcept { return m_pAllocator; }
+
+private:
+    Allocator* m_pAllocator;
+};
+
+
+template<typename T, typename U>
+inline bool operator==(const PolymorphicStdAllocatorAdapter<T>& a, const PolymorphicStdAllocatorAdapter<U>& b) noexcept
+{
+    return a.getAllocator() == b.getAllocator();
+}
+
+
+template<typename T, typename U>
+inline bool operator!=(const PolymorphicStdAllocatorAdapter<T>& a, const PolymorphicStdAllocatorAdapter<U>& b) noexcept
+{
+    return a.getAllocator() != b.getAllocator();
+}
+
+
+// std containers over an arena, or any other allocator, handed in on construction:
+//
+//      Arena::Vector<U64> keys(FrameAllocator::get());
+//
+// Nested containers do not pick up the allocator of the outer one, so construct the inner
+// ones with it too. Over a LinearAllocator, nothing is given back until the arena resets, so
+// these are meant for data that is rebuilt every frame, not grown for the whole run.
+namespace Arena {
+
+
+template<typename T>
+using Vector = std::vector<T, PolymorphicStdAllocatorAdapter<T>>;
+
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+using HashMap = std::unordered_map<K, V, Hash, KeyEqual, PolymorphicStdAllocatorAdapter<std::pair<const K, V>>>;
+
+typedef std::basic_string<char, std::char_traits<char>, PolymorphicStdAllocatorAdapter<char>> String;
+} // Arena
+} // Recluse
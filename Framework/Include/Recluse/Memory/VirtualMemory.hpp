@@ -0,0 +1,32 @@
+//
+#pragma once
+
+#include "Recluse/Arch.hpp"
+#include "Recluse/Types.hpp"
+
+namespace Recluse {
+namespace VirtualMemory {
+
+
+// Size of a regular page. Commits and decommits happen in whole pages.
+R_PUBLIC_API R_OS_CALL U64          getPageSizeBytes();
+
+// Size of a large (huge) page that can be committed on demand, or 0 if the OS can not do so.
+R_PUBLIC_API R_OS_CALL U64          getLargePageSizeBytes();
+
+// Reserves address space only, nothing is usable until committed. With useLargePages, the
+// range is aligned to, and backed by, large pages where the OS allows it. Returns nullptr on
+// failure.
+R_PUBLIC_API R_OS_CALL void*        reserve(U64 sizeBytes, Bool useLargePages = false);
+
+// Makes a page aligned range of reserved memory usable. Pages are zeroed the first time they
+// are touched.
+R_PUBLIC_API R_OS_CALL ResultCode   commit(void* pAddress, U64 sizeBytes);
+
+// Hands the physical pages of a page aligned range back to the OS. The range stays reserved.
+R_PUBLIC_API R_OS_CALL ResultCode   decommit(void* pAddress, U64 sizeBytes);
+
+// Releases a whole range returned by reserve().
+R_PUBLIC_API R_OS_CALL ResultCode   release(void* pAddress, U64 sizeBytes);
+} // VirtualMemory
+} // Recluse
@@ -7,22 +7,24 @@
 #include <stdio.h>
 
 // Logging functions.
-#define R_LOG(chan, logType, format, ...) \
+// The format string is passed as the first variadic argument, so that messages without any 
+// arguments don't leave a trailing comma on compilers that don't swallow it.
+#define R_LOG(chan, logType, ...) \
     { \
         Recluse::Log r__log__(logType, chan); \
-        Recluse::SizeT r__sz__ = snprintf(nullptr, 0, format, __VA_ARGS__); \
+        Recluse::SizeT r__sz__ = snprintf(nullptr, 0, __VA_ARGS__); \
         r__log__.data.msg.resize(r__sz__ + 1u); \
-        snprintf((char*)r__log__.data.msg.data(), r__log__.data.msg.size(), format, __VA_ARGS__); \
+        snprintf((char*)r__log__.data.msg.data(), r__log__.data.msg.size(), __VA_ARGS__); \
         r__log__ << Recluse::DateFormatter("%Y-%M-%D %h:%m:%s"); \
     }
 
 // Helper macros for logging messages.
-#define R_INFO(chan, format, ...)       do { R_LOG(chan, Recluse::LogType_Info, format, __VA_ARGS__);    } while (false)
-#define R_WARN(chan, format, ...)       do { R_LOG(chan, Recluse::LogType_Warn, format, __VA_ARGS__);    } while (false)
-#define R_VERBOSE(chan, format, ...)    do { R_LOG(chan, Recluse::LogType_Verbose, format, __VA_ARGS__); } while (false)
-#define R_TRACE(chan, format, ...)      do { R_LOG(chan, Recluse::LogType_Trace, format, __VA_ARGS__);   } while (false)
-#define R_NOTIFY(chan, format, ...)     do { R_LOG(chan, Recluse::LogType_Notify, format, __VA_ARGS__);  } while (false)
-#define R_DEBUG(chan, str, ...)         do { R_LOG(chan, Recluse::LogType_Debug, str, __VA_ARGS__); } while (false)
+#define R_INFO(chan, ...)       do { R_LOG(chan, Recluse::LogType_Info, __VA_ARGS__);    } while (false)
+#define R_WARN(chan, ...)       do { R_LOG(chan, Recluse::LogType_Warn, __VA_ARGS__);    } while (false)
+#define R_VERBOSE(chan, ...)    do { R_LOG(chan, Recluse::LogType_Verbose, __VA_ARGS__); } while (false)
+#define R_TRACE(chan, ...)      do { R_LOG(chan, Recluse::LogType_Trace, __VA_ARGS__);   } while (false)
+#define R_NOTIFY(chan, ...)     do { R_LOG(chan, Recluse::LogType_Notify, __VA_ARGS__);  } while (false)
+#define R_DEBUG(chan, ...)      do { R_LOG(chan, Recluse::LogType_Debug, __VA_ARGS__);   } while (false)
  
 #if defined(RECLUSE_DEBUG) || defined(RECLUSE_DEVELOPER)
     namespace Recluse {
@@ -72,7 +74,7 @@
         #else
             // TODO: For anything other than windows, we still need to improve this.
             #define R_ASSERT(expression) assert(expression)
-            #define R_ASSERT_FORMAT(expression, msg, ...) do { char err[512]; sprintf(err, #msg, __VA_ARGS__); assert(expression && err); } while (0)
+            #define R_ASSERT_FORMAT(expression, ...) do { char err[512]; snprintf(err, sizeof(err), __VA_ARGS__); assert((expression) && err); } while (0)
         #endif
     #else
         #undef R_DEBUG_BREAK()
@@ -90,29 +92,29 @@
 
 #if defined(RECLUSE_DEVELOPER)
     #if defined(RECLUSE_DEBUG)
-        #define R_ERROR(chan, format, ...) \
+        #define R_ERROR(chan, ...) \
             do { \
-                R_LOG(chan, Recluse::LogType_Error, format, __VA_ARGS__); \
+                R_LOG(chan, Recluse::LogType_Error, __VA_ARGS__); \
                 R_DEBUG_BREAK(); \
             } while (false)
 
         // Call an interrupt to instruct a fatal error.
-        #define R_FATAL_ERROR(chan, format, ...) \
+        #define R_FATAL_ERROR(chan, ...) \
             do { \
-                R_LOG(chan, Recluse::LogType_Fatal, format, __VA_ARGS__); \
+                R_LOG(chan, Recluse::LogType_Fatal, __VA_ARGS__); \
                 R_DEBUG_BREAK(); \
                 R_FORCE_CRASH(-1); \
             } while (false)
     #else
-        #define R_ERROR(chan, format, ...) do { R_LOG(chan, Recluse::LogType_Fatal, format, __VA_ARGS__); } while (false)
-        #define R_FATAL_ERROR(chan, format, ...) do { R_LOG(chan, Recluse::LogType_Fatal, format, __VA_ARGS__); } while (false)
+        #define R_ERROR(chan, ...) do { R_LOG(chan, Recluse::LogType_Fatal, __VA_ARGS__); } while (false)
+        #define R_FATAL_ERROR(chan, ...) do { R_LOG(chan, Recluse::LogType_Fatal, __VA_ARGS__); } while (false)
     #endif
     // NOTE(): We should always be implementing a function when needed, but for development purposes,
     // we can simply place a warning assert to let us know it is not written. Otherwise, to 
     // the user, this is entirely ignored.
     #define R_NO_IMPL() R_ASSERT_FORMAT(false, "No implementation for %s", __FUNCTION__)
 #else
-    #define R_ERROR(chan, format, ...) do { R_LOG(chan, Recluse::LogType_Error, format, __VA_ARGS__); } while (false)
-    #define R_FATAL_ERROR(chan, format, ...) do { R_LOG(chan, Recluse::LogType_Fatal, format, __VA_ARGS__); } while (false)
+    #define R_ERROR(chan, ...) do { R_LOG(chan, Recluse::LogType_Error, __VA_ARGS__); } while (false)
+    #define R_FATAL_ERROR(chan, ...) do { R_LOG(chan, Recluse::LogType_Fatal, __VA_ARGS__); } while (false)
     #define R_NO_IMPL()
 #endif
\ No newline at end of file
@@ -0,0 +1,444 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+#include "Recluse/Memory/Allocator.hpp"
+#include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+namespace Recluse {
+
+
+// Bounded multi producer, multi consumer lock free queue. Based on Dmitry Vyukov's bounded
+// MPMC queue. Each cell carries a sequence number, telling producers and consumers whether
+// the cell is ready for them, so the only contended atomics are the enqueue and dequeue
+// positions. Capacity must be a power of two.
+template<typename T>
+class MPMCQueue
+{
+public:
+    MPMCQueue()
+        : m_pAllocator(nullptr)
+        , m_pCells(nullptr)
+        , m_mask(0ull)
+    {
+        m_enqueuePos.store(0ull, std::memory_order_relaxed);
+        m_dequeuePos.store(0ull, std::memory_order_relaxed);
+    }
+
+    ~MPMCQueue() { release(); }
+
+    ResultCode initialize(Allocator* pAllocator, U32 capacity)
+    {
+        R_ASSERT(pAllocator != nullptr);
+
+        if ((capacity < 2u) || ((capacity & (capacity - 1u)) != 0u))
+        {
+            R_ERROR("MPMCQueue", "Capacity must be a power of two, and at least 2! capacity=%d", capacity);
+            return RecluseResult_InvalidArgs;
+        }
+
+        const U64 alignment = (alignof(Cell) > kCacheLineSizeBytes) ? alignof(Cell) : kCacheLineSizeBytes;
+        UPtr baseAddress    = pAllocator->allocate(sizeof(Cell) * capacity, static_cast<U16>(alignment));
+        if (!baseAddress)
+        {
+            return RecluseResult_OutOfMemory;
+        }
+
+        m_pAllocator    = pAllocator;
+        m_pCells        = reinterpret_cast<Cell*>(baseAddress);
+        m_mask          = capacity - 1u;
+
+        for (U32 i = 0; i < capacity; ++i)
+        {
+            new (&m_pCells[i]) Cell();
+            m_pCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_enqueuePos.store(0ull, std::memory_order_relaxed);
+        m_dequeuePos.store(0ull, std::memory_order_relaxed);
+
+        return RecluseResult_Ok;
+    }
+
+    // Not thread safe, no other thread may be using the queue.
+    ResultCode release()
+    {
+        if (!m_pCells)
+        {
+            return RecluseResult_Ok;
+        }
+
+        // Destroy anything that is left over.
+        const U64 enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (U64 pos = m_dequeuePos.load(std::memory_order_relaxed); pos != enqueuePos; ++pos)
+        {
+            reinterpret_cast<T*>(&m_pCells[pos & m_mask].storage)->~T();
+        }
+
+        for (U64 i = 0; i <= m_mask; ++i)
+        {
+            m_pCells[i].~Cell();
+        }
+
+        m_pAllocator->free(reinterpret_cast<UPtr>(m_pCells));
+        m_pCells        = nullptr;
+        m_pAllocator    = nullptr;
+        m_mask          = 0ull;
+
+        return RecluseResult_Ok;
+    }
+
+    // Returns false if the queue is full.
+    Bool push(const T& value) { return emplace(value); }
+    Bool push(T&& value) { return emplace(std::move(value)); }
+
+    // Returns false if the queue is empty.
+    Bool pop(T& value)
+    {
+        Cell* pCell = nullptr;
+        U64 pos     = m_dequeuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            pCell               = &m_pCells[pos & m_mask];
+            const U64 sequence  = pCell->sequence.load(std::memory_order_acquire);
+            const I64 diff      = static_cast<I64>(sequence) - static_cast<I64>(pos + 1ull);
+
+            if (diff == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1ull, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // Nothing was written to this cell yet.
+                return false;
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* pValue   = reinterpret_cast<T*>(&pCell->storage);
+        value       = std::move(*pValue);
+        pValue->~T();
+
+        // Hand the cell to the producer one lap ahead.
+        pCell->sequence.store(pos + m_mask + 1ull, std::memory_order_release);
+        return true;
+    }
+
+    U32 getCapacity() const { return static_cast<U32>(m_mask + 1ull); }
+
+    // Approximate, since other threads may be pushing or popping at the same time.
+    U32 getApproximateSize() const
+    {
+        const U64 enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+        const U64 dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+        return (enqueuePos > dequeuePos) ? static_cast<U32>(enqueuePos - dequeuePos) : 0u;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<U64>                                            sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type  storage;
+    };
+
+    template<typename Type>
+    Bool emplace(Type&& value)
+    {
+        Cell* pCell = nullptr;
+        U64 pos     = m_enqueuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            pCell               = &m_pCells[pos & m_mask];
+            const U64 sequence  = pCell->sequence.load(std::memory_order_acquire);
+            const I64 diff      = static_cast<I64>(sequence) - static_cast<I64>(pos);
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1ull, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // Consumers have not gotten to this cell yet, queue is full.
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (&pCell->storage) T(std::forward<Type>(value));
+        pCell->sequence.store(pos + 1ull, std::memory_order_release);
+        return true;
+    }
+
+    U8                  m_pad0[kCacheLineSizeBytes];
+    Allocator*          m_pAllocator;
+    Cell*               m_pCells;
+    U64                 m_mask;
+    U8                  m_pad1[kCacheLineSizeBytes - sizeof(Allocator*) - sizeof(Cell*) - sizeof(U64)];
+    std::atomic<U64>    m_enqueuePos;
+    U8                  m_pad2[kCacheLineSizeBytes - sizeof(U64)];
+    std::atomic<U64>    m_dequeuePos;
+    U8                  m_pad3[kCacheLineSizeBytes - sizeof(U64)];
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+};
+
+
+// Bounded single producer, single consumer wait free queue. Only one thread may push, and
+// only one thread may pop. The producer and consumer indices sit on their own cache lines,
+// and each side caches the last index it read from the other side, so they only touch the
+// other's cache line when the queue looks full, or empty. Capacity must be a power of two.
+template<typename T>
+class SPSCQueue
+{
+public:
+    SPSCQueue()
+        : m_pAllocator(nullptr)
+        , m_pSlots(nullptr)
+        , m_mask(0ull)
+        , m_cachedHead(0ull)
+        , m_cachedTail(0ull)
+    {
+        m_tail.store(0ull, std::memory_order_relaxed);
+        m_head.store(0ull, std::memory_order_relaxed);
+    }
+
+    ~SPSCQueue() { release(); }
+
+    ResultCode initialize(Allocator* pAllocator, U32 capacity)
+    {
+        R_ASSERT(pAllocator != nullptr);
+
+        if ((capacity < 2u) || ((capacity & (capacity - 1u)) != 0u))
+        {
+            R_ERROR("SPSCQueue", "Capacity must be a power of two, and at least 2! capacity=%d", capacity);
+            return RecluseResult_InvalidArgs;
+        }
+
+        const U64 alignment = (alignof(Slot) > kCacheLineSizeBytes) ? alignof(Slot) : kCacheLineSizeBytes;
+        UPtr baseAddress    = pAllocator->allocate(sizeof(Slot) * capacity, static_cast<U16>(alignment));
+        if (!baseAddress)
+        {
+            return RecluseResult_OutOfMemory;
+        }
+
+        m_pAllocator    = pAllocator;
+        m_pSlots        = reinterpret_cast<Slot*>(baseAddress);
+        m_mask          = capacity - 1u;
+        m_cachedHead    = 0ull;
+        m_cachedTail    = 0ull;
+
+        m_tail.store(0ull, std::memory_order_relaxed);
+        m_head.store(0ull, std::memory_order_relaxed);
+
+        return RecluseResult_Ok;
+    }
+
+    // Not thread safe, neither the producer nor the consumer may be using the queue.
+    ResultCode release()
+    {
+        if (!m_pSlots)
+        {
+            return RecluseResult_Ok;
+        }
+
+        const U64 tail = m_tail.load(std::memory_order_relaxed);
+        for (U64 head = m_head.load(std::memory_order_relaxed); head != tail; ++head)
+        {
+            reinterpret_cast<T*>(&m_pSlots[head & m_mask])->~T();
+        }
+
+        m_pAllocator->free(reinterpret_cast<UPtr>(m_pSlots));
+        m_pSlots        = nullptr;
+        m_pAllocator    = nullptr;
+        m_mask          = 0ull;
+
+        return RecluseResult_Ok;
+    }
+
+    // Producer only. Returns false if the queue is full.
+    Bool push(const T& value) { return emplace(value); }
+    Bool push(T&& value) { return emplace(std::move(value)); }
+
+    // Consumer only. Returns false if the queue is empty.
+    Bool pop(T& value)
+    {
+        const U64 head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_cachedTail)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+            {
+                return false;
+            }
+        }
+
+        T* pValue   = reinterpret_cast<T*>(&m_pSlots[head & m_mask]);
+        value       = std::move(*pValue);
+        pValue->~T();
+
+        m_head.store(head + 1ull, std::memory_order_release);
+        return true;
+    }
+
+    U32 getCapacity() const { return static_cast<U32>(m_mask + 1ull); }
+
+private:
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+    template<typename Type>
+    Bool emplace(Type&& value)
+    {
+        const U64 tail = m_tail.load(std::memory_order_relaxed);
+
+        if ((tail - m_cachedHead) > m_mask)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if ((tail - m_cachedHead) > m_mask)
+            {
+                return false;
+            }
+        }
+
+        new (&m_pSlots[tail & m_mask]) T(std::forward<Type>(value));
+        m_tail.store(tail + 1ull, std::memory_order_release);
+        return true;
+    }
+
+    U8                  m_pad0[kCacheLineSizeBytes];
+    Allocator*          m_pAllocator;
+    Slot*               m_pSlots;
+    U64                 m_mask;
+    U8                  m_pad1[kCacheLineSizeBytes - sizeof(Allocator*) - sizeof(Slot*) - sizeof(U64)];
+    // Producer cache line.
+    std::atomic<U64>    m_tail;
+    U64                 m_cachedHead;
+    U8                  m_pad2[kCacheLineSizeBytes - sizeof(U64) * 2];
+    // Consumer cache line.
+    std::atomic<U64>    m_head;
+    U64                 m_cachedTail;
+    U8                  m_pad3[kCacheLineSizeBytes - sizeof(U64) * 2];
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+};
+
+
+// Link for the intrusive MPSC queue. Types pushed onto an MPSCQueue need to inherit from this.
+struct MPSCQueueNode
+{
+    std::atomic<MPSCQueueNode*> pNext;
+};
+
+
+// Unbounded multi producer, single consumer intrusive queue. Based on Dmitry Vyukov's
+// intrusive MPSC queue. Pushing is a single atomic exchange, and never blocks. Since the nodes
+// are owned by the caller, the queue does not need an allocator. Popping may return null
+// for a moment while a producer is in the middle of a push, even if the queue is not empty.
+template<typename T>
+class MPSCQueue
+{
+public:
+    MPSCQueue()
+        : m_pTail(&m_stub)
+    {
+        m_stub.pNext.store(nullptr, std::memory_order_relaxed);
+        m_pHead.store(&m_stub, std::memory_order_relaxed);
+    }
+
+    // Any thread.
+    void push(T* pValue)
+    {
+        R_ASSERT(pValue != nullptr);
+        pushNode(static_cast<MPSCQueueNode*>(pValue));
+    }
+
+    // Consumer only. Returns null if there is nothing to pop.
+    T* pop()
+    {
+        MPSCQueueNode* pTail = m_pTail;
+        MPSCQueueNode* pNext = pTail->pNext.load(std::memory_order_acquire);
+
+        if (pTail == &m_stub)
+        {
+            if (!pNext)
+            {
+                return nullptr;
+            }
+            m_pTail = pNext;
+            pTail   = pNext;
+            pNext   = pNext->pNext.load(std::memory_order_acquire);
+        }
+
+        if (pNext)
+        {
+            m_pTail = pNext;
+            return static_cast<T*>(pTail);
+        }
+
+        // A producer has exchanged the head, but has not linked its node yet.
+        if (pTail != m_pHead.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        // Last node in the queue, push the stub behind it so we can hand it out.
+        pushNode(&m_stub);
+
+        pNext = pTail->pNext.load(std::memory_order_acquire);
+        if (pNext)
+        {
+            m_pTail = pNext;
+            return static_cast<T*>(pTail);
+        }
+
+        return nullptr;
+    }
+
+    // Consumer only.
+    Bool isEmpty() const
+    {
+        return (m_pTail == &m_stub) && !m_stub.pNext.load(std::memory_order_acquire);
+    }
+
+private:
+    void pushNode(MPSCQueueNode* pNode)
+    {
+        pNode->pNext.store(nullptr, std::memory_order_relaxed);
+        MPSCQueueNode* pPrev = m_pHead.exchange(pNode, std::memory_order_acq_rel);
+        pPrev->pNext.store(pNode, std::memory_order_release);
+    }
+
+    U8                          m_pad0[kCacheLineSizeBytes];
+    // Producer cache line.
+    std::atomic<MPSCQueueNode*> m_pHead;
+    U8                          m_pad1[kCacheLineSizeBytes - sizeof(MPSCQueueNode*)];
+    // Consumer cache line.
+    MPSCQueueNode*              m_pTail;
+    MPSCQueueNode               m_stub;
+    U8                          m_pad2[kCacheLineSizeBytes - sizeof(MPSCQueueNode*) * 2];
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+};
+} // Recluse
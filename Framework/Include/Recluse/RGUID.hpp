@@ -4,7 +4,7 @@
 #include "Recluse/Arch.hpp"
 #include "Recluse/Types.hpp"
 
-#include <xhash>
+#include <functional>
 
 namespace Recluse {
 
@@ -53,10 +53,11 @@ struct RGUID
     // hashing for storage.
     struct Hash
     {
-        bool operator()(const RGUID& rguid) const
+        size_t operator()(const RGUID& rguid) const
         {
-            return std::hash<U64>()(rguid.version.major)
-                    ^ std::hash<U64>()(rguid.version.minor);
+            size_t hash = std::hash<U64>()(rguid.version.major);
+            hash ^= std::hash<U64>()(rguid.version.minor) + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+            return hash;
         }
     };
 
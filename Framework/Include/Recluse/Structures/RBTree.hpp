@@ -72,12 +72,21 @@ public:
     typedef RBNode&         RBNodeReference;
     typedef const RBNode&   ConstantRBNodeReference;
 
-    RBTree(const _Allocator& alloc = _Allocator()) 
+    RBTree() 
         : m_root(nullptr)
         , m_numNodes(0)
         , m_compare(Comparer())
         , m_equal(TypeEqual())
-        , m_alloc(alloc) { } 
+        , m_pAlloc(&m_defaultAlloc) { } 
+
+    // Nodes are allocated from alloc, which must outlive the tree. Allocators own their
+    // bookkeeping, so they are referenced, never copied.
+    explicit RBTree(_Allocator& alloc) 
+        : m_root(nullptr)
+        , m_numNodes(0)
+        , m_compare(Comparer())
+        , m_equal(TypeEqual())
+        , m_pAlloc(&alloc) { } 
 
     // Insert data to the tree.
     void                    insert(ConstantTypeReference data);
@@ -137,7 +146,8 @@ private:
     RBNodePointer           makeNode(ConstantTypeReference data);
     void                    freeNode(RBNodePointer remNode);
 
-    _Allocator              m_alloc;
+    _Allocator              m_defaultAlloc;
+    _Allocator*             m_pAlloc;
     MemoryArena             m_arena;
     
     Comparer                m_compare;
@@ -168,7 +178,7 @@ Internal::RBDirection RBTree<Type, Comparer, TypeEqual, _Allocator>::childDirect
 template<typename Type, typename Comparer, typename TypeEqual, typename _Allocator>
 typename RBTree<Type, Comparer, typename TypeEqual, _Allocator>::RBNode* RBTree<Type, Comparer, TypeEqual, _Allocator>::makeNode(ConstantTypeReference data)
 {
-    RBNodePointer newNode = (RBNodePointer)m_alloc.allocate(sizeof(struct RBNode), pointerSizeBytes());
+    RBNodePointer newNode = (RBNodePointer)m_pAlloc->allocate(sizeof(struct RBNode), pointerSizeBytes());
     newNode->color                                  = Internal::RBColor_Red;
     newNode->parent                                 = nullptr;
     newNode->children[Internal::RBDirection_Left]   = nullptr;
@@ -181,7 +191,7 @@ typename RBTree<Type, Comparer, typename TypeEqual, _Allocator>::RBNode* RBTree<
 template<typename Type, typename Comparer, typename TypeEqual, typename _Allocator>
 void RBTree<Type, Comparer, TypeEqual, _Allocator>::freeNode(RBNodePointer remNode)
 {
-    m_alloc.free((UPtr)remNode);
+    m_pAlloc->free((UPtr)remNode);
 }
 
 template<typename Type, typename Comparer, typename TypeEqual, typename _Allocator>
@@ -0,0 +1,84 @@
+//
+#pragma once
+
+#include "Recluse/Arch.hpp"
+#include "Recluse/Types.hpp"
+
+#include <vector>
+
+namespace Recluse {
+namespace Process {
+
+
+// Set of logical processors, bit N refers to logical processor N. Same as the mask taken by
+// setThreadAffinity(), so only the first 64 logical processors can be addressed.
+typedef U64 ProcessorMask;
+
+static constexpr U32 kInvalidCacheIndex = ~0u;
+
+
+struct CpuCacheInfo
+{
+    U32             level;
+    U64             sizeBytes;
+    U32             lineSizeBytes;
+    // Logical processors sharing this cache.
+    ProcessorMask   processorMask;
+};
+
+
+struct CpuCoreInfo
+{
+    // Logical processors on this physical core. More than one bit set means SMT siblings.
+    ProcessorMask   processorMask;
+    U32             packageId;
+    U32             numaNode;
+    // Index into CpuTopology::caches for the L2 and L3 of this core, or kInvalidCacheIndex.
+    U32             l2CacheIndex;
+    U32             l3CacheIndex;
+};
+
+
+// Layout of the processors this process is allowed to run on. Processors outside of the
+// process affinity are left out, so every mask here is safe to pin threads to.
+struct CpuTopology
+{
+    // Sorted by package, then by the lowest logical processor on each core.
+    std::vector<CpuCoreInfo>    cores;
+    // Unified and data caches, L2 and up.
+    std::vector<CpuCacheInfo>   caches;
+    U32                         numPackages;
+    U32                         numNumaNodes;
+    U32                         numLogicalProcessors;
+
+    // One logical processor from each physical core. Useful for spreading threads out,
+    // without doubling up on SMT siblings.
+    ProcessorMask getPrimaryProcessorMask() const
+    {
+        ProcessorMask mask = 0ull;
+        for (U32 i = 0; i < cores.size(); ++i)
+        {
+            mask |= (cores[i].processorMask & (~cores[i].processorMask + 1ull));
+        }
+        return mask;
+    }
+
+    ProcessorMask getNumaNodeMask(U32 numaNode) const
+    {
+        ProcessorMask mask = 0ull;
+        for (U32 i = 0; i < cores.size(); ++i)
+        {
+            if (cores[i].numaNode == numaNode)
+            {
+                mask |= cores[i].processorMask;
+            }
+        }
+        return mask;
+    }
+};
+
+
+// Query the physical cores, SMT siblings, shared caches and NUMA nodes of the machine.
+R_PUBLIC_API R_OS_CALL ResultCode queryCpuTopology(CpuTopology& topology);
+} // Process
+} // Recluse
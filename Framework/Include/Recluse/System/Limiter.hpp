@@ -3,25 +3,30 @@
 
 #include "Recluse/Types.hpp"
 #include "Recluse/Time.hpp"
+#include "Recluse/Threading/Threading.hpp"
 #include <cmath>
 
 
 namespace Recluse {
 
-// limiter limits cpu performance in milliseconds.
-// This is useful if you want to limit the thread. 
-// Keep in mind that this is cpu based, which spinlocks until reaching the desired Ms.
+// limiter limits cpu performance in seconds.
+// This is useful if you want to limit the thread.
+// The thread sleeps for most of the desired time, and only spinlocks for the last
+// kSpinThresholdS, since waking up from a sleep is not exact.
 // Passing 0 as your desired, will essentially mean that you have no
 // desired speed. This will just pass the current delta.
 class Limiter
 {
 public:
+    // Spin for the last millisecond, which covers the wake up latency of most schedulers.
+    static constexpr F32 kSpinThresholdS = 0.001f;
+
     static F32 limit(F32 desiredMs, U32 clockId, U32 watchType)
     {
         F32 counterMs = 0.f;
 
         // If we request 0 or less, we just return the current delta.
-        if (desiredMs <= 0.f || isinf(desiredMs))
+        if (desiredMs <= 0.f || std::isinf(desiredMs))
         {
             return RealtimeTick::getTick(watchType).delta();
         }
@@ -32,8 +37,72 @@ public:
             RealtimeTick tick = RealtimeTick::getTick(watchType);
             F32 deltaMs = tick.delta();
             counterMs += deltaMs;
+
+            const F32 remainingS = desiredMs - counterMs;
+            if (remainingS > kSpinThresholdS)
+            {
+                sleepPrecise(static_cast<U64>((remainingS - kSpinThresholdS) * 1e9f));
+            }
         }
         return counterMs;
     }
 };
-} // Recluse
\ No newline at end of file
+
+
+struct FramePacerStats
+{
+    U64     numFrames;
+    F32     averageFrameTimeS;
+    F32     minFrameTimeS;
+    F32     maxFrameTimeS;
+    // Standard deviation of the frame times.
+    F32     frameTimeStdDevS;
+    // Average, and worst, difference between the frame times and the target.
+    F32     averageJitterS;
+    F32     maxJitterS;
+    // How late the thread wakes up from sleeping, on average.
+    F32     averageOversleepS;
+    // Current spin window at the end of each frame.
+    F32     spinThresholdS;
+};
+
+
+// Frame pacer, which holds a thread to a target frame time. Sleeps for the bulk of each frame,
+// then spins for the rest. The spin window adapts to how late the OS has been waking the thread
+// up, so it stays small on schedulers with tight wake ups. Frames that run over their deadline
+// shorten the next frame, so the average frame rate holds.
+class R_PUBLIC_API FramePacer
+{
+public:
+    FramePacer();
+
+    // Wait until the target frame time has passed since the last call to pace(). Returns the
+    // time of the frame that just ended, in seconds. The first call starts timing, and returns
+    // immediately. A target of 0 or less does not wait.
+    F32 pace(F32 targetFrameTimeS);
+
+    // Start timing over from the next call to pace(). Useful after a pause, so the pacer does
+    // not try to make up for it.
+    void reset();
+
+    void resetStats();
+
+    const FramePacerStats& getStats() const { return m_stats; }
+
+private:
+    void recordFrame(F32 frameTimeS, F32 targetFrameTimeS);
+    void recordOversleep(F32 oversleepS);
+
+    RealtimeStopWatch   m_frameStart;
+    Bool                m_isTiming;
+    // Time the last frame ran over its deadline, taken off of the next frame.
+    F32                 m_debtS;
+    F32                 m_spinThresholdS;
+    F32                 m_oversleepMeanS;
+    F32                 m_oversleepVarianceS;
+    F64                 m_frameTimeMeanS;
+    F64                 m_frameTimeM2;
+    F64                 m_jitterSumS;
+    FramePacerStats     m_stats;
+};
+} // Recluse
@@ -29,6 +29,14 @@ struct CpuInfo
 };
 
 
-R_OS_CALL ResultCode queryCpuInfo(CpuInfo& cpuInfo);
+R_PUBLIC_API R_OS_CALL ResultCode queryCpuInfo(CpuInfo& cpuInfo);
+
+// CPU time spent by the calling thread so far, user and kernel combined, in seconds.
+// Compare against wall time to see how busy a thread is keeping its core.
+R_PUBLIC_API R_OS_CALL F64 getThreadCpuTimeS();
+
+// Return addresses on the calling thread's stack, innermost first, past the first framesToSkip
+// callers. Returns how many were filled in.
+R_PUBLIC_API R_OS_CALL U32 captureStackTrace(void** ppFrames, U32 maxFrames, U32 framesToSkip = 0u);
 } // Process
 } // Recluse
\ No newline at end of file
@@ -0,0 +1,248 @@
+//
+#pragma once
+
+#include "Recluse/Arch.hpp"
+#include "Recluse/Types.hpp"
+#include "Recluse/Memory/MemoryCommon.hpp"
+
+#include <atomic>
+
+#if defined(RECLUSE_WINDOWS)
+#include <intrin.h>
+#endif
+
+namespace Recluse {
+
+
+// Memory ordering of an atomic operation. Relaxed only makes the operation itself atomic.
+// Acquire keeps later reads and writes from moving before a load, while release keeps earlier
+// ones from moving after a store. Sequentially consistent operations also see one total order
+// across all threads.
+enum MemoryOrder
+{
+    MemoryOrder_Relaxed,
+    MemoryOrder_Acquire,
+    MemoryOrder_Release,
+    MemoryOrder_AcquireRelease,
+    MemoryOrder_SequentiallyConsistent
+};
+
+
+namespace AtomicInternal {
+
+
+static R_FORCE_INLINE std::memory_order toStdOrder(MemoryOrder order)
+{
+    switch (order)
+    {
+        case MemoryOrder_Relaxed:           return std::memory_order_relaxed;
+        case MemoryOrder_Acquire:           return std::memory_order_acquire;
+        case MemoryOrder_Release:           return std::memory_order_release;
+        case MemoryOrder_AcquireRelease:    return std::memory_order_acq_rel;
+        default:                            return std::memory_order_seq_cst;
+    }
+}
+
+
+// A failed compare exchange only loads, so it can not have release semantics.
+static R_FORCE_INLINE std::memory_order toFailureOrder(MemoryOrder order)
+{
+    switch (order)
+    {
+        case MemoryOrder_Release:           return std::memory_order_relaxed;
+        case MemoryOrder_AcquireRelease:    return std::memory_order_acquire;
+        default:                            return toStdOrder(order);
+    }
+}
+} // AtomicInternal
+
+
+// Orders memory operations around the fence, without touching any particular atomic.
+static R_FORCE_INLINE void atomicThreadFence(MemoryOrder order)
+{
+    std::atomic_thread_fence(AtomicInternal::toStdOrder(order));
+}
+
+
+// Atomic value, with explicit memory ordering on each operation. Operations default to
+// sequentially consistent, so only pass a weaker order when you know it is enough.
+template<typename T>
+class Atomic
+{
+public:
+    constexpr Atomic()
+        : m_value(T()) { }
+
+    constexpr Atomic(T value)
+        : m_value(value) { }
+
+    T load(MemoryOrder order = MemoryOrder_SequentiallyConsistent) const
+    {
+        return m_value.load(AtomicInternal::toStdOrder(order));
+    }
+
+    void store(T value, MemoryOrder order = MemoryOrder_SequentiallyConsistent)
+    {
+        m_value.store(value, AtomicInternal::toStdOrder(order));
+    }
+
+    T exchange(T value, MemoryOrder order = MemoryOrder_SequentiallyConsistent)
+    {
+        return m_value.exchange(value, AtomicInternal::toStdOrder(order));
+    }
+
+    // Sets the value to desired, only if it is equal to expected. On failure, returns false and
+    // expected is updated to the current value.
+    Bool compareExchange(T& expected, T desired, MemoryOrder order = MemoryOrder_SequentiallyConsistent)
+    {
+        return m_value.compare_exchange_strong(expected, desired, AtomicInternal::toStdOrder(order), AtomicInternal::toFailureOrder(order));
+    }
+
+    // Same as compareExchange(), but may fail even if the value is equal to expected. Cheaper
+    // on some architectures, when already retrying in a loop.
+    Bool compareExchangeWeak(T& expected, T desired, MemoryOrder order = MemoryOrder_SequentiallyConsistent)
+    {
+        return m_value.compare_exchange_weak(expected, desired, AtomicInternal::toStdOrder(order), AtomicInternal::toFailureOrder(order));
+    }
+
+    // Integer operations. Each returns the value from before the operation.
+    T fetchAdd(T value, MemoryOrder order = MemoryOrder_SequentiallyConsistent) { return m_value.fetch_add(value, AtomicInternal::toStdOrder(order)); }
+    T fetchSub(T value, MemoryOrder order = MemoryOrder_SequentiallyConsistent) { return m_value.fetch_sub(value, AtomicInternal::toStdOrder(order)); }
+    T fetchAnd(T value, MemoryOrder order = MemoryOrder_SequentiallyConsistent) { return m_value.fetch_and(value, AtomicInternal::toStdOrder(order)); }
+    T fetchOr(T value, MemoryOrder order = MemoryOrder_SequentiallyConsistent) { return m_value.fetch_or(value, AtomicInternal::toStdOrder(order)); }
+    T fetchXor(T value, MemoryOrder order = MemoryOrder_SequentiallyConsistent) { return m_value.fetch_xor(value, AtomicInternal::toStdOrder(order)); }
+
+    Bool isLockFree() const { return m_value.is_lock_free(); }
+
+private:
+    std::atomic<T> m_value;
+
+    Atomic(const Atomic&) = delete;
+    Atomic& operator=(const Atomic&) = delete;
+};
+
+
+// Atomic on its own cache line. Use for values written by many threads, so writes to them do
+// not keep invalidating the data next to them. Heap allocations need to respect the alignment,
+// which plain new does not guarantee before C++17.
+template<typename T>
+class alignas(kCacheLineSizeBytes) PaddedAtomic : public Atomic<T>
+{
+public:
+    constexpr PaddedAtomic() { }
+    constexpr PaddedAtomic(T value)
+        : Atomic<T>(value) { }
+};
+
+
+// Compare exchange of 128 bits, dest must be aligned to 16 bytes. Sets dest to desired, only
+// if it is equal to expected. On failure, returns false and expected is updated to the current
+// value. Sequentially consistent.
+static R_FORCE_INLINE Bool compareExchange128(U128* dest, U128& expected, const U128& desired)
+{
+#if defined(RECLUSE_WINDOWS)
+    return _InterlockedCompareExchange128
+        (
+            reinterpret_cast<volatile __int64*>(dest),
+            static_cast<__int64>(desired.m1),
+            static_cast<__int64>(desired.m0),
+            reinterpret_cast<__int64*>(&expected)
+        ) != 0;
+#elif defined(__x86_64__)
+    // GCC routes 16 byte atomics through libatomic, which may take a lock. Use cmpxchg16b
+    // directly instead.
+    Bool result;
+    __asm__ __volatile__
+        (
+            "lock cmpxchg16b %1\n\t"
+            "sete %0"
+            : "=q" (result), "+m" (*dest), "+a" (expected.m0), "+d" (expected.m1)
+            : "b" (desired.m0), "c" (desired.m1)
+            : "cc", "memory"
+        );
+    return result;
+#else
+    unsigned __int128 expectedValue     = (static_cast<unsigned __int128>(expected.m1) << 64) | expected.m0;
+    unsigned __int128 desiredValue      = (static_cast<unsigned __int128>(desired.m1) << 64) | desired.m0;
+    const Bool result                   = __atomic_compare_exchange_n
+                                            (
+                                                reinterpret_cast<unsigned __int128*>(dest),
+                                                &expectedValue,
+                                                desiredValue,
+                                                false,
+                                                __ATOMIC_SEQ_CST,
+                                                __ATOMIC_SEQ_CST
+                                            );
+    expected.m0 = static_cast<U64>(expectedValue);
+    expected.m1 = static_cast<U64>(expectedValue >> 64);
+    return result;
+#endif
+}
+
+
+// Pointer along with a tag, that are swapped together.
+template<typename T>
+struct TaggedPointer
+{
+    T*  pointer;
+    U64 tag;
+};
+
+
+// Atomic pointer and tag pair, swapped together with a 128 bit compare exchange. Bumping the
+// tag on every swap keeps lock free lists safe from the ABA problem, where a node is popped and
+// pushed back while another thread still holds the old head.
+template<typename T>
+class alignas(16) AtomicTaggedPointer
+{
+public:
+    AtomicTaggedPointer(T* pointer = nullptr, U64 tag = 0ull)
+    {
+        m_value.m0 = reinterpret_cast<U64>(pointer);
+        m_value.m1 = tag;
+    }
+
+    // Loads with a compare exchange, so both halves are read together. This writes to the
+    // cache line, so avoid it in read heavy code.
+    TaggedPointer<T> load() const
+    {
+        U128 value = { 0ull, 0ull };
+        compareExchange128(&m_value, value, value);
+        return fromU128(value);
+    }
+
+    void store(const TaggedPointer<T>& desired)
+    {
+        TaggedPointer<T> expected = load();
+        while (!compareExchange(expected, desired)) { }
+    }
+
+    // Sets the pointer and tag only if both are equal to expected. On failure, returns false and
+    // expected is updated to the current value.
+    Bool compareExchange(TaggedPointer<T>& expected, const TaggedPointer<T>& desired)
+    {
+        U128 expectedValue      = toU128(expected);
+        const Bool result       = compareExchange128(&m_value, expectedValue, toU128(desired));
+        expected                = fromU128(expectedValue);
+        return result;
+    }
+
+private:
+    static U128 toU128(const TaggedPointer<T>& value)
+    {
+        U128 result = { reinterpret_cast<U64>(value.pointer), value.tag };
+        return result;
+    }
+
+    static TaggedPointer<T> fromU128(const U128& value)
+    {
+        TaggedPointer<T> result = { reinterpret_cast<T*>(value.m0), value.m1 };
+        return result;
+    }
+
+    mutable U128 m_value;
+
+    AtomicTaggedPointer(const AtomicTaggedPointer&) = delete;
+    AtomicTaggedPointer& operator=(const AtomicTaggedPointer&) = delete;
+};
+} // Recluse
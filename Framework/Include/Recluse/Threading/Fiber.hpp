@@ -0,0 +1,35 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+
+namespace Recluse {
+
+// Fiber function, used as the entry point of a fiber. Fibers must never return from
+// this function, they need to switch to another fiber instead.
+typedef void(*FiberFunction)(void*);
+
+typedef void* Fiber;
+
+// Default stack size of fibers. Jobs running on fibers should keep their stack usage small.
+static constexpr SizeT kDefaultFiberStackSizeBytes = 64ull * 1024ull;
+
+// Converts the calling thread into a fiber, so that it may switch to other fibers. Returns 
+// the fiber that represents the thread.
+R_PUBLIC_API R_OS_CALL Fiber       convertThreadToFiber();
+
+// Converts the calling thread back into a regular thread. Must be called on the thread 
+// that was converted.
+R_PUBLIC_API R_OS_CALL ResultCode  convertFiberToThread(Fiber threadFiber);
+
+// Creates a fiber with its own stack, which will start executing func with pData the first 
+// time it is switched to.
+R_PUBLIC_API R_OS_CALL Fiber       createFiber(FiberFunction func, void* pData, SizeT stackSizeBytes = kDefaultFiberStackSizeBytes);
+
+// Destroys a fiber. Must not be the currently running fiber.
+R_PUBLIC_API R_OS_CALL ResultCode  destroyFiber(Fiber fiber);
+
+// Saves the current fiber, and continues executing the given fiber. Must be called from 
+// a fiber.
+R_PUBLIC_API R_OS_CALL void        switchToFiber(Fiber fiber);
+} // Recluse
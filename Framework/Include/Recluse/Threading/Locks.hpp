@@ -0,0 +1,281 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+#include "Recluse/Threading/Threading.hpp"
+
+#include <string.h>
+#include <type_traits>
+
+namespace Recluse {
+
+
+// Spin lock with exponential backoff. Only meant for locks held for a handful of instructions,
+// since waiters never sleep. Spinning on a plain load, instead of retrying the exchange, keeps
+// the cache line shared between waiters until the lock is actually released.
+class SpinLock
+{
+public:
+    // Most pause instructions to spin for between checks, before yielding the thread instead.
+    static constexpr U32 kMaxBackoff = 64u;
+
+    constexpr SpinLock()
+        : m_locked(0u) { }
+
+    Bool tryLock()
+    {
+        return (m_locked.load(MemoryOrder_Relaxed) == 0u) && (m_locked.exchange(1u, MemoryOrder_Acquire) == 0u);
+    }
+
+    void lock()
+    {
+        U32 backoff = 1u;
+        while (m_locked.exchange(1u, MemoryOrder_Acquire) != 0u)
+        {
+            while (m_locked.load(MemoryOrder_Relaxed) != 0u)
+            {
+                if (backoff <= kMaxBackoff)
+                {
+                    for (U32 i = 0; i < backoff; ++i)
+                    {
+                        yieldProcessor();
+                    }
+                    backoff <<= 1u;
+                }
+                else
+                {
+                    // The holder may have been preempted, let it run.
+                    yieldThread();
+                }
+            }
+        }
+    }
+
+    void unlock()
+    {
+        m_locked.store(0u, MemoryOrder_Release);
+    }
+
+private:
+    Atomic<U32> m_locked;
+
+    SpinLock(const SpinLock&) = delete;
+    SpinLock& operator=(const SpinLock&) = delete;
+};
+
+
+// Reader-writer lock. Any number of readers may hold the lock at once, and readers never block
+// each other. Writers get exclusive access, and are preferred: once a writer is waiting, new
+// readers wait behind it, so a steady stream of readers can not starve writers. Waiters spin
+// briefly, then sleep on the lock state with waitOnAddress(). Not recursive.
+class RWLock
+{
+public:
+    constexpr RWLock()
+        : m_state(0u)
+        , m_numWaitingWriters(0u)
+        , m_writerWakeCount(0u) { }
+
+    Bool tryLockShared()
+    {
+        U32 state = m_state.load(MemoryOrder_Relaxed);
+        return !(state & (kWriterLocked | kWriterWaiting)) && m_state.compareExchange(state, state + 1u, MemoryOrder_Acquire);
+    }
+
+    void lockShared()
+    {
+        if (!tryLockShared())
+        {
+            lockSharedSlow();
+        }
+    }
+
+    void unlockShared()
+    {
+        const U32 state = m_state.fetchSub(1u, MemoryOrder_Release);
+        // The last reader out lets a waiting writer in.
+        if (((state & kReaderMask) == 1u) && (state & kWriterWaiting))
+        {
+            wakeWriter();
+        }
+    }
+
+    Bool tryLock()
+    {
+        U32 state = m_state.load(MemoryOrder_Relaxed);
+        return !(state & (kWriterLocked | kReaderMask)) && m_state.compareExchange(state, state | kWriterLocked, MemoryOrder_Acquire);
+    }
+
+    void lock()
+    {
+        if (!tryLock())
+        {
+            lockSlow();
+        }
+    }
+
+    R_PUBLIC_API void unlock();
+
+private:
+    static constexpr U32 kWriterLocked      = 1u << 31u;
+    static constexpr U32 kWriterWaiting     = 1u << 30u;
+    static constexpr U32 kReadersSleeping   = 1u << 29u;
+    static constexpr U32 kReaderMask        = kReadersSleeping - 1u;
+
+    R_PUBLIC_API void lockSharedSlow();
+    R_PUBLIC_API void lockSlow();
+    R_PUBLIC_API void wakeWriter();
+
+    // Reader count in the low bits, along with the flags above.
+    Atomic<U32> m_state;
+    Atomic<U32> m_numWaitingWriters;
+    // Bumped every time a writer is woken. Writers sleep on this, so waking them up doesn't
+    // wake up readers too.
+    Atomic<U32> m_writerWakeCount;
+
+    RWLock(const RWLock&) = delete;
+    RWLock& operator=(const RWLock&) = delete;
+};
+
+
+// Sequence lock, for small blocks of plain data that are read far more often than written.
+// Readers never block, and never write to shared memory. They copy the data out, and retry
+// if a writer changed it in the meantime. Writers are serialized with a spin lock, so keep
+// writes short.
+template<typename T>
+class SeqLock
+{
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock data must be trivially copyable.");
+
+    SeqLock()
+    {
+        const T value = T();
+        store(value);
+    }
+
+    explicit SeqLock(const T& value)
+    {
+        store(value);
+    }
+
+    T load() const
+    {
+        U64 words[kNumWords];
+        for (;;)
+        {
+            const U32 sequence = m_sequence.load(MemoryOrder_Acquire);
+            if (sequence & 1u)
+            {
+                // Mid write.
+                yieldProcessor();
+                continue;
+            }
+
+            for (U32 i = 0; i < kNumWords; ++i)
+            {
+                words[i] = m_data[i].load(MemoryOrder_Relaxed);
+            }
+
+            atomicThreadFence(MemoryOrder_Acquire);
+            if (m_sequence.load(MemoryOrder_Relaxed) == sequence)
+            {
+                break;
+            }
+        }
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    void store(const T& value)
+    {
+        U64 words[kNumWords] = { };
+        memcpy(words, &value, sizeof(T));
+
+        m_writeLock.lock();
+        const U32 sequence = m_sequence.load(MemoryOrder_Relaxed);
+        m_sequence.store(sequence + 1u, MemoryOrder_Relaxed);
+        atomicThreadFence(MemoryOrder_Release);
+
+        for (U32 i = 0; i < kNumWords; ++i)
+        {
+            m_data[i].store(words[i], MemoryOrder_Relaxed);
+        }
+
+        m_sequence.store(sequence + 2u, MemoryOrder_Release);
+        m_writeLock.unlock();
+    }
+
+    // Changes every time the data is stored. Useful for checking if the data changed, without
+    // copying it out.
+    U32 getVersion() const { return m_sequence.load(MemoryOrder_Acquire) >> 1u; }
+
+private:
+    static constexpr U32 kNumWords = static_cast<U32>((sizeof(T) + sizeof(U64) - 1) / sizeof(U64));
+
+    Atomic<U32>         m_sequence;
+    SpinLock            m_writeLock;
+    // Stored as atomic words, so readers racing with a writer are still well defined.
+    Atomic<U64>         m_data[kNumWords];
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+};
+
+
+class ScopedSpinLock
+{
+public:
+    ScopedSpinLock(SpinLock& lock)
+        : m_lock(lock)
+    {
+        m_lock.lock();
+    }
+
+    ~ScopedSpinLock()
+    {
+        m_lock.unlock();
+    }
+private:
+    SpinLock& m_lock;
+};
+
+
+class ScopedReadLock
+{
+public:
+    ScopedReadLock(RWLock& lock)
+        : m_lock(lock)
+    {
+        m_lock.lockShared();
+    }
+
+    ~ScopedReadLock()
+    {
+        m_lock.unlockShared();
+    }
+private:
+    RWLock& m_lock;
+};
+
+
+class ScopedWriteLock
+{
+public:
+    ScopedWriteLock(RWLock& lock)
+        : m_lock(lock)
+    {
+        m_lock.lock();
+    }
+
+    ~ScopedWriteLock()
+    {
+        m_lock.unlock();
+    }
+private:
+    RWLock& m_lock;
+};
+} // Recluse
@@ -3,8 +3,9 @@
 
 #include "Recluse/Types.hpp"
 #include "Recluse/Threading/Threading.hpp"
-#include "Recluse/Threading/Sema.hpp"
+#include "Recluse/Threading/Fiber.hpp"
 
+#include <atomic>
 #include <vector>
 
 namespace Recluse {
@@ -12,75 +13,168 @@ namespace Recluse {
 
 typedef ThreadFunction ThreadJob;
 
+// Maximum number of jobs that may be queued on a single thread pool. Submitting past this 
+// will run the job immediately on the calling thread.
+static constexpr U32 kMaxThreadPoolJobs = 4096u;
 
-struct R_PUBLIC_API JobFinishedPayload 
-{
-    ThreadJob   func;
-    SizeT       uid;
-    U32         resultCode;
-};
+// Worker hint for jobs that may run on any worker.
+static constexpr U32 kAnyThreadPoolWorker = ~0u;
 
 
-struct TaskJob
+// Handle to a submitted job. Can be used to wait on, or query, the job from the pool
+// that it was submitted to. A handle with id 0 is invalid.
+struct R_PUBLIC_API JobHandle
 {
-    ThreadJob   jobFunc;
-    void*       pPayload;
+    // Upper 32 bits hold the generation of the job slot, lower 32 bits hold the slot.
+    U64 id;
+
+    Bool isValid() const { return (id != 0ull); }
 };
 
-class ThreadPool 
+
+struct ThreadPoolWorker;
+struct ThreadPoolTaskSlot;
+struct ThreadPoolSharedState;
+struct ThreadPoolFiber;
+
+
+// Counter of unfinished jobs. Jobs submitted with a counter increment it, and decrement it
+// once they finish. Waiting on a counter from a job running on a fiber parks the fiber,
+// freeing the worker to run other jobs, until the counter reaches zero.
+class JobCounter
 {
 public:
-    R_PUBLIC_API ThreadPool(U32 numWorkers = 2);
-    R_PUBLIC_API ~ThreadPool();
+    JobCounter(U32 initialValue = 0u)
+        : m_pWaiters(nullptr)
+    {
+        m_value.store(initialValue, std::memory_order_relaxed);
+        m_lock.store(0u, std::memory_order_relaxed);
+    }
 
-    R_PUBLIC_API ResultCode submitJob(ThreadJob job);
-    
-    R_PUBLIC_API ResultCode waitFinished();
+    U32     getValue() const { return m_value.load(std::memory_order_acquire); }
 
-    R_PUBLIC_API Bool isExecuting();
+    // Add outstanding work to the counter.
+    void    add(U32 count = 1u) { m_value.fetch_add(count, std::memory_order_acq_rel); }
 
-    R_PUBLIC_API Bool isFinished();
-    
 private:
-
-    void threadStartFunc()
+    void lock()
     {
-        while (!m_allWorkersFinished)
+        while (m_lock.exchange(1u, std::memory_order_acquire) != 0u)
         {
-            if (tryLockMutex(m_mutex) == RecluseResult_Ok)
+            while (m_lock.load(std::memory_order_relaxed) != 0u)
             {
-                TaskJob taskJob = m_jobTasks.back();
-                
-                m_jobTasks.pop_back();
-                // Unlock the mutex when we finish.
-                unlockMutex(m_mutex);
-
-                // Run the task with the given payload.
-                taskJob.jobFunc(taskJob.pPayload);
-
-                JobFinishedPayload finished = { };
-                finished.func = taskJob.jobFunc;
-                finished.resultCode = 00;
-
-                while (!tryLockMutex(m_finishedMutex))
-                {
-                    // spin until we get our mutex.
-                }
-
-                m_finishedResults.push_back(finished);
-                unlockMutex(m_finishedMutex);
+                yieldProcessor();
             }
         }
     }
 
-    // Tasks to complete, which are carried by worker threads.
-    std::vector<TaskJob>                m_jobTasks;
-    std::vector<JobFinishedPayload>     m_finishedResults;
+    void unlock() { m_lock.store(0u, std::memory_order_release); }
+
+    std::atomic<U32>    m_value;
+    // Guards the wait list, along with the transition to zero.
+    std::atomic<U32>    m_lock;
+    // Fibers parked on this counter.
+    ThreadPoolFiber*    m_pWaiters;
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
 
+    friend class ThreadPool;
+};
+
+
+// Work stealing thread pool. Each worker owns a Chase-Lev deque that it pushes and pops
+// from the bottom, while idle workers steal from the top of other workers deques. Jobs
+// submitted from threads outside of the pool are distributed to the workers' inboxes.
+// Workers that can not find any work will go to sleep on a semaphore, instead of spinning,
+// until new work is submitted.
+//
+// Optionally, the pool may run jobs on a fixed set of fibers. Jobs running on fibers
+// that wait on a JobCounter will park their fiber, and the worker moves on to other work.
+// The parked fiber is resumed, possibly on another worker, once the counter reaches zero.
+// If all fibers are in use, jobs run directly on the worker thread, where waits fall back
+// to helping execute other jobs.
+class ThreadPool
+{
+public:
+    // Creates the pool and starts up numWorkers threads. A pool with 0 workers will
+    // run submitted jobs immediately on the calling thread. Passing numFibers > 0 enables
+    // fiber mode, with each fiber using the given stack size.
+    R_PUBLIC_API ThreadPool(U32 numWorkers = 2, U32 numFibers = 0, SizeT fiberStackSizeBytes = kDefaultFiberStackSizeBytes);
+    R_PUBLIC_API ~ThreadPool();
+
+    // Submit a job to the pool. Returns a handle that can be waited on. Job func
+    // will be called with the given payload. The worker hint queues the job on the given 
+    // worker (modulo the number of workers), which is useful for keeping related jobs on 
+    // the same cache. Hinted jobs may still be stolen by idle workers. If a counter is 
+    // given, it is incremented now, and decremented once the job finishes.
+    R_PUBLIC_API JobHandle submitJob(ThreadJob job, void* pPayload = nullptr, U32 workerHint = kAnyThreadPoolWorker, JobCounter* pCounter = nullptr);
+
+    // Wait for the given job to finish. The calling thread will help execute
+    // other jobs while it waits.
+    R_PUBLIC_API ResultCode wait(JobHandle handle);
+
+    // Wait for the counter to reach zero. On a pool fiber, the fiber is parked until then. 
+    // Otherwise, the calling thread helps execute jobs while it waits.
+    R_PUBLIC_API ResultCode waitForCounter(JobCounter* pCounter);
+
+    // Decrement the counter, resuming any fibers waiting on it once it reaches zero. Used
+    // for counters that track work other than submitted jobs.
+    R_PUBLIC_API void decrementCounter(JobCounter* pCounter, U32 count = 1u);
+
+    // Check if the job has finished executing.
+    R_PUBLIC_API Bool isDone(JobHandle handle) const;
+
+    // Run one pending job on the calling thread, if there is any. Returns true if a job 
+    // was executed. Useful for threads waiting on other work to finish.
+    R_PUBLIC_API Bool tryExecuteJob();
+
+    // Wait for all submitted jobs to finish. The calling thread helps execute jobs
+    // while waiting.
+    R_PUBLIC_API ResultCode waitFinished();
+
+    // Are there any jobs currently pending or executing?
+    R_PUBLIC_API Bool isExecuting();
+
+    // Have all jobs finished?
+    R_PUBLIC_API Bool isFinished();
+
+    // Pin a worker thread to the given logical processors. Pinning one worker per physical
+    // core keeps workers from fighting over the same core, and keeps their caches warm.
+    R_PUBLIC_API ResultCode setWorkerAffinity(U32 workerIndex, U64 affinityMask);
+
+    R_PUBLIC_API ResultCode setWorkerPriority(U32 workerIndex, ThreadPriority priority);
+
+    U32 getNumWorkers() const { return static_cast<U32>(m_workers.size()); }
+    U32 getNumFibers() const { return static_cast<U32>(m_fibers.size()); }
+    Bool isFiberMode() const { return !m_fibers.empty(); }
+
+private:
+    static U32 workerThreadFunc(void* pData);
+    static void fiberFunc(void* pData);
+
+    void            runWorker(ThreadPoolWorker* pWorker);
+    Bool            executeNextJob(ThreadPoolWorker* pWorker);
+    Bool            popJob(ThreadPoolWorker* pWorker, U32& slotIndex);
+    Bool            hasPendingWork() const;
+    void            executeJob(U32 slotIndex);
+    void            enqueueJob(ThreadPoolWorker* pWorker, U32 slotIndex, U32 workerHint);
+    Bool            acquireSlot(ThreadPoolWorker* pWorker, U32& slotIndex);
+    void            releaseSlot(ThreadPoolWorker* pWorker, U32 slotIndex);
+    void            runFiber(ThreadPoolWorker* pWorker, ThreadPoolFiber* pFiber);
+    void            finishFiberSwitch(ThreadPoolWorker* pWorker);
+    void            switchToScheduler(ThreadPoolFiber* pFiber, U32 action, JobCounter* pCounter);
+    ThreadPoolFiber* acquireFiber();
+    void            pushReadyFiber(ThreadPoolFiber* pFiber);
+    ThreadPoolFiber* popReadyFiber();
+    void            wakeWorker();
+    void            backoff(U32& spinCount);
+
+    std::vector<ThreadPoolWorker*>      m_workers;
     std::vector<Thread>                 m_threadWorkers;
-    std::vector<Thread>                 m_finishedThreads;
-    Bool                                m_allWorkersFinished;
-    Mutex                               m_mutex;
-    Mutex                               m_finishedMutex;
+    std::vector<ThreadPoolFiber*>       m_fibers;
+    ThreadPoolTaskSlot*                 m_pTaskSlots;
+    ThreadPoolSharedState*              m_pShared;
+    Semaphore                           m_wakeSemaphore;
 };
-} // Recluse
\ No newline at end of file
+} // Recluse
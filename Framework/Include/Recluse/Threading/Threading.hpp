@@ -17,6 +17,18 @@ enum ThreadResultCode
 };
 
 
+enum ThreadPriority
+{
+    ThreadPriority_Lowest,
+    ThreadPriority_Low,
+    ThreadPriority_Normal,
+    ThreadPriority_High,
+    ThreadPriority_Highest,
+    // Preempts nearly everything else on the core, keep the work on these threads short.
+    ThreadPriority_TimeCritical
+};
+
+
 enum ThreadState 
 {
     ThreadState_NotRunning,
@@ -59,6 +71,22 @@ R_PUBLIC_API R_OS_CALL ResultCode detachThread(Thread* thread);
 R_PUBLIC_API R_OS_CALL ResultCode joinThread(Thread* thread);
 R_PUBLIC_API R_OS_CALL ResultCode killThread(Thread* thread);
 
+// Restrict the thread to run on the given logical processors. Bit N of the mask refers to 
+// logical processor N.
+R_PUBLIC_API R_OS_CALL ResultCode setThreadAffinity(Thread* thread, U64 affinityMask);
+
+// Same as setThreadAffinity(), for the calling thread. Handy for threads the engine did not 
+// create, like the main thread.
+R_PUBLIC_API R_OS_CALL ResultCode setCurrentThreadAffinity(U64 affinityMask);
+
+// Raising the priority above normal may need extra privileges on some platforms, in which case
+// this fails and the priority is left alone.
+R_PUBLIC_API R_OS_CALL ResultCode setThreadPriority(Thread* thread, ThreadPriority priority);
+
+// Logical processor the calling thread is running on right now. Only a hint, since the thread
+// may be moved at any time, unless it was pinned.
+R_PUBLIC_API R_OS_CALL U32 getCurrentProcessorNumber();
+
 R_PUBLIC_API R_OS_CALL Mutex   createMutex(const char* name = nullptr);
 R_PUBLIC_API R_OS_CALL ResultCode lockMutex(Mutex mutex, U64 waitMs = kInfiniteMs);
 R_PUBLIC_API R_OS_CALL ResultCode unlockMutex(Mutex mutex);
@@ -66,8 +94,6 @@ R_PUBLIC_API R_OS_CALL ResultCode waitMutex(Mutex mutex, U64 waitTimeMs);
 R_PUBLIC_API R_OS_CALL ResultCode destroyMutex(Mutex mutex);
 R_PUBLIC_API R_OS_CALL ResultCode tryLockMutex(Mutex mutex);
 
-R_PUBLIC_API R_OS_CALL ResultCode atomicAdd();
-R_PUBLIC_API R_OS_CALL ResultCode atomicSub();
 R_PUBLIC_API R_OS_CALL U64     getMainThreadId();
 R_PUBLIC_API R_OS_CALL U64     getCurrentThreadId();
 
@@ -78,6 +104,7 @@ R_PUBLIC_API R_OS_CALL ResultCode    waitSemaphore(Semaphore sema);
 
 R_PUBLIC_API R_OS_CALL U64    compareExchange(I64* dest, I64 ex, I64 comp);
 R_PUBLIC_API R_OS_CALL I16    compareExchange(I16* dest, I16 ex, I16 comp);
+// dest must be aligned to 16 bytes. See Atomic.hpp for typed atomics.
 R_PUBLIC_API R_OS_CALL U128   compareExchange(U128* dest, U128 ex, U128 comp);
 
 R_PUBLIC_API R_OS_CALL Bool testAndSet(U32* ptr, U32 offset);
@@ -85,12 +112,30 @@ R_PUBLIC_API R_OS_CALL Bool testAndSet(U32* ptr, U32 offset);
 // Causes this thread to sleep for some milliseconds.
 R_PUBLIC_API R_OS_CALL ResultCode    sleep(U64 milliseconds);
 
+// Causes this thread to sleep for some nanoseconds, using the highest resolution timer the
+// OS provides. The thread may still wake up late, by however long the scheduler takes.
+R_PUBLIC_API R_OS_CALL ResultCode    sleepPrecise(U64 nanoseconds);
+
+// Hint to the processor that the calling thread is in a spin-wait loop.
+R_PUBLIC_API R_OS_CALL void          yieldProcessor();
+
+// Yield the remainder of this thread's time slice to another ready thread.
+R_PUBLIC_API R_OS_CALL void          yieldThread();
+
+// Sleep while the 32 bit value at pAddress still equals expected, until another thread calls
+// wakeByAddress() on it. May return spuriously, so always check the value again after. Used 
+// for building locks that only enter the kernel when they need to sleep.
+R_PUBLIC_API R_OS_CALL void          waitOnAddress(const volatile void* pAddress, U32 expected);
+
+// Wake one, or all, threads sleeping in waitOnAddress() on the given address.
+R_PUBLIC_API R_OS_CALL void          wakeByAddress(const volatile void* pAddress, Bool wakeAll);
+
 // C++ RAII locking mechanism within a scope.
 // Intended for scope locking mutexes.
 class R_PUBLIC_API ScopedLock 
 {
 public:
-    volatile ScopedLock(Mutex mutex) 
+    ScopedLock(Mutex mutex) 
         : m_mut(mutex)
     {
         lockMutex(m_mut); 
@@ -49,7 +49,7 @@ protected:
 
 
 // Stopwatch for just querying the time now, and doesn't worry about anything else.
-class RealtimeStopWatch
+class R_PUBLIC_API RealtimeStopWatch
 {
 public:
     R_OS_CALL RealtimeStopWatch();
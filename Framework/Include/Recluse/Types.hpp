@@ -45,7 +45,6 @@ typedef B64                 Bool64;
 // Error type to use for error checking.
 typedef U32                 ResultCode;
 
-#if defined(RECLUSE_WINDOWS)
 #if defined(RECLUSE_64BIT)
 typedef U64 UPtr;
 typedef U64 SizeT;
@@ -53,7 +52,6 @@ typedef U64 SizeT;
 typedef U32 UPtr;
 typedef U32 SizeT;
 #endif
-#endif
 
 // Check the OS architecture bitness size. 
 // This is the size of the supported instruction set.
@@ -1,12 +1,17 @@
 //
 #include "Recluse/Utility.hpp"
-#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Threading/Locks.hpp"
+
+#include <string.h>
 
 
 namespace Recluse {
 namespace GlobalCommands {
 namespace Internal {
-CriticalSectionGuard              g_commandCs = { };
+// Commands are registered during static initialization, and only looked up after that, so
+// lookups take the lock shared. Constant initialized, so it is usable from any static
+// constructor.
+RWLock                            g_commandLock;
 std::map<std::string, DataListener*> g_commandMap;
 
 DataListener::DataListener(const std::string& command, void* globalVariable)
@@ -18,17 +23,14 @@ DataListener::DataListener(const std::string& command, void* globalVariable)
 
 void DataListener::storeData(const std::string& command, DataListener* data)
 {
-    if (!g_commandCs.isInitialized())
-    {
-        g_commandCs.initialize();
-    }
-    ScopedCriticalSection _(g_commandCs);
+    ScopedWriteLock _(g_commandLock);
     g_commandMap.insert(std::make_pair(command, data));
 }
 
 
 DataListener* obtainData(const std::string& command)
 {
+    ScopedReadLock _(g_commandLock);
     auto iter = Internal::g_commandMap.find(command);
     if (iter != Internal::g_commandMap.end())
     {
@@ -40,7 +42,8 @@ DataListener* obtainData(const std::string& command)
 
 Bool setData(const std::string& command, const void* value, size_t sizeBytesToWrite)
 {
-    ScopedCriticalSection _(g_commandCs);
+    // Keep other writers out, so two writes to the same variable can not interleave.
+    ScopedWriteLock _(g_commandLock);
     auto iter = Internal::g_commandMap.find(command);
     if (iter != Internal::g_commandMap.end())
     {
@@ -54,7 +57,8 @@ Bool setData(const std::string& command, const void* value, size_t sizeBytesToWr
 
 Bool setDataAsString(const std::string& command, const char* value)
 {
-    ScopedCriticalSection _(g_commandCs);
+    // Assigning strings may reallocate, so keep other writers out.
+    ScopedWriteLock _(g_commandLock);
     auto iter = Internal::g_commandMap.find(command);
     if (iter != Internal::g_commandMap.end())
     {
@@ -0,0 +1,156 @@
+//
+#include "Recluse/System/Limiter.hpp"
+#include "Recluse/Threading/Threading.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Recluse {
+
+
+// Bounds of the adaptive spin window. Spinning less than this is not worth the risk of waking
+// up late, and sleeping is always cheaper than spinning more.
+static constexpr F32 kMinSpinThresholdS     = 0.0002f;
+static constexpr F32 kMaxSpinThresholdS     = 0.002f;
+static constexpr F32 kDefaultSpinThresholdS = 0.001f;
+// Weight of each new oversleep sample in the running estimate.
+static constexpr F32 kOversleepWeight       = 1.0f / 16.0f;
+
+
+static F32 getElapsedS(RealtimeStopWatch end, const RealtimeStopWatch& start)
+{
+    RealtimeTick tick = end - start;
+    return tick.delta();
+}
+
+
+FramePacer::FramePacer()
+    : m_isTiming(false)
+    , m_debtS(0.f)
+    , m_spinThresholdS(kDefaultSpinThresholdS)
+    , m_oversleepMeanS(kDefaultSpinThresholdS)
+    , m_oversleepVarianceS(0.f)
+{
+    resetStats();
+}
+
+
+void FramePacer::reset()
+{
+    m_isTiming  = false;
+    m_debtS     = 0.f;
+}
+
+
+void FramePacer::resetStats()
+{
+    m_frameTimeMeanS    = 0.0;
+    m_frameTimeM2       = 0.0;
+    m_jitterSumS        = 0.0;
+    m_stats             = { };
+    m_stats.spinThresholdS      = m_spinThresholdS;
+    m_stats.averageOversleepS   = m_oversleepMeanS;
+}
+
+
+F32 FramePacer::pace(F32 targetFrameTimeS)
+{
+    if (!m_isTiming)
+    {
+        m_frameStart    = RealtimeStopWatch();
+        m_isTiming      = true;
+        return 0.f;
+    }
+
+    const Bool shouldWait = (targetFrameTimeS > 0.f) && !std::isinf(targetFrameTimeS);
+
+    if (shouldWait)
+    {
+        const F32 deadlineS = targetFrameTimeS - m_debtS;
+
+        for (;;)
+        {
+            const F32 remainingS = deadlineS - getElapsedS(RealtimeStopWatch(), m_frameStart);
+            if (remainingS <= 0.f)
+            {
+                break;
+            }
+
+            if (remainingS > m_spinThresholdS)
+            {
+                const F32 sleepS = remainingS - m_spinThresholdS;
+                RealtimeStopWatch sleepStart;
+                sleepPrecise(static_cast<U64>(sleepS * 1e9f));
+                recordOversleep(getElapsedS(RealtimeStopWatch(), sleepStart) - sleepS);
+            }
+            else
+            {
+                yieldProcessor();
+            }
+        }
+    }
+
+    RealtimeStopWatch frameEnd;
+    const F32 frameTimeS    = getElapsedS(frameEnd, m_frameStart);
+    m_frameStart            = frameEnd;
+
+    if (shouldWait)
+    {
+        // Only carry up to one frame of debt, long hitches are not worth catching up on.
+        const F32 overrunS  = frameTimeS - (targetFrameTimeS - m_debtS);
+        m_debtS             = std::min(std::max(overrunS, 0.f), targetFrameTimeS);
+    }
+    else
+    {
+        m_debtS = 0.f;
+    }
+
+    recordFrame(frameTimeS, shouldWait ? targetFrameTimeS : frameTimeS);
+    return frameTimeS;
+}
+
+
+void FramePacer::recordFrame(F32 frameTimeS, F32 targetFrameTimeS)
+{
+    m_stats.numFrames += 1;
+
+    // Welford's running variance.
+    const F64 delta     = static_cast<F64>(frameTimeS) - m_frameTimeMeanS;
+    m_frameTimeMeanS    += delta / static_cast<F64>(m_stats.numFrames);
+    m_frameTimeM2       += delta * (static_cast<F64>(frameTimeS) - m_frameTimeMeanS);
+
+    const F32 jitterS   = std::fabs(frameTimeS - targetFrameTimeS);
+    m_jitterSumS        += jitterS;
+
+    if (m_stats.numFrames == 1)
+    {
+        m_stats.minFrameTimeS = frameTimeS;
+        m_stats.maxFrameTimeS = frameTimeS;
+    }
+
+    m_stats.minFrameTimeS       = std::min(m_stats.minFrameTimeS, frameTimeS);
+    m_stats.maxFrameTimeS       = std::max(m_stats.maxFrameTimeS, frameTimeS);
+    m_stats.maxJitterS          = std::max(m_stats.maxJitterS, jitterS);
+    m_stats.averageFrameTimeS   = static_cast<F32>(m_frameTimeMeanS);
+    m_stats.frameTimeStdDevS    = static_cast<F32>(std::sqrt(m_frameTimeM2 / static_cast<F64>(m_stats.numFrames)));
+    m_stats.averageJitterS      = static_cast<F32>(m_jitterSumS / static_cast<F64>(m_stats.numFrames));
+}
+
+
+void FramePacer::recordOversleep(F32 oversleepS)
+{
+    oversleepS = std::max(oversleepS, 0.f);
+
+    // Exponential moving average, so the window follows changes in system load.
+    const F32 delta         = oversleepS - m_oversleepMeanS;
+    m_oversleepMeanS        += delta * kOversleepWeight;
+    m_oversleepVarianceS    = (1.0f - kOversleepWeight) * (m_oversleepVarianceS + delta * delta * kOversleepWeight);
+
+    // Leave room for most wake ups, which are rarely more than a few deviations late.
+    const F32 windowS       = m_oversleepMeanS + 3.0f * std::sqrt(m_oversleepVarianceS);
+    m_spinThresholdS        = std::min(std::max(windowS, kMinSpinThresholdS), kMaxSpinThresholdS);
+
+    m_stats.averageOversleepS   = m_oversleepMeanS;
+    m_stats.spinThresholdS      = m_spinThresholdS;
+}
+} // Recluse
@@ -0,0 +1,17 @@
+// 
+#pragma once
+
+#include "Recluse/Arch.hpp"
+#include "Recluse/Types.hpp"
+
+#ifndef RECLUSE_LINUX
+#error "Linux environment variable was not defined! Maybe other environment is defined?"
+#endif 
+
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#define R_CHANNEL_LINUX "Linux"
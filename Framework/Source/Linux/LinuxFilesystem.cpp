@@ -0,0 +1,373 @@
+//
+#include "Linux/LinuxCommon.hpp"
+
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Filesystem/Filesystem.hpp"
+
+#include "Recluse/Threading/Threading.hpp"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace Recluse {
+
+
+static I32 getFileDescriptor(void* handle)
+{
+    return static_cast<I32>(reinterpret_cast<UPtr>(handle)) - 1;
+}
+
+
+U64 File::getFileSz() const
+{
+    struct stat fileStat = { };
+    if (fstat(getFileDescriptor(m_fileHandle), &fileStat) != 0)
+    {
+        return 0ull;
+    }
+    return static_cast<U64>(fileStat.st_size);
+}
+
+
+ResultCode File::readFrom(FileBufferData* pFile, const std::string& filePath)
+{
+    File file;
+    ResultCode result = RecluseResult_Ok;
+
+    result = file.open(filePath, "r");
+
+    if (file.isOpen())
+    {
+        const U64 sz = file.getFileSz();
+
+        pFile->resize(sz);
+        result = file.read(pFile->data(), pFile->size());
+        file.close();
+
+        R_DEBUG(R_CHANNEL_LINUX, "Read %llu bytes of data from file: %s", (U64)pFile->size(), filePath.c_str());
+    }
+
+    return result;
+}
+
+
+ResultCode File::writeTo(FileBufferData* pFile, const std::string& filePath)
+{
+    ResultCode result = RecluseResult_Ok;
+    File file;
+
+    result = file.open(filePath, "w");
+
+    if (file.isOpen())
+    {
+        result = file.write(pFile->data(), pFile->size());
+        file.close();
+
+        R_DEBUG(R_CHANNEL_LINUX, "Wrote %llu bytes of data to file: %s", (U64)pFile->size(), filePath.c_str());
+    }
+
+    return result;
+}
+
+
+void File::setCursor(U64 szBytes)
+{
+    lseek(getFileDescriptor(m_fileHandle), static_cast<off_t>(szBytes), SEEK_SET);
+}
+
+
+U64 File::getCursor()
+{
+    const off_t offset = lseek(getFileDescriptor(m_fileHandle), 0, SEEK_CUR);
+    return (offset < 0) ? 0ull : static_cast<U64>(offset);
+}
+
+
+typedef struct
+{
+    FileBufferDataAsync*    pAsyncBuffer;
+    std::string             filePath;
+    ResultCode              (*taskFn)       (FileBufferData*, const std::string&);
+} FileBufferTemporary;
+
+
+static ResultCode runFileAsyncTask(void* pData)
+{
+    R_ASSERT(pData != NULL);
+
+    FileBufferTemporary* pTemporary = reinterpret_cast<FileBufferTemporary*>(pData);
+
+    ResultCode result = pTemporary->taskFn(&pTemporary->pAsyncBuffer->data, pTemporary->filePath);
+
+    pTemporary->pAsyncBuffer->isFinished = true;
+
+    // The payload is owned by this task, so clean it up once we are done.
+    delete pTemporary;
+
+    return result;
+}
+
+
+static ResultCode runFileAsync(FileBufferDataAsync* pBuffer, const std::string& filePath, ResultCode (*taskFn)(FileBufferData*, const std::string&))
+{
+    R_ASSERT(pBuffer != NULL);
+
+    Thread thr                  = { };
+    FileBufferTemporary* temp   = new FileBufferTemporary();
+    temp->filePath              = filePath;
+    temp->pAsyncBuffer          = pBuffer;
+    temp->taskFn                = taskFn;
+    thr.payload                 = temp;
+
+    pBuffer->isFinished = false;
+
+    ResultCode error = createThread(&thr, runFileAsyncTask);
+    if (error != RecluseResult_Ok)
+    {
+        delete temp;
+        return error;
+    }
+
+    // Nobody joins the thread, so let it clean up after itself.
+    return detachThread(&thr);
+}
+
+
+ResultCode File::readFromAsync(FileBufferDataAsync* pBuffer, const std::string& filePath)
+{
+    return runFileAsync(pBuffer, filePath, File::readFrom);
+}
+
+
+ResultCode File::writeToAsync(FileBufferDataAsync* pBuffer, const std::string& filePath)
+{
+    return runFileAsync(pBuffer, filePath, File::writeTo);
+}
+
+
+std::vector<std::string> Filesystem::split(const std::string& filename)
+{
+    size_t f = filename.find_last_of("/\\");
+    return { filename.substr(0, f), filename.substr(f + 1) };
+}
+
+
+ResultCode File::open(const std::string& filePath, const char* access)
+{
+    if (m_isOpen)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "This File is already open...");
+
+        return RecluseResult_Ok;
+    }
+
+    Bool isRead     = false;
+    Bool isWrite    = false;
+    Bool isAppend   = false;
+    U64 len         = strlen(access);
+
+    for (U32 i = 0; i < len; ++i)
+    {
+        if (access[i] == 'w')
+        {
+            isWrite = true;
+        }
+        else if (access[i] == 'r')
+        {
+            isRead = true;
+        }
+        else if (access[i] == '+')
+        {
+            isAppend = true;
+        }
+    }
+
+    // Same semantics as the win32 backend: 'w' truncates, '+' appends, creating the file if needed.
+    I32 flags = O_CLOEXEC;
+    if ((isWrite || isAppend) && isRead)
+    {
+        flags |= O_RDWR;
+    }
+    else if (isWrite || isAppend)
+    {
+        flags |= O_WRONLY;
+    }
+    else
+    {
+        flags |= O_RDONLY;
+    }
+
+    if (isAppend)
+    {
+        flags |= O_CREAT | O_APPEND;
+    }
+    else if (isWrite)
+    {
+        flags |= O_CREAT | O_TRUNC;
+    }
+
+    const I32 fd = ::open(filePath.c_str(), flags, 0644);
+
+    if (fd < 0)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to open file: %s", filePath.c_str());
+        return RecluseResult_Failed;
+    }
+
+    // Descriptor 0 is valid, so store it offset by one to keep null as the closed handle.
+    m_fileHandle    = reinterpret_cast<void*>(static_cast<UPtr>(fd + 1));
+    m_isOpen        = true;
+
+    return RecluseResult_Ok;
+}
+
+
+void File::close()
+{
+    if (m_fileHandle)
+    {
+        if (::close(getFileDescriptor(m_fileHandle)) == 0)
+        {
+            m_fileHandle    = nullptr;
+            m_isOpen        = false;
+        }
+        else
+        {
+            R_ERROR(R_CHANNEL_LINUX, "Failed to close file!");
+        }
+    }
+}
+
+
+ResultCode File::write(const void* ptr, U64 szBytes)
+{
+    const I32 fd        = getFileDescriptor(m_fileHandle);
+    const U8* pBytes    = static_cast<const U8*>(ptr);
+
+    while (szBytes > 0ull)
+    {
+        const ssize_t written = ::write(fd, pBytes, szBytes);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            R_ERROR(R_CHANNEL_LINUX, "Failed to write to file...");
+
+            return RecluseResult_Failed;
+        }
+
+        pBytes  += written;
+        szBytes -= static_cast<U64>(written);
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode File::read(void* ptr, U64 szBytes)
+{
+    // Return invalid if we are requesting to read nothing...
+    if (szBytes == 0)
+    {
+        return RecluseResult_InvalidArgs;
+    }
+
+    const I32 fd    = getFileDescriptor(m_fileHandle);
+    U8* pBytes      = static_cast<U8*>(ptr);
+    U64 totalRead   = 0ull;
+
+    while (totalRead < szBytes)
+    {
+        const ssize_t bytesRead = ::read(fd, pBytes + totalRead, szBytes - totalRead);
+        if (bytesRead < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            R_ERROR(R_CHANNEL_LINUX, "Failed to read to file!");
+
+            return RecluseResult_Failed;
+        }
+
+        if (bytesRead == 0)
+        {
+            break;
+        }
+
+        totalRead += static_cast<U64>(bytesRead);
+    }
+
+    // zero bytes read means we probably reached end of file...
+    if (totalRead == 0)
+    {
+        return RecluseResult_Failed;
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+std::string Filesystem::getCurrentDir()
+{
+    // Match the win32 backend, which returns the directory of the executable.
+    char buffer[PATH_MAX];
+
+    const ssize_t len = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+    if (len <= 0)
+    {
+        return ".";
+    }
+    buffer[len] = '\0';
+
+    std::string::size_type pos = std::string(buffer).find_last_of('/');
+    return std::string(buffer).substr(0, pos);
+}
+
+
+std::string Filesystem::getDirectoryFromPath(const std::string& path)
+{
+    std::string p = path;
+    std::replace(p.begin(), p.end(), '\\', '/');
+
+    size_t pos = p.find_last_of('/');
+
+    return p.substr(0, pos);
+}
+
+
+Bool directoryExists(const std::string& dirPath)
+{
+    struct stat dirStat = { };
+    return ((stat(dirPath.c_str(), &dirStat) == 0) && S_ISDIR(dirStat.st_mode));
+}
+
+
+Bool Filesystem::createDirectory(const std::string& directoryPath)
+{
+    size_t pos = 0;
+    do
+    {
+        pos = directoryPath.find_first_of("\\/", pos + 1);
+        const std::string subPath = directoryPath.substr(0, pos);
+        if (mkdir(subPath.c_str(), 0755) != 0)
+        {
+            if (errno != EEXIST)
+            {
+                return false;
+            }
+        }
+    } while (pos != std::string::npos);
+    return true;
+}
+} // Recluse
@@ -0,0 +1,104 @@
+//
+#include "Linux/LinuxCommon.hpp"
+#include "Recluse/Memory/VirtualMemory.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <sys/mman.h>
+
+namespace Recluse {
+namespace VirtualMemory {
+
+// Transparent huge pages on x86-64 and arm64 with 4KB base pages.
+static const U64 kHugePageSizeBytes = 2ull * 1024ull * 1024ull;
+
+
+U64 getPageSizeBytes()
+{
+    static const U64 pageSizeBytes = static_cast<U64>(sysconf(_SC_PAGESIZE));
+    return pageSizeBytes;
+}
+
+
+U64 getLargePageSizeBytes()
+{
+#if defined(MADV_HUGEPAGE)
+    return kHugePageSizeBytes;
+#else
+    return 0ull;
+#endif
+}
+
+
+void* reserve(U64 sizeBytes, Bool useLargePages)
+{
+    const U64 alignmentBytes = (useLargePages && getLargePageSizeBytes()) ? getLargePageSizeBytes() : getPageSizeBytes();
+
+    // Over reserve, so the range can be trimmed down to the alignment huge pages need.
+    const U64 reservedSizeBytes = sizeBytes + alignmentBytes - getPageSizeBytes();
+    void* pReserved = mmap(nullptr, reservedSizeBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (pReserved == MAP_FAILED)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to reserve %llu bytes of address space! errno=%d", sizeBytes, errno);
+        return nullptr;
+    }
+
+    const UPtr reservedAddr = reinterpret_cast<UPtr>(pReserved);
+    const UPtr alignedAddr  = (reservedAddr + alignmentBytes - 1ull) & ~(alignmentBytes - 1ull);
+    const UPtr headBytes    = alignedAddr - reservedAddr;
+    const UPtr tailBytes    = reservedSizeBytes - headBytes - sizeBytes;
+    if (headBytes)
+    {
+        munmap(pReserved, headBytes);
+    }
+    if (tailBytes)
+    {
+        munmap(reinterpret_cast<void*>(alignedAddr + sizeBytes), tailBytes);
+    }
+
+#if defined(MADV_HUGEPAGE)
+    if (useLargePages)
+    {
+        // Only a hint, when THP is off the range is still backed by regular pages.
+        madvise(reinterpret_cast<void*>(alignedAddr), sizeBytes, MADV_HUGEPAGE);
+    }
+#endif
+
+    return reinterpret_cast<void*>(alignedAddr);
+}
+
+
+ResultCode commit(void* pAddress, U64 sizeBytes)
+{
+    // Pages are only backed once touched, so committing is just making them accessible.
+    if (mprotect(pAddress, sizeBytes, PROT_READ | PROT_WRITE) != 0)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to commit %llu bytes! errno=%d", sizeBytes, errno);
+        return RecluseResult_OutOfMemory;
+    }
+    return RecluseResult_Ok;
+}
+
+
+ResultCode decommit(void* pAddress, U64 sizeBytes)
+{
+    // Drop the backing pages first, so they go back to the OS, then fence the range off.
+    if ((madvise(pAddress, sizeBytes, MADV_DONTNEED) != 0) || (mprotect(pAddress, sizeBytes, PROT_NONE) != 0))
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to decommit %llu bytes! errno=%d", sizeBytes, errno);
+        return RecluseResult_Failed;
+    }
+    return RecluseResult_Ok;
+}
+
+
+ResultCode release(void* pAddress, U64 sizeBytes)
+{
+    if (munmap(pAddress, sizeBytes) != 0)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to release %llu bytes of address space! errno=%d", sizeBytes, errno);
+        return RecluseResult_Failed;
+    }
+    return RecluseResult_Ok;
+}
+} // VirtualMemory
+} // Recluse
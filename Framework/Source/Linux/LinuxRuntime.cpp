@@ -0,0 +1,264 @@
+//
+#include "Linux/LinuxCommon.hpp"
+#include "Linux/LinuxRuntime.hpp"
+
+#include "Recluse/Time.hpp"
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/System/Input.hpp"
+#include "Recluse/System/DLLLoader.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include "Logging/LogFramework.hpp"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+
+// Number of watch types available to the engine. This can vary, so be sure to update the cost needed.
+#define MAX_WATCH_TYPE_INDICES      (16)
+
+namespace Recluse {
+
+
+static U64 queryCurrentThreadId()
+{
+    return static_cast<U64>(syscall(SYS_gettid));
+}
+
+
+static struct 
+{
+    CriticalSectionGuard csTick[MAX_WATCH_TYPE_INDICES];
+    LinuxRuntimeTick    ticks[MAX_WATCH_TYPE_INDICES];
+    U64                 watchId[MAX_WATCH_TYPE_INDICES] = { };
+
+    const U64           mainThreadId    = queryCurrentThreadId();  //< this is the main thread id!
+} gLinuxRuntime;
+
+
+// Thread ids are cached, since mutexes query them on every lock.
+static thread_local U64 t_currentThreadId = 0ull;
+
+
+#if defined(RECLUSE_DEBUG) || defined(RECLUSE_DEVELOPER)
+namespace Asserts {
+
+Result AssertHandler::check(Bool cond, const char* functionStr, const char* msg)
+{
+    if (cond) return ASSERT_OK;
+
+    // No message box on this platform, so just report it and break into the debugger.
+    fprintf(stderr, "Assertion failed: %s\n\n%s\n", functionStr, msg);
+
+    return ASSERT_DEBUG;
+}
+} // Asserts
+#endif
+
+
+void enableOSColorInput()
+{
+    // Terminals already handle the escape sequences for colors.
+}
+
+
+U64 getTicksPerSecondS()
+{
+    return 1000000000ull;
+}
+
+
+U64 getCurrentTickS()
+{
+    // Raw monotonic time is not slewed by NTP, so deltas stay consistent between frames.
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return static_cast<U64>(now.tv_sec) * 1000000000ull + static_cast<U64>(now.tv_nsec);
+}
+
+
+void RealtimeTick::updateWatch(U64 id, U32 watchType)
+{
+    R_ASSERT(watchType < MAX_WATCH_TYPE_INDICES);
+
+    if (gLinuxRuntime.watchId[watchType] == 0)
+    {
+        R_ERROR
+            (
+                "RealtimeTick", 
+                "This watch=%d is not initialized! Can not update!", 
+                watchType
+            );
+        return;
+    }
+
+    if (gLinuxRuntime.watchId[watchType] != id)
+    {
+        R_ERROR
+            (
+                "RealtimeTick", 
+                "Can not update watch=%d. Id=%llu does not own it!", 
+                watchType, id
+            );
+        return;
+    }
+
+    ScopedCriticalSection _(gLinuxRuntime.csTick[watchType]);
+
+    LinuxRuntimeTick& nativeTick    = gLinuxRuntime.ticks[watchType];
+    
+    const U64 ticksPerSecond        = getTicksPerSecondS();
+    const U64 lastTimeS             = nativeTick.getLastTimeS();
+    const U64 currentTimeS          = getCurrentTickS();
+
+    F32 fDeltaTime                  = F32(currentTimeS - lastTimeS) / F32(ticksPerSecond);
+
+    nativeTick.updateLastTimeS(currentTimeS, fDeltaTime);
+}
+
+
+RealtimeTick::RealtimeTick(U32 watchType)
+{
+    R_ASSERT(watchType < MAX_WATCH_TYPE_INDICES);
+
+    if (gLinuxRuntime.watchId[watchType] == 0)
+    {
+        R_WARN("RealtimeTick", "Can't query uninitialized watch=%d! Likely not initialized yet.", watchType);
+        return;
+    }
+    
+    ScopedCriticalSection _(gLinuxRuntime.csTick[watchType]);
+    const LinuxRuntimeTick& nativeTick = gLinuxRuntime.ticks[watchType];
+    
+    m_currentTimeS  = nativeTick.getCurrentTime();
+    m_deltaTimeS    = nativeTick.getDelta();
+}
+
+
+void RealtimeTick::initializeWatch(U64 id, U32 watchType)
+{
+    R_ASSERT(watchType < MAX_WATCH_TYPE_INDICES);
+
+    if 
+        (
+            gLinuxRuntime.watchId[watchType] != 0 &&
+            gLinuxRuntime.watchId[watchType] != id
+        )
+    {
+        R_ERROR("RealtimeTick", "Watch type is already initialized! Ignoring...");
+        return;
+    }
+   
+    gLinuxRuntime.watchId[watchType]    = id;
+    gLinuxRuntime.ticks[watchType]      = LinuxRuntimeTick();
+}
+
+
+RealtimeTick RealtimeTick::getTick(U32 watchType)
+{
+    return RealtimeTick(watchType);
+}
+
+
+void pollEvents()
+{
+    // No windowing or input backend on linux yet, dedicated servers run headless.
+}
+
+
+U64 getMainThreadId()
+{
+    return gLinuxRuntime.mainThreadId;
+}
+
+
+U64 getCurrentThreadId()
+{
+    if (t_currentThreadId == 0ull)
+    {
+        t_currentThreadId = queryCurrentThreadId();
+    }
+    return t_currentThreadId;
+}
+
+
+RealtimeStopWatch::RealtimeStopWatch()
+{
+    m_currentTimeU64 = getCurrentTickS();
+}
+
+
+RealtimeStopWatch::operator Recluse::RealtimeTick()
+{
+    RealtimeTick tick = RealtimeTick();
+    tick.m_currentTimeS = F32(m_currentTimeU64);
+    tick.m_deltaTimeS = F32(m_currentTimeU64) / F32(getTicksPerSecondS());
+    return tick;
+}
+
+
+RealtimeStopWatch RealtimeStopWatch::operator-(const RealtimeStopWatch& rh)
+{
+    RealtimeStopWatch watch;
+    watch.m_currentTimeU64 = m_currentTimeU64 - rh.m_currentTimeU64;
+    return watch;
+}
+
+
+DllLoader::DllLoader(const std::string& dllName)
+    : library(nullptr)
+{
+    if (!dllName.empty())
+    {
+        load(dllName);
+    }
+}
+
+
+DllLoader::~DllLoader()
+{
+    if (isLoaded())
+    {
+        unload();
+    }
+}
+
+
+Bool DllLoader::isLoaded()
+{
+    return (library != nullptr);
+}
+
+
+Bool DllLoader::load(const std::string& dllName)
+{
+    void* handle = dlopen(dllName.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle)
+    {
+        library = handle;
+        name = dllName;
+        return true;
+    }
+    R_WARN(R_CHANNEL_LINUX, "Failed to load library %s: %s", dllName.c_str(), dlerror());
+    return false;
+}
+
+
+Bool DllLoader::unload()
+{
+    if (isLoaded())
+    {
+        dlclose(library);
+        library = nullptr;
+        name = "";
+        return true;
+    }
+    return false;
+}
+
+
+void* DllLoader::procAddress(const std::string& name)
+{
+    return dlsym(library, name.c_str());
+}
+} // Recluse
@@ -0,0 +1,37 @@
+// 
+#pragma once
+
+#include "Linux/LinuxCommon.hpp"
+
+namespace Recluse {
+
+
+// Grab ticks per second.
+U64 getTicksPerSecondS();
+U64 getCurrentTickS();
+
+class LinuxRuntimeTick 
+{
+public:
+    LinuxRuntimeTick()
+    {
+        updateLastTimeS(getCurrentTickS(), 0.f);
+    }
+
+    U64 getLastTimeS() const { return m_time; }
+    F32 getCurrentTime() const { return m_currentTimeS; }
+    F32 getDelta() const { return m_deltaTimeS; }
+
+    void updateLastTimeS(U64 newLastTimeS, F32 deltaTime)
+    {
+        m_time          = newLastTimeS;
+        m_currentTimeS  = F32(newLastTimeS);
+        m_deltaTimeS    = deltaTime;
+    }
+
+private:
+    U64 m_time;
+    F32 m_currentTimeS;
+    F32 m_deltaTimeS;
+};
+} // Recluse
@@ -0,0 +1,29 @@
+//
+#include "Linux/LinuxCommon.hpp"
+#include "Recluse/Time.hpp"
+#include "Recluse/System/DateTime.hpp"
+
+#include <sys/time.h>
+
+namespace Recluse {
+
+
+void getLocalDateTime(LocalDateTimeDesc& desc)
+{
+    struct timespec now     = { };
+    struct tm localTime     = { };
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    localtime_r(&now.tv_sec, &localTime);
+
+    desc.day            = localTime.tm_mday;
+    desc.dayOfWeek      = localTime.tm_wday;
+    desc.hour           = localTime.tm_hour;
+    desc.milliseconds   = static_cast<U32>(now.tv_nsec / 1000000l);
+    desc.minute         = localTime.tm_min;
+    // tm_mon starts from 0, while SYSTEMTIME starts from 1.
+    desc.month          = localTime.tm_mon + 1;
+    desc.second         = localTime.tm_sec;
+    desc.year           = localTime.tm_year + 1900;
+}
+} // Recluse
@@ -0,0 +1,133 @@
+//
+#include "Linux/Threading/LinuxThread.hpp"
+#include "Recluse/Threading/Fiber.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <sys/mman.h>
+#include <ucontext.h>
+
+namespace Recluse {
+
+
+struct LinuxFiber
+{
+    ucontext_t      context;
+    FiberFunction   func;
+    void*           pData;
+    void*           pStack;
+    SizeT           stackSizeBytes;
+    Bool            isThread;
+};
+
+
+// Fiber that is currently running on this thread.
+static thread_local LinuxFiber* t_pRunningFiber = nullptr;
+
+
+static void linuxFiberStart(U32 low, U32 high)
+{
+    // makecontext only passes int arguments, so the fiber pointer is split in two.
+    LinuxFiber* pFiber = reinterpret_cast<LinuxFiber*>((static_cast<UPtr>(high) << 32ull) | static_cast<UPtr>(low));
+    pFiber->func(pFiber->pData);
+
+    R_ASSERT_FORMAT(false, "Fiber returned from its function! Fibers must switch away instead.");
+    abort();
+}
+
+
+Fiber convertThreadToFiber()
+{
+    LinuxFiber* pFiber      = new LinuxFiber();
+    pFiber->func            = nullptr;
+    pFiber->pData           = nullptr;
+    pFiber->pStack          = nullptr;
+    pFiber->stackSizeBytes  = 0;
+    pFiber->isThread        = true;
+    t_pRunningFiber         = pFiber;
+    return pFiber;
+}
+
+
+ResultCode convertFiberToThread(Fiber threadFiber)
+{
+    LinuxFiber* pFiber = static_cast<LinuxFiber*>(threadFiber);
+    R_ASSERT(pFiber != NULL && pFiber->isThread);
+    R_ASSERT(t_pRunningFiber == pFiber);
+
+    t_pRunningFiber = nullptr;
+    delete pFiber;
+    return RecluseResult_Ok;
+}
+
+
+Fiber createFiber(FiberFunction func, void* pData, SizeT stackSizeBytes)
+{
+    R_ASSERT(func != NULL);
+
+    const SizeT pageSizeBytes   = static_cast<SizeT>(sysconf(_SC_PAGESIZE));
+    const SizeT stackSize       = ((stackSizeBytes + pageSizeBytes - 1) / pageSizeBytes) * pageSizeBytes;
+
+    // The lowest page is left as a guard, so stack overflows fault instead of corrupting memory.
+    void* pMemory = mmap(nullptr, stackSize + pageSizeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (pMemory == MAP_FAILED)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to allocate fiber stack! Result: %d", errno);
+        return nullptr;
+    }
+    mprotect(pMemory, pageSizeBytes, PROT_NONE);
+
+    LinuxFiber* pFiber      = new LinuxFiber();
+    pFiber->func            = func;
+    pFiber->pData           = pData;
+    pFiber->pStack          = pMemory;
+    pFiber->stackSizeBytes  = stackSize + pageSizeBytes;
+    pFiber->isThread        = false;
+
+    getcontext(&pFiber->context);
+    pFiber->context.uc_stack.ss_sp      = static_cast<U8*>(pMemory) + pageSizeBytes;
+    pFiber->context.uc_stack.ss_size    = stackSize;
+    pFiber->context.uc_link             = nullptr;
+
+    const UPtr address = reinterpret_cast<UPtr>(pFiber);
+    makecontext
+        (
+            &pFiber->context, 
+            reinterpret_cast<void(*)()>(linuxFiberStart), 
+            2, 
+            static_cast<U32>(address & 0xFFFFFFFFull), 
+            static_cast<U32>(address >> 32ull)
+        );
+
+    return pFiber;
+}
+
+
+ResultCode destroyFiber(Fiber fiber)
+{
+    LinuxFiber* pFiber = static_cast<LinuxFiber*>(fiber);
+    if (!pFiber)
+    {
+        return RecluseResult_NullPtrExcept;
+    }
+
+    R_ASSERT(!pFiber->isThread);
+    munmap(pFiber->pStack, pFiber->stackSizeBytes);
+    delete pFiber;
+
+    return RecluseResult_Ok;
+}
+
+
+void switchToFiber(Fiber fiber)
+{
+    LinuxFiber* pFiber  = static_cast<LinuxFiber*>(fiber);
+    LinuxFiber* pFrom   = t_pRunningFiber;
+    R_ASSERT(pFiber != NULL);
+    R_ASSERT(pFrom != NULL);
+
+    // Nothing thread local may be touched after the swap, since we might be resumed on 
+    // another thread.
+    t_pRunningFiber = pFiber;
+    swapcontext(&pFrom->context, &pFiber->context);
+}
+} // Recluse
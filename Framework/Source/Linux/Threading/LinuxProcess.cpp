@@ -0,0 +1,350 @@
+//
+#include "Linux/Threading/LinuxThread.hpp"
+#include "Recluse/System/Process.hpp"
+#include "Recluse/System/Architecture.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <dirent.h>
+#include <execinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace Recluse {
+namespace Process {
+
+
+static Bool readTopologyValue(U32 cpu, const char* name, I32& valueOut)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/%s", cpu, name);
+
+    FILE* pFile = fopen(path, "r");
+    if (!pFile)
+    {
+        return false;
+    }
+
+    const Bool success = (fscanf(pFile, "%d", &valueOut) == 1);
+    fclose(pFile);
+    return success;
+}
+
+
+ResultCode queryCpuInfo(CpuInfo& cpuInfo)
+{
+    const long numConfigured = sysconf(_SC_NPROCESSORS_CONF);
+    const long numOnline     = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (numOnline <= 0)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to query the number of online processors!");
+        return RecluseResult_Failed;
+    }
+
+    // Each physical core is identified by its package and core id. SMT siblings share both.
+    std::set<std::pair<I32, I32>> cores;
+    for (U32 cpu = 0; cpu < static_cast<U32>(numConfigured); ++cpu)
+    {
+        I32 packageId   = 0;
+        I32 coreId      = 0;
+        if (readTopologyValue(cpu, "core_id", coreId))
+        {
+            readTopologyValue(cpu, "physical_package_id", packageId);
+            cores.insert(std::make_pair(packageId, coreId));
+        }
+    }
+
+    const U32 numLogical    = static_cast<U32>(numOnline);
+    const U32 numCores      = cores.empty() ? numLogical : static_cast<U32>(cores.size());
+
+#if defined(__x86_64__)
+    cpuInfo.processorArchitecture = Architecture_x64;
+#elif defined(__aarch64__)
+    cpuInfo.processorArchitecture = Archictecture_Amd64;
+#elif defined(__arm__)
+    cpuInfo.processorArchitecture = Architecture_Arm32;
+#else
+    cpuInfo.processorArchitecture = Architecture_x86;
+#endif
+
+    cpuInfo.numberCoreProcessors            = numCores;
+    cpuInfo.numberLogicalProcessors         = numLogical;
+    cpuInfo.numberLogicalProcessorsPerCore  = (numCores > 0) ? (numLogical / numCores) : 1;
+
+    return RecluseResult_Ok;
+}
+
+
+static Bool readSysfsString(const char* path, char* pOut, U32 sizeBytes)
+{
+    FILE* pFile = fopen(path, "r");
+    if (!pFile)
+    {
+        return false;
+    }
+
+    const Bool success = (fgets(pOut, sizeBytes, pFile) != nullptr);
+    fclose(pFile);
+
+    if (success)
+    {
+        pOut[strcspn(pOut, "\n")] = '\0';
+    }
+    return success;
+}
+
+
+// Parse a kernel cpu list, such as "0-3,8-11", into a mask.
+static ProcessorMask parseCpuList(const char* pList)
+{
+    ProcessorMask mask = 0ull;
+    while (*pList)
+    {
+        char* pEnd          = nullptr;
+        const long first    = strtol(pList, &pEnd, 10);
+        long last           = first;
+        if (pEnd == pList)
+        {
+            break;
+        }
+
+        pList = pEnd;
+        if (*pList == '-')
+        {
+            last    = strtol(pList + 1, &pEnd, 10);
+            pList   = pEnd;
+        }
+
+        for (long cpu = first; cpu <= last && cpu < 64; ++cpu)
+        {
+            mask |= (1ull << cpu);
+        }
+
+        if (*pList == ',')
+        {
+            ++pList;
+        }
+    }
+    return mask;
+}
+
+
+static U32 readNumaNode(U32 cpu)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+
+    DIR* pDir = opendir(path);
+    if (!pDir)
+    {
+        return 0;
+    }
+
+    // The cpu directory holds a nodeN link to the NUMA node it belongs to.
+    U32 numaNode = 0;
+    while (struct dirent* pEntry = readdir(pDir))
+    {
+        if (strncmp(pEntry->d_name, "node", 4) == 0)
+        {
+            numaNode = static_cast<U32>(atoi(pEntry->d_name + 4));
+            break;
+        }
+    }
+    closedir(pDir);
+    return numaNode;
+}
+
+
+static U32 findOrAddCache(CpuTopology& topology, const CpuCacheInfo& cache)
+{
+    for (U32 i = 0; i < topology.caches.size(); ++i)
+    {
+        if ((topology.caches[i].level == cache.level) && (topology.caches[i].processorMask == cache.processorMask))
+        {
+            return i;
+        }
+    }
+    topology.caches.push_back(cache);
+    return static_cast<U32>(topology.caches.size() - 1);
+}
+
+
+static void readCaches(U32 cpu, ProcessorMask availableMask, CpuTopology& topology, CpuCoreInfo& core)
+{
+    for (U32 index = 0; ; ++index)
+    {
+        char path[128];
+        char value[256];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", cpu, index);
+        if (!readSysfsString(path, value, sizeof(value)))
+        {
+            break;
+        }
+
+        CpuCacheInfo cache  = { };
+        cache.level         = static_cast<U32>(atoi(value));
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/type", cpu, index);
+        if ((cache.level < 2) || !readSysfsString(path, value, sizeof(value)) || (strcmp(value, "Instruction") == 0))
+        {
+            continue;
+        }
+
+        // Sizes are given as "1024K".
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/size", cpu, index);
+        if (readSysfsString(path, value, sizeof(value)))
+        {
+            char* pUnit     = nullptr;
+            cache.sizeBytes = strtoull(value, &pUnit, 10);
+            if (*pUnit == 'K')      cache.sizeBytes *= 1024ull;
+            else if (*pUnit == 'M') cache.sizeBytes *= 1024ull * 1024ull;
+        }
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/coherency_line_size", cpu, index);
+        if (readSysfsString(path, value, sizeof(value)))
+        {
+            cache.lineSizeBytes = static_cast<U32>(atoi(value));
+        }
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, index);
+        cache.processorMask = readSysfsString(path, value, sizeof(value)) ? (parseCpuList(value) & availableMask) : (1ull << cpu);
+
+        const U32 cacheIndex = findOrAddCache(topology, cache);
+        if (cache.level == 2)
+        {
+            core.l2CacheIndex = cacheIndex;
+        }
+        else if (cache.level == 3)
+        {
+            core.l3CacheIndex = cacheIndex;
+        }
+    }
+}
+
+
+ResultCode queryCpuTopology(CpuTopology& topology)
+{
+    topology = CpuTopology();
+
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &affinity) != 0)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to query the process affinity! Result: %d", errno);
+        return RecluseResult_Failed;
+    }
+
+    char onlineList[256] = { };
+    ProcessorMask availableMask = ~0ull;
+    if (readSysfsString("/sys/devices/system/cpu/online", onlineList, sizeof(onlineList)))
+    {
+        availableMask = parseCpuList(onlineList);
+    }
+
+    ProcessorMask affinityMask = 0ull;
+    for (U32 cpu = 0; cpu < 64u; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &affinity))
+        {
+            affinityMask |= (1ull << cpu);
+        }
+    }
+    availableMask &= affinityMask;
+
+    // Each physical core is identified by its package and core id. SMT siblings share both.
+    std::map<std::pair<I32, I32>, U32> coreIndices;
+    std::set<I32> packages;
+    std::set<U32> numaNodes;
+    for (U32 cpu = 0; cpu < 64u; ++cpu)
+    {
+        if (!(availableMask & (1ull << cpu)))
+        {
+            continue;
+        }
+
+        I32 packageId   = 0;
+        I32 coreId      = static_cast<I32>(cpu);
+        readTopologyValue(cpu, "physical_package_id", packageId);
+        readTopologyValue(cpu, "core_id", coreId);
+
+        const std::pair<I32, I32> key(packageId, coreId);
+        auto it = coreIndices.find(key);
+        if (it == coreIndices.end())
+        {
+            CpuCoreInfo core    = { };
+            core.packageId      = static_cast<U32>(std::max(packageId, 0));
+            core.numaNode       = readNumaNode(cpu);
+            core.l2CacheIndex   = kInvalidCacheIndex;
+            core.l3CacheIndex   = kInvalidCacheIndex;
+            readCaches(cpu, availableMask, topology, core);
+
+            it = coreIndices.insert(std::make_pair(key, static_cast<U32>(topology.cores.size()))).first;
+            topology.cores.push_back(core);
+            packages.insert(packageId);
+            numaNodes.insert(core.numaNode);
+        }
+
+        topology.cores[it->second].processorMask |= (1ull << cpu);
+        topology.numLogicalProcessors += 1;
+    }
+
+    if (topology.cores.empty())
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to find any available processors!");
+        return RecluseResult_Failed;
+    }
+
+    std::sort
+        (
+            topology.cores.begin(), 
+            topology.cores.end(), 
+            [] (const CpuCoreInfo& lhs, const CpuCoreInfo& rhs) -> Bool
+            {
+                if (lhs.packageId != rhs.packageId)
+                {
+                    return lhs.packageId < rhs.packageId;
+                }
+                return (lhs.processorMask & (~lhs.processorMask + 1ull)) < (rhs.processorMask & (~rhs.processorMask + 1ull));
+            }
+        );
+
+    topology.numPackages    = static_cast<U32>(packages.size());
+    topology.numNumaNodes   = static_cast<U32>(numaNodes.size());
+
+    return RecluseResult_Ok;
+}
+
+
+F64 getThreadCpuTimeS()
+{
+    struct timespec cpuTime = { };
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime) != 0)
+    {
+        return 0.0;
+    }
+    return static_cast<F64>(cpuTime.tv_sec) + static_cast<F64>(cpuTime.tv_nsec) * 1e-9;
+}
+
+
+U32 captureStackTrace(void** ppFrames, U32 maxFrames, U32 framesToSkip)
+{
+    static const U32 kMaxCapturedFrames = 64u;
+    void* frames[kMaxCapturedFrames];
+
+    // Skip this function too.
+    const U32 numToCapture  = std::min(maxFrames + framesToSkip + 1u, kMaxCapturedFrames);
+    const I32 numCaptured   = backtrace(frames, static_cast<int>(numToCapture));
+    U32 numFrames           = 0u;
+    for (I32 i = static_cast<I32>(framesToSkip) + 1; (i < numCaptured) && (numFrames < maxFrames); ++i)
+    {
+        ppFrames[numFrames++] = frames[i];
+    }
+    return numFrames;
+}
+} // Process
+} // Recluse
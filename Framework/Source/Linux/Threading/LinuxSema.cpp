@@ -0,0 +1,98 @@
+//
+#include "Linux/Threading/LinuxThread.hpp"
+#include "Recluse/Messaging.hpp"
+
+namespace Recluse {
+
+
+// Counting semaphore on a futex. The count is the futex word, so a waiter only sleeps if the
+// count is still zero when it enters the kernel. Signalers only make the wake syscall when
+// someone may be sleeping.
+struct LinuxSemaphore
+{
+    std::atomic<U32>    count;
+    std::atomic<U32>    numWaiters;
+};
+
+
+static Bool tryDecrementSemaphore(LinuxSemaphore* pSemaphore)
+{
+    U32 count = pSemaphore->count.load(std::memory_order_relaxed);
+    while (count > 0u)
+    {
+        if (pSemaphore->count.compare_exchange_weak(count, count - 1u, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+Semaphore createSemaphore(const char* name)
+{
+    (void)name;
+    LinuxSemaphore* pSemaphore = new LinuxSemaphore();
+    pSemaphore->count.store(0u, std::memory_order_relaxed);
+    pSemaphore->numWaiters.store(0u, std::memory_order_relaxed);
+    return pSemaphore;
+}
+
+
+ResultCode destroySemaphore(Semaphore sema)
+{
+    if (!sema)
+    {
+        return RecluseResult_NullPtrExcept;
+    }
+
+    delete static_cast<LinuxSemaphore*>(sema);
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode signalSemaphore(Semaphore sema)
+{
+    R_ASSERT(sema != NULL);
+
+    LinuxSemaphore* pSemaphore = static_cast<LinuxSemaphore*>(sema);
+
+    // Both need to be sequentially consistent, pairs with the waiter incrementing numWaiters
+    // before checking the count.
+    pSemaphore->count.fetch_add(1u, std::memory_order_seq_cst);
+    if (pSemaphore->numWaiters.load(std::memory_order_seq_cst) > 0u)
+    {
+        futexWake(&pSemaphore->count, 1u);
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode waitSemaphore(Semaphore sema)
+{
+    R_ASSERT(sema != NULL);
+
+    LinuxSemaphore* pSemaphore = static_cast<LinuxSemaphore*>(sema);
+
+    // Spin shortly first, signals usually come in quick succession.
+    for (U32 i = 0; i < 64u; ++i)
+    {
+        if (tryDecrementSemaphore(pSemaphore))
+        {
+            return RecluseResult_Ok;
+        }
+        yieldProcessor();
+    }
+
+    pSemaphore->numWaiters.fetch_add(1u, std::memory_order_seq_cst);
+    while (!tryDecrementSemaphore(pSemaphore))
+    {
+        futexWait(&pSemaphore->count, 0u);
+    }
+    pSemaphore->numWaiters.fetch_sub(1u, std::memory_order_relaxed);
+
+    return RecluseResult_Ok;
+}
+} // Recluse
@@ -0,0 +1,75 @@
+//
+#pragma once
+
+#include "Recluse/Threading/Threading.hpp"
+#include "Linux/LinuxCommon.hpp"
+
+#include <atomic>
+
+namespace Recluse {
+
+
+// Sleep on the futex word, as long as it still holds the expected value. Returns false if the
+// absolute deadline (CLOCK_MONOTONIC) passed. A null deadline waits forever.
+Bool futexWait(std::atomic<U32>* pWord, U32 expected, const struct timespec* pDeadline = nullptr);
+
+// Wake up to count threads sleeping on the futex word.
+void futexWake(std::atomic<U32>* pWord, U32 count);
+
+// Get the absolute CLOCK_MONOTONIC deadline, waitMs from now.
+void getFutexDeadline(U64 waitMs, struct timespec& deadline);
+
+
+// Three state futex lock, 0 is unlocked, 1 is locked, and 2 is locked with possible waiters.
+// Unlocking only enters the kernel if someone may be waiting. Before sleeping, lockers spin
+// for an adaptive amount of time, similar to glibc's adaptive mutexes, since most of our 
+// locks are only held for a short time.
+class FutexLock
+{
+public:
+    static const U32 kMaxSpinCount = 256u;
+
+    void initialize()
+    {
+        m_state.store(0u, std::memory_order_relaxed);
+        m_spinCount.store(16u, std::memory_order_relaxed);
+    }
+
+    Bool tryLock()
+    {
+        U32 expected = 0u;
+        return m_state.compare_exchange_strong(expected, 1u, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    // Returns false if the lock could not be acquired before the timeout.
+    Bool lock(U64 waitMs = kInfiniteMs);
+
+    void unlock()
+    {
+        if (m_state.exchange(0u, std::memory_order_release) == 2u)
+        {
+            futexWake(&m_state, 1u);
+        }
+    }
+
+private:
+    std::atomic<U32>    m_state;
+    // Running estimate of how long the lock is usually held, in spin iterations.
+    std::atomic<U32>    m_spinCount;
+};
+
+
+// Recursive lock, to match the behavior of win32 mutexes and critical sections.
+struct LinuxMutex
+{
+    FutexLock           lock;
+    std::atomic<U64>    owner;
+    U32                 recursionCount;
+};
+
+
+void        initializeLinuxMutex(LinuxMutex* pMutex);
+ResultCode  lockLinuxMutex(LinuxMutex* pMutex, U64 waitMs);
+ResultCode  tryLockLinuxMutex(LinuxMutex* pMutex);
+ResultCode  unlockLinuxMutex(LinuxMutex* pMutex);
+} // Recluse
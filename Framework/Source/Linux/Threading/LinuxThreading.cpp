@@ -0,0 +1,548 @@
+//
+#include "Linux/Threading/LinuxThread.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <climits>
+
+namespace Recluse {
+
+
+static_assert(sizeof(pthread_t) <= sizeof(void*), "pthread_t must fit inside of the thread handle.");
+
+struct LinuxThreadStart
+{
+    ThreadFunction  func;
+    void*           payload;
+};
+
+
+static void* linuxThreadStart(void* pData)
+{
+    // The thread object may not outlive the creator's scope, so the start routine is
+    // passed by a copy that we own.
+    LinuxThreadStart start = *static_cast<LinuxThreadStart*>(pData);
+    delete static_cast<LinuxThreadStart*>(pData);
+
+    const U32 result = start.func(start.payload);
+    return reinterpret_cast<void*>(static_cast<UPtr>(result));
+}
+
+
+static pthread_t getPthread(const Thread* pThread)
+{
+    return (pthread_t)reinterpret_cast<UPtr>(pThread->handle);
+}
+
+
+Bool futexWait(std::atomic<U32>* pWord, U32 expected, const struct timespec* pDeadline)
+{
+    // FUTEX_WAIT_BITSET takes an absolute timeout, so spurious wake ups don't extend the wait.
+    long result = syscall
+                    (
+                        SYS_futex,
+                        reinterpret_cast<U32*>(pWord),
+                        FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+                        expected,
+                        pDeadline,
+                        nullptr,
+                        FUTEX_BITSET_MATCH_ANY
+                    );
+    return !((result == -1) && (errno == ETIMEDOUT));
+}
+
+
+void futexWake(std::atomic<U32>* pWord, U32 count)
+{
+    syscall(SYS_futex, reinterpret_cast<U32*>(pWord), FUTEX_WAKE | FUTEX_PRIVATE_FLAG, count, nullptr, nullptr, 0);
+}
+
+
+void getFutexDeadline(U64 waitMs, struct timespec& deadline)
+{
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec     += static_cast<time_t>(waitMs / 1000ull);
+    deadline.tv_nsec    += static_cast<long>((waitMs % 1000ull) * 1000000ull);
+    if (deadline.tv_nsec >= 1000000000l)
+    {
+        deadline.tv_sec     += 1;
+        deadline.tv_nsec    -= 1000000000l;
+    }
+}
+
+
+Bool FutexLock::lock(U64 waitMs)
+{
+    if (tryLock())
+    {
+        return true;
+    }
+
+    if (waitMs == 0ull)
+    {
+        return false;
+    }
+
+    // Spin for up to twice as long as the lock was held on average. Only read the state while
+    // spinning, so we don't bounce the cache line between the spinners.
+    const I32 estimate  = static_cast<I32>(m_spinCount.load(std::memory_order_relaxed));
+    const I32 maxSpins  = std::min(estimate * 2 + 16, static_cast<I32>(kMaxSpinCount));
+    I32 spins           = 0;
+    Bool acquired       = false;
+
+    for (; spins < maxSpins; ++spins)
+    {
+        if ((m_state.load(std::memory_order_relaxed) == 0u) && tryLock())
+        {
+            acquired = true;
+            break;
+        }
+        yieldProcessor();
+    }
+
+    m_spinCount.store(static_cast<U32>(estimate + (spins - estimate) / 8), std::memory_order_relaxed);
+
+    if (acquired)
+    {
+        return true;
+    }
+
+    struct timespec deadline        = { };
+    const struct timespec* pDeadline = nullptr;
+    if (waitMs != kInfiniteMs)
+    {
+        getFutexDeadline(waitMs, deadline);
+        pDeadline = &deadline;
+    }
+
+    // Mark the lock as contended, so that the owner knows to wake us once it unlocks.
+    while (m_state.exchange(2u, std::memory_order_acquire) != 0u)
+    {
+        if (!futexWait(&m_state, 2u, pDeadline))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void initializeLinuxMutex(LinuxMutex* pMutex)
+{
+    pMutex->lock.initialize();
+    pMutex->owner.store(0ull, std::memory_order_relaxed);
+    pMutex->recursionCount = 0u;
+}
+
+
+ResultCode lockLinuxMutex(LinuxMutex* pMutex, U64 waitMs)
+{
+    const U64 threadId = getCurrentThreadId();
+
+    // Only the owner can ever see its own id here.
+    if (pMutex->owner.load(std::memory_order_relaxed) == threadId)
+    {
+        ++pMutex->recursionCount;
+        return RecluseResult_Ok;
+    }
+
+    if (!pMutex->lock.lock(waitMs))
+    {
+        return RecluseResult_Timeout;
+    }
+
+    pMutex->owner.store(threadId, std::memory_order_relaxed);
+    pMutex->recursionCount = 1u;
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode tryLockLinuxMutex(LinuxMutex* pMutex)
+{
+    return lockLinuxMutex(pMutex, 0ull);
+}
+
+
+ResultCode unlockLinuxMutex(LinuxMutex* pMutex)
+{
+    R_ASSERT(pMutex->owner.load(std::memory_order_relaxed) == getCurrentThreadId());
+
+    if (--pMutex->recursionCount == 0u)
+    {
+        pMutex->owner.store(0ull, std::memory_order_relaxed);
+        pMutex->lock.unlock();
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode createThread(Thread* pThread, ThreadFunction startRoutine)
+{
+    if (!pThread)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "pThread input passed is null! This is not valid!");
+
+        return RecluseResult_InvalidArgs;
+    }
+
+    R_DEBUG(R_CHANNEL_LINUX, "Creating thread");
+
+    LinuxThreadStart* pStart    = new LinuxThreadStart();
+    pStart->func                = startRoutine;
+    pStart->payload             = pThread->payload;
+
+    pthread_t handle            = { };
+    const I32 result            = pthread_create(&handle, nullptr, linuxThreadStart, pStart);
+
+    if (result != 0)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to create thread! Result: %d", result);
+
+        delete pStart;
+        pThread->threadState = ThreadState_Unknown;
+
+        return RecluseResult_Failed;
+    }
+
+    pThread->func           = startRoutine;
+    pThread->handle         = reinterpret_cast<void*>(static_cast<UPtr>(handle));
+    pThread->uid            = static_cast<SizeT>(handle);
+    pThread->threadState    = ThreadState_Running;
+    pThread->resultCode     = ThreadResultCode_NotReady;
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode joinThread(Thread* pThread)
+{
+    R_ASSERT(pThread != NULL);
+
+    R_DEBUG(R_CHANNEL_LINUX, "Joining thread...");
+
+    void* pResult = nullptr;
+    pthread_join(getPthread(pThread), &pResult);
+
+    pThread->resultCode     = static_cast<U32>(reinterpret_cast<UPtr>(pResult));
+    pThread->threadState    = ThreadState_NotRunning;
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode detachThread(Thread* pThread)
+{
+    R_ASSERT(pThread != NULL);
+
+    if (pthread_detach(getPthread(pThread)) != 0)
+    {
+        return RecluseResult_Failed;
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode killThread(Thread* pThread)
+{
+    R_ASSERT(pThread != NULL);
+
+    R_DEBUG(R_CHANNEL_LINUX, "Killing thread=%llu ...", (U64)pThread->uid);
+
+    pthread_cancel(getPthread(pThread));
+
+    pThread->threadState = ThreadState_Unknown;
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode stopThread(Thread* pThread)
+{
+    R_ASSERT(pThread != NULL);
+    (void)pThread;
+
+    // Pthreads can't be suspended by another thread.
+    R_WARN(R_CHANNEL_LINUX, "Suspending threads is not supported on this platform.");
+
+    return RecluseResult_NoImpl;
+}
+
+
+ResultCode resumeThread(Thread* pThread)
+{
+    R_ASSERT(pThread != NULL);
+    (void)pThread;
+
+    R_WARN(R_CHANNEL_LINUX, "Suspending threads is not supported on this platform.");
+
+    return RecluseResult_NoImpl;
+}
+
+
+ResultCode setThreadAffinity(Thread* pThread, U64 affinityMask)
+{
+    R_ASSERT(pThread != NULL);
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (U32 i = 0; i < 64u; ++i)
+    {
+        if (affinityMask & (1ull << i))
+        {
+            CPU_SET(i, &cpuSet);
+        }
+    }
+
+    const I32 result = pthread_setaffinity_np(getPthread(pThread), sizeof(cpu_set_t), &cpuSet);
+    if (result != 0)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to set thread affinity mask=0x%llx! Result: %d", affinityMask, result);
+
+        return RecluseResult_Failed;
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode setCurrentThreadAffinity(U64 affinityMask)
+{
+    Thread thread   = { };
+    thread.handle   = reinterpret_cast<void*>(static_cast<UPtr>(pthread_self()));
+    return setThreadAffinity(&thread, affinityMask);
+}
+
+
+ResultCode setThreadPriority(Thread* pThread, ThreadPriority priority)
+{
+    R_ASSERT(pThread != NULL);
+
+    // Normal threads all share the same static priority, so lower priorities move the thread
+    // to the batch and idle policies. Higher priorities need a realtime policy, which usually
+    // requires CAP_SYS_NICE.
+    I32 policy                  = SCHED_OTHER;
+    struct sched_param param    = { };
+    switch (priority)
+    {
+        case ThreadPriority_Lowest:         policy = SCHED_IDLE; break;
+        case ThreadPriority_Low:            policy = SCHED_BATCH; break;
+        case ThreadPriority_High:           policy = SCHED_RR; param.sched_priority = sched_get_priority_min(SCHED_RR); break;
+        case ThreadPriority_Highest:        policy = SCHED_RR; param.sched_priority = (sched_get_priority_min(SCHED_RR) + sched_get_priority_max(SCHED_RR)) / 2; break;
+        case ThreadPriority_TimeCritical:   policy = SCHED_RR; param.sched_priority = sched_get_priority_max(SCHED_RR); break;
+        case ThreadPriority_Normal:
+        default:                            break;
+    }
+
+    const I32 result = pthread_setschedparam(getPthread(pThread), policy, &param);
+    if (result != 0)
+    {
+        R_ERROR(R_CHANNEL_LINUX, "Failed to set thread priority=%d! Result: %d", priority, result);
+
+        return RecluseResult_Failed;
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+U32 getCurrentProcessorNumber()
+{
+    const I32 cpu = sched_getcpu();
+    return (cpu < 0) ? 0u : static_cast<U32>(cpu);
+}
+
+
+Mutex createMutex(const char* name)
+{
+    // Named mutexes are shared between processes on windows. We only support mutexes within
+    // the process, so the name is ignored.
+    (void)name;
+    LinuxMutex* pMutex = new LinuxMutex();
+    initializeLinuxMutex(pMutex);
+    return pMutex;
+}
+
+
+ResultCode destroyMutex(Mutex mutex)
+{
+    if (!mutex)
+    {
+        return RecluseResult_NullPtrExcept;
+    }
+
+    delete static_cast<LinuxMutex*>(mutex);
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode lockMutex(Mutex mutex, U64 waitMs)
+{
+    ResultCode result = lockLinuxMutex(static_cast<LinuxMutex*>(mutex), waitMs);
+    return (result == RecluseResult_Ok) ? RecluseResult_Ok : RecluseResult_Failed;
+}
+
+
+ResultCode unlockMutex(Mutex mutex)
+{
+    return unlockLinuxMutex(static_cast<LinuxMutex*>(mutex));
+}
+
+
+ResultCode waitMutex(Mutex mutex, U64 waitTimeMs)
+{
+    return lockLinuxMutex(static_cast<LinuxMutex*>(mutex), waitTimeMs);
+}
+
+
+ResultCode tryLockMutex(Mutex mutex)
+{
+    ResultCode result = lockMutex(mutex, 0ull);
+    return result;
+}
+
+
+U64 compareExchange(I64* dest, I64 ex, I64 comp)
+{
+    return static_cast<U64>(__sync_val_compare_and_swap(dest, comp, ex));
+}
+
+
+I16 compareExchange(I16* dest, I16 ex, I16 comp)
+{
+    return __sync_val_compare_and_swap(dest, comp, ex);
+}
+
+
+U128 compareExchange(U128* dest, U128 ex, U128 comp)
+{
+    // On failure comp is updated to the current value, either way it holds the original.
+    compareExchange128(dest, comp, ex);
+    return comp;
+}
+
+
+Bool testAndSet(U32* ptr, U32 offset)
+{
+    const U32 bit = (1u << offset);
+    return (__atomic_fetch_or(ptr, bit, __ATOMIC_SEQ_CST) & bit) != 0u;
+}
+
+
+ResultCode sleep(U64 milliseconds)
+{
+    if (milliseconds == kInfiniteMs)
+    {
+        for (;;)
+        {
+            pause();
+        }
+    }
+
+    struct timespec remaining = { };
+    remaining.tv_sec    = static_cast<time_t>(milliseconds / 1000ull);
+    remaining.tv_nsec   = static_cast<long>((milliseconds % 1000ull) * 1000000ull);
+
+    // Keep sleeping for the remaining time, if a signal interrupted us.
+    while (nanosleep(&remaining, &remaining) == -1 && errno == EINTR)
+    {
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode sleepPrecise(U64 nanoseconds)
+{
+    // Sleep to an absolute deadline, so being interrupted by a signal does not add drift.
+    struct timespec deadline = { };
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    const U64 totalNs   = static_cast<U64>(deadline.tv_nsec) + nanoseconds;
+    deadline.tv_sec     += static_cast<time_t>(totalNs / 1000000000ull);
+    deadline.tv_nsec    = static_cast<long>(totalNs % 1000000000ull);
+
+    I32 result = 0;
+    while ((result = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL)) == EINTR)
+    {
+    }
+
+    return (result == 0) ? RecluseResult_Ok : RecluseResult_Failed;
+}
+
+
+void yieldProcessor()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+
+void yieldThread()
+{
+    sched_yield();
+}
+
+
+void waitOnAddress(const volatile void* pAddress, U32 expected)
+{
+    futexWait(reinterpret_cast<std::atomic<U32>*>(const_cast<void*>(pAddress)), expected);
+}
+
+
+void wakeByAddress(const volatile void* pAddress, Bool wakeAll)
+{
+    futexWake(reinterpret_cast<std::atomic<U32>*>(const_cast<void*>(pAddress)), wakeAll ? static_cast<U32>(INT_MAX) : 1u);
+}
+
+
+ResultCode CriticalSection::initialize()
+{
+    R_ASSERT_FORMAT(m_section == NULL, "Critical Section is not null prior to initialization! Could indicate was already created? section=%p", m_section);
+    LinuxMutex* pMutex = new LinuxMutex();
+    initializeLinuxMutex(pMutex);
+    m_section = pMutex;
+    return RecluseResult_Ok;
+}
+
+
+ResultCode CriticalSection::release()
+{
+    R_ASSERT(m_section != NULL);
+    delete static_cast<LinuxMutex*>(m_section);
+    m_section = NULL;
+    return RecluseResult_Ok;
+}
+
+
+ResultCode CriticalSection::enter()
+{
+    R_ASSERT(m_section != NULL);
+    return lockLinuxMutex(static_cast<LinuxMutex*>(m_section), kInfiniteMs);
+}
+
+
+ResultCode CriticalSection::tryEnter()
+{
+    R_ASSERT(m_section != NULL);
+    ResultCode result = tryLockLinuxMutex(static_cast<LinuxMutex*>(m_section));
+    return ((result == RecluseResult_Ok) ? RecluseResult_Ok : RecluseResult_Failed);
+}
+
+
+ResultCode CriticalSection::leave()
+{
+    R_ASSERT(m_section != NULL);
+    return unlockLinuxMutex(static_cast<LinuxMutex*>(m_section));
+}
+} // Recluse
@@ -0,0 +1,105 @@
+//
+#include "Recluse/Threading/Locks.hpp"
+
+namespace Recluse {
+
+
+// Spins before going to sleep. Most locks are released within this time, and sleeping costs
+// two trips into the kernel.
+static constexpr U32 kMaxRWLockSpins = 128u;
+
+
+void RWLock::lockSharedSlow()
+{
+    U32 numSpins = 0;
+    for (;;)
+    {
+        U32 state = m_state.load(MemoryOrder_Relaxed);
+        if (!(state & (kWriterLocked | kWriterWaiting)))
+        {
+            if (m_state.compareExchangeWeak(state, state + 1u, MemoryOrder_Acquire))
+            {
+                return;
+            }
+            continue;
+        }
+
+        if (numSpins < kMaxRWLockSpins)
+        {
+            ++numSpins;
+            yieldProcessor();
+            continue;
+        }
+
+        // Flag that readers are asleep, so the writer knows to wake us when it unlocks.
+        const U32 sleepState = state | kReadersSleeping;
+        if ((state == sleepState) || m_state.compareExchange(state, sleepState))
+        {
+            waitOnAddress(&m_state, sleepState);
+        }
+    }
+}
+
+
+void RWLock::lockSlow()
+{
+    U32 numSpins = 0;
+    for (;;)
+    {
+        U32 state = m_state.load(MemoryOrder_Relaxed);
+        if (!(state & (kWriterLocked | kReaderMask)))
+        {
+            // Keep the flags, other writers may still be waiting, and readers may be asleep.
+            if (m_state.compareExchangeWeak(state, state | kWriterLocked, MemoryOrder_Acquire))
+            {
+                return;
+            }
+            continue;
+        }
+
+        if (numSpins < kMaxRWLockSpins)
+        {
+            ++numSpins;
+            yieldProcessor();
+            continue;
+        }
+
+        // Read the wake count before registering, so a wake up that comes in between is not
+        // lost. Registering before checking the state again makes sure that any unlock after
+        // the check sees us waiting.
+        const U32 wakeCount = m_writerWakeCount.load();
+        m_numWaitingWriters.fetchAdd(1u);
+
+        state = m_state.load();
+        if ((state & (kWriterLocked | kReaderMask)) && ((state & kWriterWaiting) || m_state.compareExchange(state, state | kWriterWaiting)))
+        {
+            waitOnAddress(&m_writerWakeCount, wakeCount);
+        }
+
+        m_numWaitingWriters.fetchSub(1u);
+    }
+}
+
+
+void RWLock::unlock()
+{
+    const U32 state = m_state.exchange(0u);
+
+    if (m_numWaitingWriters.load() > 0u)
+    {
+        wakeWriter();
+    }
+
+    if (state & kReadersSleeping)
+    {
+        wakeByAddress(&m_state, true);
+    }
+}
+
+
+void RWLock::wakeWriter()
+{
+    m_writerWakeCount.fetchAdd(1u);
+    wakeByAddress(&m_writerWakeCount, false);
+}
+} // Recluse
@@ -2,6 +2,7 @@
 #include "Recluse/Logger.hpp"
 #include "Recluse/Messaging.hpp"
 #include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Threading/Atomic.hpp"
 #include "Logging/LogFramework.hpp"
 
 #include "Recluse/Filesystem/Archive.hpp"
@@ -10,16 +11,17 @@
 
 namespace Recluse {
 
-static LoggingQueue*            loggingQueue        = nullptr;
-static Thread                   displayThread;
-static volatile B32             isLogging           = true;
-static volatile LogTypeFlags    logTypeFlags        = 
 #if defined(RECLUSE_DEBUG)
-LogTypeFlags(0xFFFFFFFF);
+static const LogTypeFlags       kDefaultLogTypeFlags = LogTypeFlags(0xFFFFFFFF);
 #else
-LogTypeFlags(0xFFFFFFFF & ~(LogType_Debug | LogType_Verbose | LogType_Trace | LogType_Info));
+static const LogTypeFlags       kDefaultLogTypeFlags = LogTypeFlags(0xFFFFFFFF & ~(LogType_Debug | LogType_Verbose | LogType_Trace | LogType_Info));
 #endif
 
+static LoggingQueue*            loggingQueue        = nullptr;
+static Thread                   displayThread;
+static Atomic<B32>              isLogging           (true);
+static Atomic<LogTypeFlags>     logTypeFlags        (kDefaultLogTypeFlags);
+
 // TODO: Might look into disabling all channels, and instead enable them manually if needed.
 static std::set<std::string> g_disabledChannels = 
 {
@@ -60,7 +62,7 @@ static void printLog(const LogMessage* log)
         default: break;
     }
 
-    if ((log->type & logTypeFlags))
+    if ((log->type & logTypeFlags.load(MemoryOrder_Relaxed)))
     {
         if (!log->time.empty())
         {
@@ -98,7 +100,7 @@ static ResultCode displayFunction(void* data)
 {
     (void)data;
 
-    while (isLogging) 
+    while (isLogging.load(MemoryOrder_Acquire)) 
     {
         LogMessage* pLog    = nullptr;
         pLog                = loggingQueue->getHead();
@@ -130,7 +132,7 @@ static Bool isDisabledChannel(const std::string& channel)
 
 Log::~Log()
 {
-    if (loggingQueue && isLogging) 
+    if (loggingQueue && isLogging.load(MemoryOrder_Acquire)) 
     {
         if (!isDisabledChannel(data.channel))
         {
@@ -208,7 +210,10 @@ void LoggingQueue::dequeue()
         m_head->logMessage.type = LogType_DontStore;
         LogNode* node           = m_head;
         m_head                  = m_head->pNext;
+        // Reconstruct the node after destroying it, cleanup() destroys every node in the pool
+        // again, and not every std::string implementation leaves a destroyed string reusable.
         node->~LogNode();
+        new (node) LogNode;
     } 
     else 
     {
@@ -272,11 +277,11 @@ void Log::initializeLoggingSystem(U32 messageCacheCount)
 {
     if (!loggingQueue) 
     {
-        loggingQueue = rlsMalloc<LoggingQueue>(sizeof(LoggingQueue));
+        loggingQueue = rlsMalloc<LoggingQueue, MemoryTag_Logging>();
         loggingQueue->initialize(static_cast<U32>(messageCacheCount));
     }
 
-    isLogging = true;
+    isLogging.store(true, MemoryOrder_Release);
 
     enableOSColorInput();
 
@@ -286,7 +291,7 @@ void Log::initializeLoggingSystem(U32 messageCacheCount)
 
 void Log::destroyLoggingSystem()
 {
-    isLogging = false;
+    isLogging.store(false, MemoryOrder_Release);
     joinThread(&displayThread);
 
     if (loggingQueue) 
@@ -313,19 +318,19 @@ LogMessage* LoggingQueue::getHead() const
 
 void setLogMask(LogTypeFlags flags)
 {
-    logTypeFlags = flags;
+    logTypeFlags.store(flags, MemoryOrder_Relaxed);
 }
 
 
 void enableLogTypes(LogTypeFlags flags)
 {
-    logTypeFlags |= flags;
+    logTypeFlags.fetchOr(flags, MemoryOrder_Relaxed);
 }
 
 
 void disableLogTypes(LogTypeFlags flags)
 {
-    logTypeFlags = logTypeFlags & (~flags);
+    logTypeFlags.fetchAnd(~flags, MemoryOrder_Relaxed);
 }
 
 
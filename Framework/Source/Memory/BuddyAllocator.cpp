@@ -4,188 +4,251 @@
 #include "Recluse/Math/MathCommons.hpp"
 #include "Recluse/Messaging.hpp"
 
-#include <math.h>
-
 namespace Recluse {
 
 
-ResultCode BuddyAllocator::onInitialize()
+// Trees deeper than this would need more bookkeeping than any pool is worth.
+static constexpr U32 kMaxBuddyOrder = 24u;
+
+
+static R_FORCE_INLINE U64 leftChild(U64 nodeIndex)
 {
-    U64 totalSzBytes    = getTotalSizeBytes();
-    UPtr baseAddr    = getBaseAddr();
+    return nodeIndex * 2ull + 1ull;
+}
 
-    // Size must be power of 2.
-    R_ASSERT(Math::isPowerOf2(totalSzBytes));
-    
-    U32 nthBit  = (U32)ceil(log2(totalSzBytes));  
 
-    m_maxOrder  = nthBit + 1;
+static R_FORCE_INLINE U64 parentOf(U64 nodeIndex)
+{
+    return (nodeIndex - 1ull) / 2ull;
+}
 
-    m_freeList.resize(m_maxOrder);
 
-    BuddyBlock block    = { };
-    block.blockId       = nthBit;
-    block.addressBytes   = baseAddr;
-    block.memSzBytes    = totalSzBytes;
+// Index of the first node holding blocks of this order.
+static R_FORCE_INLINE U64 firstNodeOfOrder(U32 maxOrder, U32 order)
+{
+    return (1ull << (maxOrder - order)) - 1ull;
+}
 
-    // Store big block as initialized to the whole memory region.
-    m_freeList[nthBit].push_back(block);
 
-    return RecluseResult_Ok;
+// Smallest order with at least numBlocks min blocks.
+static R_FORCE_INLINE U32 ceilOrder(U64 numBlocks)
+{
+    return (numBlocks <= 1ull) ? 0u : (Math::bitScanReverse(numBlocks - 1ull) + 1u);
 }
 
 
-ResultCode BuddyAllocator::onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment)
+BuddyAllocator::BuddyAllocator(U64 minBlockSizeBytes)
+    : m_pTree(nullptr)
+    , m_minBlockSizeBytes(minBlockSizeBytes)
+    , m_minBlockSizeLog2(0)
+    , m_maxOrder(0)
+    , m_usableSizeBytes(0)
+    , m_baseAlignmentBytes(0)
+{
+    R_ASSERT(minBlockSizeBytes && Math::isPowerOf2(minBlockSizeBytes));
+    m_minBlockSizeLog2 = Math::bitScanForward(minBlockSizeBytes);
+}
+
+
+BuddyAllocator::~BuddyAllocator()
 {
-    R_ASSERT(Math::isPowerOf2(alignment));
-    U64 neededSzBytes   = requestSz + (alignment - 1);
-    
-    U32 nthBit          = (U32)ceil(log2(neededSzBytes));
-    
-    if (m_freeList[nthBit].size() > 0) 
+    onCleanUp();
+}
+
+
+ResultCode BuddyAllocator::onInitialize()
+{
+    // Sizes that are not a power of 2 are fine, the root block covers the next power of 2,
+    // and the tail past the end is reserved up front.
+    const U64 numBlocks = getTotalSizeBytes() >> m_minBlockSizeLog2;
+    if (numBlocks == 0ull)
     {
-        BuddyBlock block = m_freeList[nthBit][0];
-        m_freeList[nthBit].erase(m_freeList[nthBit].begin());
-        U64 blockAddress                        = block.addressBytes;
-        pOutput->baseAddress                    = align(block.addressBytes, alignment);
-        pOutput->sizeBytes                      = block.memSzBytes;
-        m_allocatedBlocks[pOutput->baseAddress] = makeBlockAllocation(blockAddress, block.memSzBytes);
-    } 
-    else 
+        R_ERROR("BuddyAllocator", "Memory given is smaller than the min block size (%llu bytes)!", m_minBlockSizeBytes);
+        return RecluseResult_InvalidArgs;
+    }
+
+    m_maxOrder = ceilOrder(numBlocks);
+    if (m_maxOrder > kMaxBuddyOrder)
     {
-        U32 i = 0;
-        for (i = nthBit + 1; i < m_maxOrder; ++i) 
-        {
-            if (m_freeList[i].size() != 0) 
-            {
-                break;
-            }
+        R_ERROR("BuddyAllocator", "Memory given needs too many min blocks, raise the min block size!");
+        return RecluseResult_InvalidArgs;
+    }
 
-        }
+    const UPtr baseAddr     = getBaseAddr();
+    m_usableSizeBytes       = numBlocks << m_minBlockSizeLog2;
+    m_baseAlignmentBytes    = baseAddr ? (1ull << Math::bitScanForward(baseAddr)) : ~0ull;
 
-        if (i == m_maxOrder) 
-        {
-            return RecluseResult_OutOfMemory;   
-        } 
-        else 
+    delete[] m_pTree;
+    m_pTree = new U8[(2ull << m_maxOrder) - 1ull];
+    resetTree();
+    return RecluseResult_Ok;
+}
+
+
+void BuddyAllocator::resetTree()
+{
+    // Fully free, every node holds its own order.
+    for (U32 order = 0; order <= m_maxOrder; ++order)
+    {
+        const U64 first = firstNodeOfOrder(m_maxOrder, order);
+        for (U64 i = 0; i < (1ull << (m_maxOrder - order)); ++i)
         {
-            BuddyBlock block    = { };
-            block               = m_freeList[i][0];
-
-            // Split block into halves.
-            m_freeList[i].erase(m_freeList[i].begin());
-            i--;
-
-            for (; i >= nthBit; --i) 
-            {
-                // split to two blocks and push back.
-                BuddyBlock blockLeft;
-                BuddyBlock blockRight;
-                
-                blockLeft.addressBytes   = block.addressBytes;
-                blockLeft.memSzBytes    = (block.memSzBytes >> 1ull);
-                
-                blockRight.addressBytes  = blockLeft.addressBytes + blockLeft.memSzBytes;
-                blockRight.memSzBytes   = (block.memSzBytes >> 1ull);
-
-                m_freeList[i].push_back(blockLeft);
-                m_freeList[i].push_back(blockRight);
-
-                block = m_freeList[i][0];
-                m_freeList[i].erase(m_freeList[i].begin());
-            }
-        
-            // Allocate the buddy block. Use the aligned address as the key to the mapped buddy block.
-            U64 blockAddress                        = block.addressBytes;
-            pOutput->baseAddress                    = align(blockAddress, alignment);
-            pOutput->sizeBytes                      = block.memSzBytes;
-            m_allocatedBlocks[pOutput->baseAddress] = makeBlockAllocation(blockAddress, block.memSzBytes);
+            m_pTree[first + i] = static_cast<U8>(order + 1u);
         }
     }
 
-    return RecluseResult_Ok;
+    reserveTail(0ull, m_maxOrder, 0ull);
 }
 
 
-ResultCode BuddyAllocator::onFree(Allocation* pOutput)
+// Marks every block past the usable size as taken. Only descends into nodes that straddle the
+// end, so this touches O(log n) nodes.
+void BuddyAllocator::reserveTail(U64 nodeIndex, U32 order, U64 offsetBytes)
 {
-    if (m_allocatedBlocks.find(pOutput->baseAddress) == m_allocatedBlocks.end()) 
+    const U64 blockSizeBytes = m_minBlockSizeBytes << order;
+    if (offsetBytes + blockSizeBytes <= m_usableSizeBytes)
     {
-        return RecluseResult_Failed;
-    
+        return;
     }
 
-    // Get the block allocation using the aligned address.
-    const BlockAllocation& blockAllocation = m_allocatedBlocks[pOutput->baseAddress];    
+    if (offsetBytes >= m_usableSizeBytes)
+    {
+        m_pTree[nodeIndex] = 0;
+        return;
+    }
 
-    UPtr baseAddr    = getBaseAddr();
-    //U64 szBytes         = pOutput->sizeBytes;
-    U32 nthBit          = (U32)ceil(log2(blockAllocation.sizeBytes));
-    U32 buddyNumber     = (U32)(blockAllocation.baseAddress / blockAllocation.sizeBytes);
-    SizeT buddyAddr     = 0;
-    U64 allocOffset     = blockAllocation.baseAddress - baseAddr;
+    const U64 left = leftChild(nodeIndex);
+    reserveTail(left, order - 1u, offsetBytes);
+    reserveTail(left + 1ull, order - 1u, offsetBytes + (blockSizeBytes >> 1ull));
 
-    // memSzBytes is always the power of our N-th value.
-    BuddyBlock block    = { };
-    block.addressBytes   = allocOffset;
-    block.memSzBytes    = (1ull << nthBit);
+    const U8 leftValue  = m_pTree[left];
+    const U8 rightValue = m_pTree[left + 1ull];
+    m_pTree[nodeIndex]  = (leftValue > rightValue) ? leftValue : rightValue;
+}
 
-    m_freeList[nthBit].push_back(block);
 
-    buddyAddr = (buddyNumber & 1)
-        ? (allocOffset - (1ull << nthBit)) 
-        : (allocOffset + (1ull << nthBit));
+// Recomputes the nodes above nodeIndex, which holds a block of the given order. Two fully
+// free buddies merge into one free block of the order above.
+void BuddyAllocator::updateParents(U64 nodeIndex, U32 order)
+{
+    while (nodeIndex > 0ull)
+    {
+        nodeIndex           = parentOf(nodeIndex);
+        const U8 leftValue  = m_pTree[leftChild(nodeIndex)];
+        const U8 rightValue = m_pTree[leftChild(nodeIndex) + 1ull];
+        const U8 fullValue  = static_cast<U8>(order + 1u);
+        order              += 1u;
+        m_pTree[nodeIndex]  = ((leftValue == fullValue) && (rightValue == fullValue))
+            ? static_cast<U8>(order + 1u)
+            : ((leftValue > rightValue) ? leftValue : rightValue);
+    }
+}
+
+
+ResultCode BuddyAllocator::onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment)
+{
+    R_ASSERT(!alignment || Math::isPowerOf2(alignment));
+
+    // Blocks are aligned to their size, relative to the base, so alignment only needs a large
+    // enough block. Unless the base address is less aligned than that.
+    if (alignment > m_baseAlignmentBytes)
+    {
+        R_ERROR("BuddyAllocator", "Alignment %d is larger than the base address alignment!", alignment);
+        return RecluseResult_InvalidArgs;
+    }
+
+    const U64 sizeBytes     = (requestSz > alignment) ? requestSz : alignment;
+    const U32 order         = ceilOrder((sizeBytes + m_minBlockSizeBytes - 1ull) >> m_minBlockSizeLog2);
+    const U8 neededValue    = static_cast<U8>(order + 1u);
+    if (!m_pTree || (order > m_maxOrder) || (m_pTree[0] < neededValue))
+    {
+        return RecluseResult_OutOfMemory;
+    }
+
+    // Walk down to a node of the needed order. When both children fit, take the one with
+    // less free space, keeping the large free blocks intact for later.
+    U64 nodeIndex = 0ull;
+    for (U32 nodeOrder = m_maxOrder; nodeOrder > order; --nodeOrder)
+    {
+        const U64 left      = leftChild(nodeIndex);
+        const U8 leftValue  = m_pTree[left];
+        const U8 rightValue = m_pTree[left + 1ull];
+        const Bool useLeft  = (leftValue >= neededValue) && ((rightValue < neededValue) || (leftValue <= rightValue));
+        nodeIndex           = useLeft ? left : (left + 1ull);
+    }
+
+    m_pTree[nodeIndex] = 0;
+    updateParents(nodeIndex, order);
+
+    const U64 offsetBytes   = (nodeIndex - firstNodeOfOrder(m_maxOrder, order)) << (order + m_minBlockSizeLog2);
+    pOutput->baseAddress    = getBaseAddr() + offsetBytes;
+    pOutput->sizeBytes      = m_minBlockSizeBytes << order;
+    return RecluseResult_Ok;
+}
+
+
+ResultCode BuddyAllocator::onFree(Allocation* pOutput)
+{
+    const U64 offsetBytes = pOutput->baseAddress - getBaseAddr();
+    if (!m_pTree || (pOutput->baseAddress < getBaseAddr()) || (offsetBytes >= m_usableSizeBytes) || (offsetBytes & (m_minBlockSizeBytes - 1ull)))
+    {
+        R_ERROR("BuddyAllocator", "Freeing 0x%llx, which is not owned by this allocator!", static_cast<U64>(pOutput->baseAddress));
+        return RecluseResult_InvalidArgs;
+    }
 
-    //
-    for (U32 i = 0; i < m_freeList[nthBit].size(); ++i) 
+    // Nodes under an allocated block are left as they were, fully free, so the first taken
+    // node up from the leaf is the block itself.
+    U64 nodeIndex   = firstNodeOfOrder(m_maxOrder, 0u) + (offsetBytes >> m_minBlockSizeLog2);
+    U32 order       = 0u;
+    while (m_pTree[nodeIndex] != 0)
     {
-        // Merge blocks together, if applicable.
-        if (m_freeList[nthBit][i].addressBytes == buddyAddr) 
+        if (nodeIndex == 0ull)
         {
-            // Check if even, merge with alloc offset. Otherwise, use buddyaddr
-            if (Math::isEven(buddyNumber)) 
-            {
-                BuddyBlock newBlock     = { };
-                newBlock.addressBytes    = allocOffset;
-                newBlock.memSzBytes     = 2ull * (1ull << nthBit);
-                m_freeList[nthBit + 1].push_back(newBlock);
-             
-            } 
-            else 
-            {
-                BuddyBlock newBlock     = { };
-                newBlock.addressBytes    = buddyAddr;
-                newBlock.memSzBytes     = 2ull * (1ull << nthBit);
-                m_freeList[nthBit + 1].push_back(newBlock);
-            
-            }
-
-            m_freeList[nthBit].erase(m_freeList[nthBit].begin() + i);
-            m_freeList[nthBit].erase(m_freeList[nthBit].begin() + m_freeList[nthBit].size() - 1);
-
-            break;
+            R_ERROR("BuddyAllocator", "Freeing 0x%llx, which is not allocated!", static_cast<U64>(pOutput->baseAddress));
+            return RecluseResult_CorruptMemory;
         }
+        nodeIndex   = parentOf(nodeIndex);
+        order      += 1u;
+    }
+
+    const U64 blockSizeBytes = m_minBlockSizeBytes << order;
+    if (offsetBytes & (blockSizeBytes - 1ull))
+    {
+        R_ERROR("BuddyAllocator", "Freeing 0x%llx, which is not the start of a block!", static_cast<U64>(pOutput->baseAddress));
+        return RecluseResult_InvalidArgs;
     }
 
-    // Erase the block after, using the aligned address.
-    pOutput->sizeBytes = blockAllocation.sizeBytes;
-    m_allocatedBlocks.erase(pOutput->baseAddress);
+    m_pTree[nodeIndex] = static_cast<U8>(order + 1u);
+    updateParents(nodeIndex, order);
+
+    pOutput->sizeBytes = blockSizeBytes;
     return RecluseResult_Ok;
 }
 
 
+U64 BuddyAllocator::getLargestFreeBlockBytes() const
+{
+    return (m_pTree && m_pTree[0]) ? (m_minBlockSizeBytes << (m_pTree[0] - 1u)) : 0ull;
+}
+
+
 ResultCode BuddyAllocator::onReset()
 {
-    return RecluseResult_NoImpl;
+    if (m_pTree)
+    {
+        resetTree();
+    }
+    return RecluseResult_Ok;
 }
 
 
 ResultCode BuddyAllocator::onCleanUp()
 {
     // Wipe out everything.
-    m_freeList.clear();
-    m_allocatedBlocks.clear();
-
+    delete[] m_pTree;
+    m_pTree             = nullptr;
+    m_maxOrder          = 0;
+    m_usableSizeBytes   = 0;
     return RecluseResult_Ok;
 }
-} // Recluse
\ No newline at end of file
+} // Recluse
@@ -0,0 +1,205 @@
+//
+#include "Recluse/Memory/ConcurrentLinearAllocator.hpp"
+#include "Recluse/Threading/Locks.hpp"
+#include "Recluse/Math/MathCommons.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <new>
+
+namespace Recluse {
+
+
+// Chunk of the arena a thread is bumping through, and the statistics of whoever used the slot.
+// Slots are locked, since threads may end up sharing one, but the lock is almost never
+// contended. The counters are only written under the lock, and read by anyone.
+struct alignas(kCacheLineSizeBytes) ConcurrentLinearSlot
+{
+    SpinLock        lock;
+    UPtr            cursor;
+    UPtr            end;
+    Atomic<U64>     usedSizeBytes;
+    Atomic<U64>     numAllocations;
+};
+
+
+static Atomic<U32> g_nextThreadSlot;
+
+
+static U32 getThreadSlot()
+{
+    static thread_local U32 threadSlot = g_nextThreadSlot.fetchAdd(1u, MemoryOrder_Relaxed);
+    return threadSlot % ConcurrentLinearAllocator::kMaxSlots;
+}
+
+
+ConcurrentLinearAllocator::ConcurrentLinearAllocator(U64 chunkSizeBytes)
+    : m_chunkSizeBytes(chunkSizeBytes)
+    , m_top(0ull)
+    , m_numFreed(0ull)
+    , m_pMetadata(nullptr)
+    , m_pSlots(nullptr)
+{
+    R_ASSERT(chunkSizeBytes > 0ull);
+    disableSharedStatistics();
+}
+
+
+ConcurrentLinearAllocator::~ConcurrentLinearAllocator()
+{
+    onCleanUp();
+}
+
+
+ResultCode ConcurrentLinearAllocator::onInitialize()
+{
+    // Aligned by hand, since new[] doesn't respect cache line alignment before c++17.
+    delete[] m_pMetadata;
+    m_pMetadata         = new U8[sizeof(ConcurrentLinearSlot) * kMaxSlots + kCacheLineSizeBytes];
+    m_pSlots            = reinterpret_cast<ConcurrentLinearSlot*>(align(reinterpret_cast<UPtr>(m_pMetadata), kCacheLineSizeBytes));
+
+    for (U32 i = 0; i < kMaxSlots; ++i)
+    {
+        new (&m_pSlots[i]) ConcurrentLinearSlot();
+    }
+
+    resetState();
+    return RecluseResult_Ok;
+}
+
+
+void ConcurrentLinearAllocator::resetState()
+{
+    m_top.store(0ull, MemoryOrder_Relaxed);
+    m_numFreed.store(0ull, MemoryOrder_Relaxed);
+    for (U32 i = 0; i < kMaxSlots; ++i)
+    {
+        ConcurrentLinearSlot& slot = m_pSlots[i];
+        slot.cursor = 0ull;
+        slot.end    = 0ull;
+        slot.usedSizeBytes.store(0ull, MemoryOrder_Relaxed);
+        slot.numAllocations.store(0ull, MemoryOrder_Relaxed);
+    }
+}
+
+
+ResultCode ConcurrentLinearAllocator::onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment)
+{
+    R_ASSERT(Math::isPowerOf2(alignment));
+    if (!m_pSlots)
+    {
+        return RecluseResult_NullPtrExcept;
+    }
+
+    const UPtr baseAddr         = getBaseAddr();
+    const U64 totalSizeBytes    = getTotalSizeBytes();
+    ConcurrentLinearSlot* pSlot = &m_pSlots[getThreadSlot()];
+    ScopedSpinLock lock(pSlot->lock);
+
+    UPtr address = align(pSlot->cursor, alignment);
+    if (!pSlot->cursor || (address + requestSz > pSlot->end))
+    {
+        // Anything larger than half a chunk would waste too much of one, so it goes straight
+        // to the shared top, and the thread keeps bumping through the chunk it has.
+        const U64 neededSzBytes = requestSz + alignment - 1u;
+        if (neededSzBytes > (m_chunkSizeBytes >> 1ull))
+        {
+            const U64 offset = m_top.fetchAdd(neededSzBytes, MemoryOrder_Relaxed);
+            if (offset + neededSzBytes > totalSizeBytes)
+            {
+                return RecluseResult_OutOfMemory;
+            }
+
+            pOutput->baseAddress    = align(baseAddr + offset, alignment);
+            pOutput->sizeBytes      = neededSzBytes;
+            pSlot->usedSizeBytes.store(pSlot->usedSizeBytes.load(MemoryOrder_Relaxed) + neededSzBytes, MemoryOrder_Relaxed);
+            pSlot->numAllocations.store(pSlot->numAllocations.load(MemoryOrder_Relaxed) + 1ull, MemoryOrder_Relaxed);
+            return RecluseResult_Ok;
+        }
+
+        // The rest of the old chunk is left behind. The last chunk may come up short, at the
+        // end of the arena.
+        const U64 offset = m_top.fetchAdd(m_chunkSizeBytes, MemoryOrder_Relaxed);
+        if (offset >= totalSizeBytes)
+        {
+            return RecluseResult_OutOfMemory;
+        }
+
+        const U64 endOffset = offset + m_chunkSizeBytes;
+        pSlot->cursor       = baseAddr + offset;
+        pSlot->end          = baseAddr + ((endOffset < totalSizeBytes) ? endOffset : totalSizeBytes);
+        address             = align(pSlot->cursor, alignment);
+        if (address + requestSz > pSlot->end)
+        {
+            return RecluseResult_OutOfMemory;
+        }
+    }
+
+    const U64 sizeBytes     = (address + requestSz) - pSlot->cursor;
+    pSlot->cursor           = address + requestSz;
+    pOutput->baseAddress    = address;
+    pOutput->sizeBytes      = sizeBytes;
+    pSlot->usedSizeBytes.store(pSlot->usedSizeBytes.load(MemoryOrder_Relaxed) + sizeBytes, MemoryOrder_Relaxed);
+    pSlot->numAllocations.store(pSlot->numAllocations.load(MemoryOrder_Relaxed) + 1ull, MemoryOrder_Relaxed);
+    return RecluseResult_Ok;
+}
+
+
+ResultCode ConcurrentLinearAllocator::onFree(Allocation* pOutput)
+{
+    // Nothing is given back until reset, but the allocation no longer counts as live. Otherwise
+    // reset() would report it released a second time.
+    pOutput->sizeBytes = 0ull;
+    m_numFreed.fetchAdd(1ull, MemoryOrder_Relaxed);
+    return RecluseResult_Ok;
+}
+
+
+U64 ConcurrentLinearAllocator::getReservedSizeBytes() const
+{
+    const U64 top = m_top.load(MemoryOrder_Relaxed);
+    return (top < getTotalSizeBytes()) ? top : getTotalSizeBytes();
+}
+
+
+U64 ConcurrentLinearAllocator::getUsedSizeBytes() const
+{
+    U64 usedSizeBytes = 0ull;
+    for (U32 i = 0; m_pSlots && (i < kMaxSlots); ++i)
+    {
+        usedSizeBytes += m_pSlots[i].usedSizeBytes.load(MemoryOrder_Relaxed);
+    }
+    return usedSizeBytes;
+}
+
+
+U64 ConcurrentLinearAllocator::getTotalAllocations() const
+{
+    U64 numAllocations = 0ull;
+    for (U32 i = 0; m_pSlots && (i < kMaxSlots); ++i)
+    {
+        numAllocations += m_pSlots[i].numAllocations.load(MemoryOrder_Relaxed);
+    }
+    const U64 numFreed = m_numFreed.load(MemoryOrder_Relaxed);
+    return (numAllocations > numFreed) ? numAllocations - numFreed : 0ull;
+}
+
+
+ResultCode ConcurrentLinearAllocator::onReset()
+{
+    if (m_pSlots)
+    {
+        resetState();
+    }
+    return RecluseResult_Ok;
+}
+
+
+ResultCode ConcurrentLinearAllocator::onCleanUp()
+{
+    delete[] m_pMetadata;
+    m_pMetadata = nullptr;
+    m_pSlots    = nullptr;
+    m_top.store(0ull, MemoryOrder_Relaxed);
+    return RecluseResult_Ok;
+}
+} // Recluse
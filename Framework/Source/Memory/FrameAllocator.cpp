@@ -0,0 +1,231 @@
+//
+#include "Recluse/Memory/FrameAllocator.hpp"
+#include "Recluse/Memory/LinearAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+#include "Recluse/Messaging.hpp"
+
+namespace Recluse {
+
+// Committed up front for each arena, enough for a quiet frame without growing.
+static constexpr U64 kInitialCommitBytes = R_KB(64);
+// Frame index of an arena that has not served a frame yet.
+static constexpr U64 kNoFrame            = ~0ull;
+
+
+struct FrameArena
+{
+    MemoryPool          pool;
+    LinearAllocator     allocator;
+    // Frame the allocator currently holds data for. Only the owning thread writes it, right
+    // after resetting the allocator, other threads read it to tell if the counters are current.
+    Atomic<U64>         frameIndex;
+};
+
+
+// Arenas of one thread, one per frame in flight. Only the owning thread allocates from them,
+// or resets them, which it does on its first get() of each frame.
+struct FrameThreadArenas
+{
+    FrameArena          arenas[FrameAllocator::kMaxFramesInFlight];
+};
+
+
+static Atomic<FrameThreadArenas*>   g_threadArenas[FrameAllocator::kMaxThreads];
+static Atomic<U32>                  g_numThreads;
+static Atomic<U64>                  g_currentFrame;
+// 0 while not initialized. Bumped on each initialize(), so threads know to register again.
+static Atomic<U32>                  g_generation;
+static U32                          g_lastGeneration        = 0u;
+static U32                          g_numFramesInFlight     = 0u;
+static U64                          g_arenaSizeBytes        = 0ull;
+static U64                          g_bufferFrames[FrameAllocator::kMaxFramesInFlight];
+static Bool                         g_bufferUsed[FrameAllocator::kMaxFramesInFlight];
+static FrameAllocatorStats          g_retiredStats;
+
+static thread_local FrameThreadArenas*  t_pArenas       = nullptr;
+static thread_local U32                 t_generation    = 0u;
+
+
+static FrameThreadArenas* registerThread()
+{
+    const U32 slot = g_numThreads.fetchAdd(1u, MemoryOrder_Relaxed);
+    if (slot >= FrameAllocator::kMaxThreads)
+    {
+        R_ERROR("FrameAllocator", "More than %d threads are using frame arenas!", FrameAllocator::kMaxThreads);
+        return nullptr;
+    }
+
+    FrameThreadArenas* pArenas = new FrameThreadArenas();
+    for (U32 i = 0; i < g_numFramesInFlight; ++i)
+    {
+        FrameArena& arena = pArenas->arenas[i];
+        if (arena.pool.reserve(g_arenaSizeBytes, kInitialCommitBytes) != RecluseResult_Ok)
+        {
+            R_ERROR("FrameAllocator", "Failed to reserve a frame arena of %llu MB!", g_arenaSizeBytes / R_1MB);
+            delete pArenas;
+            return nullptr;
+        }
+        arena.allocator.setBackingPool(&arena.pool);
+        arena.allocator.setMemoryTag(MemoryTag_Frame);
+        arena.allocator.initialize(arena.pool.getBaseAddress(), arena.pool.getTotalSizeBytes());
+        arena.frameIndex.store(kNoFrame, MemoryOrder_Relaxed);
+    }
+
+    g_threadArenas[slot].store(pArenas, MemoryOrder_Release);
+    return pArenas;
+}
+
+
+// Adds up the arenas of a buffer, over every thread. Arenas their thread has not reset for
+// the frame yet hold an older frame, and are left out.
+static FrameAllocatorStats gatherStats(U32 buffer, U64 frameIndex)
+{
+    FrameAllocatorStats stats   = { };
+    stats.frameIndex            = frameIndex;
+
+    const U32 numThreads = g_numThreads.load(MemoryOrder_Acquire);
+    for (U32 i = 0; (i < numThreads) && (i < FrameAllocator::kMaxThreads); ++i)
+    {
+        FrameThreadArenas* pArenas = g_threadArenas[i].load(MemoryOrder_Acquire);
+        if (!pArenas)
+        {
+            continue;
+        }
+
+        FrameArena& arena = pArenas->arenas[buffer];
+        if (arena.frameIndex.load(MemoryOrder_Acquire) != frameIndex)
+        {
+            continue;
+        }
+
+        const U64 numAllocations    = arena.allocator.getTotalAllocations();
+        stats.allocatedBytes       += arena.allocator.getUsedSizeBytes();
+        stats.numAllocations       += numAllocations;
+        stats.numThreads           += numAllocations ? 1u : 0u;
+    }
+
+    return stats;
+}
+
+
+ResultCode FrameAllocator::initialize(U32 numFramesInFlight, U64 arenaSizeBytes)
+{
+    if (g_generation.load(MemoryOrder_Relaxed))
+    {
+        R_WARN("FrameAllocator", "Frame arenas are already initialized! Call cleanUp() first.");
+        return RecluseResult_AlreadyExists;
+    }
+
+    if (!numFramesInFlight || (numFramesInFlight > kMaxFramesInFlight) || !arenaSizeBytes)
+    {
+        R_ERROR("FrameAllocator", "Need 1 to %d frames in flight, and a non zero arena size!", kMaxFramesInFlight);
+        return RecluseResult_InvalidArgs;
+    }
+
+    g_numFramesInFlight = numFramesInFlight;
+    g_arenaSizeBytes    = arenaSizeBytes;
+    g_retiredStats      = { };
+    for (U32 i = 0; i < kMaxFramesInFlight; ++i)
+    {
+        g_bufferFrames[i]   = 0ull;
+        g_bufferUsed[i]     = false;
+    }
+
+    g_numThreads.store(0u, MemoryOrder_Relaxed);
+    g_currentFrame.store(0ull, MemoryOrder_Relaxed);
+    g_generation.store(++g_lastGeneration, MemoryOrder_Release);
+    return RecluseResult_Ok;
+}
+
+
+void FrameAllocator::cleanUp()
+{
+    g_generation.store(0u, MemoryOrder_Release);
+
+    const U32 numThreads = g_numThreads.exchange(0u, MemoryOrder_AcquireRelease);
+    for (U32 i = 0; (i < numThreads) && (i < kMaxThreads); ++i)
+    {
+        FrameThreadArenas* pArenas = g_threadArenas[i].exchange(nullptr, MemoryOrder_Acquire);
+        if (pArenas)
+        {
+            for (U32 j = 0; j < g_numFramesInFlight; ++j)
+            {
+                pArenas->arenas[j].allocator.cleanUp();
+            }
+            delete pArenas;
+        }
+    }
+}
+
+
+void FrameAllocator::beginFrame(U64 frameIndex)
+{
+    R_ASSERT_FORMAT(g_generation.load(MemoryOrder_Relaxed), "Frame arenas are not initialized!");
+
+    // Whatever this buffer held belongs to a frame that has retired by now. Its arenas are not
+    // touched here, each thread resets its own once it sees the new frame, which can only happen
+    // after the stats below are read.
+    const U32 buffer = static_cast<U32>(frameIndex % g_numFramesInFlight);
+    if (g_bufferUsed[buffer])
+    {
+        g_retiredStats = gatherStats(buffer, g_bufferFrames[buffer]);
+    }
+
+    g_bufferFrames[buffer]  = frameIndex;
+    g_bufferUsed[buffer]    = true;
+    g_currentFrame.store(frameIndex, MemoryOrder_Release);
+}
+
+
+Allocator* FrameAllocator::get()
+{
+    const U32 generation = g_generation.load(MemoryOrder_Acquire);
+    if (!generation)
+    {
+        R_ASSERT_FORMAT(false, "Frame arenas are not initialized!");
+        return nullptr;
+    }
+
+    if (t_generation != generation)
+    {
+        t_pArenas       = registerThread();
+        t_generation    = generation;
+    }
+
+    if (!t_pArenas)
+    {
+        return nullptr;
+    }
+
+    // First use of this buffer since it was recycled, drop what it held for the retired frame.
+    const U64 frameIndex    = g_currentFrame.load(MemoryOrder_Acquire);
+    FrameArena& arena       = t_pArenas->arenas[frameIndex % g_numFramesInFlight];
+    if (arena.frameIndex.load(MemoryOrder_Relaxed) != frameIndex)
+    {
+        arena.allocator.reset();
+        arena.frameIndex.store(frameIndex, MemoryOrder_Release);
+    }
+
+    return &arena.allocator;
+}
+
+
+FrameAllocatorStats FrameAllocator::getFrameStats()
+{
+    const U64 frameIndex = g_currentFrame.load(MemoryOrder_Acquire);
+    return gatherStats(static_cast<U32>(frameIndex % g_numFramesInFlight), frameIndex);
+}
+
+
+FrameAllocatorStats FrameAllocator::getRetiredFrameStats()
+{
+    return g_retiredStats;
+}
+
+
+U32 FrameAllocator::getNumFramesInFlight()
+{
+    return g_numFramesInFlight;
+}
+} // Recluse
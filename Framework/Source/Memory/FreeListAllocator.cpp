@@ -0,0 +1,404 @@
+//
+#include "Recluse/Memory/FreeListAllocator.hpp"
+#include "Recluse/Math/MathCommons.hpp"
+#include "Recluse/Messaging.hpp"
+
+namespace Recluse {
+
+
+// Block header. The boundary tag and size sit right before the payload. The free list links
+// are only valid while the block is free, and overlap the payload otherwise.
+struct FreeListBlock
+{
+    FreeListBlock*  pPrevPhysical;
+    // Payload size in bytes, always a multiple of kBlockAlignment, so the low bits hold flags.
+    U64             sizeAndFlags;
+    FreeListBlock*  pNextFree;
+    FreeListBlock*  pPrevFree;
+};
+
+
+static constexpr U64 kBlockFreeFlag         = 1ull;
+static constexpr U64 kBlockSizeMask         = ~static_cast<U64>(FreeListAllocator::kBlockAlignment - 1u);
+// Bytes a used block costs on top of its payload.
+static constexpr U64 kBlockOverheadBytes    = 2ull * sizeof(void*);
+// Free blocks need room for their list links.
+static constexpr U64 kMinBlockSizeBytes     = 2ull * sizeof(void*);
+static constexpr U64 kSmallBlockSizeBytes   = 1ull << FreeListAllocator::kFirstLevelShift;
+static constexpr U64 kMaxBlockSizeBytes     = 1ull << FreeListAllocator::kMaxBlockSizeLog2;
+
+static_assert(kBlockOverheadBytes % FreeListAllocator::kBlockAlignment == 0, "Block headers must keep payloads aligned.");
+
+
+static R_FORCE_INLINE U64 getSize(const FreeListBlock* pBlock)
+{
+    return pBlock->sizeAndFlags & kBlockSizeMask;
+}
+
+
+static R_FORCE_INLINE Bool isFree(const FreeListBlock* pBlock)
+{
+    return (pBlock->sizeAndFlags & kBlockFreeFlag) != 0;
+}
+
+
+static R_FORCE_INLINE void setSize(FreeListBlock* pBlock, U64 sizeBytes)
+{
+    pBlock->sizeAndFlags = sizeBytes | (pBlock->sizeAndFlags & ~kBlockSizeMask);
+}
+
+
+static R_FORCE_INLINE void setFree(FreeListBlock* pBlock, Bool free)
+{
+    pBlock->sizeAndFlags = free ? (pBlock->sizeAndFlags | kBlockFreeFlag) : (pBlock->sizeAndFlags & ~kBlockFreeFlag);
+}
+
+
+static R_FORCE_INLINE UPtr getPayload(const FreeListBlock* pBlock)
+{
+    return reinterpret_cast<UPtr>(pBlock) + kBlockOverheadBytes;
+}
+
+
+static R_FORCE_INLINE FreeListBlock* getBlockFromPayload(UPtr payload)
+{
+    return reinterpret_cast<FreeListBlock*>(payload - kBlockOverheadBytes);
+}
+
+
+static R_FORCE_INLINE FreeListBlock* getNextPhysical(const FreeListBlock* pBlock)
+{
+    return reinterpret_cast<FreeListBlock*>(getPayload(pBlock) + getSize(pBlock));
+}
+
+
+// Bin that a block of this size belongs to.
+static void mapInsert(U64 sizeBytes, U32& firstLevel, U32& secondLevel)
+{
+    if (sizeBytes < kSmallBlockSizeBytes)
+    {
+        firstLevel  = 0;
+        secondLevel = static_cast<U32>(sizeBytes / (kSmallBlockSizeBytes / FreeListAllocator::kSecondLevelCount));
+    }
+    else
+    {
+        const U32 highestBit    = Math::bitScanReverse(sizeBytes);
+        secondLevel             = static_cast<U32>(sizeBytes >> (highestBit - FreeListAllocator::kSecondLevelCountLog2)) ^ FreeListAllocator::kSecondLevelCount;
+        firstLevel              = highestBit - (FreeListAllocator::kFirstLevelShift - 1u);
+    }
+}
+
+
+// First bin where every block is large enough for this size. Rounds up to the next bin,
+// so any block found fits without searching the list.
+static void mapSearch(U64 sizeBytes, U32& firstLevel, U32& secondLevel)
+{
+    if (sizeBytes >= kSmallBlockSizeBytes)
+    {
+        sizeBytes += (1ull << (Math::bitScanReverse(sizeBytes) - FreeListAllocator::kSecondLevelCountLog2)) - 1ull;
+    }
+    mapInsert(sizeBytes, firstLevel, secondLevel);
+}
+
+
+FreeListAllocator::FreeListAllocator()
+    : m_firstLevelBitmap(0)
+    , m_pFirstBlock(nullptr)
+    , m_pSentinel(nullptr)
+{
+    onCleanUp();
+}
+
+
+ResultCode FreeListAllocator::onInitialize()
+{
+    const UPtr baseAddr = align(getBaseAddr(), kBlockAlignment);
+    const UPtr endAddr  = (getBaseAddr() + getTotalSizeBytes()) & kBlockSizeMask;
+
+    // Room for one block, plus the sentinel header.
+    if ((endAddr <= baseAddr) || (endAddr - baseAddr < 2ull * kBlockOverheadBytes + kMinBlockSizeBytes))
+    {
+        R_ERROR("FreeListAllocator", "Memory given is too small to hold any block!");
+        return RecluseResult_InvalidArgs;
+    }
+
+    if (endAddr - baseAddr - 2ull * kBlockOverheadBytes >= kMaxBlockSizeBytes)
+    {
+        R_ERROR("FreeListAllocator", "Memory given is larger than the max block size!");
+        return RecluseResult_InvalidArgs;
+    }
+
+    m_pFirstBlock   = reinterpret_cast<FreeListBlock*>(baseAddr);
+    m_pSentinel     = reinterpret_cast<FreeListBlock*>(endAddr - kBlockOverheadBytes);
+    resetBlocks();
+    return RecluseResult_Ok;
+}
+
+
+void FreeListAllocator::resetBlocks()
+{
+    m_firstLevelBitmap = 0;
+    for (U32 fl = 0; fl < kFirstLevelCount; ++fl)
+    {
+        m_secondLevelBitmaps[fl] = 0;
+        for (U32 sl = 0; sl < kSecondLevelCount; ++sl)
+        {
+            m_freeLists[fl][sl] = nullptr;
+        }
+    }
+
+    if (!m_pFirstBlock)
+    {
+        return;
+    }
+
+    // One free block spanning the whole pool. The sentinel is never free, so blocks never
+    // merge past the end.
+    const U64 sizeBytes             = reinterpret_cast<UPtr>(m_pSentinel) - getPayload(m_pFirstBlock);
+    m_pFirstBlock->pPrevPhysical    = nullptr;
+    m_pFirstBlock->sizeAndFlags     = sizeBytes | kBlockFreeFlag;
+    m_pSentinel->pPrevPhysical      = m_pFirstBlock;
+    m_pSentinel->sizeAndFlags       = 0;
+    insertFreeBlock(m_pFirstBlock);
+}
+
+
+void FreeListAllocator::insertFreeBlock(FreeListBlock* pBlock)
+{
+    U32 fl = 0, sl = 0;
+    mapInsert(getSize(pBlock), fl, sl);
+
+    FreeListBlock* pHead    = m_freeLists[fl][sl];
+    pBlock->pNextFree       = pHead;
+    pBlock->pPrevFree       = nullptr;
+    if (pHead)
+    {
+        pHead->pPrevFree = pBlock;
+    }
+
+    m_freeLists[fl][sl]         = pBlock;
+    m_firstLevelBitmap         |= (1u << fl);
+    m_secondLevelBitmaps[fl]   |= (1u << sl);
+}
+
+
+void FreeListAllocator::removeFreeBlock(FreeListBlock* pBlock)
+{
+    U32 fl = 0, sl = 0;
+    mapInsert(getSize(pBlock), fl, sl);
+
+    if (pBlock->pPrevFree)
+    {
+        pBlock->pPrevFree->pNextFree = pBlock->pNextFree;
+    }
+    else
+    {
+        m_freeLists[fl][sl] = pBlock->pNextFree;
+    }
+
+    if (pBlock->pNextFree)
+    {
+        pBlock->pNextFree->pPrevFree = pBlock->pPrevFree;
+    }
+
+    if (!m_freeLists[fl][sl])
+    {
+        m_secondLevelBitmaps[fl] &= ~(1u << sl);
+        if (!m_secondLevelBitmaps[fl])
+        {
+            m_firstLevelBitmap &= ~(1u << fl);
+        }
+    }
+}
+
+
+FreeListBlock* FreeListAllocator::findFreeBlock(U64 sizeBytes)
+{
+    U32 fl = 0, sl = 0;
+    mapSearch(sizeBytes, fl, sl);
+    if (fl >= kFirstLevelCount)
+    {
+        return nullptr;
+    }
+
+    // Any bin at, or after, the one found in this range. Otherwise, the first bin of the next
+    // range that has blocks at all.
+    U32 secondLevelMap = m_secondLevelBitmaps[fl] & static_cast<U32>(~0ull << sl);
+    if (!secondLevelMap)
+    {
+        const U32 firstLevelMap = m_firstLevelBitmap & static_cast<U32>(~0ull << (fl + 1u));
+        if (!firstLevelMap)
+        {
+            return nullptr;
+        }
+        fl              = Math::bitScanForward(firstLevelMap);
+        secondLevelMap  = m_secondLevelBitmaps[fl];
+    }
+
+    sl = Math::bitScanForward(secondLevelMap);
+    return m_freeLists[fl][sl];
+}
+
+
+// Cuts the block down to sizeBytes, and returns the rest as a new block, which the caller
+// still needs to mark and insert.
+FreeListBlock* FreeListAllocator::splitBlock(FreeListBlock* pBlock, U64 sizeBytes)
+{
+    FreeListBlock* pNext        = getNextPhysical(pBlock);
+    const U64 remainingBytes    = getSize(pBlock) - sizeBytes - kBlockOverheadBytes;
+
+    setSize(pBlock, sizeBytes);
+    FreeListBlock* pRemaining       = getNextPhysical(pBlock);
+    pRemaining->pPrevPhysical       = pBlock;
+    pRemaining->sizeAndFlags        = remainingBytes;
+    pNext->pPrevPhysical            = pRemaining;
+    return pRemaining;
+}
+
+
+ResultCode FreeListAllocator::onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment)
+{
+    R_ASSERT(!alignment || Math::isPowerOf2(alignment));
+    U64 sizeBytes = align(requestSz, kBlockAlignment);
+    sizeBytes = (sizeBytes < kMinBlockSizeBytes) ? kMinBlockSizeBytes : sizeBytes;
+
+    // Payloads are always aligned to kBlockAlignment. For anything larger, look for enough
+    // extra room to shift the payload forward, and give the gap back as its own free block.
+    const Bool needsGap     = (alignment > kBlockAlignment);
+    const U64 gapBytes      = needsGap ? (alignment + kBlockOverheadBytes + kMinBlockSizeBytes) : 0ull;
+    if (sizeBytes + gapBytes >= kMaxBlockSizeBytes)
+    {
+        return RecluseResult_OutOfMemory;
+    }
+
+    FreeListBlock* pBlock = findFreeBlock(sizeBytes + gapBytes);
+    if (!pBlock)
+    {
+        return RecluseResult_OutOfMemory;
+    }
+
+    removeFreeBlock(pBlock);
+
+    if (needsGap)
+    {
+        const UPtr payload  = getPayload(pBlock);
+        UPtr aligned        = align(payload, alignment);
+        // The gap must fit a whole free block, or be nothing at all.
+        if ((aligned != payload) && (aligned - payload < kBlockOverheadBytes + kMinBlockSizeBytes))
+        {
+            aligned = align(payload + kBlockOverheadBytes + kMinBlockSizeBytes, alignment);
+        }
+
+        if (aligned != payload)
+        {
+            // The block before us is never free, free neighbors always merge, so the gap is
+            // inserted as is.
+            FreeListBlock* pAligned = splitBlock(pBlock, aligned - payload - kBlockOverheadBytes);
+            setFree(pBlock, true);
+            insertFreeBlock(pBlock);
+            pBlock = pAligned;
+        }
+    }
+
+    // Give back the tail, if it can hold a block of its own. The block after us is never free
+    // either, for the same reason as above.
+    if (getSize(pBlock) >= sizeBytes + kBlockOverheadBytes + kMinBlockSizeBytes)
+    {
+        FreeListBlock* pRemaining = splitBlock(pBlock, sizeBytes);
+        setFree(pRemaining, true);
+        insertFreeBlock(pRemaining);
+    }
+
+    setFree(pBlock, false);
+    pOutput->baseAddress    = getPayload(pBlock);
+    pOutput->sizeBytes      = getSize(pBlock);
+    return RecluseResult_Ok;
+}
+
+
+ResultCode FreeListAllocator::onFree(Allocation* pOutput)
+{
+    const UPtr payload = pOutput->baseAddress;
+    if (!m_pFirstBlock || (payload < getPayload(m_pFirstBlock)) || (payload >= reinterpret_cast<UPtr>(m_pSentinel)) || (payload & (kBlockAlignment - 1u)))
+    {
+        R_ERROR("FreeListAllocator", "Freeing 0x%llx, which is not owned by this allocator!", static_cast<U64>(payload));
+        return RecluseResult_InvalidArgs;
+    }
+
+    FreeListBlock* pBlock = getBlockFromPayload(payload);
+    if (isFree(pBlock))
+    {
+        R_ERROR("FreeListAllocator", "Double free of 0x%llx!", static_cast<U64>(payload));
+        return RecluseResult_CorruptMemory;
+    }
+
+    pOutput->sizeBytes = getSize(pBlock);
+    setFree(pBlock, true);
+
+    // Merge with free neighbors, so free space never stays split into adjacent blocks.
+    FreeListBlock* pPrev = pBlock->pPrevPhysical;
+    if (pPrev && isFree(pPrev))
+    {
+        removeFreeBlock(pPrev);
+        setSize(pPrev, getSize(pPrev) + kBlockOverheadBytes + getSize(pBlock));
+        pBlock = pPrev;
+        getNextPhysical(pBlock)->pPrevPhysical = pBlock;
+    }
+
+    FreeListBlock* pNext = getNextPhysical(pBlock);
+    if (isFree(pNext))
+    {
+        removeFreeBlock(pNext);
+        setSize(pBlock, getSize(pBlock) + kBlockOverheadBytes + getSize(pNext));
+        getNextPhysical(pBlock)->pPrevPhysical = pBlock;
+    }
+
+    insertFreeBlock(pBlock);
+    return RecluseResult_Ok;
+}
+
+
+ResultCode FreeListAllocator::onReset()
+{
+    resetBlocks();
+    return RecluseResult_Ok;
+}
+
+
+ResultCode FreeListAllocator::onCleanUp()
+{
+    m_pFirstBlock   = nullptr;
+    m_pSentinel     = nullptr;
+    resetBlocks();
+    return RecluseResult_Ok;
+}
+
+
+FreeListAllocator::FragmentationReport FreeListAllocator::getFragmentationReport() const
+{
+    FragmentationReport report = { };
+    if (!m_pFirstBlock)
+    {
+        return report;
+    }
+
+    for (const FreeListBlock* pBlock = m_pFirstBlock; pBlock != m_pSentinel; pBlock = getNextPhysical(pBlock))
+    {
+        const U64 sizeBytes = getSize(pBlock);
+        if (isFree(pBlock))
+        {
+            report.totalFreeBytes          += sizeBytes;
+            report.numFreeBlocks           += 1;
+            report.largestFreeBlockBytes    = (sizeBytes > report.largestFreeBlockBytes) ? sizeBytes : report.largestFreeBlockBytes;
+        }
+        else
+        {
+            report.usedBytes       += sizeBytes;
+            report.numUsedBlocks   += 1;
+        }
+    }
+
+    report.fragmentation = report.totalFreeBytes ? (1.0f - F32(F64(report.largestFreeBlockBytes) / F64(report.totalFreeBytes))) : 0.0f;
+    return report;
+}
+} // Recluse
@@ -0,0 +1,244 @@
+//
+#include "Recluse/Memory/MemoryBudget.hpp"
+#include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+#include "Recluse/Threading/Locks.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <vector>
+
+namespace Recluse {
+
+
+struct MemoryBudgetEntry
+{
+    Atomic<U64>     budgetBytes;
+    Atomic<U64>     softLimitBytes;
+    Atomic<U64>     reservedBytes;
+    // Only touched by update(), so crossings are logged once.
+    Bool            wasOverSoftLimit;
+    Bool            wasOverBudget;
+};
+
+
+struct MemoryBudgetCallbackEntry
+{
+    U32                     id;
+    MemoryTag               tag;
+    MemoryBudgetCallback    callback;
+};
+
+
+static MemoryBudgetEntry                        g_budgets[MemoryTag_Count];
+static Atomic<U32>                              g_numBudgets;
+static SpinLock                                 g_callbackLock;
+static std::vector<MemoryBudgetCallbackEntry>   g_callbacks;
+static U32                                      g_nextCallbackId = 1u;
+
+
+ResultCode MemoryBudgets::setBudget(MemoryTag tag, U64 budgetBytes, U64 softLimitBytes)
+{
+    if ((tag >= MemoryTag_Count) || (budgetBytes == 0ull) || (softLimitBytes > budgetBytes))
+    {
+        return RecluseResult_InvalidArgs;
+    }
+
+    MemoryBudgetEntry& entry = g_budgets[tag];
+    if (entry.budgetBytes.exchange(budgetBytes, MemoryOrder_Relaxed) == 0ull)
+    {
+        g_numBudgets.fetchAdd(1u, MemoryOrder_Relaxed);
+    }
+    entry.softLimitBytes.store(softLimitBytes ? softLimitBytes : budgetBytes, MemoryOrder_Relaxed);
+    return RecluseResult_Ok;
+}
+
+
+void MemoryBudgets::clearBudget(MemoryTag tag)
+{
+    R_ASSERT(tag < MemoryTag_Count);
+    MemoryBudgetEntry& entry = g_budgets[tag];
+    if (entry.budgetBytes.exchange(0ull, MemoryOrder_Relaxed) != 0ull)
+    {
+        g_numBudgets.fetchSub(1u, MemoryOrder_Relaxed);
+    }
+    entry.softLimitBytes.store(0ull, MemoryOrder_Relaxed);
+}
+
+
+Bool MemoryBudgets::hasBudgets()
+{
+    return g_numBudgets.load(MemoryOrder_Relaxed) != 0u;
+}
+
+
+U64 MemoryBudgets::getBudgetBytes(MemoryTag tag, U64 defaultBytes)
+{
+    R_ASSERT(tag < MemoryTag_Count);
+    const U64 budgetBytes = g_budgets[tag].budgetBytes.load(MemoryOrder_Relaxed);
+    return budgetBytes ? budgetBytes : defaultBytes;
+}
+
+
+void MemoryBudgets::reserve(MemoryTag tag, U64 sizeBytes)
+{
+    R_ASSERT(tag < MemoryTag_Count);
+    g_budgets[tag].reservedBytes.fetchAdd(sizeBytes, MemoryOrder_Relaxed);
+}
+
+
+void MemoryBudgets::unreserve(MemoryTag tag, U64 sizeBytes)
+{
+    R_ASSERT(tag < MemoryTag_Count);
+    g_budgets[tag].reservedBytes.fetchSub(sizeBytes, MemoryOrder_Relaxed);
+}
+
+
+U32 MemoryBudgets::addOverBudgetCallback(MemoryTag tag, MemoryBudgetCallback callback)
+{
+    R_ASSERT(tag < MemoryTag_Count);
+    ScopedSpinLock lock(g_callbackLock);
+    MemoryBudgetCallbackEntry entry = { g_nextCallbackId++, tag, callback };
+    g_callbacks.push_back(entry);
+    return entry.id;
+}
+
+
+void MemoryBudgets::removeOverBudgetCallback(U32 callbackId)
+{
+    ScopedSpinLock lock(g_callbackLock);
+    for (auto it = g_callbacks.begin(); it != g_callbacks.end(); ++it)
+    {
+        if (it->id == callbackId)
+        {
+            g_callbacks.erase(it);
+            return;
+        }
+    }
+}
+
+
+MemoryBudgetStatus MemoryBudgets::getStatus(MemoryTag tag)
+{
+    R_ASSERT(tag < MemoryTag_Count);
+    const MemoryBudgetEntry& entry  = g_budgets[tag];
+    const MemoryTagStats stats      = MemoryScanner::getTagStats(tag);
+    MemoryBudgetStatus status       = { };
+    status.tag                      = tag;
+    status.budgetBytes              = entry.budgetBytes.load(MemoryOrder_Relaxed);
+    status.softLimitBytes           = entry.softLimitBytes.load(MemoryOrder_Relaxed);
+    status.allocatedBytes           = stats.liveBytes;
+    status.reservedBytes            = entry.reservedBytes.load(MemoryOrder_Relaxed);
+    status.usedBytes                = status.allocatedBytes + status.reservedBytes;
+    status.peakBytes                = stats.peakBytes + status.reservedBytes;
+    status.overSoftLimit            = status.softLimitBytes && (status.usedBytes > status.softLimitBytes);
+    status.overBudget               = status.budgetBytes && (status.usedBytes > status.budgetBytes);
+    return status;
+}
+
+
+U32 MemoryBudgets::getSnapshot(MemoryBudgetStatus* pStatuses, U32 maxStatuses)
+{
+    U32 numStatuses = 0u;
+    for (U32 i = 0; (i < MemoryTag_Count) && (numStatuses < maxStatuses); ++i)
+    {
+        pStatuses[numStatuses++] = getStatus(static_cast<MemoryTag>(i));
+    }
+    return numStatuses;
+}
+
+
+void MemoryBudgets::update()
+{
+    if (!hasBudgets())
+    {
+        return;
+    }
+
+    std::vector<MemoryBudgetCallbackEntry> callbacks;
+    for (U32 i = 0; i < MemoryTag_Count; ++i)
+    {
+        MemoryBudgetEntry& entry = g_budgets[i];
+        if (!entry.budgetBytes.load(MemoryOrder_Relaxed))
+        {
+            entry.wasOverSoftLimit  = false;
+            entry.wasOverBudget     = false;
+            continue;
+        }
+
+        const MemoryBudgetStatus status = getStatus(static_cast<MemoryTag>(i));
+        if (status.overBudget && !entry.wasOverBudget)
+        {
+            R_WARN
+                (
+                    "MemoryBudgets",
+                    "%s is over budget! %llu KB used of %llu KB.",
+                    MemoryScanner::getTagName(status.tag),
+                    status.usedBytes / R_1KB,
+                    status.budgetBytes / R_1KB
+                );
+        }
+        else if (status.overSoftLimit && !entry.wasOverSoftLimit)
+        {
+            R_DEBUG
+                (
+                    "MemoryBudgets",
+                    "%s crossed its soft limit, %llu KB used of %llu KB.",
+                    MemoryScanner::getTagName(status.tag),
+                    status.usedBytes / R_1KB,
+                    status.softLimitBytes / R_1KB
+                );
+        }
+        entry.wasOverSoftLimit  = status.overSoftLimit;
+        entry.wasOverBudget     = status.overBudget;
+
+        if (!status.overSoftLimit)
+        {
+            continue;
+        }
+
+        // Called outside of the lock, so callbacks can add or remove callbacks.
+        callbacks.clear();
+        {
+            ScopedSpinLock lock(g_callbackLock);
+            for (const MemoryBudgetCallbackEntry& callback : g_callbacks)
+            {
+                if (callback.tag == status.tag)
+                {
+                    callbacks.push_back(callback);
+                }
+            }
+        }
+
+        for (const MemoryBudgetCallbackEntry& callback : callbacks)
+        {
+            callback.callback(status);
+        }
+    }
+}
+
+
+void MemoryBudgets::logSnapshot()
+{
+    for (U32 i = 0; i < MemoryTag_Count; ++i)
+    {
+        const MemoryBudgetStatus status = getStatus(static_cast<MemoryTag>(i));
+        if (!status.budgetBytes && !status.usedBytes)
+        {
+            continue;
+        }
+
+        R_INFO
+            (
+                "MemoryBudgets",
+                "%-10s used=%8llu KB (allocated=%llu KB, reserved=%llu KB) peak=%8llu KB budget=%8llu KB soft=%8llu KB",
+                MemoryScanner::getTagName(status.tag),
+                status.usedBytes / R_1KB,
+                status.allocatedBytes / R_1KB,
+                status.reservedBytes / R_1KB,
+                status.peakBytes / R_1KB,
+                status.budgetBytes / R_1KB,
+                status.softLimitBytes / R_1KB
+            );
+    }
+}
+} // Recluse
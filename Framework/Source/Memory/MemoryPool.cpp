@@ -1,13 +1,18 @@
 //
 #include "Recluse/Memory/MemoryPool.hpp"
 #include "Recluse/Memory/MemoryScan.hpp"
+#include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Memory/VirtualMemory.hpp"
 
 #include "Recluse/Messaging.hpp"
 
 #include <stdlib.h>
+#include <string.h>
 
 namespace Recluse {
 
+// Reserved pools commit at least this much more each time they grow, up to the step below.
+static const U64 kMaxCommitStepBytes = R_MB(64);
 
 
 void MemoryPool::copy(MemoryPool* dst, U64 dstOffset, MemoryPool* src, U64 srcOffset, U64 sizeBytes)
@@ -25,10 +30,13 @@ void MemoryPool::copy(MemoryPool* dst, U64 dstOffset, MemoryPool* src, U64 srcOf
 
 MemoryPool::MemoryPool(U64 szBytes, U64 pageSz)
     : m_baseAddr(0ull)
-    , m_pageSzBytes(pageSz)
     , m_totalSzBytes(0ull)
-    , m_pScanStart(nullptr)
+    , m_pageSzBytes(pageSz)
+    , m_committedSzBytes(0ull)
+    , m_initialCommitSzBytes(0ull)
     , m_isMalloc(false)     // Start with no malloc, if we are just empty initializing this pool.
+    , m_isReserved(false)
+    , m_pScanStart(nullptr)
 {
     preAllocate(szBytes, pageSz);
 }
@@ -36,14 +44,18 @@ MemoryPool::MemoryPool(U64 szBytes, U64 pageSz)
 
 MemoryPool::MemoryPool(void* ptr, U64 szBytes, U64 pageSz)
     : m_baseAddr(0ull)
-    , m_pageSzBytes(pageSz)
     , m_totalSzBytes(0ull)
-    , m_pScanStart(nullptr)
+    , m_pageSzBytes(pageSz)
+    , m_committedSzBytes(0ull)
+    , m_initialCommitSzBytes(0ull)
     , m_isMalloc(false)
+    , m_isReserved(false)
+    , m_pScanStart(nullptr)
 {
     m_baseAddr = (UPtr)ptr;
     m_pageSzBytes = pageSz;
     m_totalSzBytes = szBytes;
+    m_committedSzBytes = szBytes;
 }
 
 
@@ -94,10 +106,110 @@ void MemoryPool::preAllocate(U64 szBytes, U64 pageSz)
 
     }
 
-    m_baseAddr      = (UPtr)malloc(allocationSizeBytes);
-    m_pageSzBytes   = pageSz;
-    m_totalSzBytes  = allocationSizeBytes;
-    m_isMalloc      = true;
+    m_baseAddr          = (UPtr)malloc(allocationSizeBytes);
+    m_pageSzBytes       = pageSz;
+    m_totalSzBytes      = allocationSizeBytes;
+    m_committedSzBytes  = allocationSizeBytes;
+    m_isMalloc          = true;
+}
+
+
+ResultCode MemoryPool::reserve(U64 szBytes, U64 initialCommitSzBytes, MemoryPoolFlags flags)
+{
+    if (szBytes == 0ull || isAllocated())
+    {
+        R_WARN
+            (
+                "MemoryPool", 
+                "Memory pool is either already allocated, or 0 size bytes was passed to reserve."
+                " Be sure to either call release(), or check if the correct behavior was expected."
+            );
+        return RecluseResult_InvalidArgs;
+    }
+
+    // Commits happen in whole pages, so the reservation is rounded up to them too.
+    const Bool useLargePages    = (flags & MemoryPoolFlag_LargePages) && VirtualMemory::getLargePageSizeBytes();
+    const U64 pageSzBytes       = useLargePages ? VirtualMemory::getLargePageSizeBytes() : VirtualMemory::getPageSizeBytes();
+    const U64 reserveSzBytes    = align(szBytes, pageSzBytes);
+    void* pAddress              = VirtualMemory::reserve(reserveSzBytes, useLargePages);
+    if (!pAddress)
+    {
+        return RecluseResult_OutOfMemory;
+    }
+
+    m_baseAddr              = (UPtr)pAddress;
+    m_pageSzBytes           = pageSzBytes;
+    m_totalSzBytes          = reserveSzBytes;
+    m_committedSzBytes      = 0ull;
+    m_initialCommitSzBytes  = 0ull;
+    m_isMalloc              = false;
+    m_isReserved            = true;
+
+    if (initialCommitSzBytes)
+    {
+        ResultCode result = commit(initialCommitSzBytes);
+        if (result != RecluseResult_Ok)
+        {
+            release();
+            return result;
+        }
+        m_initialCommitSzBytes = m_committedSzBytes;
+    }
+    return RecluseResult_Ok;
+}
+
+
+ResultCode MemoryPool::commit(U64 szBytes)
+{
+    if (szBytes <= m_committedSzBytes)
+    {
+        return RecluseResult_Ok;
+    }
+
+    if (!m_isReserved || (szBytes > m_totalSzBytes))
+    {
+        return RecluseResult_OutOfMemory;
+    }
+
+    // Grow by at least the committed size so far, so a steadily growing arena only
+    // commits O(log n) times, but never by more than the max step.
+    const U64 growthSzBytes = (m_committedSzBytes < kMaxCommitStepBytes) ? m_committedSzBytes : kMaxCommitStepBytes;
+    U64 newCommittedSzBytes = align(szBytes, m_pageSzBytes);
+    if (newCommittedSzBytes < m_committedSzBytes + growthSzBytes)
+    {
+        newCommittedSzBytes = align(m_committedSzBytes + growthSzBytes, m_pageSzBytes);
+    }
+    if (newCommittedSzBytes > m_totalSzBytes)
+    {
+        newCommittedSzBytes = m_totalSzBytes;
+    }
+
+    ResultCode result = VirtualMemory::commit(getRawAddressAt(m_committedSzBytes), newCommittedSzBytes - m_committedSzBytes);
+    if (result == RecluseResult_Ok)
+    {
+        m_committedSzBytes = newCommittedSzBytes;
+    }
+    return result;
+}
+
+
+void MemoryPool::decommit(U64 keepSzBytes)
+{
+    if (!m_isReserved)
+    {
+        return;
+    }
+
+    keepSzBytes = align(keepSzBytes, m_pageSzBytes);
+    if (keepSzBytes >= m_committedSzBytes)
+    {
+        return;
+    }
+
+    if (VirtualMemory::decommit(getRawAddressAt(keepSzBytes), m_committedSzBytes - keepSzBytes) == RecluseResult_Ok)
+    {
+        m_committedSzBytes = keepSzBytes;
+    }
 }
 
 
@@ -107,8 +219,16 @@ void MemoryPool::clear(U32 defaultValue)
     {
         return;
     }
+
+    // Reserved pools give back what they grew into, and only wipe what stays committed.
+    decommit(m_initialCommitSzBytes);
+
+    if (m_committedSzBytes == 0ull)
+    {
+        return;
+    }
     // Set the memory pool to a default value, this is our clear!
-    memset((void*)m_baseAddr, defaultValue, m_totalSzBytes);
+    memset((void*)m_baseAddr, defaultValue, m_committedSzBytes);
 }
 
 
@@ -130,5 +250,20 @@ void MemoryPool::release()
         free((void*)m_baseAddr);
         m_baseAddr = 0;
     }
+
+    if (m_baseAddr && m_isReserved)
+    {
+        VirtualMemory::release((void*)m_baseAddr, m_totalSzBytes);
+        m_baseAddr = 0;
+    }
+
+    if (!m_baseAddr)
+    {
+        m_totalSzBytes          = 0ull;
+        m_committedSzBytes      = 0ull;
+        m_initialCommitSzBytes  = 0ull;
+        m_isMalloc              = false;
+        m_isReserved            = false;
+    }
 }
 } // Recluse
\ No newline at end of file
@@ -0,0 +1,555 @@
+//
+#include "Recluse/Memory/MemoryScan.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Memory/MemoryCommon.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+#include "Recluse/Threading/Locks.hpp"
+#include "Recluse/System/Process.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace Recluse {
+
+
+// Counters of one thread. Only the owning thread writes them, so a plain load and store will
+// do, instead of a locked add on counters every thread shares. Readers add them up across
+// threads, and may see them a little behind. Frees count on the thread that frees, so a
+// thread's own counters may not add up on their own, only the sums do.
+struct alignas(kCacheLineSizeBytes) MemoryThreadCounters
+{
+    Atomic<U64>     allocatedBytes[MemoryTag_Count];
+    Atomic<U64>     freedBytes[MemoryTag_Count];
+    Atomic<U64>     numAllocations[MemoryTag_Count];
+    Atomic<U64>     numFrees[MemoryTag_Count];
+};
+
+
+struct SampledAllocation
+{
+    U64             sizeBytes;
+    U64             stackHash;
+};
+
+
+static const char* kMemoryTagNames[MemoryTag_Count] =
+{
+    "Unknown",
+    "Core",
+    "Logging",
+    "Messaging",
+    "Threading",
+    "Frame",
+    "Renderer",
+    "Graphics",
+    "Scene",
+    "Game"
+};
+
+
+// Threads past the last one share it, and add to it atomically.
+static constexpr U32 kMaxCounterThreads = 128u;
+
+
+static Atomic<U32>          g_isTracking;
+static U32                  g_sampleRate        = MemoryScanner::kDefaultSampleRate;
+static Atomic<U32>          g_numCounterThreads;
+static MemoryThreadCounters g_threadCounters[kMaxCounterThreads];
+// High water marks can only be seen by adding up every thread, so they are updated whenever
+// the stats are read, and on markFrame().
+static Atomic<U64>          g_peakBytes[MemoryTag_Count];
+
+// Only touched by markFrame() and getLastFrameStats(), on the same thread.
+static MemoryTagStats       g_frameStartStats[MemoryTag_Count];
+static MemoryFrameStats     g_lastFrameStats[MemoryTag_Count];
+
+// Sampled allocations only. Ordered by address, so everything in a range that was given back
+// at once can be dropped together.
+static SpinLock                                     g_sampleLock;
+static std::map<UPtr, SampledAllocation>            g_sampledAllocations;
+static std::unordered_map<U64, MemoryCallsite>      g_callsites;
+
+
+static U32 getCounterThreadIndex()
+{
+    static thread_local U32 threadIndex = g_numCounterThreads.fetchAdd(1u, MemoryOrder_Relaxed);
+    return (threadIndex < kMaxCounterThreads) ? threadIndex : (kMaxCounterThreads - 1u);
+}
+
+
+static R_FORCE_INLINE void addToCounter(Atomic<U64>& counter, U64 value, U32 threadIndex)
+{
+    if (threadIndex == kMaxCounterThreads - 1u)
+    {
+        counter.fetchAdd(value, MemoryOrder_Relaxed);
+        return;
+    }
+    counter.store(counter.load(MemoryOrder_Relaxed) + value, MemoryOrder_Relaxed);
+}
+
+
+static void addFreed(MemoryTag tag, U64 sizeBytes, U64 numAllocations)
+{
+    const U32 threadIndex           = getCounterThreadIndex();
+    MemoryThreadCounters& counters  = g_threadCounters[threadIndex];
+    addToCounter(counters.freedBytes[tag], sizeBytes, threadIndex);
+    addToCounter(counters.numFrees[tag], numAllocations, threadIndex);
+}
+
+
+static R_FORCE_INLINE Bool isSampled(UPtr address)
+{
+    // Low bits are mostly alignment, so mix before picking.
+    const U64 hash = (static_cast<U64>(address) >> 4ull) * 0x9E3779B97F4A7C15ull;
+    return g_sampleRate && (((hash >> 32ull) & (g_sampleRate - 1u)) == 0ull);
+}
+
+
+static U64 hashStackFrames(void* const* ppFrames, U32 numFrames)
+{
+    // FNV-1a over the return addresses.
+    U64 hash = 0xCBF29CE484222325ull;
+    for (U32 i = 0; i < numFrames; ++i)
+    {
+        hash ^= static_cast<U64>(reinterpret_cast<UPtr>(ppFrames[i]));
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+
+// Callers must hold the sample lock.
+static void forgetSampledAllocation(std::map<UPtr, SampledAllocation>::iterator it)
+{
+    auto callsite = g_callsites.find(it->second.stackHash);
+    if (callsite != g_callsites.end())
+    {
+        callsite->second.liveSampledBytes          -= it->second.sizeBytes;
+        callsite->second.liveSampledAllocations    -= 1ull;
+    }
+    g_sampledAllocations.erase(it);
+}
+
+
+static void logCallsite(const MemoryCallsite& callsite)
+{
+    R_WARN
+        (
+            "MemoryScanner",
+            "Callsite 0x%016llx (%s): ~%llu bytes in ~%llu allocations still live",
+            callsite.stackHash,
+            MemoryScanner::getTagName(callsite.tag),
+            callsite.liveSampledBytes * g_sampleRate,
+            callsite.liveSampledAllocations * g_sampleRate
+        );
+
+    for (U32 i = 0; i < callsite.numStackFrames; ++i)
+    {
+        R_WARN("MemoryScanner", "    #%d 0x%llx", i, static_cast<U64>(reinterpret_cast<UPtr>(callsite.stackFrames[i])));
+    }
+}
+
+
+static void clearTracking()
+{
+    for (U32 i = 0; i < MemoryTag_Count; ++i)
+    {
+        for (U32 thread = 0; thread < kMaxCounterThreads; ++thread)
+        {
+            MemoryThreadCounters& counters = g_threadCounters[thread];
+            counters.allocatedBytes[i].store(0ull, MemoryOrder_Relaxed);
+            counters.freedBytes[i].store(0ull, MemoryOrder_Relaxed);
+            counters.numAllocations[i].store(0ull, MemoryOrder_Relaxed);
+            counters.numFrees[i].store(0ull, MemoryOrder_Relaxed);
+        }
+        g_peakBytes[i].store(0ull, MemoryOrder_Relaxed);
+        g_frameStartStats[i]    = MemoryTagStats();
+        g_lastFrameStats[i]     = MemoryFrameStats();
+    }
+
+    ScopedSpinLock lock(g_sampleLock);
+    g_sampledAllocations.clear();
+    g_callsites.clear();
+}
+
+
+ResultCode MemoryScanner::enableTracking(U32 sampleRate)
+{
+    if (isTracking())
+    {
+        return RecluseResult_AlreadyExists;
+    }
+
+    U32 rate = sampleRate ? 1u : 0u;
+    while (rate < sampleRate)
+    {
+        rate <<= 1u;
+    }
+
+    clearTracking();
+    g_sampleRate = rate;
+    g_isTracking.store(1u, MemoryOrder_Release);
+    if (g_sampleRate)
+    {
+        R_INFO("MemoryScanner", "Tracking allocations, sampling 1 in %d.", g_sampleRate);
+    }
+    else
+    {
+        R_INFO("MemoryScanner", "Tracking allocations, counters only.");
+    }
+    return RecluseResult_Ok;
+}
+
+
+void MemoryScanner::disableTracking()
+{
+    g_isTracking.store(0u, MemoryOrder_Release);
+    clearTracking();
+}
+
+
+Bool MemoryScanner::isTracking()
+{
+    return g_isTracking.load(MemoryOrder_Acquire) != 0u;
+}
+
+
+U32 MemoryScanner::getSampleRate()
+{
+    return g_sampleRate;
+}
+
+
+void MemoryScanner::recordAllocation(MemoryTag tag, UPtr address, U64 sizeBytes)
+{
+    if (!isTracking())
+    {
+        return;
+    }
+
+    const U32 threadIndex           = getCounterThreadIndex();
+    MemoryThreadCounters& counters  = g_threadCounters[threadIndex];
+    addToCounter(counters.allocatedBytes[tag], sizeBytes, threadIndex);
+    addToCounter(counters.numAllocations[tag], 1ull, threadIndex);
+
+    if (!isSampled(address))
+    {
+        return;
+    }
+
+    // Captured before taking the lock, it's the slow part. Skips this function.
+    void* stackFrames[MemoryCallsite::kMaxStackFrames];
+    const U32 numStackFrames    = Process::captureStackTrace(stackFrames, MemoryCallsite::kMaxStackFrames, 1u);
+    const U64 stackHash         = hashStackFrames(stackFrames, numStackFrames) ^ static_cast<U64>(tag);
+
+    ScopedSpinLock lock(g_sampleLock);
+    auto callsite = g_callsites.find(stackHash);
+    if (callsite == g_callsites.end())
+    {
+        MemoryCallsite newCallsite  = { };
+        newCallsite.stackHash       = stackHash;
+        newCallsite.tag             = tag;
+        newCallsite.numStackFrames  = numStackFrames;
+        std::copy(stackFrames, stackFrames + numStackFrames, newCallsite.stackFrames);
+        callsite = g_callsites.insert(std::make_pair(stackHash, newCallsite)).first;
+    }
+
+    callsite->second.sampledBytes              += sizeBytes;
+    callsite->second.sampledAllocations        += 1ull;
+    callsite->second.liveSampledBytes          += sizeBytes;
+    callsite->second.liveSampledAllocations    += 1ull;
+
+    // An address handed out again, without its free being reported, replaces the stale record.
+    auto it = g_sampledAllocations.find(address);
+    if (it != g_sampledAllocations.end())
+    {
+        forgetSampledAllocation(it);
+    }
+
+    SampledAllocation sample    = { };
+    sample.sizeBytes            = sizeBytes;
+    sample.stackHash            = stackHash;
+    g_sampledAllocations.insert(std::make_pair(address, sample));
+}
+
+
+void MemoryScanner::recordFree(MemoryTag tag, UPtr address, U64 sizeBytes)
+{
+    if (!isTracking())
+    {
+        return;
+    }
+
+    addFreed(tag, sizeBytes, 1ull);
+
+    if (!isSampled(address))
+    {
+        return;
+    }
+
+    ScopedSpinLock lock(g_sampleLock);
+    auto it = g_sampledAllocations.find(address);
+    if (it != g_sampledAllocations.end())
+    {
+        forgetSampledAllocation(it);
+    }
+}
+
+
+void MemoryScanner::recordRelease(MemoryTag tag, UPtr address, U64 rangeSizeBytes, U64 sizeBytes, U64 numAllocations)
+{
+    if (!isTracking())
+    {
+        return;
+    }
+
+    addFreed(tag, sizeBytes, numAllocations);
+
+    ScopedSpinLock lock(g_sampleLock);
+    auto it = g_sampledAllocations.lower_bound(address);
+    while ((it != g_sampledAllocations.end()) && (it->first < address + rangeSizeBytes))
+    {
+        auto next = std::next(it);
+        forgetSampledAllocation(it);
+        it = next;
+    }
+}
+
+
+MemoryTagStats MemoryScanner::getTagStats(MemoryTag tag)
+{
+    R_ASSERT(tag < MemoryTag_Count);
+    U64 freedBytes  = 0ull;
+    U64 numFrees    = 0ull;
+    MemoryTagStats stats = { };
+    for (U32 i = 0; i < kMaxCounterThreads; ++i)
+    {
+        const MemoryThreadCounters& counters = g_threadCounters[i];
+        stats.totalBytes        += counters.allocatedBytes[tag].load(MemoryOrder_Relaxed);
+        stats.totalAllocations  += counters.numAllocations[tag].load(MemoryOrder_Relaxed);
+        freedBytes              += counters.freedBytes[tag].load(MemoryOrder_Relaxed);
+        numFrees                += counters.numFrees[tag].load(MemoryOrder_Relaxed);
+    }
+
+    // Counters read while other threads allocate may be off a little, and could even cross.
+    stats.liveBytes         = (stats.totalBytes > freedBytes) ? (stats.totalBytes - freedBytes) : 0ull;
+    stats.liveAllocations   = (stats.totalAllocations > numFrees) ? (stats.totalAllocations - numFrees) : 0ull;
+
+    U64 peakBytes = g_peakBytes[tag].load(MemoryOrder_Relaxed);
+    while ((stats.liveBytes > peakBytes) && !g_peakBytes[tag].compareExchangeWeak(peakBytes, stats.liveBytes, MemoryOrder_Relaxed))
+    {
+    }
+    stats.peakBytes = (stats.liveBytes > peakBytes) ? stats.liveBytes : peakBytes;
+    return stats;
+}
+
+
+void MemoryScanner::markFrame()
+{
+    if (!isTracking())
+    {
+        return;
+    }
+
+    for (U32 i = 0; i < MemoryTag_Count; ++i)
+    {
+        const MemoryTagStats stats          = getTagStats(static_cast<MemoryTag>(i));
+        g_lastFrameStats[i].bytes           = stats.totalBytes - g_frameStartStats[i].totalBytes;
+        g_lastFrameStats[i].numAllocations  = stats.totalAllocations - g_frameStartStats[i].totalAllocations;
+        g_frameStartStats[i]                = stats;
+    }
+}
+
+
+MemoryFrameStats MemoryScanner::getLastFrameStats(MemoryTag tag)
+{
+    R_ASSERT(tag < MemoryTag_Count);
+    return g_lastFrameStats[tag];
+}
+
+
+U32 MemoryScanner::getTopCallsites(MemoryCallsite* pCallsites, U32 maxCallsites)
+{
+    std::vector<MemoryCallsite> callsites;
+    {
+        ScopedSpinLock lock(g_sampleLock);
+        callsites.reserve(g_callsites.size());
+        for (auto& callsite : g_callsites)
+        {
+            callsites.push_back(callsite.second);
+        }
+    }
+
+    const U32 numCallsites = std::min(maxCallsites, static_cast<U32>(callsites.size()));
+    std::partial_sort
+        (
+            callsites.begin(),
+            callsites.begin() + numCallsites,
+            callsites.end(),
+            [] (const MemoryCallsite& lhs, const MemoryCallsite& rhs) -> bool { return lhs.sampledBytes > rhs.sampledBytes; }
+        );
+    std::copy(callsites.begin(), callsites.begin() + numCallsites, pCallsites);
+    return numCallsites;
+}
+
+
+void MemoryScanner::resetPeaks()
+{
+    for (U32 i = 0; i < MemoryTag_Count; ++i)
+    {
+        g_peakBytes[i].store(0ull, MemoryOrder_Relaxed);
+        getTagStats(static_cast<MemoryTag>(i));
+    }
+}
+
+
+U64 MemoryScanner::scanMemoryLeaks(const MemoryPool* pool)
+{
+    if (!pool || !isTracking())
+    {
+        return 0ull;
+    }
+
+    const UPtr baseAddress  = pool->getBaseAddress();
+    const UPtr endAddress   = baseAddress + pool->getTotalSizeBytes();
+    U64 sampledBytes        = 0ull;
+    U64 numSampled          = 0ull;
+
+    ScopedSpinLock lock(g_sampleLock);
+    for (auto it = g_sampledAllocations.lower_bound(baseAddress); (it != g_sampledAllocations.end()) && (it->first < endAddress); ++it)
+    {
+        sampledBytes    += it->second.sizeBytes;
+        numSampled      += 1ull;
+    }
+
+    if (numSampled)
+    {
+        R_WARN
+            (
+                "MemoryScanner",
+                "Pool at 0x%llx is released with ~%llu bytes in ~%llu allocations still live!",
+                static_cast<U64>(baseAddress),
+                sampledBytes * g_sampleRate,
+                numSampled * g_sampleRate
+            );
+    }
+
+    return sampledBytes;
+}
+
+
+Bool MemoryScanner::getMemoryAllocationLocation(const void* ptr, MemoryCallsite& callsiteOut)
+{
+    ScopedSpinLock lock(g_sampleLock);
+    auto it = g_sampledAllocations.find(reinterpret_cast<UPtr>(ptr));
+    if (it == g_sampledAllocations.end())
+    {
+        return false;
+    }
+
+    auto callsite = g_callsites.find(it->second.stackHash);
+    if (callsite == g_callsites.end())
+    {
+        return false;
+    }
+
+    callsiteOut = callsite->second;
+    return true;
+}
+
+
+U64 MemoryScanner::reportLeaks()
+{
+    if (!isTracking())
+    {
+        return 0ull;
+    }
+
+    U64 liveBytes = 0ull;
+    for (U32 i = 0; i < MemoryTag_Count; ++i)
+    {
+        const MemoryTagStats stats = getTagStats(static_cast<MemoryTag>(i));
+        if (stats.liveAllocations || stats.liveBytes)
+        {
+            R_WARN
+                (
+                    "MemoryScanner",
+                    "%s: %llu bytes in %llu allocations still live. Peaked at %llu bytes.",
+                    getTagName(static_cast<MemoryTag>(i)),
+                    stats.liveBytes,
+                    stats.liveAllocations,
+                    stats.peakBytes
+                );
+        }
+        liveBytes += stats.liveBytes;
+    }
+
+    std::vector<MemoryCallsite> leaks;
+    {
+        ScopedSpinLock lock(g_sampleLock);
+        for (auto& callsite : g_callsites)
+        {
+            if (callsite.second.liveSampledAllocations)
+            {
+                leaks.push_back(callsite.second);
+            }
+        }
+    }
+
+    std::sort
+        (
+            leaks.begin(),
+            leaks.end(),
+            [] (const MemoryCallsite& lhs, const MemoryCallsite& rhs) -> bool { return lhs.liveSampledBytes > rhs.liveSampledBytes; }
+        );
+
+    for (const MemoryCallsite& callsite : leaks)
+    {
+        logCallsite(callsite);
+    }
+
+    if (!liveBytes && leaks.empty())
+    {
+        R_INFO("MemoryScanner", "No leaks found.");
+    }
+
+    return liveBytes;
+}
+
+
+void* rlsAllocateBytes(U64 sizeBytes, U32 count, MemoryTag tag)
+{
+    RlsAllocationHeader* pHeader    = static_cast<RlsAllocationHeader*>(::operator new(sizeof(RlsAllocationHeader) + sizeBytes));
+    pHeader->sizeBytes              = sizeBytes;
+    pHeader->count                  = count;
+    pHeader->tag                    = static_cast<U16>(tag);
+    pHeader->tracked                = MemoryScanner::isTracking() ? 1u : 0u;
+
+    void* ptr = pHeader + 1;
+    if (pHeader->tracked)
+    {
+        MemoryScanner::recordAllocation(tag, reinterpret_cast<UPtr>(ptr), sizeBytes);
+    }
+    return ptr;
+}
+
+
+void rlsFreeBytes(void* ptr)
+{
+    RlsAllocationHeader* pHeader = rlsGetHeader(ptr);
+    if (pHeader->tracked)
+    {
+        MemoryScanner::recordFree(static_cast<MemoryTag>(pHeader->tag), reinterpret_cast<UPtr>(ptr), pHeader->sizeBytes);
+    }
+    ::operator delete(pHeader);
+}
+
+
+const char* MemoryScanner::getTagName(MemoryTag tag)
+{
+    return (tag < MemoryTag_Count) ? kMemoryTagNames[tag] : "Invalid";
+}
+} // Recluse
@@ -0,0 +1,422 @@
+//
+#include "Recluse/Memory/PoolAllocator.hpp"
+#include "Recluse/Threading/Locks.hpp"
+#include "Recluse/Math/MathCommons.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <string.h>
+#include <new>
+
+namespace Recluse {
+
+
+static constexpr U8 kUnassignedSlab       = 0xFFu;
+static constexpr U8 kFreeBlockPoison      = 0xDDu;
+static constexpr U8 kNewBlockFill         = 0xCDu;
+// Blocks moved between a magazine and the shared lists at a time.
+static constexpr U32 kMagazineBatchSize   = PoolAllocator::kMagazineCapacity / 2u;
+
+
+// Free blocks store the next link in their own first bytes.
+struct PoolFreeBlock
+{
+    PoolFreeBlock* pNext;
+};
+
+
+// Shared lists of a size class. Only touched when a magazine runs dry, or overflows.
+struct alignas(kCacheLineSizeBytes) PoolSizeClass
+{
+    SpinLock        lock;
+    PoolFreeBlock*  pFreeList;
+    // Part of the current slab that has not been carved into blocks yet.
+    UPtr            carveCursor;
+    UPtr            carveEnd;
+};
+
+
+struct PoolMagazineList
+{
+    PoolFreeBlock*  pHead;
+    U32             count;
+};
+
+
+// Magazines are locked too, since threads may end up sharing one, but the lock is almost
+// never contended.
+struct alignas(kCacheLineSizeBytes) PoolMagazine
+{
+    SpinLock            lock;
+    PoolMagazineList    lists[PoolAllocator::kMaxSizeClasses];
+};
+
+
+static Atomic<U32> g_nextThreadSlot;
+
+
+static U32 getThreadSlot()
+{
+    static thread_local U32 threadSlot = g_nextThreadSlot.fetchAdd(1u, MemoryOrder_Relaxed);
+    return threadSlot % PoolAllocator::kMaxMagazines;
+}
+
+
+static U32 getSizeClass(U64 sizeBytes)
+{
+    U32 sizeClass       = 0;
+    U64 blockSizeBytes  = PoolAllocator::kMinBlockSizeBytes;
+    while (blockSizeBytes < sizeBytes)
+    {
+        blockSizeBytes <<= 1ull;
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+
+static R_FORCE_INLINE U64 getBlockSizeBytes(U32 sizeClass)
+{
+    return static_cast<U64>(PoolAllocator::kMinBlockSizeBytes) << sizeClass;
+}
+
+
+// Checks that nothing wrote to the block since it was freed. The link is skipped, since it is
+// overwritten on free.
+static Bool isPoisonIntact(UPtr address, U64 blockSizeBytes)
+{
+    const U8* pBytes = reinterpret_cast<const U8*>(address);
+    for (U64 i = sizeof(PoolFreeBlock); i < blockSizeBytes; ++i)
+    {
+        if (pBytes[i] != kFreeBlockPoison)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+PoolAllocator::PoolAllocator(U32 maxBlockSizeBytes, U64 slabSizeBytes, PoolAllocatorFlags flags)
+    : m_numSizeClasses(0)
+    , m_slabSizeBytes(0)
+    , m_flags(flags)
+    , m_slabBase(0)
+    , m_numSlabs(0)
+    , m_nextSlab(0u)
+    , m_pMetadata(nullptr)
+    , m_pSizeClasses(nullptr)
+    , m_pMagazines(nullptr)
+    , m_pAllocatedBits(nullptr)
+    , m_numAllocatedBitWords(0)
+{
+    R_ASSERT(Math::isPowerOf2(maxBlockSizeBytes));
+    m_numSizeClasses = getSizeClass(maxBlockSizeBytes) + 1u;
+    R_ASSERT_FORMAT(m_numSizeClasses <= kMaxSizeClasses, "PoolAllocator max block size %d is too large!", maxBlockSizeBytes);
+
+    // Slabs must fit whole blocks of any size class.
+    const U64 maxSizeBytes  = getBlockSizeBytes(m_numSizeClasses - 1u);
+    m_slabSizeBytes         = R_ALLOC_MASK(slabSizeBytes > maxSizeBytes ? slabSizeBytes : maxSizeBytes, maxSizeBytes);
+}
+
+
+PoolAllocator::~PoolAllocator()
+{
+    onCleanUp();
+}
+
+
+ResultCode PoolAllocator::onInitialize()
+{
+    // Aligning the slabs to the largest block size keeps every block aligned to its own size.
+    const UPtr baseAddr     = getBaseAddr();
+    const UPtr endAddr      = baseAddr + getTotalSizeBytes();
+    m_slabBase              = align(baseAddr, getMaxBlockSizeBytes());
+
+    if (m_slabBase + m_slabSizeBytes > endAddr)
+    {
+        R_ERROR("PoolAllocator", "Memory given is smaller than one slab (%llu bytes)!", m_slabSizeBytes);
+        return RecluseResult_InvalidArgs;
+    }
+
+    m_numSlabs      = static_cast<U32>((endAddr - m_slabBase) / m_slabSizeBytes);
+    m_slabSizeClasses.resize(m_numSlabs);
+
+    // One buffer for the shared lists and magazines, aligned by hand, since new[] doesn't
+    // respect cache line alignment before c++17.
+    const U64 sizeClassesBytes  = sizeof(PoolSizeClass) * m_numSizeClasses;
+    const U64 magazinesBytes    = sizeof(PoolMagazine) * kMaxMagazines;
+    m_pMetadata                 = new U8[sizeClassesBytes + magazinesBytes + kCacheLineSizeBytes];
+    const UPtr metadata         = align(reinterpret_cast<UPtr>(m_pMetadata), kCacheLineSizeBytes);
+    m_pSizeClasses              = reinterpret_cast<PoolSizeClass*>(metadata);
+    m_pMagazines                = reinterpret_cast<PoolMagazine*>(metadata + sizeClassesBytes);
+
+    for (U32 i = 0; i < m_numSizeClasses; ++i)
+    {
+        new (&m_pSizeClasses[i]) PoolSizeClass();
+    }
+
+    for (U32 i = 0; i < kMaxMagazines; ++i)
+    {
+        new (&m_pMagazines[i]) PoolMagazine();
+    }
+
+    if (m_flags & PoolAllocatorFlag_Debug)
+    {
+        const U64 numBlocks     = (m_numSlabs * m_slabSizeBytes) / kMinBlockSizeBytes;
+        m_numAllocatedBitWords  = (numBlocks + 63ull) / 64ull;
+        m_pAllocatedBits        = new Atomic<U64>[m_numAllocatedBitWords];
+    }
+
+    resetState();
+    return RecluseResult_Ok;
+}
+
+
+void PoolAllocator::resetState()
+{
+    for (U32 i = 0; i < m_numSlabs; ++i)
+    {
+        m_slabSizeClasses[i] = kUnassignedSlab;
+    }
+
+    for (U32 i = 0; i < m_numSizeClasses; ++i)
+    {
+        m_pSizeClasses[i].pFreeList     = nullptr;
+        m_pSizeClasses[i].carveCursor   = 0;
+        m_pSizeClasses[i].carveEnd      = 0;
+    }
+
+    for (U32 i = 0; i < kMaxMagazines; ++i)
+    {
+        for (U32 sizeClass = 0; sizeClass < kMaxSizeClasses; ++sizeClass)
+        {
+            m_pMagazines[i].lists[sizeClass].pHead = nullptr;
+            m_pMagazines[i].lists[sizeClass].count = 0;
+        }
+    }
+
+    for (U64 i = 0; i < m_numAllocatedBitWords; ++i)
+    {
+        m_pAllocatedBits[i].store(0ull, MemoryOrder_Relaxed);
+    }
+
+    m_nextSlab.store(0u);
+}
+
+
+U32 PoolAllocator::getNumUsedSlabs() const
+{
+    const U32 nextSlab = m_nextSlab.load(MemoryOrder_Relaxed);
+    return (nextSlab < m_numSlabs) ? nextSlab : m_numSlabs;
+}
+
+
+Bool PoolAllocator::refill(U32 sizeClass, PoolMagazine* pMagazine)
+{
+    PoolSizeClass& shared       = m_pSizeClasses[sizeClass];
+    PoolMagazineList& list      = pMagazine->lists[sizeClass];
+    const U64 blockSizeBytes    = getBlockSizeBytes(sizeClass);
+    const Bool isDebug          = (m_flags & PoolAllocatorFlag_Debug);
+
+    ScopedSpinLock _(shared.lock);
+
+    // Blocks freed back by other magazines first.
+    while (shared.pFreeList && (list.count < kMagazineBatchSize))
+    {
+        PoolFreeBlock* pBlock   = shared.pFreeList;
+        shared.pFreeList        = pBlock->pNext;
+        pBlock->pNext           = list.pHead;
+        list.pHead              = pBlock;
+        list.count             += 1;
+    }
+
+    // Then fresh blocks, carved out of the current slab, or a new one.
+    while (list.count < kMagazineBatchSize)
+    {
+        if (shared.carveCursor == shared.carveEnd)
+        {
+            // Checked first, so an exhausted pool doesn't keep bumping the counter.
+            const U32 slab = (m_nextSlab.load(MemoryOrder_Relaxed) < m_numSlabs) ? m_nextSlab.fetchAdd(1u, MemoryOrder_Relaxed) : m_numSlabs;
+            if (slab >= m_numSlabs)
+            {
+                break;
+            }
+            m_slabSizeClasses[slab] = static_cast<U8>(sizeClass);
+            shared.carveCursor      = m_slabBase + slab * m_slabSizeBytes;
+            shared.carveEnd         = shared.carveCursor + m_slabSizeBytes;
+        }
+
+        PoolFreeBlock* pBlock   = reinterpret_cast<PoolFreeBlock*>(shared.carveCursor);
+        shared.carveCursor     += blockSizeBytes;
+        if (isDebug)
+        {
+            memset(pBlock, kFreeBlockPoison, blockSizeBytes);
+        }
+        pBlock->pNext           = list.pHead;
+        list.pHead              = pBlock;
+        list.count             += 1;
+    }
+
+    return (list.count > 0);
+}
+
+
+void PoolAllocator::flush(U32 sizeClass, PoolMagazine* pMagazine, U32 count)
+{
+    PoolMagazineList& list = pMagazine->lists[sizeClass];
+    if (!list.pHead || (count == 0))
+    {
+        return;
+    }
+
+    // Split off the first count blocks, then hand them over in one go.
+    PoolFreeBlock* pFirst   = list.pHead;
+    PoolFreeBlock* pLast    = pFirst;
+    U32 numBlocks           = 1;
+    while ((numBlocks < count) && pLast->pNext)
+    {
+        pLast = pLast->pNext;
+        ++numBlocks;
+    }
+
+    list.pHead      = pLast->pNext;
+    list.count     -= numBlocks;
+
+    PoolSizeClass& shared = m_pSizeClasses[sizeClass];
+    ScopedSpinLock _(shared.lock);
+    pLast->pNext        = shared.pFreeList;
+    shared.pFreeList    = pFirst;
+}
+
+
+Bool PoolAllocator::markAllocated(UPtr address, Bool allocated)
+{
+    const U64 blockIndex    = (address - m_slabBase) / kMinBlockSizeBytes;
+    const U64 bit           = 1ull << (blockIndex & 63ull);
+    Atomic<U64>& word       = m_pAllocatedBits[blockIndex / 64ull];
+    const U64 previous      = allocated ? word.fetchOr(bit, MemoryOrder_Relaxed) : word.fetchAnd(~bit, MemoryOrder_Relaxed);
+    // Fails if the block was already in the requested state.
+    return ((previous & bit) != 0) != allocated;
+}
+
+
+ResultCode PoolAllocator::onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment)
+{
+    R_ASSERT(!alignment || Math::isPowerOf2(alignment));
+
+    // Blocks are aligned to their size, so a larger alignment only needs a larger block.
+    const U32 sizeClass = getSizeClass((requestSz > alignment) ? requestSz : alignment);
+    if (sizeClass >= m_numSizeClasses)
+    {
+        return RecluseResult_InvalidArgs;
+    }
+
+    PoolMagazine* pMagazine = &m_pMagazines[getThreadSlot()];
+    PoolFreeBlock* pBlock   = nullptr;
+    {
+        ScopedSpinLock _(pMagazine->lock);
+        PoolMagazineList& list = pMagazine->lists[sizeClass];
+        if (!list.pHead && !refill(sizeClass, pMagazine))
+        {
+            return RecluseResult_OutOfMemory;
+        }
+
+        pBlock      = list.pHead;
+        list.pHead  = pBlock->pNext;
+        list.count -= 1;
+    }
+
+    const UPtr address          = reinterpret_cast<UPtr>(pBlock);
+    const U64 blockSizeBytes    = getBlockSizeBytes(sizeClass);
+
+    if (m_flags & PoolAllocatorFlag_Debug)
+    {
+        if (!isPoisonIntact(address, blockSizeBytes))
+        {
+            R_ERROR("PoolAllocator", "Block 0x%llx was written to after it was freed!", static_cast<U64>(address));
+        }
+        markAllocated(address, true);
+        memset(pBlock, kNewBlockFill, blockSizeBytes);
+    }
+
+    pOutput->baseAddress    = address;
+    pOutput->sizeBytes      = blockSizeBytes;
+    return RecluseResult_Ok;
+}
+
+
+ResultCode PoolAllocator::onFree(Allocation* pOutput)
+{
+    const UPtr address = pOutput->baseAddress;
+    if ((address < m_slabBase) || (address >= m_slabBase + m_numSlabs * m_slabSizeBytes))
+    {
+        R_ERROR("PoolAllocator", "Freeing 0x%llx, which is not owned by this allocator!", static_cast<U64>(address));
+        return RecluseResult_InvalidArgs;
+    }
+
+    const U64 offset            = address - m_slabBase;
+    const U8 sizeClass          = m_slabSizeClasses[offset / m_slabSizeBytes];
+    const U64 blockSizeBytes    = (sizeClass == kUnassignedSlab) ? 0ull : getBlockSizeBytes(sizeClass);
+    if (!blockSizeBytes || (offset & (blockSizeBytes - 1ull)))
+    {
+        R_ERROR("PoolAllocator", "Freeing 0x%llx, which is not the start of a block!", static_cast<U64>(address));
+        return RecluseResult_InvalidArgs;
+    }
+
+    if (m_flags & PoolAllocatorFlag_Debug)
+    {
+        if (!markAllocated(address, false))
+        {
+            R_ERROR("PoolAllocator", "Double free of block 0x%llx!", static_cast<U64>(address));
+            return RecluseResult_CorruptMemory;
+        }
+        memset(reinterpret_cast<void*>(address), kFreeBlockPoison, blockSizeBytes);
+    }
+
+    PoolMagazine* pMagazine = &m_pMagazines[getThreadSlot()];
+    ScopedSpinLock _(pMagazine->lock);
+    PoolMagazineList& list  = pMagazine->lists[sizeClass];
+    PoolFreeBlock* pBlock   = reinterpret_cast<PoolFreeBlock*>(address);
+    pBlock->pNext           = list.pHead;
+    list.pHead              = pBlock;
+    list.count             += 1;
+
+    // Keep half, so alternating allocs and frees don't bounce blocks to the shared lists.
+    if (list.count > kMagazineCapacity)
+    {
+        flush(sizeClass, pMagazine, kMagazineBatchSize);
+    }
+
+    pOutput->sizeBytes = blockSizeBytes;
+    return RecluseResult_Ok;
+}
+
+
+ResultCode PoolAllocator::onReset()
+{
+    if (!m_pSizeClasses)
+    {
+        return RecluseResult_Ok;
+    }
+
+    resetState();
+    return RecluseResult_Ok;
+}
+
+
+ResultCode PoolAllocator::onCleanUp()
+{
+    // Shared lists and magazines are trivially destructible, so releasing their buffer is enough.
+    delete[] m_pMetadata;
+    delete[] m_pAllocatedBits;
+    m_pMetadata             = nullptr;
+    m_pSizeClasses          = nullptr;
+    m_pMagazines            = nullptr;
+    m_pAllocatedBits        = nullptr;
+    m_numAllocatedBitWords  = 0;
+    m_numSlabs              = 0;
+    m_slabBase              = 0;
+    m_slabSizeClasses.clear();
+    return RecluseResult_Ok;
+}
+} // Recluse
@@ -0,0 +1,175 @@
+//
+#include "Recluse/Memory/StackAllocator.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <string.h>
+
+namespace Recluse {
+
+
+#if defined(RECLUSE_DEBUG)
+static constexpr U64 kStackSentinel         = 0x5AC4A11C5AC4A11Cull;
+static constexpr U8 kFreedMemoryPoison      = 0xDDu;
+#endif
+
+
+// Sits right in front of each allocation.
+struct StackAllocationHeader
+{
+#if defined(RECLUSE_DEBUG)
+    U64     sentinel;
+#endif
+    // Top before this allocation, where freeing it rewinds to.
+    UPtr    prevTop;
+    // Allocation before this one, 0 if none.
+    UPtr    prevAllocation;
+};
+
+
+static R_FORCE_INLINE StackAllocationHeader* getHeader(UPtr allocation)
+{
+    return reinterpret_cast<StackAllocationHeader*>(allocation - sizeof(StackAllocationHeader));
+}
+
+
+StackAllocator::StackAllocator()
+    : m_lastAllocation(0ull)
+{
+}
+
+
+ResultCode StackAllocator::onInitialize()
+{
+    m_lastAllocation = 0ull;
+    return LinearAllocator::onInitialize();
+}
+
+
+StackMarker StackAllocator::getMarker() const
+{
+    StackMarker marker      = { };
+    marker.top              = getTop();
+    marker.numAllocations   = getTotalAllocations();
+    marker.lastAllocation   = m_lastAllocation;
+    return marker;
+}
+
+
+ResultCode StackAllocator::freeToMarker(const StackMarker& marker)
+{
+    const UPtr top = getTop();
+    if ((marker.top > top) || (marker.top < getBaseAddr()))
+    {
+        R_ERROR("StackAllocator", "Freeing to a marker that was already freed past! Markers must be freed in reverse order.");
+        return RecluseResult_CorruptMemory;
+    }
+
+#if defined(RECLUSE_DEBUG)
+    // Walk down the allocations made since the marker. The last one must start right at the
+    // marker, otherwise the marker is stale.
+    UPtr allocation = m_lastAllocation;
+    UPtr rewindTop  = top;
+    while (allocation)
+    {
+        const StackAllocationHeader* pHeader = getHeader(allocation);
+        if (pHeader->sentinel != kStackSentinel)
+        {
+            R_ERROR("StackAllocator", "Sentinel of 0x%llx was overwritten! Something wrote past the end of an allocation.", static_cast<U64>(allocation));
+            return RecluseResult_CorruptMemory;
+        }
+
+        if (pHeader->prevTop < marker.top)
+        {
+            break;
+        }
+
+        rewindTop   = pHeader->prevTop;
+        allocation  = pHeader->prevAllocation;
+    }
+
+    if (rewindTop != marker.top)
+    {
+        R_ERROR("StackAllocator", "Freeing to a stale marker! Markers must be freed in reverse order.");
+        return RecluseResult_CorruptMemory;
+    }
+
+    memset(reinterpret_cast<void*>(marker.top), kFreedMemoryPoison, top - marker.top);
+#endif
+
+    m_lastAllocation = marker.lastAllocation;
+
+    // Frees in between may have already given some of these back.
+    const U64 numAllocations = getTotalAllocations();
+    setTop(marker.top);
+    releaseUsage(marker.top, top - marker.top, (numAllocations > marker.numAllocations) ? (numAllocations - marker.numAllocations) : 0ull);
+    return RecluseResult_Ok;
+}
+
+
+ResultCode StackAllocator::onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment)
+{
+    // Room for the header in front, keeping the allocation itself aligned.
+    const UPtr prevTop              = getTop();
+    const U16 headerAlignment       = (alignment > alignof(StackAllocationHeader)) ? alignment : static_cast<U16>(alignof(StackAllocationHeader));
+    const U64 headerSizeBytes       = align(sizeof(StackAllocationHeader), headerAlignment);
+    ResultCode result               = LinearAllocator::onAllocate(pOutput, requestSz + headerSizeBytes, headerAlignment);
+    if (result != RecluseResult_Ok)
+    {
+        return result;
+    }
+
+    pOutput->baseAddress                    += headerSizeBytes;
+    StackAllocationHeader* pHeader          = getHeader(pOutput->baseAddress);
+#if defined(RECLUSE_DEBUG)
+    pHeader->sentinel                       = kStackSentinel;
+#endif
+    pHeader->prevTop                        = prevTop;
+    pHeader->prevAllocation                 = m_lastAllocation;
+    m_lastAllocation                        = pOutput->baseAddress;
+    return RecluseResult_Ok;
+}
+
+
+ResultCode StackAllocator::onFree(Allocation* pOutput)
+{
+    const UPtr top          = getTop();
+    const UPtr allocation   = pOutput->baseAddress;
+    if ((allocation < getBaseAddr()) || (allocation >= top))
+    {
+        R_ERROR("StackAllocator", "Freeing 0x%llx, which is not on the stack!", static_cast<U64>(allocation));
+        return RecluseResult_InvalidArgs;
+    }
+
+    if (allocation != m_lastAllocation)
+    {
+        R_ERROR("StackAllocator", "Freeing 0x%llx out of order! Only the most recent allocation can be freed.", static_cast<U64>(allocation));
+        return RecluseResult_CorruptMemory;
+    }
+
+    const StackAllocationHeader* pHeader = getHeader(allocation);
+#if defined(RECLUSE_DEBUG)
+    if (pHeader->sentinel != kStackSentinel)
+    {
+        R_ERROR("StackAllocator", "Sentinel of 0x%llx was overwritten! Something wrote past the end of an allocation.", static_cast<U64>(allocation));
+        return RecluseResult_CorruptMemory;
+    }
+#endif
+
+    const UPtr prevTop  = pHeader->prevTop;
+    m_lastAllocation    = pHeader->prevAllocation;
+#if defined(RECLUSE_DEBUG)
+    memset(reinterpret_cast<void*>(prevTop), kFreedMemoryPoison, top - prevTop);
+#endif
+
+    setTop(prevTop);
+    pOutput->sizeBytes = top - prevTop;
+    return RecluseResult_Ok;
+}
+
+
+ResultCode StackAllocator::onReset()
+{
+    m_lastAllocation = 0ull;
+    return LinearAllocator::onReset();
+}
+} // Recluse
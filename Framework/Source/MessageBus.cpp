@@ -18,15 +18,18 @@ MessageBus::MessageBus()
 
 void MessageBus::initialize(SizeT eventCacheSzBytes)
 {
-    // Pre-allocate a sizeable pool. Include room for our allocator!
-    m_messageMemPool.preAllocate(eventCacheSzBytes + sizeof(LinearAllocator));
+    // Reserve a sizeable pool, only the front is committed until messages pile up. Include room for our allocator!
+    m_messageMemPool.reserve(eventCacheSzBytes + sizeof(LinearAllocator), R_KB(64));
 
     // We will allocate our allocator into the pool too!
-    m_pMessageAllocator = new (reinterpret_cast<void*>(m_messageMemPool.getBaseAddress())) LinearAllocator();
+    LinearAllocator* pAllocator = new (reinterpret_cast<void*>(m_messageMemPool.getBaseAddress())) LinearAllocator();
+    pAllocator->setBackingPool(&m_messageMemPool);
+    pAllocator->setMemoryTag(MemoryTag_Messaging);
+    m_pMessageAllocator = pAllocator;
     m_pMessageAllocator->initialize
             (
                 m_messageMemPool.getPtrAddressAt(sizeof(LinearAllocator)), 
-                m_messageMemPool.getTotalSizeBytes()
+                m_messageMemPool.getTotalSizeBytes() - sizeof(LinearAllocator)
             );
 }
 
@@ -1,17 +1,1099 @@
 //
 #include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Memory/MemoryCommon.hpp"
+
+#include <atomic>
 
 namespace Recluse {
 
-ThreadPool::ThreadPool(U32 numWorkers)
-    : m_allWorkersFinished(true)
+
+static constexpr U32 kJobQueueMask          = kMaxThreadPoolJobs - 1u;
+static constexpr U32 kInvalidSlot           = 0xFFFFFFFFu;
+// Handle returned for jobs that had to run on the submitting thread.
+static constexpr U64 kInlineJobHandle       = 0xFFFFFFFFull;
+// Number of free slots a worker keeps for itself, before handing them back to the pool.
+static constexpr U32 kWorkerSlotCacheSize   = 32u;
+// Number of times a worker will spin looking for work before it decides to sleep.
+static constexpr U32 kWorkerSpinCount       = 64u;
+// Number of times a waiting thread will spin before it starts yielding its time slice.
+static constexpr U32 kWaiterSpinCount       = 128u;
+
+static_assert((kMaxThreadPoolJobs & kJobQueueMask) == 0, "kMaxThreadPoolJobs must be a power of two!");
+
+
+// Slot holding a submitted job. The generation is bumped once the job completes, which 
+// is how handles can tell their job has finished, even after the slot is reused.
+struct ThreadPoolTaskSlot
+{
+    ThreadJob           func;
+    void*               pPayload;
+    JobCounter*         pCounter;
+    std::atomic<U32>    generation;
+    std::atomic<U32>    nextFree;
+    U8                  pad[kCacheLineSizeBytes - sizeof(ThreadJob) - sizeof(void*) - sizeof(JobCounter*) - sizeof(U32) * 2];
+};
+
+
+enum FiberAction
+{
+    FiberAction_None,
+    // Fiber finished its job, and can be returned to the free list.
+    FiberAction_Finished,
+    // Fiber is waiting on a counter.
+    FiberAction_Park,
+    // Fiber wants to be resumed later, after other work had a chance to run.
+    FiberAction_Yield
+};
+
+
+struct ThreadPoolFiber
+{
+    Fiber               handle;
+    ThreadPool*         pPool;
+    U32                 slotIndex;
+    // Link for the free, ready, or counter wait lists. A fiber is only on one at a time.
+    ThreadPoolFiber*    pNext;
+};
+
+
+struct ThreadPoolSharedState
+{
+    // Head of the free slot list. Upper 32 bits are a tag to avoid ABA.
+    std::atomic<U64>    freeSlotHead;
+    U8                  pad0[kCacheLineSizeBytes - sizeof(U64)];
+    std::atomic<U64>    pendingJobs;
+    U8                  pad1[kCacheLineSizeBytes - sizeof(U64)];
+    std::atomic<I32>    sleepingWorkers;
+    std::atomic<U32>    nextInbox;
+    std::atomic<Bool>   shutdown;
+    U8                  pad2[kCacheLineSizeBytes - sizeof(I32) - sizeof(U32) - sizeof(Bool)];
+    // Fiber lists, only used in fiber mode.
+    CriticalSectionGuard fiberCs;
+    ThreadPoolFiber*    pFreeFibers;
+    ThreadPoolFiber*    pReadyHead;
+    ThreadPoolFiber*    pReadyTail;
+    std::atomic<U32>    numReadyFibers;
+};
+
+
+static U64 makeJobHandleId(U32 generation, U32 slotIndex)
+{
+    return (static_cast<U64>(generation) << 32ull) | static_cast<U64>(slotIndex + 1u);
+}
+
+
+// Chase-Lev work stealing deque. The owning worker pushes and takes from the bottom, while
+// other threads steal from the top. The number of jobs in flight is bounded by the number
+// of task slots, so the buffer is fixed and never needs to grow.
+class WorkStealingDeque
+{
+public:
+    void initialize()
+    {
+        m_top.store(0, std::memory_order_relaxed);
+        m_bottom.store(0, std::memory_order_relaxed);
+        for (U32 i = 0; i < kMaxThreadPoolJobs; ++i)
+        {
+            m_entries[i].store(kInvalidSlot, std::memory_order_relaxed);
+        }
+    }
+
+    // Owner thread only.
+    Bool push(U32 slotIndex)
+    {
+        const I64 b = m_bottom.load(std::memory_order_relaxed);
+        const I64 t = m_top.load(std::memory_order_acquire);
+
+        if ((b - t) >= static_cast<I64>(kMaxThreadPoolJobs))
+        {
+            return false;
+        }
+
+        m_entries[b & kJobQueueMask].store(slotIndex, std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner thread only.
+    Bool take(U32& slotIndex)
+    {
+        const I64 b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        I64 t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // Empty.
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slotIndex = m_entries[b & kJobQueueMask].load(std::memory_order_relaxed);
+
+        if (t == b)
+        {
+            // Last job in the deque, need to race any thieves for it.
+            const Bool won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        return true;
+    }
+
+    // Any thread.
+    Bool steal(U32& slotIndex)
+    {
+        I64 t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const I64 b = m_bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+        {
+            return false;
+        }
+
+        slotIndex = m_entries[t & kJobQueueMask].load(std::memory_order_relaxed);
+        return m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    Bool isEmpty() const
+    {
+        return (m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed));
+    }
+
+private:
+    std::atomic<I64>    m_top;
+    U8                  m_pad0[kCacheLineSizeBytes - sizeof(I64)];
+    std::atomic<I64>    m_bottom;
+    U8                  m_pad1[kCacheLineSizeBytes - sizeof(I64)];
+    std::atomic<U32>    m_entries[kMaxThreadPoolJobs];
+};
+
+
+// Inbox for jobs that are submitted from threads outside of the pool, since they can not
+// push onto a worker's deque.
+class JobInbox
+{
+public:
+    void initialize()
+    {
+        m_head = 0;
+        m_tail = 0;
+        m_count.store(0, std::memory_order_relaxed);
+    }
+
+    void push(U32 slotIndex)
+    {
+        ScopedCriticalSection _(m_cs);
+        R_ASSERT((m_tail - m_head) < kMaxThreadPoolJobs);
+        m_ring[m_tail & kJobQueueMask] = slotIndex;
+        m_tail += 1;
+        m_count.store(m_tail - m_head, std::memory_order_release);
+    }
+
+    Bool pop(U32& slotIndex)
+    {
+        if (isEmpty())
+        {
+            return false;
+        }
+
+        ScopedCriticalSection _(m_cs);
+
+        if (m_head == m_tail)
+        {
+            return false;
+        }
+
+        slotIndex = m_ring[m_head & kJobQueueMask];
+        m_head += 1;
+        m_count.store(m_tail - m_head, std::memory_order_release);
+        return true;
+    }
+
+    Bool isEmpty() const
+    {
+        return (m_count.load(std::memory_order_acquire) == 0);
+    }
+
+private:
+    CriticalSectionGuard    m_cs;
+    std::atomic<U32>        m_count;
+    U32                     m_head;
+    U32                     m_tail;
+    U32                     m_ring[kMaxThreadPoolJobs];
+};
+
+
+struct ThreadPoolWorker
+{
+    WorkStealingDeque   deque;
+    JobInbox            inbox;
+    ThreadPool*         pPool;
+    U32                 index;
+    U32                 numCachedSlots;
+    U32                 cachedSlots[kWorkerSlotCacheSize];
+    // Fiber of the worker thread itself, which runs the scheduling loop in fiber mode.
+    Fiber               schedulerFiber;
+    // Action the last fiber requested when it switched back to the scheduler. This is 
+    // carried out after the switch, once the fiber is no longer running.
+    U32                 fiberAction;
+    ThreadPoolFiber*    pActionFiber;
+    JobCounter*         pActionCounter;
+};
+
+
+// Worker that the current thread is running as, if any.
+static thread_local ThreadPoolWorker*   t_pCurrentWorker    = nullptr;
+// Pool fiber that the current thread is running, if any.
+static thread_local ThreadPoolFiber*    t_pCurrentFiber     = nullptr;
+static thread_local U32                 t_stealSeed         = 0u;
+
+
+// Thread locals are accessed through functions that are never inlined. Fibers may resume 
+// on a different thread, so the compiler must not cache thread local addresses across a 
+// fiber switch.
+R_NO_INLINE static ThreadPoolWorker* getCurrentWorker()
+{
+    return t_pCurrentWorker;
+}
+
+
+R_NO_INLINE static ThreadPoolFiber* getCurrentFiber()
+{
+    return t_pCurrentFiber;
+}
+
+
+R_NO_INLINE static void setCurrentFiber(ThreadPoolFiber* pFiber)
+{
+    t_pCurrentFiber = pFiber;
+}
+
+
+// Returns the worker the calling thread runs as, if it belongs to the given pool.
+static ThreadPoolWorker* getLocalWorker(const ThreadPool* pPool)
+{
+    ThreadPoolWorker* pWorker = getCurrentWorker();
+    return (pWorker && (pWorker->pPool == pPool)) ? pWorker : nullptr;
+}
+
+
+// Returns the pool fiber the calling thread is running, if it belongs to the given pool.
+static ThreadPoolFiber* getLocalFiber(const ThreadPool* pPool)
+{
+    ThreadPoolFiber* pFiber = getCurrentFiber();
+    return (pFiber && (pFiber->pPool == pPool)) ? pFiber : nullptr;
+}
+
+
+static U32 nextStealIndex()
+{
+    if (t_stealSeed == 0u)
+    {
+        t_stealSeed = static_cast<U32>(getCurrentThreadId()) | 1u;
+    }
+
+    // xorshift32
+    U32 x = t_stealSeed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    t_stealSeed = x;
+    return x;
+}
+
+
+// Claims one of the sleeping workers. Submitters must signal the semaphore for every claim
+// they make, while a worker that claims itself back simply cancels going to sleep.
+static Bool claimSleepingWorker(ThreadPoolSharedState* pShared)
+{
+    I32 sleeping = pShared->sleepingWorkers.load(std::memory_order_relaxed);
+    while (sleeping > 0)
+    {
+        if (pShared->sleepingWorkers.compare_exchange_weak(sleeping, sleeping - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+ThreadPool::ThreadPool(U32 numWorkers, U32 numFibers, SizeT fiberStackSizeBytes)
+    : m_pTaskSlots(nullptr)
+    , m_pShared(nullptr)
+    , m_wakeSemaphore(nullptr)
 {
+    m_pShared = new ThreadPoolSharedState();
+    m_pShared->pendingJobs.store(0ull, std::memory_order_relaxed);
+    m_pShared->sleepingWorkers.store(0, std::memory_order_relaxed);
+    m_pShared->nextInbox.store(0u, std::memory_order_relaxed);
+    m_pShared->shutdown.store(false, std::memory_order_relaxed);
+    m_pShared->pFreeFibers  = nullptr;
+    m_pShared->pReadyHead   = nullptr;
+    m_pShared->pReadyTail   = nullptr;
+    m_pShared->numReadyFibers.store(0u, std::memory_order_relaxed);
+
+    // All slots start out in the free list.
+    m_pTaskSlots = new ThreadPoolTaskSlot[kMaxThreadPoolJobs];
+    for (U32 i = 0; i < kMaxThreadPoolJobs; ++i)
+    {
+        m_pTaskSlots[i].func        = nullptr;
+        m_pTaskSlots[i].pPayload    = nullptr;
+        m_pTaskSlots[i].pCounter    = nullptr;
+        m_pTaskSlots[i].generation.store(0u, std::memory_order_relaxed);
+        m_pTaskSlots[i].nextFree.store((i + 1u < kMaxThreadPoolJobs) ? (i + 1u) : kInvalidSlot, std::memory_order_relaxed);
+    }
+    m_pShared->freeSlotHead.store(0ull, std::memory_order_release);
+
+    if (numWorkers == 0)
+    {
+        return;
+    }
+
+    m_wakeSemaphore = createSemaphore();
+
+    // All workers need to be ready before any thread starts, since they will try stealing
+    // from each other immediately.
+    m_workers.resize(numWorkers);
+    for (U32 i = 0; i < numWorkers; ++i)
+    {
+        ThreadPoolWorker* pWorker = new ThreadPoolWorker();
+        pWorker->deque.initialize();
+        pWorker->inbox.initialize();
+        pWorker->pPool          = this;
+        pWorker->index          = i;
+        pWorker->numCachedSlots = 0;
+        pWorker->schedulerFiber = nullptr;
+        pWorker->fiberAction    = FiberAction_None;
+        pWorker->pActionFiber   = nullptr;
+        pWorker->pActionCounter = nullptr;
+        m_workers[i]            = pWorker;
+    }
+
+    m_fibers.reserve(numFibers);
+    for (U32 i = 0; i < numFibers; ++i)
+    {
+        ThreadPoolFiber* pFiber = new ThreadPoolFiber();
+        pFiber->pPool           = this;
+        pFiber->slotIndex       = kInvalidSlot;
+        pFiber->handle          = createFiber(fiberFunc, pFiber, fiberStackSizeBytes);
+        if (!pFiber->handle)
+        {
+            R_ERROR("ThreadPool", "Failed to create job fiber %d!", i);
+            delete pFiber;
+            break;
+        }
+        pFiber->pNext           = m_pShared->pFreeFibers;
+        m_pShared->pFreeFibers  = pFiber;
+        m_fibers.push_back(pFiber);
+    }
+
     m_threadWorkers.resize(numWorkers);
+    for (U32 i = 0; i < numWorkers; ++i)
+    {
+        Thread& thread  = m_threadWorkers[i];
+        thread          = { };
+        thread.payload  = m_workers[i];
+
+        ResultCode result = createThread(&thread, workerThreadFunc);
+        if (result != RecluseResult_Ok)
+        {
+            R_ERROR("ThreadPool", "Failed to create worker thread %d!", i);
+        }
+    }
 }
 
 
 ThreadPool::~ThreadPool()
 {
-    // Need to clean up.s
+    waitFinished();
+
+    if (!m_workers.empty())
+    {
+        m_pShared->shutdown.store(true, std::memory_order_seq_cst);
+
+        // Wake everyone up, so they can see the shutdown.
+        for (U32 i = 0; i < m_workers.size(); ++i)
+        {
+            signalSemaphore(m_wakeSemaphore);
+        }
+
+        for (U32 i = 0; i < m_threadWorkers.size(); ++i)
+        {
+            if (m_threadWorkers[i].handle)
+            {
+                joinThread(&m_threadWorkers[i]);
+            }
+        }
+
+        for (U32 i = 0; i < m_workers.size(); ++i)
+        {
+            delete m_workers[i];
+        }
+
+        for (U32 i = 0; i < m_fibers.size(); ++i)
+        {
+            destroyFiber(m_fibers[i]->handle);
+            delete m_fibers[i];
+        }
+
+        destroySemaphore(m_wakeSemaphore);
+    }
+
+    m_workers.clear();
+    m_threadWorkers.clear();
+    m_fibers.clear();
+
+    delete[] m_pTaskSlots;
+    delete m_pShared;
+
+    m_pTaskSlots    = nullptr;
+    m_pShared       = nullptr;
+    m_wakeSemaphore = nullptr;
+}
+
+
+JobHandle ThreadPool::submitJob(ThreadJob job, void* pPayload, U32 workerHint, JobCounter* pCounter)
+{
+    R_ASSERT(job != nullptr);
+
+    ThreadPoolWorker* pWorker   = getLocalWorker(this);
+    U32 slotIndex               = kInvalidSlot;
+
+    if (m_workers.empty() || !acquireSlot(pWorker, slotIndex))
+    {
+        // No workers, or the pool is saturated. Waiting for a slot could dead lock if the jobs 
+        // holding them are waiting on us, so just run the job here.
+        job(pPayload);
+        JobHandle handle = { kInlineJobHandle };
+        return handle;
+    }
+
+    ThreadPoolTaskSlot& slot    = m_pTaskSlots[slotIndex];
+    slot.func                   = job;
+    slot.pPayload               = pPayload;
+    slot.pCounter               = pCounter;
+    JobHandle handle            = { makeJobHandleId(slot.generation.load(std::memory_order_relaxed), slotIndex) };
+
+    if (pCounter)
+    {
+        pCounter->add(1u);
+    }
+
+    m_pShared->pendingJobs.fetch_add(1ull, std::memory_order_relaxed);
+
+    enqueueJob(pWorker, slotIndex, workerHint);
+    wakeWorker();
+
+    return handle;
+}
+
+
+ResultCode ThreadPool::wait(JobHandle handle)
+{
+    if (!handle.isValid())
+    {
+        return RecluseResult_InvalidArgs;
+    }
+
+    ThreadPoolFiber* pFiber = getLocalFiber(this);
+    if (pFiber)
+    {
+        // Handles don't keep a wait list, so just let other work run until the job is done.
+        while (!isDone(handle))
+        {
+            switchToScheduler(pFiber, FiberAction_Yield, nullptr);
+        }
+        return RecluseResult_Ok;
+    }
+
+    ThreadPoolWorker* pWorker   = getLocalWorker(this);
+    U32 spinCount               = 0;
+
+    while (!isDone(handle))
+    {
+        if (executeNextJob(pWorker))
+        {
+            spinCount = 0;
+        }
+        else
+        {
+            backoff(spinCount);
+        }
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+Bool ThreadPool::isDone(JobHandle handle) const
+{
+    const U32 slotIndex = static_cast<U32>(handle.id & 0xFFFFFFFFull);
+    if (handle.id == kInlineJobHandle || slotIndex == 0 || slotIndex > kMaxThreadPoolJobs)
+    {
+        return true;
+    }
+
+    const U32 generation = static_cast<U32>(handle.id >> 32ull);
+    return (m_pTaskSlots[slotIndex - 1].generation.load(std::memory_order_acquire) != generation);
+}
+
+
+Bool ThreadPool::tryExecuteJob()
+{
+    return executeNextJob(getLocalWorker(this));
+}
+
+
+ResultCode ThreadPool::waitForCounter(JobCounter* pCounter)
+{
+    R_ASSERT(pCounter != nullptr);
+
+    if (pCounter->getValue() != 0u)
+    {
+        ThreadPoolFiber* pFiber = getLocalFiber(this);
+        if (pFiber)
+        {
+            // Parked until the counter reaches zero.
+            switchToScheduler(pFiber, FiberAction_Park, pCounter);
+        }
+        else
+        {
+            ThreadPoolWorker* pWorker   = getLocalWorker(this);
+            U32 spinCount               = 0;
+
+            while (pCounter->getValue() != 0u)
+            {
+                if (executeNextJob(pWorker))
+                {
+                    spinCount = 0;
+                }
+                else
+                {
+                    backoff(spinCount);
+                }
+            }
+        }
+    }
+
+    // Whoever brought the counter to zero may still hold the lock, make sure they are done
+    // with the counter before the caller is free to destroy it.
+    pCounter->lock();
+    pCounter->unlock();
+
+    return RecluseResult_Ok;
+}
+
+
+void ThreadPool::decrementCounter(JobCounter* pCounter, U32 count)
+{
+    R_ASSERT(pCounter != nullptr);
+
+    ThreadPoolFiber* pWaiters = nullptr;
+
+    pCounter->lock();
+    const U32 previous = pCounter->m_value.fetch_sub(count, std::memory_order_acq_rel);
+    R_ASSERT(previous >= count);
+    if (previous == count)
+    {
+        pWaiters                = pCounter->m_pWaiters;
+        pCounter->m_pWaiters    = nullptr;
+    }
+    pCounter->unlock();
+
+    while (pWaiters)
+    {
+        ThreadPoolFiber* pNext = pWaiters->pNext;
+        pushReadyFiber(pWaiters);
+        pWaiters = pNext;
+    }
+}
+
+
+ResultCode ThreadPool::waitFinished()
+{
+    ThreadPoolWorker* pWorker = getLocalWorker(this);
+    // Calling from within a job would never finish, since the pending count includes the caller.
+    R_ASSERT(pWorker == nullptr);
+    U32 spinCount = 0;
+
+    while (m_pShared->pendingJobs.load(std::memory_order_acquire) > 0ull)
+    {
+        if (executeNextJob(pWorker))
+        {
+            spinCount = 0;
+        }
+        else
+        {
+            backoff(spinCount);
+        }
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+Bool ThreadPool::isExecuting()
+{
+    return (m_pShared->pendingJobs.load(std::memory_order_acquire) > 0ull);
+}
+
+
+Bool ThreadPool::isFinished()
+{
+    return (m_pShared->pendingJobs.load(std::memory_order_acquire) == 0ull);
+}
+
+
+ResultCode ThreadPool::setWorkerAffinity(U32 workerIndex, U64 affinityMask)
+{
+    if ((workerIndex >= m_threadWorkers.size()) || !m_threadWorkers[workerIndex].handle)
+    {
+        return RecluseResult_InvalidArgs;
+    }
+    return setThreadAffinity(&m_threadWorkers[workerIndex], affinityMask);
+}
+
+
+ResultCode ThreadPool::setWorkerPriority(U32 workerIndex, ThreadPriority priority)
+{
+    if ((workerIndex >= m_threadWorkers.size()) || !m_threadWorkers[workerIndex].handle)
+    {
+        return RecluseResult_InvalidArgs;
+    }
+    return setThreadPriority(&m_threadWorkers[workerIndex], priority);
+}
+
+
+U32 ThreadPool::workerThreadFunc(void* pData)
+{
+    ThreadPoolWorker* pWorker = static_cast<ThreadPoolWorker*>(pData);
+    pWorker->pPool->runWorker(pWorker);
+    return 0;
+}
+
+
+void ThreadPool::fiberFunc(void* pData)
+{
+    ThreadPoolFiber* pFiber = static_cast<ThreadPoolFiber*>(pData);
+    ThreadPool* pPool       = pFiber->pPool;
+
+    // Fibers never return, once the job is done they go back to the scheduler, which
+    // puts them back on the free list until the next job.
+    for (;;)
+    {
+        pPool->executeJob(pFiber->slotIndex);
+        pPool->switchToScheduler(pFiber, FiberAction_Finished, nullptr);
+    }
+}
+
+
+void ThreadPool::runWorker(ThreadPoolWorker* pWorker)
+{
+    t_pCurrentWorker    = pWorker;
+    U32 idleCount       = 0;
+
+    if (!m_fibers.empty())
+    {
+        pWorker->schedulerFiber = convertThreadToFiber();
+    }
+
+    while (!m_pShared->shutdown.load(std::memory_order_acquire))
+    {
+        if (executeNextJob(pWorker))
+        {
+            idleCount = 0;
+            continue;
+        }
+
+        if (idleCount < kWorkerSpinCount)
+        {
+            ++idleCount;
+            yieldProcessor();
+            continue;
+        }
+
+        idleCount = 0;
+
+        // Announce that we are going to sleep, then check one last time for work. Submitters
+        // check the sleeping count after publishing their job, so either we see their job here,
+        // or they see us and signal the semaphore.
+        m_pShared->sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (hasPendingWork() || m_pShared->shutdown.load(std::memory_order_relaxed))
+        {
+            if (claimSleepingWorker(m_pShared))
+            {
+                continue;
+            }
+            // Someone already claimed our wake up, so consume the signal below.
+        }
+
+        waitSemaphore(m_wakeSemaphore);
+    }
+
+    if (pWorker->schedulerFiber)
+    {
+        convertFiberToThread(pWorker->schedulerFiber);
+        pWorker->schedulerFiber = nullptr;
+    }
+
+    t_pCurrentWorker = nullptr;
+}
+
+
+Bool ThreadPool::executeNextJob(ThreadPoolWorker* pWorker)
+{
+    // Only the worker's scheduler may switch to fibers. Anywhere else, jobs run in place.
+    const Bool canSwitch    = pWorker && pWorker->schedulerFiber && !getLocalFiber(this);
+    ThreadPoolFiber* pFiber = nullptr;
+
+    if (canSwitch)
+    {
+        // Resumed fibers go first, since they are holding on to a fiber already.
+        pFiber = popReadyFiber();
+        if (pFiber)
+        {
+            runFiber(pWorker, pFiber);
+            return true;
+        }
+    }
+
+    U32 slotIndex = kInvalidSlot;
+    if (!popJob(pWorker, slotIndex))
+    {
+        return false;
+    }
+
+    pFiber = canSwitch ? acquireFiber() : nullptr;
+    if (pFiber)
+    {
+        pFiber->slotIndex = slotIndex;
+        runFiber(pWorker, pFiber);
+    }
+    else
+    {
+        executeJob(slotIndex);
+    }
+
+    return true;
+}
+
+
+Bool ThreadPool::popJob(ThreadPoolWorker* pWorker, U32& slotIndex)
+{
+    if (pWorker)
+    {
+        if (pWorker->deque.take(slotIndex) || pWorker->inbox.pop(slotIndex))
+        {
+            return true;
+        }
+    }
+
+    const U32 numWorkers = static_cast<U32>(m_workers.size());
+    if (numWorkers == 0)
+    {
+        return false;
+    }
+
+    const U32 start = nextStealIndex() % numWorkers;
+
+    for (U32 i = 0; i < numWorkers; ++i)
+    {
+        ThreadPoolWorker* pVictim = m_workers[(start + i) % numWorkers];
+        if (pVictim != pWorker && pVictim->deque.steal(slotIndex))
+        {
+            return true;
+        }
+    }
+
+    for (U32 i = 0; i < numWorkers; ++i)
+    {
+        ThreadPoolWorker* pVictim = m_workers[(start + i) % numWorkers];
+        if (pVictim != pWorker && pVictim->inbox.pop(slotIndex))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+Bool ThreadPool::hasPendingWork() const
+{
+    for (U32 i = 0; i < m_workers.size(); ++i)
+    {
+        if (!m_workers[i]->deque.isEmpty() || !m_workers[i]->inbox.isEmpty())
+        {
+            return true;
+        }
+    }
+    return (m_pShared->numReadyFibers.load(std::memory_order_relaxed) > 0u);
+}
+
+
+void ThreadPool::executeJob(U32 slotIndex)
+{
+    ThreadPoolTaskSlot& slot    = m_pTaskSlots[slotIndex];
+    JobCounter* pCounter        = slot.pCounter;
+
+    slot.func(slot.pPayload);
+
+    // Bumping the generation is what marks any handles to this job as done.
+    slot.generation.fetch_add(1u, std::memory_order_release);
+
+    if (pCounter)
+    {
+        decrementCounter(pCounter, 1u);
+    }
+
+    // The job may have been resumed on a different worker, so query the worker again.
+    releaseSlot(getLocalWorker(this), slotIndex);
+
+    m_pShared->pendingJobs.fetch_sub(1ull, std::memory_order_acq_rel);
+}
+
+
+void ThreadPool::enqueueJob(ThreadPoolWorker* pWorker, U32 slotIndex, U32 workerHint)
+{
+    const U32 numWorkers = static_cast<U32>(m_workers.size());
+
+    if (workerHint != kAnyThreadPoolWorker)
+    {
+        ThreadPoolWorker* pTarget = m_workers[workerHint % numWorkers];
+        if (pTarget != pWorker)
+        {
+            pTarget->inbox.push(slotIndex);
+            return;
+        }
+    }
+
+    if (pWorker && pWorker->deque.push(slotIndex))
+    {
+        return;
+    }
+
+    const U32 inboxIndex = m_pShared->nextInbox.fetch_add(1u, std::memory_order_relaxed) % numWorkers;
+    m_workers[inboxIndex]->inbox.push(slotIndex);
+}
+
+
+Bool ThreadPool::acquireSlot(ThreadPoolWorker* pWorker, U32& slotIndex)
+{
+    if (pWorker && pWorker->numCachedSlots > 0)
+    {
+        pWorker->numCachedSlots -= 1;
+        slotIndex = pWorker->cachedSlots[pWorker->numCachedSlots];
+        return true;
+    }
+
+    U64 head = m_pShared->freeSlotHead.load(std::memory_order_acquire);
+    for (;;)
+    {
+        const U32 index = static_cast<U32>(head & 0xFFFFFFFFull);
+        if (index == kInvalidSlot)
+        {
+            return false;
+        }
+
+        const U64 tag   = (head >> 32ull) + 1ull;
+        const U32 next  = m_pTaskSlots[index].nextFree.load(std::memory_order_relaxed);
+        if (m_pShared->freeSlotHead.compare_exchange_weak(head, (tag << 32ull) | next, std::memory_order_acquire, std::memory_order_acquire))
+        {
+            slotIndex = index;
+            return true;
+        }
+    }
+}
+
+
+void ThreadPool::releaseSlot(ThreadPoolWorker* pWorker, U32 slotIndex)
+{
+    if (pWorker && pWorker->numCachedSlots < kWorkerSlotCacheSize)
+    {
+        pWorker->cachedSlots[pWorker->numCachedSlots] = slotIndex;
+        pWorker->numCachedSlots += 1;
+        return;
+    }
+
+    U64 head = m_pShared->freeSlotHead.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        m_pTaskSlots[slotIndex].nextFree.store(static_cast<U32>(head & 0xFFFFFFFFull), std::memory_order_relaxed);
+        const U64 tag = (head >> 32ull) + 1ull;
+        if (m_pShared->freeSlotHead.compare_exchange_weak(head, (tag << 32ull) | slotIndex, std::memory_order_release, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+}
+
+
+void ThreadPool::runFiber(ThreadPoolWorker* pWorker, ThreadPoolFiber* pFiber)
+{
+    setCurrentFiber(pFiber);
+    switchToFiber(pFiber->handle);
+    // Back on the scheduler, which always stays on this thread.
+    setCurrentFiber(nullptr);
+    finishFiberSwitch(pWorker);
+}
+
+
+void ThreadPool::finishFiberSwitch(ThreadPoolWorker* pWorker)
+{
+    const U32 action            = pWorker->fiberAction;
+    ThreadPoolFiber* pFiber     = pWorker->pActionFiber;
+    JobCounter* pCounter        = pWorker->pActionCounter;
+
+    pWorker->fiberAction        = FiberAction_None;
+    pWorker->pActionFiber       = nullptr;
+    pWorker->pActionCounter     = nullptr;
+
+    switch (action)
+    {
+        case FiberAction_Finished:
+        {
+            ScopedCriticalSection _(m_pShared->fiberCs);
+            pFiber->slotIndex       = kInvalidSlot;
+            pFiber->pNext           = m_pShared->pFreeFibers;
+            m_pShared->pFreeFibers  = pFiber;
+            break;
+        }
+
+        case FiberAction_Park:
+        {
+            // The fiber is no longer running, so it is now safe for others to resume it.
+            pCounter->lock();
+            if (pCounter->m_value.load(std::memory_order_acquire) == 0u)
+            {
+                pCounter->unlock();
+                pushReadyFiber(pFiber);
+            }
+            else
+            {
+                pFiber->pNext           = pCounter->m_pWaiters;
+                pCounter->m_pWaiters    = pFiber;
+                pCounter->unlock();
+            }
+            break;
+        }
+
+        case FiberAction_Yield:
+            pushReadyFiber(pFiber);
+            break;
+
+        case FiberAction_None:
+        default:
+            break;
+    }
+}
+
+
+void ThreadPool::switchToScheduler(ThreadPoolFiber* pFiber, U32 action, JobCounter* pCounter)
+{
+    ThreadPoolWorker* pWorker   = getLocalWorker(this);
+    R_ASSERT(pWorker != nullptr);
+
+    pWorker->fiberAction        = action;
+    pWorker->pActionFiber       = pFiber;
+    pWorker->pActionCounter     = pCounter;
+
+    switchToFiber(pWorker->schedulerFiber);
+    // Resumed, possibly on another worker.
+}
+
+
+ThreadPoolFiber* ThreadPool::acquireFiber()
+{
+    ScopedCriticalSection _(m_pShared->fiberCs);
+
+    ThreadPoolFiber* pFiber = m_pShared->pFreeFibers;
+    if (pFiber)
+    {
+        m_pShared->pFreeFibers  = pFiber->pNext;
+        pFiber->pNext           = nullptr;
+    }
+
+    return pFiber;
+}
+
+
+void ThreadPool::pushReadyFiber(ThreadPoolFiber* pFiber)
+{
+    {
+        ScopedCriticalSection _(m_pShared->fiberCs);
+
+        pFiber->pNext = nullptr;
+        if (m_pShared->pReadyTail)
+        {
+            m_pShared->pReadyTail->pNext = pFiber;
+        }
+        else
+        {
+            m_pShared->pReadyHead = pFiber;
+        }
+        m_pShared->pReadyTail = pFiber;
+        m_pShared->numReadyFibers.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    wakeWorker();
+}
+
+
+ThreadPoolFiber* ThreadPool::popReadyFiber()
+{
+    if (m_pShared->numReadyFibers.load(std::memory_order_relaxed) == 0u)
+    {
+        return nullptr;
+    }
+
+    ScopedCriticalSection _(m_pShared->fiberCs);
+
+    ThreadPoolFiber* pFiber = m_pShared->pReadyHead;
+    if (pFiber)
+    {
+        m_pShared->pReadyHead = pFiber->pNext;
+        if (!m_pShared->pReadyHead)
+        {
+            m_pShared->pReadyTail = nullptr;
+        }
+        pFiber->pNext = nullptr;
+        m_pShared->numReadyFibers.fetch_sub(1u, std::memory_order_relaxed);
+    }
+
+    return pFiber;
+}
+
+
+void ThreadPool::wakeWorker()
+{
+    // Pairs with the fence in runWorker(), before a worker goes to sleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_pShared->sleepingWorkers.load(std::memory_order_relaxed) > 0 && claimSleepingWorker(m_pShared))
+    {
+        signalSemaphore(m_wakeSemaphore);
+    }
+}
+
+
+void ThreadPool::backoff(U32& spinCount)
+{
+    if (spinCount < kWaiterSpinCount)
+    {
+        ++spinCount;
+        yieldProcessor();
+    }
+    else
+    {
+        yieldThread();
+    }
 }
-} // Recluse
\ No newline at end of file
+} // Recluse
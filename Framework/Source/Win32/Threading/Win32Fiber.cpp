@@ -0,0 +1,106 @@
+//
+#include "Win32/Threading/Win32Thread.hpp"
+#include "Recluse/Threading/Fiber.hpp"
+#include "Recluse/Messaging.hpp"
+
+namespace Recluse {
+
+
+struct Win32Fiber
+{
+    LPVOID          handle;
+    FiberFunction   func;
+    void*           pData;
+    Bool            isThread;
+};
+
+
+static VOID WINAPI win32FiberStart(LPVOID lpParameter)
+{
+    Win32Fiber* pFiber = static_cast<Win32Fiber*>(lpParameter);
+    pFiber->func(pFiber->pData);
+
+    R_ASSERT_FORMAT(false, "Fiber returned from its function! Fibers must switch away instead.");
+}
+
+
+Fiber convertThreadToFiber()
+{
+    Win32Fiber* pFiber  = new Win32Fiber();
+    pFiber->func        = nullptr;
+    pFiber->pData       = nullptr;
+    pFiber->isThread    = true;
+    pFiber->handle      = ConvertThreadToFiberEx(pFiber, FIBER_FLAG_FLOAT_SWITCH);
+
+    if (!pFiber->handle)
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to convert thread to fiber! Result: %d", GetLastError());
+        delete pFiber;
+        return nullptr;
+    }
+
+    return pFiber;
+}
+
+
+ResultCode convertFiberToThread(Fiber threadFiber)
+{
+    Win32Fiber* pFiber = static_cast<Win32Fiber*>(threadFiber);
+    R_ASSERT(pFiber != NULL && pFiber->isThread);
+
+    if (!ConvertFiberToThread())
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to convert fiber to thread! Result: %d", GetLastError());
+        return RecluseResult_Failed;
+    }
+
+    delete pFiber;
+    return RecluseResult_Ok;
+}
+
+
+Fiber createFiber(FiberFunction func, void* pData, SizeT stackSizeBytes)
+{
+    R_ASSERT(func != NULL);
+
+    Win32Fiber* pFiber  = new Win32Fiber();
+    pFiber->func        = func;
+    pFiber->pData       = pData;
+    pFiber->isThread    = false;
+    // Only commit a page up front, the rest of the stack is reserved.
+    pFiber->handle      = CreateFiberEx(4096, stackSizeBytes, FIBER_FLAG_FLOAT_SWITCH, win32FiberStart, pFiber);
+
+    if (!pFiber->handle)
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to create fiber! Result: %d", GetLastError());
+        delete pFiber;
+        return nullptr;
+    }
+
+    return pFiber;
+}
+
+
+ResultCode destroyFiber(Fiber fiber)
+{
+    Win32Fiber* pFiber = static_cast<Win32Fiber*>(fiber);
+    if (!pFiber)
+    {
+        return RecluseResult_NullPtrExcept;
+    }
+
+    R_ASSERT(!pFiber->isThread);
+    DeleteFiber(pFiber->handle);
+    delete pFiber;
+
+    return RecluseResult_Ok;
+}
+
+
+void switchToFiber(Fiber fiber)
+{
+    Win32Fiber* pFiber = static_cast<Win32Fiber*>(fiber);
+    R_ASSERT(pFiber != NULL);
+    SwitchToFiber(pFiber->handle);
+}
+} // Recluse
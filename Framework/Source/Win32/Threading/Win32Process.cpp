@@ -0,0 +1,279 @@
+//
+#include "Win32/Threading/Win32Thread.hpp"
+#include "Recluse/System/Process.hpp"
+#include "Recluse/System/Architecture.hpp"
+#include "Recluse/Messaging.hpp"
+
+#include <intrin.h>
+#include <algorithm>
+#include <vector>
+
+namespace Recluse {
+namespace Process {
+
+
+ResultCode queryCpuInfo(CpuInfo& cpuInfo)
+{
+    DWORD bufferSizeBytes = 0;
+    GetLogicalProcessorInformation(nullptr, &bufferSizeBytes);
+
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to query the logical processor information size!");
+        return RecluseResult_Failed;
+    }
+
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(bufferSizeBytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!GetLogicalProcessorInformation(infos.data(), &bufferSizeBytes))
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to query logical processor information! Result: %d", GetLastError());
+        return RecluseResult_Failed;
+    }
+
+    U32 numCores    = 0;
+    U32 numLogical  = 0;
+    for (U32 i = 0; i < infos.size(); ++i)
+    {
+        if (infos[i].Relationship == RelationProcessorCore)
+        {
+            numCores    += 1;
+            numLogical  += static_cast<U32>(__popcnt64(infos[i].ProcessorMask));
+        }
+    }
+
+    SYSTEM_INFO systemInfo = { };
+    GetNativeSystemInfo(&systemInfo);
+
+    switch (systemInfo.wProcessorArchitecture)
+    {
+        case PROCESSOR_ARCHITECTURE_AMD64:
+            cpuInfo.processorArchitecture = Architecture_x64;
+            break;
+        case PROCESSOR_ARCHITECTURE_ARM:
+            cpuInfo.processorArchitecture = Architecture_Arm32;
+            break;
+        case PROCESSOR_ARCHITECTURE_ARM64:
+            cpuInfo.processorArchitecture = Archictecture_Amd64;
+            break;
+        case PROCESSOR_ARCHITECTURE_INTEL:
+        default:
+            cpuInfo.processorArchitecture = Architecture_x86;
+            break;
+    }
+
+    cpuInfo.numberCoreProcessors            = numCores;
+    cpuInfo.numberLogicalProcessors         = numLogical;
+    cpuInfo.numberLogicalProcessorsPerCore  = (numCores > 0) ? (numLogical / numCores) : 1;
+
+    return RecluseResult_Ok;
+}
+
+
+static U32 findOrAddCache(CpuTopology& topology, const CpuCacheInfo& cache)
+{
+    for (U32 i = 0; i < topology.caches.size(); ++i)
+    {
+        if ((topology.caches[i].level == cache.level) && (topology.caches[i].processorMask == cache.processorMask))
+        {
+            return i;
+        }
+    }
+    topology.caches.push_back(cache);
+    return static_cast<U32>(topology.caches.size() - 1);
+}
+
+
+ResultCode queryCpuTopology(CpuTopology& topology)
+{
+    topology = CpuTopology();
+
+    DWORD bufferSizeBytes = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &bufferSizeBytes);
+
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to query the logical processor information size!");
+        return RecluseResult_Failed;
+    }
+
+    std::vector<U8> buffer(bufferSizeBytes);
+    if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &bufferSizeBytes))
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to query logical processor information! Result: %d", GetLastError());
+        return RecluseResult_Failed;
+    }
+
+    // Affinity masks only cover the processor group the process runs in, which is group 0
+    // unless the process was moved.
+    DWORD_PTR processAffinity   = 0;
+    DWORD_PTR systemAffinity    = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processAffinity, &systemAffinity))
+    {
+        processAffinity = ~DWORD_PTR(0);
+    }
+    const ProcessorMask availableMask = static_cast<ProcessorMask>(processAffinity);
+
+    std::vector<ProcessorMask> packageMasks;
+    std::vector<std::pair<U32, ProcessorMask>> numaMasks;
+    std::vector<CpuCacheInfo> caches;
+
+    for (DWORD offset = 0; offset < bufferSizeBytes; )
+    {
+        const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* pInfo = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+        offset += pInfo->Size;
+
+        switch (pInfo->Relationship)
+        {
+            case RelationProcessorCore:
+            {
+                const GROUP_AFFINITY& groupMask = pInfo->Processor.GroupMask[0];
+                const ProcessorMask mask        = (groupMask.Group == 0) ? (static_cast<ProcessorMask>(groupMask.Mask) & availableMask) : 0ull;
+                if (mask)
+                {
+                    CpuCoreInfo core    = { };
+                    core.processorMask  = mask;
+                    core.l2CacheIndex   = kInvalidCacheIndex;
+                    core.l3CacheIndex   = kInvalidCacheIndex;
+                    topology.cores.push_back(core);
+                    topology.numLogicalProcessors += static_cast<U32>(__popcnt64(mask));
+                }
+                break;
+            }
+            case RelationProcessorPackage:
+            {
+                const GROUP_AFFINITY& groupMask = pInfo->Processor.GroupMask[0];
+                packageMasks.push_back((groupMask.Group == 0) ? static_cast<ProcessorMask>(groupMask.Mask) : 0ull);
+                break;
+            }
+            case RelationNumaNode:
+            {
+                const GROUP_AFFINITY& groupMask = pInfo->NumaNode.GroupMask;
+                numaMasks.push_back(std::make_pair(static_cast<U32>(pInfo->NumaNode.NodeNumber), (groupMask.Group == 0) ? static_cast<ProcessorMask>(groupMask.Mask) : 0ull));
+                break;
+            }
+            case RelationCache:
+            {
+                const CACHE_RELATIONSHIP& cacheInfo = pInfo->Cache;
+                if ((cacheInfo.Level >= 2) && (cacheInfo.Type != CacheInstruction) && (cacheInfo.GroupMask.Group == 0))
+                {
+                    CpuCacheInfo cache  = { };
+                    cache.level         = cacheInfo.Level;
+                    cache.sizeBytes     = cacheInfo.CacheSize;
+                    cache.lineSizeBytes = cacheInfo.LineSize;
+                    cache.processorMask = static_cast<ProcessorMask>(cacheInfo.GroupMask.Mask) & availableMask;
+                    if (cache.processorMask)
+                    {
+                        caches.push_back(cache);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    if (topology.cores.empty())
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to find any available processors!");
+        return RecluseResult_Failed;
+    }
+
+    std::vector<U32> usedNumaNodes;
+    for (U32 i = 0; i < topology.cores.size(); ++i)
+    {
+        CpuCoreInfo& core = topology.cores[i];
+
+        for (U32 package = 0; package < packageMasks.size(); ++package)
+        {
+            if (packageMasks[package] & core.processorMask)
+            {
+                core.packageId = package;
+                break;
+            }
+        }
+
+        for (U32 node = 0; node < numaMasks.size(); ++node)
+        {
+            if (numaMasks[node].second & core.processorMask)
+            {
+                core.numaNode = numaMasks[node].first;
+                break;
+            }
+        }
+
+        for (U32 cache = 0; cache < caches.size(); ++cache)
+        {
+            if (caches[cache].processorMask & core.processorMask)
+            {
+                const U32 cacheIndex = findOrAddCache(topology, caches[cache]);
+                if (caches[cache].level == 2)
+                {
+                    core.l2CacheIndex = cacheIndex;
+                }
+                else if (caches[cache].level == 3)
+                {
+                    core.l3CacheIndex = cacheIndex;
+                }
+            }
+        }
+
+        if (std::find(usedNumaNodes.begin(), usedNumaNodes.end(), core.numaNode) == usedNumaNodes.end())
+        {
+            usedNumaNodes.push_back(core.numaNode);
+        }
+    }
+
+    std::sort
+        (
+            topology.cores.begin(), 
+            topology.cores.end(), 
+            [] (const CpuCoreInfo& lhs, const CpuCoreInfo& rhs) -> Bool
+            {
+                if (lhs.packageId != rhs.packageId)
+                {
+                    return lhs.packageId < rhs.packageId;
+                }
+                return (lhs.processorMask & (~lhs.processorMask + 1ull)) < (rhs.processorMask & (~rhs.processorMask + 1ull));
+            }
+        );
+
+    U32 numPackages = 0;
+    for (U32 package = 0; package < packageMasks.size(); ++package)
+    {
+        numPackages += (packageMasks[package] & availableMask) ? 1 : 0;
+    }
+
+    topology.numPackages    = std::max(numPackages, 1u);
+    topology.numNumaNodes   = static_cast<U32>(usedNumaNodes.size());
+
+    return RecluseResult_Ok;
+}
+
+
+F64 getThreadCpuTimeS()
+{
+    FILETIME creationTime   = { };
+    FILETIME exitTime       = { };
+    FILETIME kernelTime     = { };
+    FILETIME userTime       = { };
+
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        return 0.0;
+    }
+
+    // Filetimes are in 100ns intervals.
+    const U64 kernel100Ns   = (static_cast<U64>(kernelTime.dwHighDateTime) << 32ull) | kernelTime.dwLowDateTime;
+    const U64 user100Ns     = (static_cast<U64>(userTime.dwHighDateTime) << 32ull) | userTime.dwLowDateTime;
+    return static_cast<F64>(kernel100Ns + user100Ns) * 1e-7;
+}
+
+
+U32 captureStackTrace(void** ppFrames, U32 maxFrames, U32 framesToSkip)
+{
+    // Skip this function too.
+    return static_cast<U32>(RtlCaptureStackBackTrace(framesToSkip + 1, maxFrames, ppFrames, nullptr));
+}
+} // Process
+} // Recluse
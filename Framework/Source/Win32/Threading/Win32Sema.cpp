@@ -0,0 +1,56 @@
+//
+#include "Win32/Threading/Win32Thread.hpp"
+#include "Recluse/Messaging.hpp"
+
+namespace Recluse {
+
+
+ResultCode destroySemaphore(Semaphore sema)
+{
+    if (!sema)
+    {
+        return RecluseResult_NullPtrExcept;
+    }
+
+    CloseHandle(sema);
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode signalSemaphore(Semaphore sema)
+{
+    R_ASSERT(sema != NULL);
+
+    if (!ReleaseSemaphore(sema, 1, nullptr))
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to signal semaphore! Result: %d", GetLastError());
+
+        return RecluseResult_Failed;
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode waitSemaphore(Semaphore sema)
+{
+    R_ASSERT(sema != NULL);
+
+    DWORD result = WaitForSingleObject(sema, INFINITE);
+
+    switch (result)
+    {
+        case WAIT_OBJECT_0:
+            return RecluseResult_Ok;
+
+        case WAIT_TIMEOUT:
+            return RecluseResult_Timeout;
+
+        default:
+            return RecluseResult_Failed;
+    }
+
+    return RecluseResult_Failed;
+}
+} // Recluse
@@ -1,6 +1,7 @@
 // 
 #include "Win32/Threading/Win32Thread.hpp"
 #include "Recluse/Messaging.hpp"
+#include "Recluse/Threading/Atomic.hpp"
 
 #include <process.h>
 
@@ -101,6 +102,63 @@ ResultCode resumeThread(Thread* pThread)
 }
 
 
+ResultCode setThreadAffinity(Thread* pThread, U64 affinityMask)
+{
+    R_ASSERT(pThread != NULL);
+
+    if (!SetThreadAffinityMask(pThread->handle, (DWORD_PTR)affinityMask))
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to set thread affinity mask=0x%llx! Result: %d", affinityMask, GetLastError());
+
+        return RecluseResult_Failed;
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+ResultCode setCurrentThreadAffinity(U64 affinityMask)
+{
+    // Pseudo handle, no need to close it.
+    Thread thread   = { };
+    thread.handle   = GetCurrentThread();
+    return setThreadAffinity(&thread, affinityMask);
+}
+
+
+ResultCode setThreadPriority(Thread* pThread, ThreadPriority priority)
+{
+    R_ASSERT(pThread != NULL);
+
+    int win32Priority = THREAD_PRIORITY_NORMAL;
+    switch (priority)
+    {
+        case ThreadPriority_Lowest:         win32Priority = THREAD_PRIORITY_LOWEST; break;
+        case ThreadPriority_Low:            win32Priority = THREAD_PRIORITY_BELOW_NORMAL; break;
+        case ThreadPriority_High:           win32Priority = THREAD_PRIORITY_ABOVE_NORMAL; break;
+        case ThreadPriority_Highest:        win32Priority = THREAD_PRIORITY_HIGHEST; break;
+        case ThreadPriority_TimeCritical:   win32Priority = THREAD_PRIORITY_TIME_CRITICAL; break;
+        case ThreadPriority_Normal:
+        default:                            break;
+    }
+
+    if (!SetThreadPriority(pThread->handle, win32Priority))
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to set thread priority=%d! Result: %d", priority, GetLastError());
+
+        return RecluseResult_Failed;
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+U32 getCurrentProcessorNumber()
+{
+    return static_cast<U32>(GetCurrentProcessorNumber());
+}
+
+
 Mutex createMutex(const char* name)
 {
     name;
@@ -179,7 +237,7 @@ ResultCode tryLockMutex(Mutex mutex)
 
 Semaphore createSemaphore(const char* name)
 {
-    HANDLE semaphoreHandle = CreateSemaphore(NULL, 0, 16, name);
+    HANDLE semaphoreHandle = CreateSemaphore(NULL, 0, LONG_MAX, name);
     return semaphoreHandle;
 }
 
@@ -197,8 +255,9 @@ I16 compareExchange(I16* dest, I16 ex, I16 comp)
 
 U128 compareExchange(U128* dest, U128 ex, U128 comp)
 {
-    R_NO_IMPL();
-    return U128();
+    // On failure comp is updated to the current value, either way it holds the original.
+    compareExchange128(dest, comp, ex);
+    return comp;
 }
 
 
@@ -208,6 +267,86 @@ Bool testAndSet(U32* ptr, U32 offset)
 }
 
 
+ResultCode sleep(U64 milliseconds)
+{
+    DWORD waitTimeMs = (milliseconds == kInfiniteMs) ? INFINITE : (DWORD)milliseconds;
+    Sleep(waitTimeMs);
+    return RecluseResult_Ok;
+}
+
+
+#if !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+ResultCode sleepPrecise(U64 nanoseconds)
+{
+    // Sleep() is stuck to the system timer resolution, usually 15.6ms. High resolution waitable
+    // timers are not, but are only available on Windows 10 1803 and up. Each thread keeps its 
+    // own timer, since a timer can only be waited on by one thread at a time.
+    static thread_local HANDLE timer = NULL;
+
+    if (!timer)
+    {
+        timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!timer)
+        {
+            timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+        }
+
+        if (!timer)
+        {
+            R_ERROR(R_CHANNEL_WIN32, "Failed to create waitable timer! Falling back to Sleep()");
+            Sleep(static_cast<DWORD>(nanoseconds / 1000000ull));
+            return RecluseResult_Failed;
+        }
+    }
+
+    // Negative due time is relative, in 100ns intervals.
+    LARGE_INTEGER dueTime = { };
+    dueTime.QuadPart = -static_cast<LONGLONG>(nanoseconds / 100ull);
+
+    if (!SetWaitableTimer(timer, &dueTime, 0, NULL, NULL, FALSE))
+    {
+        return RecluseResult_Failed;
+    }
+
+    WaitForSingleObject(timer, INFINITE);
+    return RecluseResult_Ok;
+}
+
+
+void yieldProcessor()
+{
+    YieldProcessor();
+}
+
+
+void yieldThread()
+{
+    SwitchToThread();
+}
+
+
+void waitOnAddress(const volatile void* pAddress, U32 expected)
+{
+    WaitOnAddress(const_cast<volatile void*>(pAddress), &expected, sizeof(U32), INFINITE);
+}
+
+
+void wakeByAddress(const volatile void* pAddress, Bool wakeAll)
+{
+    if (wakeAll)
+    {
+        WakeByAddressAll(const_cast<void*>(pAddress));
+    }
+    else
+    {
+        WakeByAddressSingle(const_cast<void*>(pAddress));
+    }
+}
+
+
 ResultCode CriticalSection::initialize()
 {
     R_ASSERT_FORMAT(m_section == NULL, "Critical Section is not null prior to initialization! Could indicate was already created? section=%d", m_section);
@@ -164,7 +164,7 @@ std::vector<std::string> Filesystem::split(const std::string& filename)
 }
 
 
-ResultCode File::open(const std::string& filePath, char* access)
+ResultCode File::open(const std::string& filePath, const char* access)
 {
     if (m_isOpen) 
     {
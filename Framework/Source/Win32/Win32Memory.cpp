@@ -0,0 +1,77 @@
+//
+#include "Win32/Win32Common.hpp"
+#include "Recluse/Memory/VirtualMemory.hpp"
+#include "Recluse/Messaging.hpp"
+
+namespace Recluse {
+namespace VirtualMemory {
+
+
+U64 getPageSizeBytes()
+{
+    static U64 pageSizeBytes = 0ull;
+    if (!pageSizeBytes)
+    {
+        SYSTEM_INFO info = { };
+        GetSystemInfo(&info);
+        pageSizeBytes = static_cast<U64>(info.dwPageSize);
+    }
+    return pageSizeBytes;
+}
+
+
+U64 getLargePageSizeBytes()
+{
+    // Large pages on Windows need SeLockMemoryPrivilege, and must be committed in full when
+    // reserved. Neither works with committing on demand, so they are not offered.
+    return 0ull;
+}
+
+
+void* reserve(U64 sizeBytes, Bool useLargePages)
+{
+    (void)useLargePages;
+    void* pAddress = VirtualAlloc(nullptr, static_cast<SIZE_T>(sizeBytes), MEM_RESERVE, PAGE_NOACCESS);
+    if (!pAddress)
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to reserve %llu bytes of address space! error=%d", sizeBytes, GetLastError());
+    }
+    return pAddress;
+}
+
+
+ResultCode commit(void* pAddress, U64 sizeBytes)
+{
+    if (!VirtualAlloc(pAddress, static_cast<SIZE_T>(sizeBytes), MEM_COMMIT, PAGE_READWRITE))
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to commit %llu bytes! error=%d", sizeBytes, GetLastError());
+        return RecluseResult_OutOfMemory;
+    }
+    return RecluseResult_Ok;
+}
+
+
+ResultCode decommit(void* pAddress, U64 sizeBytes)
+{
+    if (!VirtualFree(pAddress, static_cast<SIZE_T>(sizeBytes), MEM_DECOMMIT))
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to decommit %llu bytes! error=%d", sizeBytes, GetLastError());
+        return RecluseResult_Failed;
+    }
+    return RecluseResult_Ok;
+}
+
+
+ResultCode release(void* pAddress, U64 sizeBytes)
+{
+    // The whole reservation goes at once, VirtualFree wants a size of 0 here.
+    (void)sizeBytes;
+    if (!VirtualFree(pAddress, 0, MEM_RELEASE))
+    {
+        R_ERROR(R_CHANNEL_WIN32, "Failed to release address space! error=%d", GetLastError());
+        return RecluseResult_Failed;
+    }
+    return RecluseResult_Ok;
+}
+} // VirtualMemory
+} // Recluse
@@ -0,0 +1,30 @@
+//
+#pragma once
+
+#include "Recluse/Types.hpp"
+#include "Recluse/Time.hpp"
+#include "Recluse/Messaging.hpp"
+
+namespace Recluse {
+namespace Test {
+
+
+// Seconds elapsed since start was taken.
+inline F32 measure(const RealtimeStopWatch& start)
+{
+    RealtimeStopWatch end;
+    RealtimeTick tick = end - start;
+    return tick.delta();
+}
+
+
+// Logs whether the test passed, and shuts down logging. Returns the exit code for main().
+inline int finish(const char* testName, Bool success)
+{
+    R_INFO(testName, "Finished! %s", success ? "Passed" : "Failed");
+
+    Log::destroyLoggingSystem();
+    return success ? 0 : -1;
+}
+} // Test
+} // Recluse
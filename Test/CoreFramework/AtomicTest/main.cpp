@@ -0,0 +1,293 @@
+#include "Recluse/Threading/Atomic.hpp"
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumCounterIterations  = 1000000;
+static const U32 kNumStackIterations    = 200000;
+static const U32 kNumStackNodes         = 64;
+static const U32 kMaxThreads            = 8;
+
+static Atomic<U32>  g_startFlag;
+static Atomic<U32>  g_numReady;
+
+
+static void waitForStart()
+{
+    // Line up all threads before starting, so they actually contend.
+    g_numReady.fetchAdd(1u);
+    while (g_startFlag.load(MemoryOrder_Acquire) == 0u)
+    {
+        yieldProcessor();
+    }
+}
+
+
+static F32 runThreads(Thread* threads, U32 numThreads, ThreadFunction function)
+{
+    g_startFlag.store(0u);
+    g_numReady.store(0u);
+
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        createThread(&threads[i], function);
+    }
+
+    while (g_numReady.load() != numThreads)
+    {
+        yieldThread();
+    }
+
+    RealtimeStopWatch start;
+    g_startFlag.store(1u, MemoryOrder_Release);
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        joinThread(&threads[i]);
+    }
+    return Test::measure(start);
+}
+
+
+// Counters -------------------------------------------------------------------
+
+
+static Atomic<U64>          g_sharedCounter;
+// Each thread gets its own counter, but they all sit on the same few cache lines.
+static Atomic<U64>          g_packedCounters[kMaxThreads];
+static PaddedAtomic<U64>    g_paddedCounters[kMaxThreads];
+
+
+static ResultCode sharedCounterThread(void* pData)
+{
+    (void)pData;
+    waitForStart();
+    for (U32 i = 0; i < kNumCounterIterations; ++i)
+    {
+        g_sharedCounter.fetchAdd(1ull, MemoryOrder_Relaxed);
+    }
+    return RecluseResult_Ok;
+}
+
+
+static ResultCode packedCounterThread(void* pData)
+{
+    Atomic<U64>& counter = g_packedCounters[reinterpret_cast<UPtr>(pData)];
+    waitForStart();
+    for (U32 i = 0; i < kNumCounterIterations; ++i)
+    {
+        counter.fetchAdd(1ull, MemoryOrder_Relaxed);
+    }
+    return RecluseResult_Ok;
+}
+
+
+static ResultCode paddedCounterThread(void* pData)
+{
+    PaddedAtomic<U64>& counter = g_paddedCounters[reinterpret_cast<UPtr>(pData)];
+    waitForStart();
+    for (U32 i = 0; i < kNumCounterIterations; ++i)
+    {
+        counter.fetchAdd(1ull, MemoryOrder_Relaxed);
+    }
+    return RecluseResult_Ok;
+}
+
+
+static Bool testCounters(U32 numThreads)
+{
+    Thread threads[kMaxThreads] = { };
+    const U64 expectedCount     = U64(kNumCounterIterations) * U64(numThreads);
+    Bool success                = true;
+
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        threads[i].payload = reinterpret_cast<void*>(UPtr(i));
+        g_packedCounters[i].store(0ull);
+        g_paddedCounters[i].store(0ull);
+    }
+    g_sharedCounter.store(0ull);
+
+    const F32 sharedSecs = runThreads(threads, numThreads, sharedCounterThread);
+    const F32 packedSecs = runThreads(threads, numThreads, packedCounterThread);
+    const F32 paddedSecs = runThreads(threads, numThreads, paddedCounterThread);
+
+    U64 packedCount = 0;
+    U64 paddedCount = 0;
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        packedCount += g_packedCounters[i].load();
+        paddedCount += g_paddedCounters[i].load();
+    }
+
+    R_INFO
+        (
+            "AtomicTest",
+            "counters threads=%d  shared: %6.2f ns/op  packed: %6.2f ns/op  padded: %6.2f ns/op",
+            numThreads,
+            (sharedSecs * 1e9f) / F32(expectedCount),
+            (packedSecs * 1e9f) / F32(expectedCount),
+            (paddedSecs * 1e9f) / F32(expectedCount)
+        );
+
+    if ((g_sharedCounter.load() != expectedCount) || (packedCount != expectedCount) || (paddedCount != expectedCount))
+    {
+        R_ERROR
+            (
+                "AtomicTest",
+                "Counter mismatch! shared=%llu packed=%llu padded=%llu expected=%llu",
+                g_sharedCounter.load(),
+                packedCount,
+                paddedCount,
+                expectedCount
+            );
+        success = false;
+    }
+
+    return success;
+}
+
+
+// Tagged pointer stack -------------------------------------------------------
+
+
+struct StackNode
+{
+    Atomic<StackNode*>  pNext;
+    U32                 index;
+};
+
+
+// Lock free stack, where every thread pops a node and pushes it right back. Nodes are reused
+// constantly, so without the tag a pop could swap in a next pointer that has gone stale.
+static StackNode                        g_nodes[kNumStackNodes];
+static AtomicTaggedPointer<StackNode>   g_stackHead;
+
+
+static void pushNode(StackNode* pNode)
+{
+    TaggedPointer<StackNode> head = g_stackHead.load();
+    TaggedPointer<StackNode> desired;
+    do
+    {
+        pNode->pNext.store(head.pointer, MemoryOrder_Relaxed);
+        desired.pointer = pNode;
+        desired.tag     = head.tag + 1;
+    } while (!g_stackHead.compareExchange(head, desired));
+}
+
+
+static StackNode* popNode()
+{
+    TaggedPointer<StackNode> head = g_stackHead.load();
+    TaggedPointer<StackNode> desired;
+    do
+    {
+        if (!head.pointer)
+        {
+            return nullptr;
+        }
+        desired.pointer = head.pointer->pNext.load(MemoryOrder_Relaxed);
+        desired.tag     = head.tag + 1;
+    } while (!g_stackHead.compareExchange(head, desired));
+    return head.pointer;
+}
+
+
+static ResultCode stackThread(void* pData)
+{
+    (void)pData;
+    waitForStart();
+    for (U32 i = 0; i < kNumStackIterations; ++i)
+    {
+        StackNode* pNode = popNode();
+        if (pNode)
+        {
+            pushNode(pNode);
+        }
+    }
+    return RecluseResult_Ok;
+}
+
+
+static Bool testTaggedStack(U32 numThreads)
+{
+    Thread threads[kMaxThreads] = { };
+    Bool seen[kNumStackNodes]   = { };
+    Bool success                = true;
+
+    g_stackHead.store(TaggedPointer<StackNode>{ nullptr, 0ull });
+    for (U32 i = 0; i < kNumStackNodes; ++i)
+    {
+        g_nodes[i].index = i;
+        pushNode(&g_nodes[i]);
+    }
+
+    const F32 secs = runThreads(threads, numThreads, stackThread);
+
+    // Every node should still be in the stack, exactly once.
+    U32 numNodes = 0;
+    while (StackNode* pNode = popNode())
+    {
+        if (seen[pNode->index] || (numNodes >= kNumStackNodes))
+        {
+            success = false;
+            break;
+        }
+        seen[pNode->index] = true;
+        ++numNodes;
+    }
+
+    R_INFO
+        (
+            "AtomicTest",
+            "tagged stack threads=%d: %6.2f ns/op",
+            numThreads,
+            (secs * 1e9f) / F32(U64(kNumStackIterations) * numThreads * 2ull)
+        );
+
+    if (!success || (numNodes != kNumStackNodes))
+    {
+        R_ERROR("AtomicTest", "Tagged stack lost or duplicated nodes! got=%d expected=%d", numNodes, kNumStackNodes);
+        success = false;
+    }
+
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    const U32 threadCounts[]    = { 1, 2, 4, 8 };
+    Bool success                = true;
+
+    for (U32 t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)
+    {
+        success &= testCounters(threadCounts[t]);
+        success &= testTaggedStack(threadCounts[t]);
+    }
+
+    // 128 bit compare exchange should return the original value, whether it swapped or not.
+    alignas(16) U128 value      = { 1ull, 2ull };
+    const U128 expected         = { 1ull, 2ull };
+    const U128 desired          = { 3ull, 4ull };
+    U128 original               = compareExchange(&value, desired, expected);
+    if ((original.m0 != 1ull) || (original.m1 != 2ull) || (value.m0 != 3ull) || (value.m1 != 4ull))
+    {
+        R_ERROR("AtomicTest", "compareExchange(U128) failed to swap!");
+        success = false;
+    }
+
+    original = compareExchange(&value, expected, expected);
+    if ((original.m0 != 3ull) || (original.m1 != 4ull) || (value.m0 != 3ull) || (value.m1 != 4ull))
+    {
+        R_ERROR("AtomicTest", "compareExchange(U128) swapped on a mismatch!");
+        success = false;
+    }
+
+    return Test::finish("AtomicTest", success);
+}
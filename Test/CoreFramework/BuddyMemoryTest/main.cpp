@@ -1,54 +1,216 @@
-
-#include <iostream>
 #include "Recluse/Memory/BuddyAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
 #include "Recluse/Memory/MemoryCommon.hpp"
 #include "Recluse/Messaging.hpp"
 #include "Recluse/Time.hpp"
-#include "Recluse/Messaging.hpp"
+#include "TestCommon.hpp"
+
+#include <vector>
+#include <string.h>
 
 using namespace Recluse;
 
-inline void logTick()
+static const U32 kNumOps            = 1000000;
+static const U32 kNumSlots          = 4096;
+static const U64 kMinBlockSizeBytes = 256ull;
+
+
+struct Slot
 {
-    RealtimeTick::updateWatch(1ull, 0);
-    RealtimeTick tick = RealtimeTick::getTick(0);
-    R_DEBUG("Core", "Finished: %f secs", tick.delta());
+    UPtr    address;
+    U64     sizeBytes;
+};
+
+
+static U32 nextRandom(U32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8u;
 }
 
-int main()
+
+// Random allocs and frees against a heap of offsets, the way the GPU allocators use it. When
+// validating, a shadow map of min blocks catches any two live blocks that overlap. That costs
+// far more than the allocator itself, so timed runs skip it.
+static Bool runStress(U64 totalSizeBytes, Bool validate)
 {
-    Log::initializeLoggingSystem();
+    BuddyAllocator allocator(kMinBlockSizeBytes);
+    allocator.initialize(0ull, totalSizeBytes);
+
+    const U64 largestEmpty = allocator.getLargestFreeBlockBytes();
+    std::vector<Slot> slots(kNumSlots);
+    std::vector<U8> shadow(validate ? (totalSizeBytes / kMinBlockSizeBytes) : 0ull);
+    U32 random          = 42u;
+    U64 numOverlaps     = 0;
+    U64 numMisaligned   = 0;
+    U64 numOutOfMemory  = 0;
+    U64 liveBytes       = 0;
+
+    RealtimeStopWatch start;
+    for (U32 i = 0; i < kNumOps; ++i)
+    {
+        Slot& slot = slots[nextRandom(random) % kNumSlots];
+        if (slot.sizeBytes)
+        {
+            for (U64 b = slot.address / kMinBlockSizeBytes; validate && (b < (slot.address + slot.sizeBytes) / kMinBlockSizeBytes); ++b)
+            {
+                shadow[b] = 0;
+            }
+            allocator.free(slot.address);
+            liveBytes      -= slot.sizeBytes;
+            slot.sizeBytes  = 0;
+            continue;
+        }
 
-    // Initialize the realtime tick.
-    RealtimeTick::initializeWatch(1ull, 0);
+        // Buffers and textures, from a few hundred bytes up to a few MB.
+        const U32 shift         = 6u + nextRandom(random) % 16u;
+        const U64 requestBytes  = (1ull << shift) + nextRandom(random) % (1ull << shift);
+        const U16 alignment     = static_cast<U16>(256u << (nextRandom(random) % 4u));
+        const UPtr address      = allocator.allocate(requestBytes, alignment);
+        if (allocator.getLastError() != RecluseResult_Ok)
+        {
+            numOutOfMemory += 1;
+            continue;
+        }
 
-    R_DEBUG("Core", "Initialize buddy memory allocator.");
-    BuddyAllocator* pAllocator = new BuddyAllocator();
-    pAllocator->initialize(0, align(R_1MB, 4));
+        slot.address    = address;
+        slot.sizeBytes  = kMinBlockSizeBytes;
+        while (slot.sizeBytes < requestBytes || slot.sizeBytes < alignment)
+        {
+            slot.sizeBytes <<= 1ull;
+        }
 
-    R_DEBUG("Core", "Allocating buddy block.");
+        numMisaligned  += (address & (alignment - 1u)) ? 1 : 0;
+        liveBytes      += slot.sizeBytes;
+        for (U64 b = address / kMinBlockSizeBytes; validate && (b < (address + slot.sizeBytes) / kMinBlockSizeBytes); ++b)
+        {
+            numOverlaps    += shadow[b];
+            shadow[b]       = 1;
+        }
+    }
+    F32 secs = Test::measure(start);
 
-    UPtr alloc = pAllocator->allocate(257, 4);
-    logTick();
-    UPtr alloc2 = pAllocator->allocate(512, 4);
-    logTick();
+    R_INFO
+        (
+            "BuddyMemoryTest",
+            "%6llu MB heap, %d ops%s: %6.1f ns/op (out of memory %llu times)",
+            totalSizeBytes / R_1MB,
+            kNumOps,
+            validate ? ", validated" : "",
+            (secs * 1e9f) / F32(kNumOps),
+            numOutOfMemory
+        );
 
-    R_TRACE("Core", "Allocation: \t\t%llu bytes\n\t\toffset:\t\t%llu", 257, alloc);
-    R_TRACE("Core", "Allocation2: \t%llu bytes\n\t\toffset:\t\t%llu", 512, alloc2);
-    R_TRACE("Core", "Allocator: allocations: %d, allocated mem: %d bytes", pAllocator->getTotalAllocations(), pAllocator->getUsedSizeBytes());
+    const Bool usageMatches = (allocator.getUsedSizeBytes() == liveBytes);
+    for (U32 i = 0; i < kNumSlots; ++i)
+    {
+        if (slots[i].sizeBytes)
+        {
+            allocator.free(slots[i].address);
+        }
+    }
 
-    pAllocator->free(alloc);
-    logTick();
+    // Everything freed, so every buddy should have merged back.
+    if (numOverlaps || numMisaligned || !usageMatches || allocator.getTotalAllocations() || (allocator.getLargestFreeBlockBytes() != largestEmpty))
+    {
+        R_ERROR
+            (
+                "BuddyMemoryTest",
+                "Stress failed! overlaps=%llu misaligned=%llu usage matches=%d leaked=%llu largest free=%llu expected=%llu",
+                numOverlaps,
+                numMisaligned,
+                usageMatches,
+                allocator.getTotalAllocations(),
+                allocator.getLargestFreeBlockBytes(),
+                largestEmpty
+            );
+        return false;
+    }
 
-    pAllocator->free(alloc2);
-    logTick();
-    R_TRACE("Core", "Allocator: allocations: %d, allocated mem: %d bytes", pAllocator->getTotalAllocations(), pAllocator->getUsedSizeBytes());
+    allocator.cleanUp();
+    return true;
+}
+
+
+static Bool testBuddy()
+{
+    Bool success = true;
+    MemoryPool pool(R_MB(1));
+    BuddyAllocator allocator(64ull);
+    allocator.initialize(pool.getBaseAddress(), R_MB(1));
 
-    pAllocator->cleanUp();
-    delete pAllocator;
+    // Sizes round up to the next power of 2 block.
+    const UPtr first    = allocator.allocate(257, 4);
+    const UPtr second   = allocator.allocate(512, 4);
+    if (!first || !second || (allocator.getUsedSizeBytes() != 1024ull))
+    {
+        R_ERROR("BuddyMemoryTest", "Blocks are the wrong size! used=%llu", allocator.getUsedSizeBytes());
+        success = false;
+    }
 
-    R_DEBUG("Core", "Finished!");
+    // The memory is real here, so it must be writable.
+    memset(reinterpret_cast<void*>(first), 0xAB, 257);
+    memset(reinterpret_cast<void*>(second), 0xCD, 512);
 
-    Log::destroyLoggingSystem();
-    return 0;
-}
\ No newline at end of file
+    allocator.free(first + 64u);
+    if (allocator.getLastError() != ResultCode(RecluseResult_InvalidArgs))
+    {
+        R_ERROR("BuddyMemoryTest", "Freeing the middle of a block should fail!");
+        success = false;
+    }
+
+    allocator.free(first);
+    allocator.free(first);
+    if (allocator.getLastError() != ResultCode(RecluseResult_CorruptMemory))
+    {
+        R_ERROR("BuddyMemoryTest", "Double free was not caught!");
+        success = false;
+    }
+
+    allocator.free(second);
+    if ((allocator.getTotalAllocations() != 0ull) || (allocator.getLargestFreeBlockBytes() != R_MB(1)))
+    {
+        R_ERROR("BuddyMemoryTest", "Freed buddies did not merge back!");
+        success = false;
+    }
+
+    if (allocator.allocate(R_MB(2), 4) || (allocator.getLastError() != ResultCode(RecluseResult_OutOfMemory)))
+    {
+        R_ERROR("BuddyMemoryTest", "Allocating more than the pool holds should fail!");
+        success = false;
+    }
+
+    allocator.cleanUp();
+
+    // Sizes that are not a power of 2 still work, the tail past the end is never handed out.
+    BuddyAllocator offsets(kMinBlockSizeBytes);
+    offsets.initialize(0ull, R_MB(3));
+    const UPtr a = offsets.allocate(R_MB(2), 256);
+    const UPtr b = offsets.allocate(R_MB(1), 256);
+    const UPtr c = offsets.allocate(kMinBlockSizeBytes, 256);
+    if ((offsets.getTotalAllocations() != 2ull) || (offsets.getLastError() != ResultCode(RecluseResult_OutOfMemory)) || (a == b) || (b + R_MB(1) > R_MB(3)))
+    {
+        R_ERROR("BuddyMemoryTest", "Heap that is not a power of 2 handed out memory past its end!");
+        success = false;
+    }
+    (void)c;
+    offsets.cleanUp();
+
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+
+    success &= testBuddy();
+    success &= runStress(R_MB(64), true);
+    success &= runStress(R_MB(256) + R_MB(64), true);
+    success &= runStress(R_MB(64), false);
+    success &= runStress(R_MB(256) + R_MB(64), false);
+
+    return Test::finish("BuddyMemoryTest", success);
+}
@@ -0,0 +1,239 @@
+#include "Recluse/Memory/ConcurrentLinearAllocator.hpp"
+#include "Recluse/Memory/LinearAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Threading/Locks.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <vector>
+
+using namespace Recluse;
+
+static const U32 kAllocsPerThread       = 100000;
+static const U32 kMaxThreads            = 32;
+static const U32 kMaxRequestSizeBytes   = 256;
+static const U64 kPoolSizeBytes         = R_GB(1);
+
+static Atomic<U32>  g_startFlag;
+static Atomic<U32>  g_numReady;
+static Atomic<U64>  g_numCorrupted;
+
+
+// A linear allocator behind a lock, the way an arena had to be shared before.
+class LockedLinearAllocator : public Allocator
+{
+public:
+    ResultCode onInitialize() override
+    {
+        m_allocator.initialize(getBaseAddr(), getTotalSizeBytes());
+        return RecluseResult_Ok;
+    }
+
+    ResultCode onAllocate(Allocation* pOutput, U64 requestSz, U16 alignment) override
+    {
+        ScopedSpinLock lock(m_lock);
+        pOutput->baseAddress = m_allocator.allocate(requestSz, alignment);
+        pOutput->sizeBytes   = requestSz;
+        return m_allocator.getLastError();
+    }
+
+    ResultCode onFree(Allocation* pOutput) override { pOutput->sizeBytes = 0; return RecluseResult_Ok; }
+    ResultCode onReset() override { m_allocator.reset(); return RecluseResult_Ok; }
+    ResultCode onCleanUp() override { m_allocator.cleanUp(); return RecluseResult_Ok; }
+
+private:
+    SpinLock        m_lock;
+    LinearAllocator m_allocator;
+};
+
+
+struct ProducerPayload
+{
+    Allocator*  pAllocator;
+    U32         threadIndex;
+    U32         numFailed;
+};
+
+
+static U32 nextRandom(U32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8u;
+}
+
+
+// Records tagged blocks, like commands, then checks none of them got stomped by another thread.
+static ResultCode producerThread(void* pData)
+{
+    ProducerPayload* pPayload   = static_cast<ProducerPayload*>(pData);
+    Allocator* pAllocator       = pPayload->pAllocator;
+    std::vector<U8*> blocks(kAllocsPerThread);
+    std::vector<U32> sizes(kAllocsPerThread);
+    U32 random                  = pPayload->threadIndex + 1u;
+    const U8 tag                = static_cast<U8>(pPayload->threadIndex + 1u);
+
+    g_numReady.fetchAdd(1u);
+    while (g_startFlag.load(MemoryOrder_Acquire) == 0u)
+    {
+        yieldProcessor();
+    }
+
+    for (U32 i = 0; i < kAllocsPerThread; ++i)
+    {
+        sizes[i]    = 8u + nextRandom(random) % kMaxRequestSizeBytes;
+        blocks[i]   = reinterpret_cast<U8*>(pAllocator->allocate(sizes[i], 16u));
+        if (!blocks[i])
+        {
+            pPayload->numFailed += 1;
+            continue;
+        }
+        blocks[i][0]                = tag;
+        blocks[i][sizes[i] - 1u]    = tag;
+    }
+
+    U64 numCorrupted = 0;
+    for (U32 i = 0; i < kAllocsPerThread; ++i)
+    {
+        numCorrupted += (blocks[i] && ((blocks[i][0] != tag) || (blocks[i][sizes[i] - 1u] != tag))) ? 1 : 0;
+    }
+    g_numCorrupted.fetchAdd(numCorrupted);
+    return RecluseResult_Ok;
+}
+
+
+static Bool runBenchmark(const char* name, Allocator* pAllocator, U32 numThreads)
+{
+    Thread threads[kMaxThreads]             = { };
+    ProducerPayload payloads[kMaxThreads]   = { };
+
+    pAllocator->reset();
+    g_startFlag.store(0u);
+    g_numReady.store(0u);
+    g_numCorrupted.store(0ull);
+
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        payloads[i].pAllocator  = pAllocator;
+        payloads[i].threadIndex = i;
+        threads[i].payload      = &payloads[i];
+        createThread(&threads[i], producerThread);
+    }
+
+    while (g_numReady.load() != numThreads)
+    {
+        yieldThread();
+    }
+
+    RealtimeStopWatch start;
+    g_startFlag.store(1u, MemoryOrder_Release);
+    U32 numFailed = 0;
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        joinThread(&threads[i]);
+        numFailed += payloads[i].numFailed;
+    }
+    F32 secs = Test::measure(start);
+
+    const U64 numAllocs = U64(kAllocsPerThread) * numThreads;
+    R_INFO
+        (
+            "ConcurrentLinearAllocatorBenchmark",
+            "%-10s threads=%2d: %8.1f ns/alloc %12.0f allocs/sec",
+            name,
+            numThreads,
+            (secs * 1e9f) / F32(numAllocs),
+            F32(numAllocs) / secs
+        );
+
+    if (numFailed || g_numCorrupted.load() || (pAllocator->getTotalAllocations() != numAllocs))
+    {
+        R_ERROR
+            (
+                "ConcurrentLinearAllocatorBenchmark",
+                "%s failed! failed allocs=%d corrupted=%llu allocations=%llu",
+                name,
+                numFailed,
+                g_numCorrupted.load(),
+                pAllocator->getTotalAllocations()
+            );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+    MemoryPool pool;
+    pool.reserve(kPoolSizeBytes, kPoolSizeBytes);
+
+    const U32 threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+    for (U32 i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); ++i)
+    {
+        {
+            LockedLinearAllocator allocator;
+            allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+            success &= runBenchmark("Locked", &allocator, threadCounts[i]);
+            allocator.cleanUp();
+        }
+
+        {
+            ConcurrentLinearAllocator allocator;
+            allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+            success &= runBenchmark("Concurrent", &allocator, threadCounts[i]);
+            R_INFO
+                (
+                    "ConcurrentLinearAllocatorBenchmark",
+                    "           used=%llu KB reserved=%llu KB",
+                    allocator.getUsedSizeBytes() / R_1KB,
+                    allocator.getReservedSizeBytes() / R_1KB
+                );
+            allocator.cleanUp();
+        }
+    }
+
+    // Running past the end of the arena fails cleanly, rather than handing out memory past it.
+    {
+        ConcurrentLinearAllocator allocator(R_KB(4));
+        allocator.initialize(pool.getBaseAddress(), R_KB(10));
+        U32 numAllocated = 0;
+        while (allocator.allocate(512, 16))
+        {
+            numAllocated += 1;
+        }
+        if ((allocator.getLastError() != ResultCode(RecluseResult_OutOfMemory)) || (allocator.getReservedSizeBytes() > R_KB(10)) || (numAllocated < 16u))
+        {
+            R_ERROR("ConcurrentLinearAllocatorBenchmark", "Arena did not run out cleanly! allocated=%d", numAllocated);
+            success = false;
+        }
+        allocator.cleanUp();
+    }
+
+    // Frees give nothing back, but no longer count as live allocations.
+    {
+        ConcurrentLinearAllocator allocator;
+        allocator.initialize(pool.getBaseAddress(), R_MB(1));
+        UPtr addresses[4] = { };
+        for (U32 i = 0; i < 4; ++i)
+        {
+            addresses[i] = allocator.allocate(64, 16);
+        }
+        allocator.free(addresses[3]);
+        const U64 numLive = allocator.getTotalAllocations();
+        allocator.reset();
+        if ((numLive != 3ull) || (allocator.getTotalAllocations() != 0ull))
+        {
+            R_ERROR("ConcurrentLinearAllocatorBenchmark", "Wrong allocation count after free! live=%llu after reset=%llu", numLive, allocator.getTotalAllocations());
+            success = false;
+        }
+        allocator.cleanUp();
+    }
+
+    return Test::finish("ConcurrentLinearAllocatorBenchmark", success);
+}
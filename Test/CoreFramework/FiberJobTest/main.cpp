@@ -0,0 +1,175 @@
+#include <atomic>
+
+#include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/Threading/Fiber.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumChains         = 64;
+static const U32 kChainDepth        = 32;
+static const U32 kNumFanOutJobs     = 4096;
+static const U32 kNumFibers         = 256;
+static const U32 kNumPingPongs      = 100000;
+
+static std::atomic<U64> g_sum;
+static ThreadPool*      g_pPool = nullptr;
+
+
+// Each link in the chain submits the next one, and waits for it to finish. On fibers,
+// every waiting link parks instead of holding on to the worker.
+U32 chainJob(void* pData)
+{
+    const U64 value = reinterpret_cast<U64>(pData);
+    const U64 chain = value >> 16ull;
+    const U64 depth = value & 0xFFFFull;
+
+    if (depth == 0)
+    {
+        g_sum.fetch_add(chain + 1ull, std::memory_order_relaxed);
+        return 0;
+    }
+
+    JobCounter counter;
+    g_pPool->submitJob(chainJob, reinterpret_cast<void*>((chain << 16ull) | (depth - 1ull)), kAnyThreadPoolWorker, &counter);
+    g_pPool->waitForCounter(&counter);
+    return 0;
+}
+
+
+U32 leafJob(void* pData)
+{
+    g_sum.fetch_add(reinterpret_cast<U64>(pData), std::memory_order_relaxed);
+    return 0;
+}
+
+
+U32 fanOutJob(void* pData)
+{
+    (void)pData;
+    JobCounter counter;
+    for (U64 i = 1; i <= kNumFanOutJobs; ++i)
+    {
+        g_pPool->submitJob(leafJob, reinterpret_cast<void*>(i), kAnyThreadPoolWorker, &counter);
+    }
+    g_pPool->waitForCounter(&counter);
+    return 0;
+}
+
+
+static Fiber    g_mainFiber     = nullptr;
+static Fiber    g_pongFiber     = nullptr;
+
+void pongFunc(void* pData)
+{
+    (void)pData;
+    for (;;)
+    {
+        switchToFiber(g_mainFiber);
+    }
+}
+
+
+F32 measureSwitchCostNs()
+{
+    g_mainFiber = convertThreadToFiber();
+    g_pongFiber = createFiber(pongFunc, nullptr);
+
+    RealtimeStopWatch start;
+    for (U32 i = 0; i < kNumPingPongs; ++i)
+    {
+        switchToFiber(g_pongFiber);
+    }
+    F32 secs = Test::measure(start);
+
+    destroyFiber(g_pongFiber);
+    convertFiberToThread(g_mainFiber);
+    g_pongFiber = nullptr;
+    g_mainFiber = nullptr;
+
+    // Each ping pong is two switches.
+    return (secs * 1e9f) / F32(kNumPingPongs * 2u);
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    const U64 expectedChainSum  = (U64(kNumChains) * U64(kNumChains + 1)) / 2ull;
+    const U64 expectedFanOutSum = (U64(kNumFanOutJobs) * U64(kNumFanOutJobs + 1)) / 2ull;
+    const U32 workerCounts[]    = { 1, 2, 4, 8 };
+    Bool success                = true;
+
+    R_INFO("FiberJobTest", "Fiber switch: %.1f ns", measureSwitchCostNs());
+
+    for (U32 w = 0; w < sizeof(workerCounts) / sizeof(workerCounts[0]); ++w)
+    {
+        for (U32 mode = 0; mode < 2; ++mode)
+        {
+            const U32 numWorkers    = workerCounts[w];
+            const Bool useFibers    = (mode == 1);
+            ThreadPool pool(numWorkers, useFibers ? kNumFibers : 0);
+            g_pPool = &pool;
+
+            // Deep dependency chains, all running at once.
+            g_sum.store(0ull);
+            RealtimeStopWatch start;
+            for (U64 i = 0; i < kNumChains; ++i)
+            {
+                pool.submitJob(chainJob, reinterpret_cast<void*>((i << 16ull) | kChainDepth));
+            }
+            pool.waitFinished();
+            F32 chainSecs = Test::measure(start);
+
+            if (g_sum.load() != expectedChainSum)
+            {
+                R_ERROR("FiberJobTest", "Chain sum mismatch! workers=%d fibers=%d got=%llu expected=%llu", numWorkers, pool.getNumFibers(), g_sum.load(), expectedChainSum);
+                success = false;
+            }
+
+            // One job waiting on many.
+            g_sum.store(0ull);
+            start = RealtimeStopWatch();
+            pool.submitJob(fanOutJob);
+            pool.waitFinished();
+            F32 fanOutSecs = Test::measure(start);
+
+            if (g_sum.load() != expectedFanOutSum)
+            {
+                R_ERROR("FiberJobTest", "Fan out sum mismatch! workers=%d fibers=%d got=%llu expected=%llu", numWorkers, pool.getNumFibers(), g_sum.load(), expectedFanOutSum);
+                success = false;
+            }
+
+            // Waiting on a counter from outside of the pool.
+            JobCounter counter;
+            g_sum.store(0ull);
+            for (U64 i = 1; i <= kNumFanOutJobs; ++i)
+            {
+                pool.submitJob(leafJob, reinterpret_cast<void*>(i), kAnyThreadPoolWorker, &counter);
+            }
+            pool.waitForCounter(&counter);
+            if ((g_sum.load() != expectedFanOutSum) || (counter.getValue() != 0u))
+            {
+                R_ERROR("FiberJobTest", "External counter wait failed! workers=%d fibers=%d", numWorkers, pool.getNumFibers());
+                success = false;
+            }
+
+            R_INFO
+                (
+                    "FiberJobTest",
+                    "workers=%2d  %s  chains: %8.3f ms  fan out: %8.3f ms",
+                    numWorkers,
+                    useFibers ? "fibers " : "threads",
+                    chainSecs * 1000.0f,
+                    fanOutSecs * 1000.0f
+                );
+        }
+    }
+
+    g_pPool = nullptr;
+
+    return Test::finish("FiberJobTest", success);
+}
@@ -0,0 +1,220 @@
+#include "Recluse/Memory/FrameAllocator.hpp"
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <stdlib.h>
+#include <vector>
+
+using namespace Recluse;
+
+static const U32 kNumThreads            = 4;
+static const U32 kNumFrames             = 200;
+static const U32 kAllocsPerFrame        = 4000;
+static const U32 kNumFramesInFlight     = 2;
+
+// Frame the workers may start on, and how many thread frames they finished.
+static Atomic<U64>  g_frameReady;
+static Atomic<U64>  g_numFinished;
+static Atomic<U64>  g_numCorrupted;
+static Atomic<U64>  g_numFailed;
+
+
+struct WorkerPayload
+{
+    U32     threadIndex;
+};
+
+
+static U32 nextRandom(U32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8u;
+}
+
+
+static U8 makeTag(U32 threadIndex, U64 frameIndex)
+{
+    return static_cast<U8>((threadIndex * 31u) + frameIndex + 1u);
+}
+
+
+// Each frame, fills the arena with tagged blocks. The blocks of the frame before must still
+// be intact, since that frame has not retired yet.
+static ResultCode workerThread(void* pData)
+{
+    const U32 threadIndex = static_cast<WorkerPayload*>(pData)->threadIndex;
+    std::vector<U8*> blocks[kNumFramesInFlight];
+    U32 random = threadIndex + 1u;
+
+    for (U64 frame = 0; frame < kNumFrames; ++frame)
+    {
+        while (g_frameReady.load(MemoryOrder_Acquire) < frame + 1u)
+        {
+            yieldProcessor();
+        }
+
+        const std::vector<U8*>& previous = blocks[(frame + kNumFramesInFlight - 1u) % kNumFramesInFlight];
+        for (U32 i = 0; i < previous.size(); ++i)
+        {
+            if (previous[i][0] != makeTag(threadIndex, frame - 1u))
+            {
+                g_numCorrupted.fetchAdd(1ull, MemoryOrder_Relaxed);
+            }
+        }
+
+        std::vector<U8*>& current   = blocks[frame % kNumFramesInFlight];
+        Allocator* pAllocator       = FrameAllocator::get();
+        const U8 tag                = makeTag(threadIndex, frame);
+        current.clear();
+        for (U32 i = 0; i < kAllocsPerFrame; ++i)
+        {
+            const U32 sizeBytes = 16u + nextRandom(random) % 1024u;
+            U8* pBytes          = reinterpret_cast<U8*>(pAllocator->allocate(sizeBytes, 16u));
+            if (!pBytes)
+            {
+                g_numFailed.fetchAdd(1ull, MemoryOrder_Relaxed);
+                continue;
+            }
+            pBytes[0]               = tag;
+            pBytes[sizeBytes - 1u]  = tag;
+            current.push_back(pBytes);
+        }
+
+        g_numFinished.fetchAdd(1ull, MemoryOrder_Release);
+    }
+
+    return RecluseResult_Ok;
+}
+
+
+// Runs the frames with worker threads, checking the per frame counters as it goes.
+static Bool runFrames()
+{
+    Bool success = true;
+    Thread threads[kNumThreads]             = { };
+    WorkerPayload payloads[kNumThreads]     = { };
+
+    FrameAllocator::initialize(kNumFramesInFlight);
+    for (U32 i = 0; i < kNumThreads; ++i)
+    {
+        payloads[i].threadIndex = i;
+        threads[i].payload      = &payloads[i];
+        createThread(&threads[i], workerThread);
+    }
+
+    RealtimeStopWatch start;
+    for (U64 frame = 0; frame < kNumFrames; ++frame)
+    {
+        FrameAllocator::beginFrame(frame);
+        const FrameAllocatorStats retired = FrameAllocator::getRetiredFrameStats();
+        if ((frame >= kNumFramesInFlight) && ((retired.frameIndex != frame - kNumFramesInFlight) || (retired.numAllocations != kAllocsPerFrame * kNumThreads)))
+        {
+            R_ERROR("FrameAllocatorTest", "Frame %llu retired with the wrong counts! allocations=%llu", retired.frameIndex, retired.numAllocations);
+            success = false;
+        }
+
+        g_frameReady.store(frame + 1u, MemoryOrder_Release);
+        while (g_numFinished.load(MemoryOrder_Acquire) < (frame + 1u) * kNumThreads)
+        {
+            yieldProcessor();
+        }
+
+        const FrameAllocatorStats stats = FrameAllocator::getFrameStats();
+        if ((frame % 50u) == 0u)
+        {
+            R_INFO
+                (
+                    "FrameAllocatorTest",
+                    "frame %3llu: %6llu KB in %llu allocations, from %d threads",
+                    stats.frameIndex,
+                    stats.allocatedBytes / 1024ull,
+                    stats.numAllocations,
+                    stats.numThreads
+                );
+        }
+        if ((stats.numThreads != kNumThreads) || (stats.numAllocations != kAllocsPerFrame * kNumThreads))
+        {
+            success = false;
+        }
+    }
+    F32 secs = Test::measure(start);
+
+    for (U32 i = 0; i < kNumThreads; ++i)
+    {
+        joinThread(&threads[i]);
+    }
+    FrameAllocator::cleanUp();
+
+    R_INFO
+        (
+            "FrameAllocatorTest",
+            "%d frames, %d threads: %.2f ms/frame",
+            kNumFrames,
+            kNumThreads,
+            (secs * 1000.f) / F32(kNumFrames)
+        );
+
+    if (g_numCorrupted.load() || g_numFailed.load())
+    {
+        R_ERROR("FrameAllocatorTest", "Failed! corrupted=%llu failed allocs=%llu", g_numCorrupted.load(), g_numFailed.load());
+        success = false;
+    }
+
+    return success;
+}
+
+
+// One thread, the same per frame requests, against malloc and free.
+static void compareWithMalloc()
+{
+    std::vector<void*> blocks(kAllocsPerFrame);
+    U32 random = 1u;
+
+    RealtimeStopWatch mallocStart;
+    for (U32 frame = 0; frame < kNumFrames; ++frame)
+    {
+        for (U32 i = 0; i < kAllocsPerFrame; ++i)
+        {
+            blocks[i] = malloc(16u + nextRandom(random) % 1024u);
+            *reinterpret_cast<U8*>(blocks[i]) = 1u;
+        }
+        for (U32 i = 0; i < kAllocsPerFrame; ++i)
+        {
+            free(blocks[i]);
+        }
+    }
+    F32 mallocSecs = Test::measure(mallocStart);
+
+    FrameAllocator::initialize(kNumFramesInFlight);
+    random = 1u;
+    RealtimeStopWatch frameStart;
+    for (U32 frame = 0; frame < kNumFrames; ++frame)
+    {
+        FrameAllocator::beginFrame(frame);
+        Allocator* pAllocator = FrameAllocator::get();
+        for (U32 i = 0; i < kAllocsPerFrame; ++i)
+        {
+            *reinterpret_cast<U8*>(pAllocator->allocate(16u + nextRandom(random) % 1024u, 16u)) = 1u;
+        }
+    }
+    F32 frameSecs = Test::measure(frameStart);
+    FrameAllocator::cleanUp();
+
+    const F32 numOps = F32(kNumFrames) * F32(kAllocsPerFrame);
+    R_INFO("FrameAllocatorTest", "Malloc: %6.1f ns/alloc, Frame arena: %6.1f ns/alloc", (mallocSecs * 1e9f) / numOps, (frameSecs * 1e9f) / numOps);
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+
+    success &= runFrames();
+    compareWithMalloc();
+
+    return Test::finish("FrameAllocatorTest", success);
+}
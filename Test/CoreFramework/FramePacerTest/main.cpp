@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Recluse/System/Limiter.hpp"
+#include "Recluse/System/Process.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const F32 kFrameRates[]      = { 30.0f, 60.0f, 144.0f };
+static const F32 kSecondsPerRun     = 2.0f;
+
+
+// What Limiter used to do, spin on the clock for the whole frame.
+class BusyWaitPacer
+{
+public:
+    F32 pace(F32 targetFrameTimeS)
+    {
+        F32 frameTimeS = Test::measure(m_frameStart);
+        while (frameTimeS < targetFrameTimeS)
+        {
+            frameTimeS = Test::measure(m_frameStart);
+        }
+        m_frameStart = RealtimeStopWatch();
+        return frameTimeS;
+    }
+
+private:
+    RealtimeStopWatch m_frameStart;
+};
+
+
+struct RunResult
+{
+    F32 averageFrameTimeS;
+    F32 averageJitterS;
+    F32 maxJitterS;
+    F32 cpuUsage;
+};
+
+
+template<typename Pacer>
+static RunResult runPacer(Pacer& pacer, F32 frameRate)
+{
+    const F32 targetFrameTimeS  = 1.0f / frameRate;
+    const U32 numFrames         = static_cast<U32>(frameRate * kSecondsPerRun);
+    RunResult result            = { };
+
+    const F64 cpuStartS = Process::getThreadCpuTimeS();
+    RealtimeStopWatch start;
+
+    pacer.pace(targetFrameTimeS);
+    for (U32 i = 0; i < numFrames; ++i)
+    {
+        const F32 frameTimeS    = pacer.pace(targetFrameTimeS);
+        const F32 jitterS       = std::fabs(frameTimeS - targetFrameTimeS);
+        result.averageJitterS   += jitterS;
+        result.maxJitterS       = std::max(result.maxJitterS, jitterS);
+    }
+
+    const F32 wallS             = Test::measure(start);
+    const F64 cpuS              = Process::getThreadCpuTimeS() - cpuStartS;
+    result.averageFrameTimeS    = wallS / F32(numFrames);
+    result.averageJitterS       /= F32(numFrames);
+    result.cpuUsage             = static_cast<F32>(cpuS / wallS);
+    return result;
+}
+
+
+static void printResult(const char* name, F32 frameRate, const RunResult& result)
+{
+    R_INFO
+        (
+            "FramePacerTest",
+            "%-10s %5.1f Hz  frame: %7.3f ms  jitter avg: %6.3f ms  max: %6.3f ms  cpu: %5.1f%%",
+            name,
+            frameRate,
+            result.averageFrameTimeS * 1000.0f,
+            result.averageJitterS * 1000.0f,
+            result.maxJitterS * 1000.0f,
+            result.cpuUsage * 100.0f
+        );
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+
+    for (U32 i = 0; i < sizeof(kFrameRates) / sizeof(kFrameRates[0]); ++i)
+    {
+        const F32 frameRate         = kFrameRates[i];
+        const F32 targetFrameTimeS  = 1.0f / frameRate;
+
+        BusyWaitPacer busyWaitPacer;
+        RunResult busyWaitResult = runPacer(busyWaitPacer, frameRate);
+        printResult("busy wait", frameRate, busyWaitResult);
+
+        FramePacer framePacer;
+        RunResult pacerResult = runPacer(framePacer, frameRate);
+        printResult("pacer", frameRate, pacerResult);
+
+        const FramePacerStats& stats = framePacer.getStats();
+        R_INFO
+            (
+                "FramePacerTest",
+                "           oversleep avg: %6.3f ms  spin window: %6.3f ms  frame std dev: %6.3f ms",
+                stats.averageOversleepS * 1000.0f,
+                stats.spinThresholdS * 1000.0f,
+                stats.frameTimeStdDevS * 1000.0f
+            );
+
+        // The average rate should hold, within 2%.
+        if (std::fabs(pacerResult.averageFrameTimeS - targetFrameTimeS) > (targetFrameTimeS * 0.02f))
+        {
+            R_ERROR("FramePacerTest", "Frame pacer missed its target at %.1f Hz!", frameRate);
+            success = false;
+        }
+
+        // Sleeping through most of the frame should leave the core mostly idle.
+        if (pacerResult.cpuUsage > 0.5f)
+        {
+            R_ERROR("FramePacerTest", "Frame pacer used %.1f%% cpu at %.1f Hz!", pacerResult.cpuUsage * 100.0f, frameRate);
+            success = false;
+        }
+    }
+
+    return Test::finish("FramePacerTest", success);
+}
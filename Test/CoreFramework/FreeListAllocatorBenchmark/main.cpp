@@ -0,0 +1,252 @@
+#include "Recluse/Memory/FreeListAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <vector>
+
+using namespace Recluse;
+
+static const U32 kNumOps                = 1000000;
+static const U32 kNumSlots              = 4096;
+static const U32 kReportInterval        = 250000;
+static const U64 kPoolSizeBytes         = R_MB(256);
+
+
+struct Slot
+{
+    UPtr    address;
+    U64     sizeBytes;
+    U8      tag;
+};
+
+
+// One step of the workload. Built up front, so every allocator runs the exact same sequence.
+struct Op
+{
+    U32     slot;
+    U32     sizeBytes;
+    U16     alignment;
+};
+
+
+static U32 nextRandom(U32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8u;
+}
+
+
+static std::vector<Op> buildOps()
+{
+    std::vector<Op> ops(kNumOps);
+    U32 random = 1234u;
+    const U16 alignments[] = { 8u, 16u, 16u, 16u, 64u, 256u, 4096u };
+
+    for (U32 i = 0; i < kNumOps; ++i)
+    {
+        // Mostly small sizes, spread log uniformly up to 64KB, with the odd large blob.
+        const U32 shift     = 4u + nextRandom(random) % 13u;
+        const U32 large     = (nextRandom(random) % 1000u) == 0u ? R_MB(4) : 0u;
+        ops[i].slot         = nextRandom(random) % kNumSlots;
+        ops[i].sizeBytes    = large + (1u << shift) + nextRandom(random) % (1u << shift);
+        ops[i].alignment    = alignments[nextRandom(random) % (sizeof(alignments) / sizeof(alignments[0]))];
+    }
+    return ops;
+}
+
+
+static void report(const char* when, const FreeListAllocator& allocator)
+{
+    const FreeListAllocator::FragmentationReport report = allocator.getFragmentationReport();
+    R_INFO
+        (
+            "FreeListAllocatorBenchmark",
+            "%-10s used=%8llu KB (%6d blocks) free=%8llu KB (%6d blocks) largest free=%8llu KB fragmentation=%.3f",
+            when,
+            report.usedBytes / 1024ull,
+            report.numUsedBlocks,
+            report.totalFreeBytes / 1024ull,
+            report.numFreeBlocks,
+            report.largestFreeBlockBytes / 1024ull,
+            report.fragmentation
+        );
+}
+
+
+// Runs the ops against the allocator. Each slot is freed if it holds an allocation, otherwise
+// it gets a new one. Checks that blocks are aligned, and that no block stomped another.
+static Bool runOps(const char* name, Allocator* pAllocator, const std::vector<Op>& ops, const FreeListAllocator* pReportAllocator)
+{
+    std::vector<Slot> slots(kNumSlots);
+    U64 numFailed       = 0;
+    U64 numCorrupted    = 0;
+    U64 numMisaligned   = 0;
+    U64 liveBytes       = 0;
+    U8 nextTag          = 1;
+
+    RealtimeStopWatch start;
+    for (U32 i = 0; i < ops.size(); ++i)
+    {
+        const Op& op    = ops[i];
+        Slot& slot      = slots[op.slot];
+
+        if (slot.address)
+        {
+            const U8* pBytes = reinterpret_cast<const U8*>(slot.address);
+            numCorrupted += ((pBytes[0] != slot.tag) || (pBytes[slot.sizeBytes - 1u] != slot.tag)) ? 1 : 0;
+            pAllocator->free(slot.address);
+            liveBytes      -= slot.sizeBytes;
+            slot.address    = 0;
+        }
+        else
+        {
+            slot.address = pAllocator->allocate(op.sizeBytes, op.alignment);
+            if (!slot.address)
+            {
+                numFailed += 1;
+                continue;
+            }
+
+            numMisaligned  += (slot.address & (op.alignment - 1u)) ? 1 : 0;
+            slot.sizeBytes  = op.sizeBytes;
+            slot.tag        = nextTag++;
+            liveBytes      += op.sizeBytes;
+
+            U8* pBytes                      = reinterpret_cast<U8*>(slot.address);
+            pBytes[0]                       = slot.tag;
+            pBytes[slot.sizeBytes - 1u]     = slot.tag;
+        }
+
+        if (pReportAllocator && ((i + 1u) % kReportInterval) == 0u)
+        {
+            report("midway", *pReportAllocator);
+        }
+    }
+    F32 secs = Test::measure(start);
+
+    R_INFO
+        (
+            "FreeListAllocatorBenchmark",
+            "%-8s %d ops: %8.1f ns/op, live at end=%llu KB",
+            name,
+            static_cast<U32>(ops.size()),
+            (secs * 1e9f) / F32(ops.size()),
+            liveBytes / 1024ull
+        );
+
+    if (pReportAllocator)
+    {
+        report("end", *pReportAllocator);
+    }
+
+    for (U32 i = 0; i < kNumSlots; ++i)
+    {
+        if (slots[i].address)
+        {
+            pAllocator->free(slots[i].address);
+        }
+    }
+
+    if (numFailed || numCorrupted || numMisaligned || pAllocator->getTotalAllocations())
+    {
+        R_ERROR
+            (
+                "FreeListAllocatorBenchmark",
+                "%s failed! failed allocs=%llu corrupted=%llu misaligned=%llu leaked=%llu",
+                name,
+                numFailed,
+                numCorrupted,
+                numMisaligned,
+                pAllocator->getTotalAllocations()
+            );
+        return false;
+    }
+
+    return true;
+}
+
+
+static Bool testFreeList(MemoryPool& pool)
+{
+    FreeListAllocator allocator;
+    Bool success = true;
+
+    allocator.initialize(pool.getBaseAddress(), R_KB(64));
+    const FreeListAllocator::FragmentationReport empty = allocator.getFragmentationReport();
+
+    const UPtr first    = allocator.allocate(100u, 8u);
+    const UPtr second   = allocator.allocate(200u, 1024u);
+    const UPtr third    = allocator.allocate(300u, 8u);
+    if (!first || !second || !third || (second & 1023u))
+    {
+        R_ERROR("FreeListAllocatorBenchmark", "Basic allocations failed!");
+        success = false;
+    }
+
+    if (allocator.allocate(R_KB(64), 8u) || (allocator.getLastError() != ResultCode(RecluseResult_OutOfMemory)))
+    {
+        R_ERROR("FreeListAllocatorBenchmark", "Allocating more than the pool holds should fail!");
+        success = false;
+    }
+
+    // Freeing the middle block leaves a hole, freeing its neighbors merges everything back.
+    allocator.free(second);
+    allocator.free(second);
+    if (allocator.getLastError() != ResultCode(RecluseResult_CorruptMemory))
+    {
+        R_ERROR("FreeListAllocatorBenchmark", "Double free was not caught!");
+        success = false;
+    }
+
+    allocator.free(first);
+    allocator.free(third);
+
+    const FreeListAllocator::FragmentationReport merged = allocator.getFragmentationReport();
+    if ((merged.numFreeBlocks != 1u) || (merged.numUsedBlocks != 0u) || (merged.totalFreeBytes != empty.totalFreeBytes) || (allocator.getUsedSizeBytes() != 0ull))
+    {
+        R_ERROR("FreeListAllocatorBenchmark", "Freed blocks did not merge back into one! free blocks=%d", merged.numFreeBlocks);
+        success = false;
+    }
+
+    allocator.cleanUp();
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+    MemoryPool pool(kPoolSizeBytes);
+    const std::vector<Op> ops = buildOps();
+
+    success &= testFreeList(pool);
+
+    {
+        MallocAllocator allocator;
+        allocator.initialize(0, 0);
+        success &= runOps("Malloc", &allocator, ops, nullptr);
+        allocator.cleanUp();
+    }
+
+    {
+        FreeListAllocator allocator;
+        allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+        const FreeListAllocator::FragmentationReport empty = allocator.getFragmentationReport();
+        success &= runOps("FreeList", &allocator, ops, &allocator);
+
+        // Everything freed, so everything should have merged back into one block.
+        const FreeListAllocator::FragmentationReport finished = allocator.getFragmentationReport();
+        if ((finished.numFreeBlocks != 1u) || (finished.totalFreeBytes != empty.totalFreeBytes))
+        {
+            R_ERROR("FreeListAllocatorBenchmark", "Pool did not merge back into one block! free blocks=%d", finished.numFreeBlocks);
+            success = false;
+        }
+        allocator.cleanUp();
+    }
+
+    return Test::finish("FreeListAllocatorBenchmark", success);
+}
@@ -0,0 +1,249 @@
+#include "Recluse/Threading/Locks.hpp"
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumOpsPerThread   = 200000;
+static const U32 kMaxThreads        = 8;
+
+enum LockType
+{
+    LockType_CriticalSection,
+    LockType_SpinLock,
+    LockType_RWLock,
+    LockType_SeqLock,
+    LockType_Count
+};
+
+static const char* kLockTypeNames[LockType_Count] = { "CriticalSection", "SpinLock", "RWLock", "SeqLock" };
+
+
+// Writers always keep both halves equal, so a reader seeing them differ read a torn update.
+struct SharedData
+{
+    U64 first;
+    U64 second;
+};
+
+static CriticalSection      g_criticalSection;
+static SpinLock             g_spinLock;
+static RWLock               g_rwLock;
+static SharedData           g_data;
+static SeqLock<SharedData>  g_seqData;
+
+static Atomic<U32>          g_startFlag;
+static Atomic<U32>          g_numReady;
+static Atomic<U64>          g_numTornReads;
+
+
+struct BenchmarkPayload
+{
+    LockType    lockType;
+    U32         writePercent;
+    U32         threadIndex;
+    U32         numWrites;
+};
+
+
+static void writeData(SharedData& data)
+{
+    data.first  += 1;
+    data.second += 1;
+}
+
+
+static U64 runOps(LockType lockType, U32 writePercent, U32 threadIndex)
+{
+    U64 numWrites   = 0;
+    U64 numTorn     = 0;
+
+    for (U32 i = 0; i < kNumOpsPerThread; ++i)
+    {
+        // Offset each thread, so writes don't all line up.
+        const Bool isWrite = ((i + threadIndex * 37u) % 100u) < writePercent;
+        SharedData read    = { };
+
+        switch (lockType)
+        {
+            case LockType_CriticalSection:
+            {
+                ScopedCriticalSection _(g_criticalSection);
+                if (isWrite) writeData(g_data);
+                else read = g_data;
+                break;
+            }
+            case LockType_SpinLock:
+            {
+                ScopedSpinLock _(g_spinLock);
+                if (isWrite) writeData(g_data);
+                else read = g_data;
+                break;
+            }
+            case LockType_RWLock:
+            {
+                if (isWrite)
+                {
+                    ScopedWriteLock _(g_rwLock);
+                    writeData(g_data);
+                }
+                else
+                {
+                    ScopedReadLock _(g_rwLock);
+                    read = g_data;
+                }
+                break;
+            }
+            case LockType_SeqLock:
+            default:
+            {
+                if (isWrite)
+                {
+                    // Writers serialize on the seqlock, but still need to read-modify-write
+                    // the data as one step.
+                    ScopedSpinLock _(g_spinLock);
+                    SharedData data = g_seqData.load();
+                    writeData(data);
+                    g_seqData.store(data);
+                }
+                else
+                {
+                    read = g_seqData.load();
+                }
+                break;
+            }
+        }
+
+        numWrites   += isWrite ? 1 : 0;
+        numTorn     += (read.first != read.second) ? 1 : 0;
+    }
+
+    g_numTornReads.fetchAdd(numTorn);
+    return numWrites;
+}
+
+
+static ResultCode benchmarkThread(void* pData)
+{
+    BenchmarkPayload* pPayload = static_cast<BenchmarkPayload*>(pData);
+
+    // Line up all threads before starting, so they actually contend.
+    g_numReady.fetchAdd(1u);
+    while (g_startFlag.load(MemoryOrder_Acquire) == 0u)
+    {
+        yieldProcessor();
+    }
+
+    pPayload->numWrites = static_cast<U32>(runOps(pPayload->lockType, pPayload->writePercent, pPayload->threadIndex));
+    return RecluseResult_Ok;
+}
+
+
+static Bool runBenchmark(LockType lockType, U32 writePercent, U32 numThreads)
+{
+    Thread threads[kMaxThreads]             = { };
+    BenchmarkPayload payloads[kMaxThreads]  = { };
+    const SharedData zero                   = { };
+
+    g_data = zero;
+    g_seqData.store(zero);
+    g_numTornReads.store(0ull);
+    g_startFlag.store(0u);
+    g_numReady.store(0u);
+
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        payloads[i].lockType        = lockType;
+        payloads[i].writePercent    = writePercent;
+        payloads[i].threadIndex     = i;
+        threads[i].payload          = &payloads[i];
+        createThread(&threads[i], benchmarkThread);
+    }
+
+    while (g_numReady.load() != numThreads)
+    {
+        yieldThread();
+    }
+
+    RealtimeStopWatch start;
+    g_startFlag.store(1u, MemoryOrder_Release);
+    U64 expectedWrites = 0;
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        joinThread(&threads[i]);
+        expectedWrites += payloads[i].numWrites;
+    }
+    F32 secs = Test::measure(start);
+
+    R_INFO
+        (
+            "LockBenchmark",
+            "%-16s writes=%2d%% threads=%d: %8.1f ns/op",
+            kLockTypeNames[lockType],
+            writePercent,
+            numThreads,
+            (secs * 1e9f) / F32(U64(kNumOpsPerThread) * numThreads)
+        );
+
+    const SharedData result = (lockType == LockType_SeqLock) ? g_seqData.load() : g_data;
+    if ((g_numTornReads.load() > 0ull) || (result.first != expectedWrites) || (result.second != expectedWrites))
+    {
+        R_ERROR
+            (
+                "LockBenchmark",
+                "%s failed! torn reads=%llu writes=%llu expected=%llu",
+                kLockTypeNames[lockType],
+                g_numTornReads.load(),
+                result.first,
+                expectedWrites
+            );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    const U32 threadCounts[]    = { 1, 2, 4, 8 };
+    const U32 writePercents[]   = { 0, 1, 10, 50 };
+    Bool success                = true;
+
+    g_criticalSection.initialize();
+
+    for (U32 w = 0; w < sizeof(writePercents) / sizeof(writePercents[0]); ++w)
+    {
+        for (U32 t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)
+        {
+            for (U32 lockType = 0; lockType < LockType_Count; ++lockType)
+            {
+                success &= runBenchmark(static_cast<LockType>(lockType), writePercents[w], threadCounts[t]);
+            }
+        }
+    }
+
+    // Writers are exclusive, readers are not.
+    if (!g_rwLock.tryLockShared() || !g_rwLock.tryLockShared() || g_rwLock.tryLock())
+    {
+        R_ERROR("LockBenchmark", "RWLock should allow many readers, and no writer alongside them!");
+        success = false;
+    }
+    g_rwLock.unlockShared();
+    g_rwLock.unlockShared();
+
+    if (!g_rwLock.tryLock() || g_rwLock.tryLockShared())
+    {
+        R_ERROR("LockBenchmark", "RWLock should not allow readers alongside a writer!");
+        success = false;
+    }
+    g_rwLock.unlock();
+
+    g_criticalSection.release();
+
+    return Test::finish("LockBenchmark", success);
+}
@@ -0,0 +1,158 @@
+#include "Recluse/Memory/MemoryBudget.hpp"
+#include "Recluse/Memory/FreeListAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "TestCommon.hpp"
+
+#include <vector>
+
+using namespace Recluse;
+
+static const U64 kPoolSizeBytes     = R_MB(16);
+static const U64 kBudgetBytes       = R_MB(4);
+static const U64 kSoftLimitBytes    = R_MB(3);
+static const U64 kAllocationBytes   = R_KB(64);
+
+
+// Stands in for a streaming system, that drops what it holds when asked to.
+struct TextureCache
+{
+    FreeListAllocator   allocator;
+    std::vector<UPtr>   textures;
+    U32                 numEvictions;
+
+    void stream(U32 count)
+    {
+        for (U32 i = 0; i < count; ++i)
+        {
+            textures.push_back(allocator.allocate(kAllocationBytes, 16));
+        }
+    }
+
+    void evict(const MemoryBudgetStatus& status)
+    {
+        // Free the oldest until back under the soft limit.
+        U64 usedBytes = status.usedBytes;
+        U32 numFreed  = 0u;
+        while ((usedBytes > status.softLimitBytes) && (numFreed < textures.size()))
+        {
+            allocator.free(textures[numFreed++]);
+            usedBytes -= kAllocationBytes;
+        }
+        textures.erase(textures.begin(), textures.begin() + numFreed);
+        numEvictions++;
+    }
+};
+
+
+static Bool testSoftLimit(MemoryPool& pool)
+{
+    Bool success = true;
+    TextureCache cache;
+    cache.numEvictions = 0u;
+    cache.allocator.setMemoryTag(MemoryTag_Graphics);
+    cache.allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+    const U32 callbackId = MemoryBudgets::addOverBudgetCallback(MemoryTag_Graphics, [&cache] (const MemoryBudgetStatus& status) { cache.evict(status); });
+
+    // Stay under the soft limit, nothing should be evicted.
+    cache.stream(U32(kSoftLimitBytes / kAllocationBytes) - 8u);
+    MemoryBudgets::update();
+    if (cache.numEvictions)
+    {
+        R_ERROR("MemoryBudgetTest", "Evicted while under the soft limit!");
+        success = false;
+    }
+
+    // Go over, the cache is asked to evict, and ends up back under.
+    cache.stream(16u);
+    MemoryBudgets::update();
+    MemoryBudgetStatus status = MemoryBudgets::getStatus(MemoryTag_Graphics);
+    if ((cache.numEvictions != 1u) || status.overSoftLimit || (status.usedBytes > kSoftLimitBytes))
+    {
+        R_ERROR("MemoryBudgetTest", "Not evicted back under the soft limit! used=%llu KB", status.usedBytes / R_1KB);
+        success = false;
+    }
+
+    // Reserved memory counts too.
+    MemoryBudgets::reserve(MemoryTag_Graphics, kBudgetBytes);
+    status = MemoryBudgets::getStatus(MemoryTag_Graphics);
+    if (!status.overBudget || (status.reservedBytes != kBudgetBytes))
+    {
+        R_ERROR("MemoryBudgetTest", "Reserved memory was not charged to the budget!");
+        success = false;
+    }
+    MemoryBudgets::unreserve(MemoryTag_Graphics, kBudgetBytes);
+
+    // Removed callbacks are not called again.
+    MemoryBudgets::removeOverBudgetCallback(callbackId);
+    cache.stream(16u);
+    MemoryBudgets::update();
+    if (cache.numEvictions != 1u)
+    {
+        R_ERROR("MemoryBudgetTest", "Removed callback was still called!");
+        success = false;
+    }
+
+    for (UPtr texture : cache.textures)
+    {
+        cache.allocator.free(texture);
+    }
+    cache.allocator.cleanUp();
+    return success;
+}
+
+
+static Bool testSnapshot()
+{
+    Bool success = true;
+    MemoryBudgetStatus statuses[MemoryTag_Count];
+    const U32 numStatuses = MemoryBudgets::getSnapshot(statuses, MemoryTag_Count);
+    if ((numStatuses != MemoryTag_Count) || (statuses[MemoryTag_Graphics].budgetBytes != kBudgetBytes) || (statuses[MemoryTag_Graphics].softLimitBytes != kSoftLimitBytes))
+    {
+        R_ERROR("MemoryBudgetTest", "Snapshot does not match the budgets!");
+        success = false;
+    }
+
+    // Tags without a budget size off their defaults.
+    if ((MemoryBudgets::getBudgetBytes(MemoryTag_Messaging, R_MB(2)) != R_MB(2)) || (MemoryBudgets::getBudgetBytes(MemoryTag_Graphics, R_MB(2)) != kBudgetBytes))
+    {
+        R_ERROR("MemoryBudgetTest", "Budget sizes are off!");
+        success = false;
+    }
+
+    if (MemoryBudgets::setBudget(MemoryTag_Scene, R_MB(1), R_MB(2)) != ResultCode(RecluseResult_InvalidArgs))
+    {
+        R_ERROR("MemoryBudgetTest", "Soft limit above the budget was accepted!");
+        success = false;
+    }
+
+    MemoryBudgets::logSnapshot();
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+    MemoryPool pool(kPoolSizeBytes);
+
+    MemoryBudgets::setBudget(MemoryTag_Graphics, kBudgetBytes, kSoftLimitBytes);
+    // Counters only, as the main loop does when budgets are set.
+    MemoryScanner::enableTracking(0u);
+
+    success &= testSoftLimit(pool);
+    success &= testSnapshot();
+
+    MemoryScanner::disableTracking();
+    MemoryBudgets::clearBudget(MemoryTag_Graphics);
+    if (MemoryBudgets::hasBudgets())
+    {
+        R_ERROR("MemoryBudgetTest", "Budgets left after clearing!");
+        success = false;
+    }
+
+    return Test::finish("MemoryBudgetTest", success);
+}
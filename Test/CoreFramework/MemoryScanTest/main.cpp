@@ -0,0 +1,253 @@
+#include "Recluse/Memory/MemoryScan.hpp"
+#include "Recluse/Memory/FreeListAllocator.hpp"
+#include "Recluse/Memory/LinearAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <vector>
+
+using namespace Recluse;
+
+static const U64 kPoolSizeBytes     = R_MB(64);
+static const U32 kNumAllocations    = 20000;
+static const U32 kNumIterations     = 200;
+static const U32 kMaxCallsites      = 8;
+
+
+struct LeakyObject
+{
+    U64     values[4];
+};
+
+
+static U32 nextRandom(U32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8u;
+}
+
+
+// Allocates and frees the same way each run, so the tracked run can be compared to the untracked one.
+static U64 churn(Allocator* pAllocator, std::vector<UPtr>& live)
+{
+    U32 random      = 1u;
+    U64 checksum    = 0ull;
+    for (U32 it = 0; it < kNumIterations; ++it)
+    {
+        for (U32 i = 0; i < kNumAllocations; ++i)
+        {
+            live[i] = pAllocator->allocate(16u + (nextRandom(random) % 240u), 16u);
+            checksum += live[i] ? 1ull : 0ull;
+        }
+
+        for (U32 i = 0; i < kNumAllocations; ++i)
+        {
+            pAllocator->free(live[i]);
+        }
+    }
+    return checksum;
+}
+
+
+static Bool testTagStats(MemoryPool& pool)
+{
+    Bool success = true;
+    FreeListAllocator allocator;
+    allocator.setMemoryTag(MemoryTag_Renderer);
+    allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+    std::vector<UPtr> allocations;
+    for (U32 i = 0; i < 1000; ++i)
+    {
+        allocations.push_back(allocator.allocate(128, 16));
+    }
+
+    MemoryTagStats stats = MemoryScanner::getTagStats(MemoryTag_Renderer);
+    if ((stats.liveAllocations != 1000ull) || (stats.liveBytes != allocator.getUsedSizeBytes()) || (stats.peakBytes != stats.liveBytes))
+    {
+        R_ERROR("MemoryScanTest", "Tag stats do not match the allocator! live=%llu used=%llu", stats.liveBytes, allocator.getUsedSizeBytes());
+        success = false;
+    }
+
+    const U64 peakBytes = stats.peakBytes;
+    for (UPtr allocation : allocations)
+    {
+        allocator.free(allocation);
+    }
+
+    stats = MemoryScanner::getTagStats(MemoryTag_Renderer);
+    if (stats.liveAllocations || stats.liveBytes || (stats.peakBytes != peakBytes) || (stats.totalAllocations != 1000ull))
+    {
+        R_ERROR("MemoryScanTest", "Frees were not tracked! live=%llu peak=%llu", stats.liveBytes, stats.peakBytes);
+        success = false;
+    }
+
+    allocator.cleanUp();
+    return success;
+}
+
+
+// Arenas give everything back on reset. The frame stats should show what each frame allocated.
+static Bool testFrameStats(MemoryPool& pool)
+{
+    Bool success = true;
+    LinearAllocator allocator;
+    allocator.setMemoryTag(MemoryTag_Frame);
+    allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+    MemoryScanner::markFrame();
+    for (U32 frame = 1; frame <= 3; ++frame)
+    {
+        allocator.reset();
+        for (U32 i = 0; i < frame * 100u; ++i)
+        {
+            allocator.allocate(64, 16);
+        }
+        MemoryScanner::markFrame();
+
+        const MemoryFrameStats frameStats = MemoryScanner::getLastFrameStats(MemoryTag_Frame);
+        if (frameStats.numAllocations != frame * 100u)
+        {
+            R_ERROR("MemoryScanTest", "Frame %d allocated %llu times, expected %d!", frame, frameStats.numAllocations, frame * 100u);
+            success = false;
+        }
+    }
+
+    allocator.reset();
+    const MemoryTagStats stats = MemoryScanner::getTagStats(MemoryTag_Frame);
+    if (stats.liveAllocations || stats.liveBytes || (stats.peakBytes < 300ull * 64ull))
+    {
+        R_ERROR("MemoryScanTest", "Arena reset was not tracked! live=%llu peak=%llu", stats.liveBytes, stats.peakBytes);
+        success = false;
+    }
+
+    allocator.cleanUp();
+    return success;
+}
+
+
+// Leaks are reported by tag and by callsite, and the callsite of a sampled allocation can be looked up.
+static Bool testLeaks()
+{
+    Bool success = true;
+    std::vector<LeakyObject*> objects;
+    for (U32 i = 0; i < 64; ++i)
+    {
+        objects.push_back(rlsMalloc<LeakyObject, MemoryTag_Game>());
+    }
+
+    // Free all but one.
+    for (U32 i = 1; i < objects.size(); ++i)
+    {
+        rlsFree(objects[i]);
+    }
+
+    MemoryCallsite callsite = { };
+    if (!MemoryScanner::getMemoryAllocationLocation(objects[0], callsite) || (callsite.tag != MemoryTag_Game) || !callsite.numStackFrames)
+    {
+        R_ERROR("MemoryScanTest", "No callsite found for a sampled allocation!");
+        success = false;
+    }
+
+    const MemoryTagStats stats = MemoryScanner::getTagStats(MemoryTag_Game);
+    if ((stats.liveAllocations != 1ull) || (stats.liveBytes != sizeof(LeakyObject)) || (MemoryScanner::reportLeaks() != sizeof(LeakyObject)))
+    {
+        R_ERROR("MemoryScanTest", "Leak was not found! live=%llu allocations", stats.liveAllocations);
+        success = false;
+    }
+
+    rlsFree(objects[0]);
+    if (MemoryScanner::reportLeaks() != 0ull)
+    {
+        R_ERROR("MemoryScanTest", "Leaks left after everything was freed!");
+        success = false;
+    }
+
+    return success;
+}
+
+
+// Sampled at the default rate, the busiest callsite should still stand out.
+static Bool benchmark(MemoryPool& pool)
+{
+    Bool success = true;
+    std::vector<UPtr> live(kNumAllocations);
+    U64 checksums[2] = { };
+    F32 secs[2] = { };
+
+    for (U32 tracked = 0; tracked < 2; ++tracked)
+    {
+        if (tracked)
+        {
+            MemoryScanner::enableTracking();
+        }
+
+        FreeListAllocator allocator;
+        allocator.setMemoryTag(MemoryTag_Scene);
+        allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+        RealtimeStopWatch start;
+        checksums[tracked]  = churn(&allocator, live);
+        secs[tracked]       = Test::measure(start);
+        allocator.cleanUp();
+    }
+
+    MemoryCallsite callsites[kMaxCallsites];
+    const U32 numCallsites = MemoryScanner::getTopCallsites(callsites, kMaxCallsites);
+    const U64 numAllocs = U64(kNumAllocations) * kNumIterations;
+    R_INFO
+        (
+            "MemoryScanTest",
+            "Allocate + free: untracked=%.1f ns, tracked=%.1f ns, sampling 1 in %d",
+            (secs[0] * 1e9f) / F32(numAllocs),
+            (secs[1] * 1e9f) / F32(numAllocs),
+            MemoryScanner::getSampleRate()
+        );
+
+    if (numCallsites)
+    {
+        R_INFO
+            (
+                "MemoryScanTest",
+                "Top callsite 0x%016llx (%s): ~%llu allocations, ~%llu KB",
+                callsites[0].stackHash,
+                MemoryScanner::getTagName(callsites[0].tag),
+                callsites[0].sampledAllocations * MemoryScanner::getSampleRate(),
+                (callsites[0].sampledBytes * MemoryScanner::getSampleRate()) / R_1KB
+            );
+    }
+
+    // Sampling by address should land somewhere near 1 in N. Only a few dozen addresses get
+    // sampled at the default rate, so leave plenty of room.
+    const U64 sampled = numCallsites ? callsites[0].sampledAllocations * MemoryScanner::getSampleRate() : 0ull;
+    if ((checksums[0] != checksums[1]) || !numCallsites || (callsites[0].tag != MemoryTag_Scene) || (sampled < numAllocs / 4) || (sampled > numAllocs * 4))
+    {
+        R_ERROR("MemoryScanTest", "Sampling is off! estimated=%llu actual=%llu", sampled, numAllocs);
+        success = false;
+    }
+
+    MemoryScanner::disableTracking();
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+    MemoryPool pool(kPoolSizeBytes);
+
+    // Everything is sampled, so the tests are exact.
+    MemoryScanner::enableTracking(1u);
+    success &= testTagStats(pool);
+    success &= testFrameStats(pool);
+    success &= testLeaks();
+    MemoryScanner::disableTracking();
+
+    success &= benchmark(pool);
+
+    return Test::finish("MemoryScanTest", success);
+}
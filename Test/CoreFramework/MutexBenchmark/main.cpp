@@ -0,0 +1,187 @@
+#include <atomic>
+#include <mutex>
+
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumUncontendedIterations  = 2000000;
+static const U32 kNumContendedIterations    = 200000;
+static const U32 kMaxThreads                = 32;
+
+enum LockType
+{
+    LockType_Mutex,
+    LockType_CriticalSection,
+    LockType_StdMutex,
+    LockType_Count
+};
+
+static const char* kLockTypeNames[LockType_Count] = { "Mutex", "CriticalSection", "std::mutex" };
+
+static Mutex            g_mutex         = nullptr;
+static CriticalSection  g_criticalSection;
+static std::mutex       g_stdMutex;
+
+// Only ever touched inside of the lock, used to check the locks actually exclude.
+static U64              g_counter       = 0;
+static std::atomic<U32> g_startFlag;
+static std::atomic<U32> g_numReady;
+
+
+struct BenchmarkPayload
+{
+    LockType    lockType;
+    U32         numIterations;
+};
+
+
+static void runLockLoop(LockType lockType, U32 numIterations)
+{
+    switch (lockType)
+    {
+        case LockType_Mutex:
+            for (U32 i = 0; i < numIterations; ++i)
+            {
+                lockMutex(g_mutex);
+                ++g_counter;
+                unlockMutex(g_mutex);
+            }
+            break;
+        case LockType_CriticalSection:
+            for (U32 i = 0; i < numIterations; ++i)
+            {
+                ScopedCriticalSection _(g_criticalSection);
+                ++g_counter;
+            }
+            break;
+        case LockType_StdMutex:
+        default:
+            for (U32 i = 0; i < numIterations; ++i)
+            {
+                std::lock_guard<std::mutex> _(g_stdMutex);
+                ++g_counter;
+            }
+            break;
+    }
+}
+
+
+static ResultCode benchmarkThread(void* pData)
+{
+    BenchmarkPayload* pPayload = static_cast<BenchmarkPayload*>(pData);
+
+    // Line up all threads before starting, so they actually contend.
+    g_numReady.fetch_add(1u);
+    while (g_startFlag.load(std::memory_order_acquire) == 0u)
+    {
+        yieldProcessor();
+    }
+
+    runLockLoop(pPayload->lockType, pPayload->numIterations);
+    return RecluseResult_Ok;
+}
+
+
+static Bool runContended(LockType lockType, U32 numThreads)
+{
+    Thread threads[kMaxThreads]             = { };
+    BenchmarkPayload payload                = { lockType, kNumContendedIterations / numThreads };
+    const U64 expectedCount                 = U64(payload.numIterations) * U64(numThreads);
+
+    g_counter = 0;
+    g_startFlag.store(0u);
+    g_numReady.store(0u);
+
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        threads[i].payload = &payload;
+        createThread(&threads[i], benchmarkThread);
+    }
+
+    while (g_numReady.load() != numThreads)
+    {
+        yieldThread();
+    }
+
+    RealtimeStopWatch start;
+    g_startFlag.store(1u, std::memory_order_release);
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        joinThread(&threads[i]);
+    }
+    F32 secs = Test::measure(start);
+
+    R_INFO
+        (
+            "MutexBenchmark",
+            "%-16s contended, threads=%2d: %8.1f ns/op",
+            kLockTypeNames[lockType],
+            numThreads,
+            (secs * 1e9f) / F32(expectedCount)
+        );
+
+    if (g_counter != expectedCount)
+    {
+        R_ERROR("MutexBenchmark", "%s counter mismatch! got=%llu expected=%llu", kLockTypeNames[lockType], g_counter, expectedCount);
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    const U32 threadCounts[]    = { 2, 4, 8, 16, 32 };
+    Bool success                = true;
+
+    g_mutex = createMutex("MutexBenchmark");
+    g_criticalSection.initialize();
+
+    // Uncontended, only measures the fast path of each lock.
+    for (U32 lockType = 0; lockType < LockType_Count; ++lockType)
+    {
+        g_counter = 0;
+        RealtimeStopWatch start;
+        runLockLoop(static_cast<LockType>(lockType), kNumUncontendedIterations);
+        F32 secs = Test::measure(start);
+
+        R_INFO("MutexBenchmark", "%-16s uncontended:          %8.1f ns/op", kLockTypeNames[lockType], (secs * 1e9f) / F32(kNumUncontendedIterations));
+
+        if (g_counter != kNumUncontendedIterations)
+        {
+            success = false;
+        }
+    }
+
+    for (U32 t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)
+    {
+        for (U32 lockType = 0; lockType < LockType_Count; ++lockType)
+        {
+            success &= runContended(static_cast<LockType>(lockType), threadCounts[t]);
+        }
+    }
+
+    // Recursive locking should still be allowed on the same thread.
+    if ((tryLockMutex(g_mutex) != RecluseResult_Ok) || (tryLockMutex(g_mutex) != RecluseResult_Ok))
+    {
+        R_ERROR("MutexBenchmark", "Mutex failed to lock recursively!");
+        success = false;
+    }
+    else
+    {
+        unlockMutex(g_mutex);
+        unlockMutex(g_mutex);
+    }
+
+    g_criticalSection.release();
+    destroyMutex(g_mutex);
+
+    return Test::finish("MutexBenchmark", success);
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <vector>
+
+#include "Recluse/Algorithms/Parallel.hpp"
+#include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U64 kElementCounts[]   = { 10000, 100000, 1000000 };
+static const U32 kWorkerCounts[]    = { 0, 1, 3, 7 };
+
+
+// Enough work per element to be worth spreading out, roughly a small transform update.
+static U64 hashValue(U64 value)
+{
+    U64 hash = value;
+    for (U32 i = 0; i < 32; ++i)
+    {
+        hash = hash * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    return hash;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+
+    for (U32 c = 0; c < sizeof(kElementCounts) / sizeof(kElementCounts[0]); ++c)
+    {
+        const U64 count = kElementCounts[c];
+        std::vector<U64> input(count);
+        std::vector<U64> output(count);
+        std::vector<U64> sorted;
+
+        for (U64 i = 0; i < count; ++i)
+        {
+            input[i] = hashValue(i);
+        }
+
+        sorted = input;
+        std::sort(sorted.begin(), sorted.end());
+
+        U64 expectedSum = 0;
+        for (U64 i = 0; i < count; ++i)
+        {
+            expectedSum += hashValue(input[i]);
+        }
+
+        for (U32 w = 0; w < sizeof(kWorkerCounts) / sizeof(kWorkerCounts[0]); ++w)
+        {
+            // 0 workers runs everything on the calling thread, which is our serial baseline.
+            const U32 numWorkers = kWorkerCounts[w];
+            ThreadPool pool(numWorkers);
+            ParallelRange range = { 0ull, count };
+
+            RealtimeStopWatch start;
+            parallelFor(&pool, range, kAutoGrainSize, [&] (U64 i) -> void { output[i] = hashValue(input[i]); });
+            F32 forSecs = Test::measure(start);
+
+            start = RealtimeStopWatch();
+            U64 sum = parallelReduce
+                        (
+                            &pool,
+                            range,
+                            kAutoGrainSize,
+                            0ull,
+                            [&] (U64 i) -> U64 { return hashValue(input[i]); },
+                            [] (U64 lhs, U64 rhs) -> U64 { return lhs + rhs; }
+                        );
+            F32 reduceSecs = Test::measure(start);
+
+            std::vector<U64> data = input;
+            start = RealtimeStopWatch();
+            parallelSort(&pool, data.data(), data.size());
+            F32 sortSecs = Test::measure(start);
+
+            Bool forPassed = true;
+            for (U64 i = 0; i < count; ++i)
+            {
+                if (output[i] != hashValue(input[i]))
+                {
+                    forPassed = false;
+                    break;
+                }
+                output[i] = 0;
+            }
+
+            if (!forPassed || (sum != expectedSum) || (data != sorted))
+            {
+                R_ERROR
+                    (
+                        "ParallelBenchmark",
+                        "Mismatch! count=%llu workers=%d for=%d reduce=%d sort=%d",
+                        count,
+                        numWorkers,
+                        forPassed,
+                        sum == expectedSum,
+                        data == sorted
+                    );
+                success = false;
+            }
+
+            R_INFO
+                (
+                    "ParallelBenchmark",
+                    "count=%8llu workers=%d  for: %8.3f ms  reduce: %8.3f ms  sort: %8.3f ms",
+                    count,
+                    numWorkers,
+                    forSecs * 1000.0f,
+                    reduceSecs * 1000.0f,
+                    sortSecs * 1000.0f
+                );
+        }
+    }
+
+    return Test::finish("ParallelBenchmark", success);
+}
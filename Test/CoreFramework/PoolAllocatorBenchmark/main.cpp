@@ -0,0 +1,267 @@
+#include "Recluse/Memory/PoolAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumRoundsPerThread    = 2000;
+static const U32 kBatchSize             = 128;
+static const U32 kMaxThreads            = 16;
+static const U32 kMaxRequestSizeBytes   = 256;
+static const U64 kPoolSizeBytes         = R_MB(64);
+
+static Atomic<U32>  g_startFlag;
+static Atomic<U32>  g_numReady;
+static Atomic<U64>  g_numCorrupted;
+
+
+struct BenchmarkPayload
+{
+    Allocator*  pAllocator;
+    U32         threadIndex;
+    U32         numFailed;
+};
+
+
+// Cheap deterministic sizes, so every run, and every allocator, sees the same requests.
+static U32 nextRandom(U32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8u;
+}
+
+
+static ResultCode benchmarkThread(void* pData)
+{
+    BenchmarkPayload* pPayload  = static_cast<BenchmarkPayload*>(pData);
+    Allocator* pAllocator       = pPayload->pAllocator;
+    UPtr blocks[kBatchSize]     = { };
+    U32 sizes[kBatchSize]       = { };
+    U32 random                  = pPayload->threadIndex + 1u;
+    const U8 tag                = static_cast<U8>(pPayload->threadIndex + 1u);
+    U64 numCorrupted            = 0;
+
+    g_numReady.fetchAdd(1u);
+    while (g_startFlag.load(MemoryOrder_Acquire) == 0u)
+    {
+        yieldProcessor();
+    }
+
+    for (U32 round = 0; round < kNumRoundsPerThread; ++round)
+    {
+        for (U32 i = 0; i < kBatchSize; ++i)
+        {
+            sizes[i]    = 8u + nextRandom(random) % kMaxRequestSizeBytes;
+            blocks[i]   = pAllocator->allocate(sizes[i], 8u);
+            if (!blocks[i])
+            {
+                pPayload->numFailed += 1;
+                continue;
+            }
+            // Touch both ends, so overlapping blocks from different threads get caught.
+            U8* pBytes              = reinterpret_cast<U8*>(blocks[i]);
+            pBytes[0]               = tag;
+            pBytes[sizes[i] - 1u]   = tag;
+        }
+
+        // Free in reverse, so blocks come back in a different order than they went out.
+        for (U32 i = kBatchSize; i > 0; --i)
+        {
+            const UPtr block = blocks[i - 1u];
+            if (!block)
+            {
+                continue;
+            }
+            const U8* pBytes = reinterpret_cast<const U8*>(block);
+            numCorrupted += ((pBytes[0] != tag) || (pBytes[sizes[i - 1u] - 1u] != tag)) ? 1 : 0;
+            pAllocator->free(block);
+        }
+    }
+
+    g_numCorrupted.fetchAdd(numCorrupted);
+    return RecluseResult_Ok;
+}
+
+
+static Bool runBenchmark(const char* name, Allocator* pAllocator, U32 numThreads)
+{
+    Thread threads[kMaxThreads]             = { };
+    BenchmarkPayload payloads[kMaxThreads]  = { };
+
+    g_startFlag.store(0u);
+    g_numReady.store(0u);
+    g_numCorrupted.store(0ull);
+
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        payloads[i].pAllocator  = pAllocator;
+        payloads[i].threadIndex = i;
+        threads[i].payload      = &payloads[i];
+        createThread(&threads[i], benchmarkThread);
+    }
+
+    while (g_numReady.load() != numThreads)
+    {
+        yieldThread();
+    }
+
+    RealtimeStopWatch start;
+    g_startFlag.store(1u, MemoryOrder_Release);
+    U32 numFailed = 0;
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        joinThread(&threads[i]);
+        numFailed += payloads[i].numFailed;
+    }
+    F32 secs = Test::measure(start);
+
+    // One op is an allocate, plus its free.
+    const U64 numOps = U64(kNumRoundsPerThread) * kBatchSize * numThreads;
+    R_INFO
+        (
+            "PoolAllocatorBenchmark",
+            "%-8s threads=%2d: %8.1f ns/op %10.0f ops/sec",
+            name,
+            numThreads,
+            (secs * 1e9f) / F32(numOps),
+            F32(numOps) / secs
+        );
+
+    if (numFailed || g_numCorrupted.load() || pAllocator->getTotalAllocations() || pAllocator->getUsedSizeBytes())
+    {
+        R_ERROR
+            (
+                "PoolAllocatorBenchmark",
+                "%s failed! failed allocs=%d corrupted=%llu live allocs=%llu live bytes=%llu",
+                name,
+                numFailed,
+                g_numCorrupted.load(),
+                pAllocator->getTotalAllocations(),
+                pAllocator->getUsedSizeBytes()
+            );
+        return false;
+    }
+
+    return true;
+}
+
+
+static Bool testDebugChecks(MemoryPool& pool)
+{
+    PoolAllocator allocator(512u, PoolAllocator::kDefaultSlabSizeBytes, PoolAllocatorFlag_Debug);
+    Bool success = true;
+
+    allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+    // Blocks are aligned to their size, and big enough for the request.
+    const UPtr small    = allocator.allocate(24u, 8u);
+    const UPtr aligned  = allocator.allocate(8u, 128u);
+    if (!small || !aligned || (aligned & 127ull) || (allocator.getUsedSizeBytes() != 32ull + 128ull))
+    {
+        R_ERROR("PoolAllocatorBenchmark", "Pool blocks are the wrong size, or misaligned!");
+        success = false;
+    }
+
+    if (allocator.allocate(1024u, 8u) || (allocator.getLastError() != ResultCode(RecluseResult_InvalidArgs)))
+    {
+        R_ERROR("PoolAllocatorBenchmark", "Requests above the max block size should fail!");
+        success = false;
+    }
+
+    allocator.free(small + 8u);
+    if (allocator.getLastError() != ResultCode(RecluseResult_InvalidArgs))
+    {
+        R_ERROR("PoolAllocatorBenchmark", "Freeing the middle of a block should fail!");
+        success = false;
+    }
+
+    allocator.free(small);
+    allocator.free(small);
+    if (allocator.getLastError() != ResultCode(RecluseResult_CorruptMemory))
+    {
+        R_ERROR("PoolAllocatorBenchmark", "Double free was not caught!");
+        success = false;
+    }
+
+    allocator.free(aligned);
+    if (allocator.getTotalAllocations() || allocator.getUsedSizeBytes())
+    {
+        R_ERROR("PoolAllocatorBenchmark", "Pool still reports live allocations!");
+        success = false;
+    }
+
+    // Freed blocks are poisoned, and handed out again first.
+    if (*reinterpret_cast<const U8*>(small + 8u) != 0xDDu)
+    {
+        R_ERROR("PoolAllocatorBenchmark", "Freed block was not poisoned!");
+        success = false;
+    }
+
+    allocator.cleanUp();
+    return success;
+}
+
+
+static Bool testExhaustion(MemoryPool& pool)
+{
+    // Two slabs, even after aligning the base, so the second size class to ask gets the last one, and the third gets nothing.
+    PoolAllocator allocator(256u, R_KB(4));
+    Bool success = true;
+
+    allocator.initialize(pool.getBaseAddress(), R_KB(8) + 256u);
+
+    const UPtr first    = allocator.allocate(16u, 8u);
+    const UPtr second   = allocator.allocate(32u, 8u);
+    const UPtr third    = allocator.allocate(64u, 8u);
+    if (!first || !second || third || (allocator.getLastError() != ResultCode(RecluseResult_OutOfMemory)) || (allocator.getNumUsedSlabs() != 2u))
+    {
+        R_ERROR("PoolAllocatorBenchmark", "Pool should run out of slabs!");
+        success = false;
+    }
+
+    allocator.free(first);
+    allocator.free(second);
+
+    // Reset hands every slab back.
+    allocator.reset();
+    if (!allocator.allocate(64u, 8u) || (allocator.getNumUsedSlabs() != 1u))
+    {
+        R_ERROR("PoolAllocatorBenchmark", "Pool should have slabs again after reset!");
+        success = false;
+    }
+
+    allocator.cleanUp();
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    const U32 threadCounts[]    = { 1, 2, 4, 8, 16 };
+    Bool success                = true;
+    MemoryPool pool(kPoolSizeBytes);
+
+    success &= testDebugChecks(pool);
+    success &= testExhaustion(pool);
+
+    for (U32 t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)
+    {
+        MallocAllocator mallocAllocator;
+        PoolAllocator poolAllocator(512u);
+        mallocAllocator.initialize(0, 0);
+        poolAllocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+        success &= runBenchmark("Malloc", &mallocAllocator, threadCounts[t]);
+        success &= runBenchmark("Pool", &poolAllocator, threadCounts[t]);
+
+        poolAllocator.cleanUp();
+        mallocAllocator.cleanUp();
+    }
+
+    return Test::finish("PoolAllocatorBenchmark", success);
+}
@@ -0,0 +1,282 @@
+#include <atomic>
+#include <queue>
+#include <vector>
+
+#include "Recluse/Queue.hpp"
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumItems          = 1u << 20u;
+static const U32 kQueueCapacity     = 1024u;
+static const U32 kMaxThreads        = 8u;
+
+static MallocAllocator  g_allocator;
+static std::atomic<U32> g_startFlag;
+static std::atomic<U32> g_numReady;
+static std::atomic<U64> g_numConsumed;
+static std::atomic<U64> g_sum;
+
+
+// The way cross thread handoffs are done currently, a std::queue behind a mutex.
+class MutexQueue
+{
+public:
+    Bool push(U64 value)
+    {
+        ScopedLock _(m_mutex);
+        m_queue.push(value);
+        return true;
+    }
+
+    Bool pop(U64& value)
+    {
+        ScopedLock _(m_mutex);
+        if (m_queue.empty())
+        {
+            return false;
+        }
+        value = m_queue.front();
+        m_queue.pop();
+        return true;
+    }
+
+private:
+    MutexGuard          m_mutex;
+    std::queue<U64>     m_queue;
+};
+
+
+class MPMCQueueAdapter
+{
+public:
+    MPMCQueueAdapter() { m_queue.initialize(&g_allocator, kQueueCapacity); }
+    Bool push(U64 value) { return m_queue.push(value); }
+    Bool pop(U64& value) { return m_queue.pop(value); }
+
+private:
+    MPMCQueue<U64> m_queue;
+};
+
+
+class SPSCQueueAdapter
+{
+public:
+    SPSCQueueAdapter() { m_queue.initialize(&g_allocator, kQueueCapacity); }
+    Bool push(U64 value) { return m_queue.push(value); }
+    Bool pop(U64& value) { return m_queue.pop(value); }
+
+private:
+    SPSCQueue<U64> m_queue;
+};
+
+
+struct ValueNode : public MPSCQueueNode
+{
+    U64 value;
+};
+
+
+// Nodes are allocated up front, the intrusive queue only links them.
+class MPSCQueueAdapter
+{
+public:
+    MPSCQueueAdapter() : m_nodes(kNumItems + 1u) { }
+
+    Bool push(U64 value)
+    {
+        ValueNode* pNode    = &m_nodes[value];
+        pNode->value        = value;
+        m_queue.push(pNode);
+        return true;
+    }
+
+    Bool pop(U64& value)
+    {
+        ValueNode* pNode = m_queue.pop();
+        if (!pNode)
+        {
+            return false;
+        }
+        value = pNode->value;
+        return true;
+    }
+
+private:
+    std::vector<ValueNode>  m_nodes;
+    MPSCQueue<ValueNode>    m_queue;
+};
+
+
+template<typename QueueType>
+struct BenchmarkPayload
+{
+    QueueType*  pQueue;
+    U64         firstValue;
+    U64         numValues;
+};
+
+
+static void waitForStart()
+{
+    g_numReady.fetch_add(1u);
+    while (g_startFlag.load(std::memory_order_acquire) == 0u)
+    {
+        yieldProcessor();
+    }
+}
+
+
+template<typename QueueType>
+static ResultCode producerThread(void* pData)
+{
+    BenchmarkPayload<QueueType>* pPayload = static_cast<BenchmarkPayload<QueueType>*>(pData);
+    waitForStart();
+
+    const U64 lastValue = pPayload->firstValue + pPayload->numValues;
+    for (U64 value = pPayload->firstValue; value < lastValue; ++value)
+    {
+        while (!pPayload->pQueue->push(value))
+        {
+            yieldThread();
+        }
+    }
+    return RecluseResult_Ok;
+}
+
+
+template<typename QueueType>
+static ResultCode consumerThread(void* pData)
+{
+    BenchmarkPayload<QueueType>* pPayload = static_cast<BenchmarkPayload<QueueType>*>(pData);
+    waitForStart();
+
+    U64 sum = 0;
+    U64 value = 0;
+    while (g_numConsumed.load(std::memory_order_relaxed) < kNumItems)
+    {
+        if (pPayload->pQueue->pop(value))
+        {
+            sum += value;
+            g_numConsumed.fetch_add(1ull, std::memory_order_relaxed);
+        }
+        else
+        {
+            yieldThread();
+        }
+    }
+    g_sum.fetch_add(sum);
+    return RecluseResult_Ok;
+}
+
+
+template<typename QueueType>
+static Bool runBenchmark(const char* name, U32 numProducers, U32 numConsumers)
+{
+    QueueType* pQueue                                   = new QueueType();
+    Thread threads[kMaxThreads * 2]                     = { };
+    BenchmarkPayload<QueueType> payloads[kMaxThreads]   = { };
+    BenchmarkPayload<QueueType> consumerPayload         = { pQueue, 0, 0 };
+    const U64 valuesPerProducer                         = kNumItems / numProducers;
+    const U32 numThreads                                = numProducers + numConsumers;
+
+    g_startFlag.store(0u);
+    g_numReady.store(0u);
+    g_numConsumed.store(0ull);
+    g_sum.store(0ull);
+
+    for (U32 i = 0; i < numProducers; ++i)
+    {
+        // Values start at 1, so the sum also catches lost zeroes.
+        payloads[i].pQueue      = pQueue;
+        payloads[i].firstValue  = 1ull + valuesPerProducer * i;
+        payloads[i].numValues   = valuesPerProducer;
+        threads[i].payload      = &payloads[i];
+        createThread(&threads[i], producerThread<QueueType>);
+    }
+
+    for (U32 i = numProducers; i < numThreads; ++i)
+    {
+        threads[i].payload = &consumerPayload;
+        createThread(&threads[i], consumerThread<QueueType>);
+    }
+
+    while (g_numReady.load() != numThreads)
+    {
+        yieldThread();
+    }
+
+    RealtimeStopWatch start;
+    g_startFlag.store(1u, std::memory_order_release);
+    for (U32 i = 0; i < numThreads; ++i)
+    {
+        joinThread(&threads[i]);
+    }
+    F32 secs = Test::measure(start);
+
+    delete pQueue;
+
+    const U64 expectedSum = (U64(kNumItems) * U64(kNumItems + 1u)) / 2ull;
+
+    R_INFO
+        (
+            "QueueBenchmark",
+            "%-12s producers=%d consumers=%d: %8.2f M items/s",
+            name,
+            numProducers,
+            numConsumers,
+            (F32(kNumItems) / secs) / 1e6f
+        );
+
+    if (g_sum.load() != expectedSum)
+    {
+        R_ERROR("QueueBenchmark", "%s sum mismatch! got=%llu expected=%llu", name, g_sum.load(), expectedSum);
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    const U32 threadCounts[]    = { 1, 2, 4 };
+    Bool success                = true;
+
+    success &= runBenchmark<MutexQueue>("Mutex", 1, 1);
+    success &= runBenchmark<SPSCQueueAdapter>("SPSCQueue", 1, 1);
+
+    for (U32 i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); ++i)
+    {
+        success &= runBenchmark<MutexQueue>("Mutex", threadCounts[i], 1);
+        success &= runBenchmark<MPSCQueueAdapter>("MPSCQueue", threadCounts[i], 1);
+    }
+
+    for (U32 i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); ++i)
+    {
+        success &= runBenchmark<MutexQueue>("Mutex", threadCounts[i], threadCounts[i]);
+        success &= runBenchmark<MPMCQueueAdapter>("MPMCQueue", threadCounts[i], threadCounts[i]);
+    }
+
+    // Leftover values should be destroyed on release, and a full queue must refuse pushes.
+    MPMCQueue<std::string> stringQueue;
+    stringQueue.initialize(&g_allocator, 4u);
+    for (U32 i = 0; i < 4u; ++i)
+    {
+        stringQueue.push(std::string(64, 'a' + char(i)));
+    }
+    std::string value;
+    if (stringQueue.push(std::string("full")) || !stringQueue.pop(value) || (value[0] != 'a'))
+    {
+        R_ERROR("QueueBenchmark", "MPMCQueue capacity check failed!");
+        success = false;
+    }
+    stringQueue.release();
+
+    return Test::finish("QueueBenchmark", success);
+}
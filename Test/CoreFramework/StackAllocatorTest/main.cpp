@@ -0,0 +1,170 @@
+#include "Recluse/Memory/StackAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <string.h>
+
+using namespace Recluse;
+
+static const U64 kPoolSizeBytes     = R_MB(64);
+static const U64 kScratchSizeBytes  = R_KB(64);
+static const U32 kTreeDepth         = 4;
+static const U32 kTreeBreadth       = 4;
+static const U32 kNumIterations     = 1000000;
+
+
+// Nested scratch work, like a pass that calls into passes of its own. Each call takes some
+// scratch, and calls kTreeBreadth more below it.
+static void runPass(Allocator* pAllocator, U32 depth, U64& peakBytes, Bool scoped)
+{
+    StackAllocator* pStack = scoped ? static_cast<StackAllocator*>(pAllocator) : nullptr;
+    StackMarker marker = pStack ? pStack->getMarker() : StackMarker();
+
+    void* pScratch = reinterpret_cast<void*>(pAllocator->allocate(kScratchSizeBytes, 16));
+    memset(pScratch, static_cast<int>(depth), kScratchSizeBytes);
+    peakBytes = (pAllocator->getUsedSizeBytes() > peakBytes) ? pAllocator->getUsedSizeBytes() : peakBytes;
+
+    for (U32 i = 0; (depth + 1u < kTreeDepth) && (i < kTreeBreadth); ++i)
+    {
+        runPass(pAllocator, depth + 1u, peakBytes, scoped);
+    }
+
+    if (pStack)
+    {
+        pStack->freeToMarker(marker);
+    }
+}
+
+
+static Bool testMarkers(MemoryPool& pool)
+{
+    Bool success = true;
+    StackAllocator allocator;
+    allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+    const UPtr first = allocator.allocate(100, 8);
+    const StackMarker afterFirst = allocator.getMarker();
+    {
+        ScopedStackMark mark(allocator);
+        allocator.allocate(200, 64);
+        allocator.allocate(300, 16);
+    }
+
+    const StackMarker afterScope = allocator.getMarker();
+    if ((afterScope.top != afterFirst.top) || (allocator.getTotalAllocations() != 1ull))
+    {
+        R_ERROR("StackAllocatorTest", "Scope did not free back to where it started!");
+        success = false;
+    }
+
+    // The most recent allocation can be popped.
+    allocator.free(first);
+    if ((allocator.getLastError() != RecluseResult_Ok) || allocator.getUsedSizeBytes() || allocator.getTotalAllocations())
+    {
+        R_ERROR("StackAllocatorTest", "Popping the last allocation failed! used=%llu", allocator.getUsedSizeBytes());
+        success = false;
+    }
+
+    // Freeing the outer marker first leaves the inner one dangling past the top.
+    const StackMarker outer = allocator.getMarker();
+    allocator.allocate(64, 16);
+    const StackMarker inner = allocator.getMarker();
+    allocator.allocate(64, 16);
+    allocator.freeToMarker(outer);
+    if (allocator.freeToMarker(inner) != ResultCode(RecluseResult_CorruptMemory))
+    {
+        R_ERROR("StackAllocatorTest", "Out of order markers were not caught!");
+        success = false;
+    }
+
+    // Only the most recent allocation can be freed, in every build.
+    const UPtr older = allocator.allocate(16, 16);
+    const UPtr newer = allocator.allocate(16, 16);
+    const U64 numAllocations = allocator.getTotalAllocations();
+    allocator.free(older);
+    if ((allocator.getLastError() != ResultCode(RecluseResult_CorruptMemory)) || (allocator.getTotalAllocations() != numAllocations))
+    {
+        R_ERROR("StackAllocatorTest", "Out of order free was not caught!");
+        success = false;
+    }
+
+#if defined(RECLUSE_DEBUG)
+    // Run off the end of the older allocation, into the sentinel of the newer one.
+    memset(reinterpret_cast<void*>(older), 0, static_cast<size_t>(newer - older));
+    allocator.free(newer);
+    if (allocator.getLastError() != ResultCode(RecluseResult_CorruptMemory))
+    {
+        R_ERROR("StackAllocatorTest", "Overwritten sentinel was not caught!");
+        success = false;
+    }
+#endif
+
+    allocator.cleanUp();
+    return success;
+}
+
+
+// Scoped scratch should peak at one path down the tree, not at every pass in it.
+static Bool testPeakUsage(MemoryPool& pool)
+{
+    U64 linearPeakBytes = 0;
+    U64 stackPeakBytes  = 0;
+
+    {
+        LinearAllocator allocator;
+        allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+        runPass(&allocator, 0u, linearPeakBytes, false);
+        allocator.cleanUp();
+    }
+
+    {
+        StackAllocator allocator;
+        allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+        runPass(&allocator, 0u, stackPeakBytes, true);
+        if (allocator.getUsedSizeBytes() || allocator.getTotalAllocations())
+        {
+            R_ERROR("StackAllocatorTest", "Passes leaked scratch! used=%llu", allocator.getUsedSizeBytes());
+            return false;
+        }
+        allocator.cleanUp();
+    }
+
+    R_INFO("StackAllocatorTest", "Peak scratch: linear=%llu KB, stack=%llu KB", linearPeakBytes / R_1KB, stackPeakBytes / R_1KB);
+    return stackPeakBytes < (kScratchSizeBytes + R_KB(1)) * kTreeDepth;
+}
+
+
+static void benchmark(MemoryPool& pool)
+{
+    StackAllocator allocator;
+    allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+    RealtimeStopWatch start;
+    for (U32 i = 0; i < kNumIterations; ++i)
+    {
+        ScopedStackMark mark(allocator);
+        *reinterpret_cast<U32*>(allocator.allocate(64, 16))     = i;
+        *reinterpret_cast<U32*>(allocator.allocate(256, 16))    = i;
+    }
+    F32 secs = Test::measure(start);
+    allocator.cleanUp();
+
+    R_INFO("StackAllocatorTest", "Scope with 2 allocations: %.1f ns", (secs * 1e9f) / F32(kNumIterations));
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+    MemoryPool pool(kPoolSizeBytes);
+
+    success &= testMarkers(pool);
+    success &= testPeakUsage(pool);
+    benchmark(pool);
+
+    return Test::finish("StackAllocatorTest", success);
+}
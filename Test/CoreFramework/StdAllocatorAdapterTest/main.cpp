@@ -0,0 +1,235 @@
+#include "Recluse/Memory/StdAllocatorAdapter.hpp"
+#include "Recluse/Memory/LinearAllocator.hpp"
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <stdlib.h>
+#include <new>
+
+using namespace Recluse;
+
+static const U32 kNumFrames         = 200;
+static const U32 kNumObjects        = 4000;
+static const U32 kNumPasses         = 6;
+static const U64 kArenaSizeBytes    = R_MB(16);
+
+// Global heap calls, counted through the replaced operator new below.
+static U64 g_numHeapAllocations     = 0;
+
+
+void* operator new(std::size_t sizeBytes)
+{
+    g_numHeapAllocations += 1;
+    void* ptr = malloc(sizeBytes ? sizeBytes : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    free(ptr);
+}
+
+
+static U32 nextRandom(U32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8u;
+}
+
+
+// What a frame of the renderer does: sort objects into the passes they are drawn in, keep a
+// list of what's visible, and name a few things for debug markers. Returns a checksum.
+template<typename Map, typename List, typename Str>
+static U64 buildFrame(Map& passKeys, List& visible, Str& marker, U32 frame)
+{
+    U32 random = frame + 1u;
+    for (U32 i = 0; i < kNumObjects; ++i)
+    {
+        const U32 value = nextRandom(random);
+        if (value & 1u)
+        {
+            visible.push_back(i);
+        }
+        passKeys.find(value % kNumPasses)->second.push_back((static_cast<U64>(value) << 32ull) | i);
+    }
+
+    for (U32 i = 0; i < kNumPasses; ++i)
+    {
+        marker.append("Pass ");
+        marker.push_back(static_cast<char>('0' + i));
+        marker.append(" of the frame, drawn after the ones before it. ");
+    }
+
+    U64 checksum = visible.size() + marker.size();
+    for (auto& pass : passKeys)
+    {
+        U64 passChecksum = pass.first * pass.second.size();
+        for (U64 key : pass.second)
+        {
+            passChecksum ^= key;
+        }
+        checksum += passChecksum;
+    }
+    return checksum;
+}
+
+
+static U64 heapFrame(U32 frame)
+{
+    std::unordered_map<U32, std::vector<U64>> passKeys;
+    for (U32 i = 0; i < kNumPasses; ++i)
+    {
+        passKeys[i];
+    }
+    std::vector<U32> visible;
+    std::string marker;
+    return buildFrame(passKeys, visible, marker, frame);
+}
+
+
+static U64 arenaFrame(LinearAllocator& allocator, U32 frame)
+{
+    allocator.reset();
+
+    Arena::Vector<U64>::allocator_type adapter(&allocator);
+    Arena::HashMap<U32, Arena::Vector<U64>> passKeys(adapter);
+    for (U32 i = 0; i < kNumPasses; ++i)
+    {
+        passKeys.emplace(i, Arena::Vector<U64>(adapter));
+    }
+    Arena::Vector<U32> visible(adapter);
+    Arena::String marker(adapter);
+    return buildFrame(passKeys, visible, marker, frame);
+}
+
+
+// Same frames on the heap and in an arena. They must agree, and the arena must not touch the heap.
+static Bool testFrames(LinearAllocator& allocator)
+{
+    Bool success = true;
+    U64 heapChecksum    = 0;
+    U64 arenaChecksum   = 0;
+
+    U64 numHeapAllocations = g_numHeapAllocations;
+    RealtimeStopWatch heapStart;
+    for (U32 i = 0; i < kNumFrames; ++i)
+    {
+        heapChecksum += heapFrame(i);
+    }
+    const F32 heapSecs          = Test::measure(heapStart);
+    const U64 heapCallsPerFrame = (g_numHeapAllocations - numHeapAllocations) / kNumFrames;
+
+    numHeapAllocations = g_numHeapAllocations;
+    RealtimeStopWatch arenaStart;
+    for (U32 i = 0; i < kNumFrames; ++i)
+    {
+        arenaChecksum += arenaFrame(allocator, i);
+    }
+    const F32 arenaSecs             = Test::measure(arenaStart);
+    const U64 arenaCallsPerFrame    = (g_numHeapAllocations - numHeapAllocations) / kNumFrames;
+
+    R_INFO("StdAllocatorAdapterTest", "Heap:  %4llu heap calls/frame, %.3f ms/frame", heapCallsPerFrame, (heapSecs * 1000.0f) / F32(kNumFrames));
+    R_INFO("StdAllocatorAdapterTest", "Arena: %4llu heap calls/frame, %.3f ms/frame, %llu KB of arena", arenaCallsPerFrame, (arenaSecs * 1000.0f) / F32(kNumFrames), allocator.getUsedSizeBytes() / R_1KB);
+
+    if (heapChecksum != arenaChecksum)
+    {
+        R_ERROR("StdAllocatorAdapterTest", "Arena containers do not match the heap ones!");
+        success = false;
+    }
+
+    if (arenaCallsPerFrame != 0ull)
+    {
+        R_ERROR("StdAllocatorAdapterTest", "Arena containers went to the global heap!");
+        success = false;
+    }
+
+    return success;
+}
+
+
+static Bool testAdapters(MemoryPool& pool)
+{
+    Bool success = true;
+    LinearAllocator allocator;
+    allocator.initialize(pool.getBaseAddress(), R_KB(4));
+
+    // The typed adapter, straight over a LinearAllocator.
+    {
+        StdAllocatorAdapter<U64, LinearAllocator> adapter(&allocator);
+        std::vector<U64, StdAllocatorAdapter<U64, LinearAllocator>> values(adapter);
+        values.push_back(0x1234ull);
+        const UPtr address = reinterpret_cast<UPtr>(values.data());
+        if ((address < pool.getBaseAddress()) || (address >= pool.getBaseAddress() + R_KB(4)) || (address % alignof(U64)))
+        {
+            R_ERROR("StdAllocatorAdapterTest", "Typed adapter did not allocate from the arena!");
+            success = false;
+        }
+    }
+
+    // Running out of arena throws, like running out of heap would.
+    Bool threw = false;
+    try
+    {
+        Arena::Vector<U8> bytes(&allocator);
+        bytes.resize(R_KB(8));
+    }
+    catch (const std::bad_alloc&)
+    {
+        threw = true;
+    }
+
+    if (!threw)
+    {
+        R_ERROR("StdAllocatorAdapterTest", "Running out of arena did not throw!");
+        success = false;
+    }
+
+    // Copies go to the heap, so they can outlive the arena.
+    allocator.reset();
+    Arena::String name(&allocator);
+    name.assign("A name long enough to not fit in the small string buffer.");
+    Arena::String copy(name);
+    if ((copy != name) || (copy.get_allocator().getAllocator() != nullptr))
+    {
+        R_ERROR("StdAllocatorAdapterTest", "Copy of an arena string is still in the arena!");
+        success = false;
+    }
+
+    allocator.cleanUp();
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+    MemoryPool pool;
+    pool.reserve(kArenaSizeBytes, R_KB(64));
+
+    {
+        LinearAllocator allocator;
+        allocator.setBackingPool(&pool);
+        allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+        success &= testFrames(allocator);
+        allocator.cleanUp();
+    }
+
+    success &= testAdapters(pool);
+
+    return Test::finish("StdAllocatorAdapterTest", success);
+}
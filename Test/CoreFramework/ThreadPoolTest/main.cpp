@@ -0,0 +1,129 @@
+#include <atomic>
+
+#include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumJobs           = 200000;
+static const U32 kNumSpawnerJobs    = 64;
+static const U32 kWorkPerJob        = 256;
+
+static std::atomic<U64> g_sum;
+static ThreadPool*      g_pPool = nullptr;
+
+// Small amount of work, so we mostly measure the overhead of the pool.
+U32 smallJob(void* pData)
+{
+    U64 value = reinterpret_cast<U64>(pData);
+    U64 hash  = value;
+    for (U32 i = 0; i < kWorkPerJob; ++i)
+    {
+        hash = hash * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    volatile U64 sink = hash;
+    (void)sink;
+    g_sum.fetch_add(value, std::memory_order_relaxed);
+    return 0;
+}
+
+
+// Submits jobs from within the pool, which go into the worker's own deque, so other
+// workers need to steal them.
+U32 spawnerJob(void* pData)
+{
+    U64 first = reinterpret_cast<U64>(pData);
+    for (U64 i = 0; i < (kNumJobs / kNumSpawnerJobs); ++i)
+    {
+        g_pPool->submitJob(smallJob, reinterpret_cast<void*>(first + i));
+    }
+    return 0;
+}
+
+
+U32 nestedWaitJob(void* pData)
+{
+    // Waiting inside of a job should help execute, instead of dead locking.
+    JobHandle handle = g_pPool->submitJob(smallJob, pData);
+    g_pPool->wait(handle);
+    return 0;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    const U64 expectedSum   = (U64(kNumJobs) * U64(kNumJobs + 1)) / 2ull;
+    const U32 workerCounts[] = { 0, 1, 2, 4, 8, 16, 32 };
+    Bool success            = true;
+
+    for (U32 w = 0; w < sizeof(workerCounts) / sizeof(workerCounts[0]); ++w)
+    {
+        const U32 numWorkers = workerCounts[w];
+        ThreadPool pool(numWorkers);
+        g_pPool = &pool;
+
+        // Submitting from the main thread.
+        g_sum.store(0ull);
+        RealtimeStopWatch start;
+        for (U64 i = 1; i <= kNumJobs; ++i)
+        {
+            pool.submitJob(smallJob, reinterpret_cast<void*>(i));
+        }
+        pool.waitFinished();
+        F32 externalSecs = Test::measure(start);
+
+        if (g_sum.load() != expectedSum)
+        {
+            R_ERROR("ThreadPoolTest", "External submit sum mismatch! workers=%d got=%llu expected=%llu", numWorkers, g_sum.load(), expectedSum);
+            success = false;
+        }
+
+        // Submitting from within the pool, which requires stealing to scale.
+        g_sum.store(0ull);
+        start = RealtimeStopWatch();
+        for (U64 i = 0; i < kNumSpawnerJobs; ++i)
+        {
+            pool.submitJob(spawnerJob, reinterpret_cast<void*>(1ull + i * (kNumJobs / kNumSpawnerJobs)));
+        }
+        pool.waitFinished();
+        F32 stealSecs = Test::measure(start);
+
+        if (g_sum.load() != expectedSum)
+        {
+            R_ERROR("ThreadPoolTest", "Stealing sum mismatch! workers=%d got=%llu expected=%llu", numWorkers, g_sum.load(), expectedSum);
+            success = false;
+        }
+
+        // Handles.
+        g_sum.store(0ull);
+        JobHandle handle = pool.submitJob(nestedWaitJob, reinterpret_cast<void*>(7ull));
+        if ((pool.wait(handle) != RecluseResult_Ok) || !pool.isDone(handle))
+        {
+            R_ERROR("ThreadPoolTest", "Waiting on job handle failed! workers=%d", numWorkers);
+            success = false;
+        }
+        pool.waitFinished();
+        if (g_sum.load() != 7ull)
+        {
+            R_ERROR("ThreadPoolTest", "Nested wait job did not run! workers=%d", numWorkers);
+            success = false;
+        }
+
+        R_INFO
+            (
+                "ThreadPoolTest", 
+                "workers=%2d  external: %10.0f tasks/sec  stealing: %10.0f tasks/sec", 
+                numWorkers, 
+                F32(kNumJobs) / externalSecs, 
+                F32(kNumJobs) / stealSecs
+            );
+    }
+
+    g_pPool = nullptr;
+
+    return Test::finish("ThreadPoolTest", success);
+}
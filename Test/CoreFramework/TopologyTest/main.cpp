@@ -0,0 +1,251 @@
+#include "Recluse/System/Architecture.hpp"
+#include "Recluse/Threading/Atomic.hpp"
+#include "Recluse/Threading/Threading.hpp"
+#include "Recluse/Messaging.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumPinSamples = 10000;
+
+static Atomic<U32> g_startFlag;
+
+
+static U32 countBits(U64 mask)
+{
+    U32 count = 0;
+    for (; mask; mask &= (mask - 1ull))
+    {
+        ++count;
+    }
+    return count;
+}
+
+
+struct PinPayload
+{
+    U64     affinityMask;
+    U32     numMisses;
+    // Pin from inside the thread, instead of having the main thread do it.
+    Bool    pinSelf;
+};
+
+
+static ResultCode pinnedThread(void* pData)
+{
+    PinPayload* pPayload = static_cast<PinPayload*>(pData);
+
+    if (pPayload->pinSelf && (setCurrentThreadAffinity(pPayload->affinityMask) != RecluseResult_Ok))
+    {
+        pPayload->numMisses += 1;
+    }
+
+    // Wait until the main thread has pinned us.
+    while (g_startFlag.load(MemoryOrder_Acquire) == 0u)
+    {
+        yieldThread();
+    }
+
+    for (U32 i = 0; i < kNumPinSamples; ++i)
+    {
+        const U32 processor = getCurrentProcessorNumber();
+        if ((processor >= 64u) || !(pPayload->affinityMask & (1ull << processor)))
+        {
+            pPayload->numMisses += 1;
+        }
+
+        if ((i % 256u) == 0u)
+        {
+            yieldThread();
+        }
+    }
+    return RecluseResult_Ok;
+}
+
+
+static void printTopology(const Process::CpuTopology& topology)
+{
+    R_INFO
+        (
+            "TopologyTest",
+            "packages=%d numa nodes=%d physical cores=%d logical processors=%d",
+            topology.numPackages,
+            topology.numNumaNodes,
+            static_cast<U32>(topology.cores.size()),
+            topology.numLogicalProcessors
+        );
+
+    for (U32 i = 0; i < topology.cores.size(); ++i)
+    {
+        const Process::CpuCoreInfo& core = topology.cores[i];
+        R_INFO
+            (
+                "TopologyTest",
+                "core %2d: package=%d numa=%d processors=0x%016llx smt=%d l2=%d l3=%d",
+                i,
+                core.packageId,
+                core.numaNode,
+                core.processorMask,
+                countBits(core.processorMask),
+                (core.l2CacheIndex == Process::kInvalidCacheIndex) ? -1 : I32(core.l2CacheIndex),
+                (core.l3CacheIndex == Process::kInvalidCacheIndex) ? -1 : I32(core.l3CacheIndex)
+            );
+    }
+
+    for (U32 i = 0; i < topology.caches.size(); ++i)
+    {
+        const Process::CpuCacheInfo& cache = topology.caches[i];
+        R_INFO
+            (
+                "TopologyTest",
+                "cache %2d: L%d size=%llu KB line=%d bytes shared by=0x%016llx",
+                i,
+                cache.level,
+                cache.sizeBytes / 1024ull,
+                cache.lineSizeBytes,
+                cache.processorMask
+            );
+    }
+}
+
+
+static Bool validateTopology(const Process::CpuTopology& topology)
+{
+    Bool success        = true;
+    U64 seenMask        = 0ull;
+    U32 numProcessors   = 0;
+
+    for (U32 i = 0; i < topology.cores.size(); ++i)
+    {
+        const Process::CpuCoreInfo& core = topology.cores[i];
+
+        // Every logical processor belongs to exactly one core.
+        if (!core.processorMask || (seenMask & core.processorMask))
+        {
+            R_ERROR("TopologyTest", "Core %d has an empty, or overlapping, processor mask!", i);
+            success = false;
+        }
+        seenMask        |= core.processorMask;
+        numProcessors   += countBits(core.processorMask);
+
+        const U32 cacheIndices[] = { core.l2CacheIndex, core.l3CacheIndex };
+        for (U32 c = 0; c < 2; ++c)
+        {
+            if (cacheIndices[c] == Process::kInvalidCacheIndex)
+            {
+                continue;
+            }
+
+            if ((cacheIndices[c] >= topology.caches.size()) || !(topology.caches[cacheIndices[c]].processorMask & core.processorMask))
+            {
+                R_ERROR("TopologyTest", "Core %d points to a cache it does not share!", i);
+                success = false;
+            }
+        }
+    }
+
+    if (numProcessors != topology.numLogicalProcessors)
+    {
+        R_ERROR("TopologyTest", "Cores hold %d processors, expected %d!", numProcessors, topology.numLogicalProcessors);
+        success = false;
+    }
+
+    if (countBits(topology.getPrimaryProcessorMask()) != topology.cores.size())
+    {
+        R_ERROR("TopologyTest", "Primary processor mask should have one processor per core!");
+        success = false;
+    }
+
+    return success;
+}
+
+
+static Bool testPinning(const Process::CpuTopology& topology)
+{
+    Bool success = true;
+
+    // Pin one thread to the first logical processor of each core, then make sure it never
+    // shows up anywhere else.
+    for (U32 i = 0; i < topology.cores.size(); ++i)
+    {
+        const U64 coreMask      = topology.cores[i].processorMask;
+        // Every other thread pins itself, the way the main thread does.
+        const Bool pinSelf      = (i % 2u) == 1u;
+        PinPayload payload      = { coreMask & (~coreMask + 1ull), 0u, pinSelf };
+        Thread thread           = { };
+        thread.payload          = &payload;
+
+        g_startFlag.store(0u);
+        if (createThread(&thread, pinnedThread) != RecluseResult_Ok)
+        {
+            R_ERROR("TopologyTest", "Failed to create thread for core %d!", i);
+            success = false;
+            continue;
+        }
+
+        const ResultCode affinityResult = pinSelf ? RecluseResult_Ok : setThreadAffinity(&thread, payload.affinityMask);
+        g_startFlag.store(1u, MemoryOrder_Release);
+        joinThread(&thread);
+
+        if ((affinityResult != RecluseResult_Ok) || (payload.numMisses > 0))
+        {
+            R_ERROR("TopologyTest", "Thread pinned to 0x%llx ran elsewhere %d times!", payload.affinityMask, payload.numMisses);
+            success = false;
+        }
+    }
+
+    R_INFO("TopologyTest", "Pinned a thread to each of %d cores.", static_cast<U32>(topology.cores.size()));
+    return success;
+}
+
+
+static Bool testPriority()
+{
+    PinPayload payload      = { ~0ull, 0u, false };
+    Thread thread           = { };
+    thread.payload          = &payload;
+    Bool success            = true;
+
+    g_startFlag.store(0u);
+    createThread(&thread, pinnedThread);
+
+    // Lowering priority never needs privileges. Raising it might, so failures are only logged.
+    if ((setThreadPriority(&thread, ThreadPriority_Low) != RecluseResult_Ok) || (setThreadPriority(&thread, ThreadPriority_Normal) != RecluseResult_Ok))
+    {
+        R_ERROR("TopologyTest", "Failed to lower the thread priority!");
+        success = false;
+    }
+
+    if (setThreadPriority(&thread, ThreadPriority_High) != RecluseResult_Ok)
+    {
+        R_WARN("TopologyTest", "Raising the thread priority is not allowed for this process.");
+    }
+
+    g_startFlag.store(1u, MemoryOrder_Release);
+    joinThread(&thread);
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+    Process::CpuTopology topology;
+
+    if (Process::queryCpuTopology(topology) != RecluseResult_Ok)
+    {
+        R_ERROR("TopologyTest", "Failed to query the cpu topology!");
+        success = false;
+    }
+    else
+    {
+        printTopology(topology);
+        success &= validateTopology(topology);
+        success &= testPinning(topology);
+        success &= testPriority();
+    }
+
+    return Test::finish("TopologyTest", success);
+}
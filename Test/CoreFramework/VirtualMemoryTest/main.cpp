@@ -0,0 +1,155 @@
+#include "Recluse/Memory/MemoryPool.hpp"
+#include "Recluse/Memory/LinearAllocator.hpp"
+#include "Recluse/Memory/VirtualMemory.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <string.h>
+
+using namespace Recluse;
+
+static const U64 kReserveSizeBytes  = R_GB(4);
+static const U64 kArenaSizeBytes    = R_MB(512);
+static const U64 kChunkSizeBytes    = R_KB(64);
+
+
+// A linear arena over a reserved pool. Checks the arena grows in place, only commits what it
+// touches, and gives it all back on clear.
+static Bool testGrowth()
+{
+    Bool success = true;
+    MemoryPool pool;
+    if (pool.reserve(kReserveSizeBytes, R_KB(64)) != RecluseResult_Ok)
+    {
+        R_ERROR("VirtualMemoryTest", "Failed to reserve %llu MB!", kReserveSizeBytes / R_1MB);
+        return false;
+    }
+
+    const U64 initialCommitBytes = pool.getCommittedSizeBytes();
+    if (!pool.isReserved() || (pool.getTotalSizeBytes() != kReserveSizeBytes) || (initialCommitBytes < R_KB(64)) || (initialCommitBytes >= R_MB(1)))
+    {
+        R_ERROR("VirtualMemoryTest", "Reserved pool has the wrong sizes! committed=%llu", initialCommitBytes);
+        success = false;
+    }
+
+    LinearAllocator allocator;
+    allocator.setBackingPool(&pool);
+    allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+    // Allocations must stay contiguous, nothing is ever moved to make room.
+    UPtr expected = pool.getBaseAddress();
+    for (U64 i = 0; i < (R_MB(64) / kChunkSizeBytes); ++i)
+    {
+        const UPtr address = allocator.allocate(kChunkSizeBytes, 16);
+        if (address != expected)
+        {
+            R_ERROR("VirtualMemoryTest", "Arena moved, or failed to grow! at chunk %llu", i);
+            success = false;
+            break;
+        }
+        memset(reinterpret_cast<void*>(address), 0xAB, kChunkSizeBytes);
+        expected += kChunkSizeBytes;
+    }
+
+    const U64 grownCommitBytes = pool.getCommittedSizeBytes();
+    if ((grownCommitBytes < R_MB(64)) || (grownCommitBytes > R_MB(128)))
+    {
+        R_ERROR("VirtualMemoryTest", "Arena committed %llu MB for 64 MB of allocations!", grownCommitBytes / R_1MB);
+        success = false;
+    }
+
+    // Clearing shrinks back down, and the allocator picks up right where it started.
+    pool.clear();
+    allocator.reset();
+    const U8* pFirst = reinterpret_cast<const U8*>(allocator.allocate(R_MB(8), 16));
+    if ((pool.getCommittedSizeBytes() > R_MB(16)) || !pFirst || (pFirst[0] != 0) || (pFirst[R_MB(8) - 1] != 0))
+    {
+        R_ERROR("VirtualMemoryTest", "Clear did not decommit! committed=%llu MB", pool.getCommittedSizeBytes() / R_1MB);
+        success = false;
+    }
+
+    if (pool.commit(kReserveSizeBytes + 1ull) != ResultCode(RecluseResult_OutOfMemory))
+    {
+        R_ERROR("VirtualMemoryTest", "Committing past the reserved size should fail!");
+        success = false;
+    }
+
+    allocator.cleanUp();
+    pool.release();
+    if (pool.isAllocated() || pool.getCommittedSizeBytes())
+    {
+        R_ERROR("VirtualMemoryTest", "Released pool still reports memory!");
+        success = false;
+    }
+
+    return success;
+}
+
+
+// Fills an arena and sweeps it a few times, the way a big frame arena gets used. Large pages
+// mean far fewer TLB misses on the sweeps.
+static Bool runArena(const char* name, MemoryPoolFlags flags)
+{
+    MemoryPool pool;
+    if (pool.reserve(kReserveSizeBytes, 0ull, flags) != RecluseResult_Ok)
+    {
+        return false;
+    }
+
+    LinearAllocator allocator;
+    allocator.setBackingPool(&pool);
+    allocator.initialize(pool.getBaseAddress(), pool.getTotalSizeBytes());
+
+    RealtimeStopWatch fillStart;
+    for (U64 i = 0; i < (kArenaSizeBytes / kChunkSizeBytes); ++i)
+    {
+        memset(reinterpret_cast<void*>(allocator.allocate(kChunkSizeBytes, 16)), static_cast<int>(i), kChunkSizeBytes);
+    }
+    F32 fillSecs = Test::measure(fillStart);
+
+    // Stride by a page, so every access lands on a new page.
+    U64 sum = 0;
+    RealtimeStopWatch sweepStart;
+    for (U32 sweep = 0; sweep < 8u; ++sweep)
+    {
+        for (U64 offset = 0; offset < kArenaSizeBytes; offset += 4096ull + 64ull * sweep)
+        {
+            sum += *reinterpret_cast<const U8*>(pool.getBaseAddress() + offset);
+        }
+    }
+    F32 sweepSecs = Test::measure(sweepStart);
+
+    R_INFO
+        (
+            "VirtualMemoryTest",
+            "%-12s page=%8llu KB fill=%7.2f ms sweep=%7.2f ms committed=%llu MB (%llu)",
+            name,
+            pool.getPageSzBytes() / R_1KB,
+            fillSecs * 1000.f,
+            sweepSecs * 1000.f,
+            pool.getCommittedSizeBytes() / R_1MB,
+            sum
+        );
+
+    allocator.cleanUp();
+    pool.release();
+    return true;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = true;
+
+    success &= testGrowth();
+    success &= runArena("Pages", MemoryPoolFlag_None);
+    if (VirtualMemory::getLargePageSizeBytes())
+    {
+        success &= runArena("Large pages", MemoryPoolFlag_LargePages);
+    }
+
+    return Test::finish("VirtualMemoryTest", success);
+}
@@ -0,0 +1,293 @@
+#include "Recluse/Game/Component.hpp"
+#include "Recluse/Game/Archetype.hpp"
+#include "Recluse/Game/Components/Transform.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+using namespace Recluse;
+
+static const U32 kNumEntities   = 100000;
+static const U32 kNumFrames     = 20;
+
+
+class MoverComponent : public ECS::Component
+{
+public:
+    R_COMPONENT_DECLARE(MoverComponent);
+    Math::Float3 direction;
+};
+
+
+class TagComponent : public ECS::Component
+{
+public:
+    R_COMPONENT_DECLARE(TagComponent);
+    U32 value = 0;
+};
+
+
+// Map based registry, the same way TransformRegistry stores its components.
+template<typename TypeComponent>
+class MapRegistry : public ECS::ComponentRegistry<TypeComponent>
+{
+public:
+    ResultCode onAllocateComponent(const RGUID& owner) override
+    {
+        if (m_table.find(owner) != m_table.end())
+        {
+            return RecluseResult_AlreadyExists;
+        }
+        m_table[owner].setOwner(owner);
+        return RecluseResult_Ok;
+    }
+
+    ResultCode onFreeComponent(const RGUID& owner) override
+    {
+        return m_table.erase(owner) ? RecluseResult_Ok : RecluseResult_NotFound;
+    }
+
+    std::vector<TypeComponent*> getAllComponents() override
+    {
+        std::vector<TypeComponent*> components;
+        for (auto& it : m_table)
+        {
+            components.push_back(&it.second);
+        }
+        return components;
+    }
+
+    TypeComponent* getComponent(const RGUID& owner) override
+    {
+        auto it = m_table.find(owner);
+        return (it != m_table.end()) ? &it->second : nullptr;
+    }
+
+    ResultCode onCleanUp() override
+    {
+        m_table.clear();
+        return RecluseResult_Ok;
+    }
+
+private:
+    std::map<RGUID, TypeComponent, RGUID::Less> m_table;
+};
+
+
+static RGUID makeEntity(U32 i)
+{
+    // Spread out like real guids, so map order is not creation order.
+    return RGUID(U64(i) * 0x9E3779B97F4A7C15ull, U64(i));
+}
+
+
+static void populate(ECS::Registry& registry)
+{
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        const RGUID entity = makeEntity(i);
+        registry.makeComponent<Transform>(entity, true);
+        registry.makeComponent<MoverComponent>(entity, true);
+        registry.getComponent<MoverComponent>(entity)->direction = Math::Float3(1.0f, 0.0f, F32(i & 7));
+        // Every other entity gets a third component, so the archetype path has two archetypes to walk.
+        if (i & 1)
+        {
+            registry.makeComponent<TagComponent>(entity, true);
+        }
+    }
+}
+
+
+// What systems do today, components of one type, with a lookup per entity for the sibling.
+static F32 iterateRegistry(ECS::Registry& registry, F32& checksum)
+{
+    RealtimeStopWatch start;
+    for (U32 frame = 0; frame < kNumFrames; ++frame)
+    {
+        std::vector<MoverComponent*> movers = registry.getComponentRegistry<MoverComponent>()->getAllComponents();
+        for (MoverComponent* mover : movers)
+        {
+            Transform* transform = registry.getComponent<Transform>(mover->getOwner());
+            transform->position = transform->position + mover->direction * 0.016f;
+        }
+    }
+    const F32 secs = Test::measure(start);
+
+    for (Transform* transform : registry.getComponentRegistry<Transform>()->getAllComponents())
+    {
+        checksum += transform->position.x + transform->position.z;
+    }
+    return secs;
+}
+
+
+static F32 iterateStorage(ECS::Registry& registry, F32& checksum)
+{
+    RealtimeStopWatch start;
+    for (U32 frame = 0; frame < kNumFrames; ++frame)
+    {
+        registry.getStorage().forEach<Transform, MoverComponent>([] (const RGUID&, Transform& transform, MoverComponent& mover) -> void
+            {
+                transform.position = transform.position + mover.direction * 0.016f;
+            });
+    }
+    const F32 secs = Test::measure(start);
+
+    registry.getStorage().forEach<Transform>([&checksum] (const RGUID&, Transform& transform) -> void
+        {
+            checksum += transform.position.x + transform.position.z;
+        });
+    return secs;
+}
+
+
+// Adds and removes move entities between archetypes, and swap back keeps the others findable.
+static Bool testStructuralChanges()
+{
+    Bool success = true;
+    ECS::ArchetypeStorage storage;
+    for (U32 i = 0; i < 1000; ++i)
+    {
+        storage.addComponent<MoverComponent>(makeEntity(i))->direction = Math::Float3(F32(i), 0.0f, 0.0f);
+        storage.addComponent<TagComponent>(makeEntity(i))->value = i;
+    }
+
+    // Remove the tag from every third entity, and destroy every seventh.
+    for (U32 i = 0; i < 1000; ++i)
+    {
+        if ((i % 3) == 0)
+        {
+            storage.removeComponent<TagComponent>(makeEntity(i));
+        }
+        if ((i % 7) == 0)
+        {
+            storage.destroyEntity(makeEntity(i));
+        }
+    }
+
+    U32 numTagged = 0;
+    for (U32 i = 0; i < 1000; ++i)
+    {
+        MoverComponent* mover   = storage.getComponent<MoverComponent>(makeEntity(i));
+        TagComponent* tag       = storage.getComponent<TagComponent>(makeEntity(i));
+        const Bool destroyed    = (i % 7) == 0;
+        const Bool tagged       = !destroyed && ((i % 3) != 0);
+        if ((destroyed == (mover != nullptr)) || (tagged != (tag != nullptr)) || (mover && (mover->direction.x != F32(i))) || (tag && (tag->value != i)))
+        {
+            R_ERROR("ArchetypeStorageTest", "Entity %d lost its components!", i);
+            success = false;
+            break;
+        }
+        numTagged += tagged ? 1 : 0;
+    }
+
+    U32 numVisited = 0;
+    storage.forEach<MoverComponent, TagComponent>([&numVisited] (const RGUID&, MoverComponent&, TagComponent&) -> void { numVisited++; });
+    if (numVisited != numTagged)
+    {
+        R_ERROR("ArchetypeStorageTest", "forEach visited %d entities, expected %d!", numVisited, numTagged);
+        success = false;
+    }
+
+    // Entities that lose their last component are dropped, not left behind in the empty archetype.
+    for (U32 i = 0; i < 1000; ++i)
+    {
+        storage.removeComponent<TagComponent>(makeEntity(i));
+        storage.removeComponent<MoverComponent>(makeEntity(i));
+    }
+
+    U32 numStored = 0;
+    for (const ECS::Archetype* pArchetype : storage.getArchetypes())
+    {
+        numStored += pArchetype->getNumEntities();
+    }
+
+    if (storage.getNumEntities() != 0 || numStored != 0 || storage.hasEntity(makeEntity(1)))
+    {
+        R_ERROR("ArchetypeStorageTest", "%d entities with no components are still stored!", storage.getNumEntities());
+        success = false;
+    }
+    return success;
+}
+
+
+// Same, through a registry, the way entities free their components.
+static Bool testRegistryFree()
+{
+    Bool success = true;
+    ECS::Registry registry;
+    registry.addArchetypeRegistry<MoverComponent>();
+    registry.addArchetypeRegistry<TagComponent>();
+    for (U32 i = 0; i < 1000; ++i)
+    {
+        registry.makeComponent<MoverComponent>(makeEntity(i));
+        registry.makeComponent<TagComponent>(makeEntity(i));
+        registry.removeComponent<MoverComponent>(makeEntity(i));
+        registry.removeComponent<TagComponent>(makeEntity(i));
+    }
+
+    if (registry.getStorage().getNumEntities() != 0)
+    {
+        R_ERROR("ArchetypeStorageTest", "Registry kept %d entities with no components!", registry.getStorage().getNumEntities());
+        success = false;
+    }
+    registry.cleanUp();
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = testStructuralChanges();
+    success = testRegistryFree() && success;
+
+    ECS::Registry mapRegistry;
+    mapRegistry.addComponentRegistry<TransformRegistry>();
+    mapRegistry.addComponentRegistry<MapRegistry<MoverComponent>>();
+    mapRegistry.addComponentRegistry<MapRegistry<TagComponent>>();
+
+    ECS::Registry archetypeRegistry;
+    archetypeRegistry.addArchetypeRegistry<Transform>();
+    archetypeRegistry.addArchetypeRegistry<MoverComponent>();
+    archetypeRegistry.addArchetypeRegistry<TagComponent>();
+
+    RealtimeStopWatch start;
+    populate(mapRegistry);
+    const F32 mapPopulateSecs = Test::measure(start);
+
+    start = RealtimeStopWatch();
+    populate(archetypeRegistry);
+    const F32 archetypePopulateSecs = Test::measure(start);
+
+    F32 checksums[3] = { };
+    const F32 mapSecs           = iterateRegistry(mapRegistry, checksums[0]);
+    const F32 registrySecs      = iterateRegistry(archetypeRegistry, checksums[1]);
+    const F32 storageSecs       = iterateStorage(archetypeRegistry, checksums[2]);
+    const F32 perEntity         = 1e9f / F32(U64(kNumEntities) * kNumFrames);
+
+    R_INFO("ArchetypeStorageTest", "%d entities, Transform + MoverComponent, %d frames", kNumEntities, kNumFrames);
+    R_INFO("ArchetypeStorageTest", "Populate: map=%.1f ms, archetype=%.1f ms", mapPopulateSecs * 1000.0f, archetypePopulateSecs * 1000.0f);
+    R_INFO("ArchetypeStorageTest", "Map registries, per entity lookup:        %.2f ns/entity", mapSecs * perEntity);
+    R_INFO("ArchetypeStorageTest", "Archetype registries, per entity lookup:  %.2f ns/entity", registrySecs * perEntity);
+    R_INFO("ArchetypeStorageTest", "Archetype storage, forEach:               %.2f ns/entity (%.1fx)", storageSecs * perEntity, mapSecs / storageSecs);
+
+    // The archetype registry ran both paths, so it moved twice as far. Sums are in a different
+    // order, so allow for rounding.
+    const F32 tolerance = fabsf(checksums[0]) * 1e-3f;
+    if ((fabsf(checksums[1] - checksums[0]) > tolerance) || (fabsf(checksums[2] - checksums[0] * 2.0f) > tolerance * 2.0f))
+    {
+        R_ERROR("ArchetypeStorageTest", "Checksums do not match! map=%f archetype=%f, %f", checksums[0], checksums[1], checksums[2]);
+        success = false;
+    }
+
+    mapRegistry.cleanUp();
+    archetypeRegistry.cleanUp();
+
+    return Test::finish("ArchetypeStorageTest", success);
+}
@@ -0,0 +1,207 @@
+#include "Recluse/Game/Component.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <map>
+#include <vector>
+
+using namespace Recluse;
+
+static const U32 kNumEntities   = 1024;
+static const U32 kNumLookups    = 10000000;
+
+#define TEST_COMPONENT(_class) \
+    class _class : public ECS::Component \
+    { \
+    public: \
+        R_COMPONENT_DECLARE(_class); \
+        U32 value = 0; \
+    };
+
+TEST_COMPONENT(ComponentA)
+TEST_COMPONENT(ComponentB)
+TEST_COMPONENT(ComponentC)
+TEST_COMPONENT(ComponentD)
+TEST_COMPONENT(ComponentE)
+TEST_COMPONENT(ComponentF)
+TEST_COMPONENT(ComponentG)
+TEST_COMPONENT(ComponentH)
+TEST_COMPONENT(ComponentI)
+TEST_COMPONENT(ComponentJ)
+TEST_COMPONENT(ComponentK)
+TEST_COMPONENT(ComponentL)
+TEST_COMPONENT(ComponentM)
+TEST_COMPONENT(ComponentN)
+TEST_COMPONENT(ComponentO)
+TEST_COMPONENT(ComponentP)
+
+
+// Entities are numbered, so the component lookup itself is an array index, and what is measured
+// is finding the registry.
+template<typename TypeComponent>
+class ArrayRegistry : public ECS::ComponentRegistry<TypeComponent>
+{
+public:
+    ArrayRegistry()
+        : m_components(kNumEntities)
+    {
+        this->m_numberOfComponentsAllocated = 0;
+    }
+
+    TypeComponent* getComponent(const RGUID& owner) override
+    {
+        return (owner.ss.hash0 < kNumEntities) ? &m_components[owner.ss.hash0] : nullptr;
+    }
+
+    ResultCode onCleanUp() override { return RecluseResult_Ok; }
+
+protected:
+    ResultCode onAllocateComponent(const RGUID& owner) override
+    {
+        m_components[owner.ss.hash0].setOwner(owner);
+        m_components[owner.ss.hash0].value = owner.ss.hash0;
+        return RecluseResult_Ok;
+    }
+
+    ResultCode onFreeComponent(const RGUID& owner) override { return RecluseResult_Ok; }
+
+private:
+    std::vector<TypeComponent> m_components;
+};
+
+
+// Lookup the Registry did before type indices, a map keyed by the hashed class name, hashed on
+// every call.
+class MapLookup
+{
+public:
+    template<typename ComponentType>
+    void add(ECS::Registry& registry)
+    {
+        m_records[ComponentType::classGUID()] = registry.getComponentRegistry<ComponentType>();
+    }
+
+    template<typename ComponentType>
+    ComponentType* getComponent(const RGUID& guid) const
+    {
+        auto it = m_records.find(ComponentType::classGUID());
+        if (it != m_records.end())
+        {
+            return static_cast<ECS::ComponentRegistry<ComponentType>*>(it->second)->getComponent(guid);
+        }
+        return nullptr;
+    }
+
+private:
+    std::map<ECS::ComponentUUID, ECS::AbstractRegistry*> m_records;
+};
+
+
+template<typename... Components>
+static void addAll(ECS::Registry& registry, MapLookup& mapLookup)
+{
+    const ResultCode results[] = { registry.addComponentRegistry<ArrayRegistry<Components>>()... };
+    for (ResultCode result : results)
+    {
+        R_ASSERT(result == RecluseResult_Ok);
+    }
+
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        const ResultCode made[] = { registry.makeComponent<Components>(RGUID(i, 0ull), true)... };
+        (void)made;
+    }
+
+    const int added[] = { (mapLookup.add<Components>(registry), 0)... };
+    (void)added;
+}
+
+
+// Looks up a few of the types, from the front, middle and back of the map.
+template<typename Lookup>
+static F32 benchmark(const Lookup& lookup, U64& checksum)
+{
+    RealtimeStopWatch start;
+    for (U32 i = 0; i < kNumLookups; i += 4)
+    {
+        const RGUID entity(i % kNumEntities, 0ull);
+        checksum += lookup.template getComponent<ComponentA>(entity)->value;
+        checksum += lookup.template getComponent<ComponentF>(entity)->value;
+        checksum += lookup.template getComponent<ComponentK>(entity)->value;
+        checksum += lookup.template getComponent<ComponentP>(entity)->value;
+    }
+    return Test::measure(start);
+}
+
+
+static Bool testTypeIndices(ECS::Registry& registry)
+{
+    Bool success = true;
+
+    // Same type, same index, and every type its own.
+    if (ECS::ComponentTypeId<ComponentA>::index() != ECS::getComponentTypeIndex(ComponentA::classGUID())
+        || ECS::ComponentTypeId<ComponentA>::index() == ECS::ComponentTypeId<ComponentB>::index()
+        || ECS::ComponentTypeId<ComponentA>::uuid() != ComponentA::classGUID())
+    {
+        R_ERROR("ComponentTypeIndexTest", "Component type indices do not match!");
+        success = false;
+    }
+
+    if (registry.addComponentRegistry<ArrayRegistry<ComponentA>>() != RecluseResult_Failed)
+    {
+        R_ERROR("ComponentTypeIndexTest", "Registry for ComponentA was added twice!");
+        success = false;
+    }
+
+    // A type the registry has no registry for, that is indexed after all the others.
+    class UnregisteredComponent : public ECS::Component
+    {
+    public:
+        R_COMPONENT_DECLARE(UnregisteredComponent);
+    };
+
+    if (registry.getComponentRegistry<UnregisteredComponent>() || registry.getComponent<UnregisteredComponent>(RGUID(0ull, 0ull)))
+    {
+        R_ERROR("ComponentTypeIndexTest", "Found a registry that was never added!");
+        success = false;
+    }
+
+    if (registry.getComponent<ComponentP>(RGUID(7ull, 0ull))->value != 7u)
+    {
+        R_ERROR("ComponentTypeIndexTest", "Wrong component returned!");
+        success = false;
+    }
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    ECS::Registry registry;
+    MapLookup mapLookup;
+    addAll<ComponentA, ComponentB, ComponentC, ComponentD, ComponentE, ComponentF, ComponentG, ComponentH,
+           ComponentI, ComponentJ, ComponentK, ComponentL, ComponentM, ComponentN, ComponentO, ComponentP>(registry, mapLookup);
+
+    Bool success = testTypeIndices(registry);
+
+    U64 checksums[2] = { };
+    const F32 mapSecs   = benchmark(mapLookup, checksums[0]);
+    const F32 indexSecs = benchmark(registry, checksums[1]);
+    if (checksums[0] != checksums[1])
+    {
+        R_ERROR("ComponentTypeIndexTest", "Checksums do not match! map=%llu index=%llu", checksums[0], checksums[1]);
+        success = false;
+    }
+
+    const F32 perLookup = 1e9f / F32(kNumLookups);
+    R_INFO("ComponentTypeIndexTest", "getComponent, 16 registries, %d lookups", kNumLookups);
+    R_INFO("ComponentTypeIndexTest", "Hashed uuid, map lookup:  %.2f ns (%.1f M/s)", mapSecs * perLookup, F32(kNumLookups) / mapSecs * 1e-6f);
+    R_INFO("ComponentTypeIndexTest", "Type index, array lookup: %.2f ns (%.1f M/s, %.1fx)", indexSecs * perLookup, F32(kNumLookups) / indexSecs * 1e-6f, mapSecs / indexSecs);
+
+    registry.cleanUp();
+
+    return Test::finish("ComponentTypeIndexTest", success);
+}
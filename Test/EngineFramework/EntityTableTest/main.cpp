@@ -0,0 +1,188 @@
+#include "Recluse/Game/GameEntity.hpp"
+#include "Recluse/Game/EntityTable.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace Recluse;
+
+static const U32 kNumEntities   = 1000000;
+static const U32 kNumLookups    = 4000000;
+
+
+static U32 nextRandom(U32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8u;
+}
+
+
+// The allocation path entities used before the entity table, a malloc per entity, with the
+// address packed into the RGUID.
+static ECS::GameEntity* mallocAlloc(U64 szBytes, ECS::GameEntityMemoryAllocationType type)
+{
+    ECS::GameEntityAllocation allocation = { };
+    allocation.offsetAddress    = (SizeT)malloc(szBytes);
+    allocation.szBytes          = szBytes;
+    allocation.allocType        = type;
+
+    RGUID guid      = { };
+    guid.ss.hash0   = (U32)((allocation.offsetAddress & 0x00000000FFFFFFFF)      );
+    guid.ss.hash1   = (U32)((allocation.offsetAddress & 0xFFFFFFFF00000000) >> 32);
+    return new (reinterpret_cast<void*>(allocation.offsetAddress)) ECS::GameEntity(allocation, guid);
+}
+
+
+static void mallocFree(ECS::GameEntity* pEntity)
+{
+    const ECS::GameEntityAllocation allocation = pEntity->getAllocation();
+    pEntity->~GameEntity();
+    free((void*)allocation.offsetAddress);
+}
+
+
+static ECS::GameEntity* mallocFind(const RGUID& rguid)
+{
+    return reinterpret_cast<ECS::GameEntity*>(U64(rguid.ss.hash0) | (U64(rguid.ss.hash1) << 32));
+}
+
+
+struct BenchmarkResult
+{
+    F32 createSecs;
+    F32 lookupSecs;
+    F32 destroySecs;
+    F32 recreateSecs;
+};
+
+
+static BenchmarkResult benchmark(std::vector<ECS::GameEntity*>& entities, std::vector<RGUID>& guids)
+{
+    BenchmarkResult result = { };
+
+    RealtimeStopWatch start;
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        entities[i] = ECS::GameEntity::instantiate(sizeof(ECS::GameEntity));
+    }
+    result.createSecs = Test::measure(start);
+
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        guids[i] = entities[i]->getUUID();
+    }
+
+    U32 random = 1u;
+    U64 found = 0ull;
+    start = RealtimeStopWatch();
+    for (U32 i = 0; i < kNumLookups; ++i)
+    {
+        ECS::GameEntity* pEntity = ECS::GameEntity::findEntity(guids[nextRandom(random) % kNumEntities]);
+        found += pEntity->isActive() ? 0u : 1u;
+    }
+    result.lookupSecs = Test::measure(start);
+    R_ASSERT(found == kNumLookups);
+
+    start = RealtimeStopWatch();
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        ECS::GameEntity::free(entities[i]);
+    }
+    result.destroySecs = Test::measure(start);
+
+    // Second time around, slots and heap blocks are reused.
+    start = RealtimeStopWatch();
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        entities[i] = ECS::GameEntity::instantiate(sizeof(ECS::GameEntity));
+    }
+    result.recreateSecs = Test::measure(start);
+
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        ECS::GameEntity::free(entities[i]);
+    }
+    return result;
+}
+
+
+static Bool testHandles()
+{
+    Bool success = true;
+    ECS::EntityTable table;
+
+    ECS::GameEntity* pEntity    = table.create();
+    const RGUID guid            = pEntity->getUUID();
+    const ECS::EntityHandle handle = pEntity->getHandle();
+    if (!guid.isValid() || !handle.isValid() || (table.find(handle) != pEntity) || (ECS::EntityHandle::fromRGUID(guid) != handle))
+    {
+        R_ERROR("EntityTableTest", "Handle does not find its entity!");
+        success = false;
+    }
+
+    // The slot is reused, but the old handle must not find the new entity.
+    table.destroy(pEntity);
+    ECS::GameEntity* pReused = table.create();
+    if ((pReused != pEntity) || table.find(handle) || table.isAlive(handle) || (table.find(pReused->getHandle()) != pReused))
+    {
+        R_ERROR("EntityTableTest", "Stale handle was not caught!");
+        success = false;
+    }
+
+    // RGUIDs that did not come from a table are rejected.
+    if (table.find(ECS::EntityHandle::fromRGUID(generateRGUID())))
+    {
+        R_ERROR("EntityTableTest", "Foreign RGUID found an entity!");
+        success = false;
+    }
+
+    table.destroy(pReused);
+    if (table.getNumEntities() != 0u || table.getNumSlots() != 1u)
+    {
+        R_ERROR("EntityTableTest", "Slots were not recycled! slots=%d", table.getNumSlots());
+        success = false;
+    }
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Bool success = testHandles();
+
+    std::vector<ECS::GameEntity*> entities(kNumEntities);
+    std::vector<RGUID> guids(kNumEntities);
+
+    // Entity table first, it is the default.
+    const BenchmarkResult table = benchmark(entities, guids);
+
+    // Stale handles from the run above must all be caught.
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        if (ECS::GameEntity::findEntity(guids[i]))
+        {
+            R_ERROR("EntityTableTest", "Destroyed entity %d was still found!", i);
+            success = false;
+            break;
+        }
+    }
+
+    ECS::GameEntityAllocationCall mallocCalls = { nullptr, nullptr, mallocAlloc, mallocFree, mallocFind };
+    ECS::GameEntity::setOnAllocation(mallocCalls);
+    const BenchmarkResult heap = benchmark(entities, guids);
+
+    const F32 perEntity = 1e9f / F32(kNumEntities);
+    const F32 perLookup = 1e9f / F32(kNumLookups);
+    R_INFO("EntityTableTest", "%d entities            malloc        entity table", kNumEntities);
+    R_INFO("EntityTableTest", "create        %8.1f ns   %8.1f ns", heap.createSecs * perEntity, table.createSecs * perEntity);
+    R_INFO("EntityTableTest", "find          %8.1f ns   %8.1f ns (validated)", heap.lookupSecs * perLookup, table.lookupSecs * perLookup);
+    R_INFO("EntityTableTest", "destroy       %8.1f ns   %8.1f ns", heap.destroySecs * perEntity, table.destroySecs * perEntity);
+    R_INFO("EntityTableTest", "recreate      %8.1f ns   %8.1f ns", heap.recreateSecs * perEntity, table.recreateSecs * perEntity);
+
+    return Test::finish("EntityTableTest", success);
+}
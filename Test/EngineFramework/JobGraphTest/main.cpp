@@ -0,0 +1,221 @@
+#include <atomic>
+#include <vector>
+
+#include "Recluse/JobStreamer.hpp"
+#include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+using namespace Recluse;
+
+static const U32 kNumAnimationJobs  = 16;
+static const U32 kNumTransformJobs  = 16;
+static const U32 kNumViews          = 4;
+static const U32 kNumPasses         = 8;
+static const U32 kNumFrames         = 30;
+
+struct FrameJob
+{
+    F32                     workMs;
+    std::vector<FrameJob*>  dependencies;
+    std::atomic<U32>        finishedFrame;
+    std::atomic<U32>        badOrderCount;
+};
+
+static U32 g_currentFrame = 0;
+
+
+// Spin for a fixed amount of time, to simulate a job's workload.
+static void simulateWork(F32 workMs)
+{
+    RealtimeStopWatch start;
+    for (;;)
+    {
+        RealtimeStopWatch now;
+        RealtimeTick tick = now - start;
+        if ((tick.delta() * 1000.0f) >= workMs)
+        {
+            break;
+        }
+    }
+}
+
+
+U32 frameJob(void* pData)
+{
+    FrameJob* pJob = static_cast<FrameJob*>(pData);
+
+    // All dependencies must have finished this frame, before we start.
+    for (U32 i = 0; i < pJob->dependencies.size(); ++i)
+    {
+        if (pJob->dependencies[i]->finishedFrame.load() != g_currentFrame)
+        {
+            pJob->badOrderCount.fetch_add(1);
+        }
+    }
+
+    simulateWork(pJob->workMs);
+    pJob->finishedFrame.store(g_currentFrame);
+    return 0;
+}
+
+
+class FrameGraphBuilder
+{
+public:
+    FrameGraphBuilder(JobGraph& graph) : m_graph(graph) { }
+
+    ~FrameGraphBuilder()
+    {
+        for (U32 i = 0; i < m_jobs.size(); ++i)
+        {
+            delete m_jobs[i];
+        }
+    }
+
+    JobNodeId add(const char* name, F32 workMs, JobType affinity)
+    {
+        FrameJob* pJob = new FrameJob();
+        pJob->workMs = workMs;
+        pJob->finishedFrame.store(~0u);
+        pJob->badOrderCount.store(0);
+        m_jobs.push_back(pJob);
+        return m_graph.addJob(name, frameJob, pJob, affinity);
+    }
+
+    void depend(JobNodeId before, JobNodeId after)
+    {
+        m_graph.addDependency(before, after);
+        m_jobs[after]->dependencies.push_back(m_jobs[before]);
+    }
+
+    U32 getBadOrderCount() const
+    {
+        U32 count = 0;
+        for (U32 i = 0; i < m_jobs.size(); ++i)
+        {
+            count += m_jobs[i]->badOrderCount.load();
+        }
+        return count;
+    }
+
+private:
+    JobGraph&               m_graph;
+    std::vector<FrameJob*>  m_jobs;
+};
+
+
+// Builds a frame as: animation -> transforms -> culling (per view) -> command build (per pass) -> submit.
+static void buildFrameGraph(FrameGraphBuilder& builder)
+{
+    JobNodeId beginFrame = builder.add("BeginFrame", 0.05f, JobType_Main);
+    JobNodeId animations[kNumAnimationJobs];
+    JobNodeId transforms[kNumTransformJobs];
+    JobNodeId culling[kNumViews];
+    JobNodeId commands[kNumPasses];
+
+    for (U32 i = 0; i < kNumAnimationJobs; ++i)
+    {
+        animations[i] = builder.add("Animation", 0.4f, JobType_Animation);
+        builder.depend(beginFrame, animations[i]);
+    }
+
+    // Each transform batch depends on the pair of animation batches that drive it.
+    for (U32 i = 0; i < kNumTransformJobs; ++i)
+    {
+        transforms[i] = builder.add("Transforms", 0.2f, JobType_Simulation);
+        builder.depend(animations[i], transforms[i]);
+        builder.depend(animations[(i + 1) % kNumAnimationJobs], transforms[i]);
+    }
+
+    for (U32 v = 0; v < kNumViews; ++v)
+    {
+        culling[v] = builder.add("Culling", 0.5f, JobType_Main);
+        for (U32 i = 0; i < kNumTransformJobs; ++i)
+        {
+            builder.depend(transforms[i], culling[v]);
+        }
+    }
+
+    JobNodeId submit = builder.add("Submit", 0.3f, JobType_Renderer);
+    for (U32 p = 0; p < kNumPasses; ++p)
+    {
+        commands[p] = builder.add("CommandBuild", 0.6f, JobType_Renderer);
+        builder.depend(culling[p % kNumViews], commands[p]);
+        builder.depend(commands[p], submit);
+    }
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    const U32 workerCounts[] = { 0, 1, 2, 4, 8, 16 };
+    Bool success = true;
+
+    // A graph with a cycle should fail to kick.
+    {
+        ThreadPool pool(1);
+        JobGraph cyclic;
+        FrameGraphBuilder builder(cyclic);
+        JobNodeId a = builder.add("A", 0.0f, JobType_Main);
+        JobNodeId b = builder.add("B", 0.0f, JobType_Main);
+        builder.depend(a, b);
+        builder.depend(b, a);
+        if (cyclic.kick(&pool) == RecluseResult_Ok)
+        {
+            R_ERROR("JobGraphTest", "Cyclic graph was kicked!");
+            success = false;
+        }
+    }
+
+    for (U32 w = 0; w < sizeof(workerCounts) / sizeof(workerCounts[0]); ++w)
+    {
+        ThreadPool pool(workerCounts[w]);
+        JobGraph graph;
+        FrameGraphBuilder builder(graph);
+        buildFrameGraph(builder);
+
+        JobGraphStats average = { };
+        for (U32 frame = 0; frame < kNumFrames; ++frame)
+        {
+            g_currentFrame = frame;
+            if (graph.kick(&pool) != RecluseResult_Ok)
+            {
+                R_ERROR("JobGraphTest", "Failed to kick the frame graph!");
+                success = false;
+                break;
+            }
+            graph.wait();
+
+            const JobGraphStats& stats  = graph.getStats();
+            average.wallTimeMs         += stats.wallTimeMs / F32(kNumFrames);
+            average.criticalPathMs     += stats.criticalPathMs / F32(kNumFrames);
+            average.totalWorkMs        += stats.totalWorkMs / F32(kNumFrames);
+            average.utilization        += stats.utilization / F32(kNumFrames);
+            average.numThreads          = stats.numThreads;
+        }
+
+        if (builder.getBadOrderCount() != 0)
+        {
+            R_ERROR("JobGraphTest", "%d jobs started before their dependencies finished!", builder.getBadOrderCount());
+            success = false;
+        }
+
+        R_INFO
+            (
+                "JobGraphTest", 
+                "threads=%2d jobs=%d  wall: %6.3f ms  critical path: %6.3f ms  total work: %6.3f ms  utilization: %5.1f%%", 
+                average.numThreads, 
+                graph.getNumJobs(),
+                average.wallTimeMs, 
+                average.criticalPathMs, 
+                average.totalWorkMs, 
+                average.utilization * 100.0f
+            );
+    }
+
+    return Test::finish("JobGraphTest", success);
+}
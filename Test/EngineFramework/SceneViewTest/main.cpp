@@ -0,0 +1,269 @@
+#include "Recluse/Scene/Scene.hpp"
+#include "Recluse/Game/Component.hpp"
+#include "Recluse/Game/Components/Transform.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+using namespace Recluse;
+
+static const U32 kNumEntities   = 100000;
+static const U32 kNumFrames     = 20;
+
+
+class VelocityComponent : public ECS::Component
+{
+public:
+    R_COMPONENT_DECLARE(VelocityComponent);
+    Math::Float3 velocity;
+};
+
+
+class DampingComponent : public ECS::Component
+{
+public:
+    R_COMPONENT_DECLARE(DampingComponent);
+    F32 damping = 1.0f;
+};
+
+
+class FrozenComponent : public ECS::Component
+{
+public:
+    R_COMPONENT_DECLARE(FrozenComponent);
+};
+
+
+// Map based registry, the same way TransformRegistry stores its components.
+template<typename TypeComponent>
+class MapRegistry : public ECS::ComponentRegistry<TypeComponent>
+{
+public:
+    ResultCode onAllocateComponent(const RGUID& owner) override
+    {
+        m_table[owner].setOwner(owner);
+        return RecluseResult_Ok;
+    }
+
+    ResultCode onFreeComponent(const RGUID& owner) override
+    {
+        return m_table.erase(owner) ? RecluseResult_Ok : RecluseResult_NotFound;
+    }
+
+    std::vector<TypeComponent*> getAllComponents() override
+    {
+        std::vector<TypeComponent*> components;
+        for (auto& it : m_table)
+        {
+            components.push_back(&it.second);
+        }
+        return components;
+    }
+
+    TypeComponent* getComponent(const RGUID& owner) override
+    {
+        auto it = m_table.find(owner);
+        return (it != m_table.end()) ? &it->second : nullptr;
+    }
+
+    ResultCode onCleanUp() override
+    {
+        m_table.clear();
+        return RecluseResult_Ok;
+    }
+
+private:
+    std::map<RGUID, TypeComponent, RGUID::Less> m_table;
+};
+
+
+static RGUID makeEntity(U32 i)
+{
+    return RGUID(U64(i) * 0x9E3779B97F4A7C15ull, U64(i));
+}
+
+
+static void populate(ECS::Registry& registry)
+{
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        const RGUID entity = makeEntity(i);
+        registry.makeComponent<Transform>(entity, true);
+        registry.makeComponent<VelocityComponent>(entity, true);
+        registry.makeComponent<DampingComponent>(entity, true);
+        registry.getComponent<VelocityComponent>(entity)->velocity = Math::Float3(1.0f, 0.0f, F32(i & 7));
+        registry.getComponent<DampingComponent>(entity)->damping = 0.5f;
+        // One in eight are frozen, and are skipped by the excluding view.
+        if ((i & 7) == 0)
+        {
+            registry.makeComponent<FrozenComponent>(entity, true);
+        }
+    }
+}
+
+
+static void step(Transform& transform, VelocityComponent& velocity, DampingComponent& damping)
+{
+    transform.position = transform.position + velocity.velocity * (damping.damping * 0.016f);
+}
+
+
+// What systems do today, a copy of all components of one type, then a lookup per entity for each
+// sibling component, the way obtainTuple() finds them.
+static F32 iterateRegistry(ECS::Registry& registry)
+{
+    RealtimeStopWatch start;
+    for (U32 frame = 0; frame < kNumFrames; ++frame)
+    {
+        std::vector<Transform*> transforms = registry.getComponentRegistry<Transform>()->getAllComponents();
+        for (Transform* transform : transforms)
+        {
+            const RGUID owner                   = transform->getOwner();
+            VelocityComponent* velocity         = registry.getComponent<VelocityComponent>(owner);
+            DampingComponent* damping           = registry.getComponent<DampingComponent>(owner);
+            if (velocity && damping && !registry.getComponent<FrozenComponent>(owner))
+            {
+                step(*transform, *velocity, *damping);
+            }
+        }
+    }
+    return Test::measure(start);
+}
+
+
+static F32 iterateView(Engine::Scene& scene, ECS::Registry& registry)
+{
+    RealtimeStopWatch start;
+    for (U32 frame = 0; frame < kNumFrames; ++frame)
+    {
+        scene.view<Transform, VelocityComponent, DampingComponent>(&registry).exclude<FrozenComponent>().forEach(
+            [] (const RGUID&, Transform& transform, VelocityComponent& velocity, DampingComponent& damping) -> void
+            {
+                step(transform, velocity, damping);
+            });
+    }
+    return Test::measure(start);
+}
+
+
+static F32 checksum(ECS::Registry& registry)
+{
+    F32 sum = 0.0f;
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        const Transform* transform = registry.getComponent<Transform>(makeEntity(i));
+        sum += transform->position.x + transform->position.z;
+    }
+    return sum;
+}
+
+
+// Views are cached per set of types, and pick up archetypes made after the query was first used.
+static Bool testQueries(Engine::Scene& scene)
+{
+    Bool success = true;
+    ECS::Registry registry;
+    registry.addArchetypeRegistry<VelocityComponent>();
+    registry.addArchetypeRegistry<DampingComponent>();
+    registry.addArchetypeRegistry<FrozenComponent>();
+
+    for (U32 i = 0; i < 100; ++i)
+    {
+        registry.makeComponent<VelocityComponent>(makeEntity(i));
+    }
+
+    ECS::View<VelocityComponent> view = scene.view<VelocityComponent>(&registry).exclude<FrozenComponent>();
+    const ECS::ArchetypeQuery* pQuery = view.getQuery();
+    if (view.getNumEntities() != 100u || pQuery->archetypes.size() != 1u)
+    {
+        R_ERROR("SceneViewTest", "View found %d entities, expected 100!", view.getNumEntities());
+        success = false;
+    }
+
+    // New archetypes after the query was made.
+    for (U32 i = 0; i < 100; ++i)
+    {
+        if (i % 2)
+        {
+            registry.makeComponent<DampingComponent>(makeEntity(i));
+        }
+        if ((i % 5) == 0)
+        {
+            registry.makeComponent<FrozenComponent>(makeEntity(i));
+        }
+    }
+
+    U32 numVisited = 0;
+    view = scene.view<VelocityComponent>(&registry).exclude<FrozenComponent>();
+    view.forEach([&] (const RGUID& entity, VelocityComponent&) -> void
+        {
+            numVisited++;
+            success = success && !registry.getComponent<FrozenComponent>(entity);
+        });
+
+    if (view.getQuery() != pQuery || numVisited != 80u || view.getNumEntities() != 80u)
+    {
+        R_ERROR("SceneViewTest", "View visited %d entities after structural changes, expected 80!", numVisited);
+        success = false;
+    }
+
+    U32 numDamped = 0;
+    scene.view<VelocityComponent, DampingComponent>(&registry).forEach([&numDamped] (const RGUID&, VelocityComponent&, DampingComponent&) -> void { numDamped++; });
+    if (numDamped != 50u)
+    {
+        R_ERROR("SceneViewTest", "View visited %d damped entities, expected 50!", numDamped);
+        success = false;
+    }
+
+    registry.cleanUp();
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+
+    Engine::Scene scene("SceneViewTest");
+    Bool success = testQueries(scene);
+
+    ECS::Registry mapRegistry;
+    mapRegistry.addComponentRegistry<TransformRegistry>();
+    mapRegistry.addComponentRegistry<MapRegistry<VelocityComponent>>();
+    mapRegistry.addComponentRegistry<MapRegistry<DampingComponent>>();
+    mapRegistry.addComponentRegistry<MapRegistry<FrozenComponent>>();
+
+    ECS::Registry archetypeRegistry;
+    archetypeRegistry.addArchetypeRegistry<Transform>();
+    archetypeRegistry.addArchetypeRegistry<VelocityComponent>();
+    archetypeRegistry.addArchetypeRegistry<DampingComponent>();
+    archetypeRegistry.addArchetypeRegistry<FrozenComponent>();
+
+    populate(mapRegistry);
+    populate(archetypeRegistry);
+
+    const F32 registrySecs  = iterateRegistry(mapRegistry);
+    const F32 viewSecs      = iterateView(scene, archetypeRegistry);
+    const F32 perEntity     = 1e9f / F32(U64(kNumEntities) * kNumFrames);
+
+    R_INFO("SceneViewTest", "%d entities, view<Transform, Velocity, Damping>().exclude<Frozen>(), %d frames", kNumEntities, kNumFrames);
+    R_INFO("SceneViewTest", "getAllComponents + per entity lookups: %.2f ns/entity", registrySecs * perEntity);
+    R_INFO("SceneViewTest", "Scene::view:                           %.2f ns/entity (%.1fx)", viewSecs * perEntity, registrySecs / viewSecs);
+
+    const F32 mapSum        = checksum(mapRegistry);
+    const F32 viewSum       = checksum(archetypeRegistry);
+    if (fabsf(mapSum - viewSum) > fabsf(mapSum) * 1e-3f)
+    {
+        R_ERROR("SceneViewTest", "Checksums do not match! registry=%f view=%f", mapSum, viewSum);
+        success = false;
+    }
+
+    mapRegistry.cleanUp();
+    archetypeRegistry.cleanUp();
+
+    return Test::finish("SceneViewTest", success);
+}
@@ -0,0 +1,275 @@
+#include "Recluse/Game/Component.hpp"
+#include "Recluse/Game/SystemScheduler.hpp"
+#include "Recluse/Threading/ThreadPool.hpp"
+#include "Recluse/Messaging.hpp"
+#include "Recluse/Time.hpp"
+#include "TestCommon.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using namespace Recluse;
+
+static const U32 kNumEntities   = 20000;
+static const U32 kNumFrames     = 10;
+static const U32 kNumTypes      = 8;
+static const U32 kNumSystems    = 20;
+
+static const char* kSystemNames[kNumSystems] =
+{
+    "System00", "System01", "System02", "System03", "System04", "System05", "System06", "System07", "System08", "System09",
+    "System10", "System11", "System12", "System13", "System14", "System15", "System16", "System17", "System18", "System19"
+};
+
+
+// Numbered components, declared by hand since R_COMPONENT_DECLARE names them by class.
+template<U32 Number>
+class DataComponent : public ECS::Component
+{
+public:
+    static ECS::ComponentUUID classGUID() { return 0x5359535445440000ull + Number; }
+    virtual ECS::ComponentUUID getClassGUID() const override { return classGUID(); }
+    F32 value = 1.0f;
+};
+
+
+static void step(F32& written, F32 read)
+{
+    // Enough math per entity that a system takes a fraction of a millisecond.
+    F32 value = written;
+    for (U32 i = 0; i < 16; ++i)
+    {
+        value = value * 0.999f + sinf(read + F32(i)) * 0.001f;
+    }
+    written = value;
+}
+
+
+// Writes one component type from another. With a pool, the work inside the system is split by
+// chunk as well.
+template<typename Written, typename Read>
+class SyntheticSystem : public ECS::AbstractSystem
+{
+public:
+    SyntheticSystem(const char* name, ThreadPool* pChunkPool)
+        : m_name(name)
+        , m_pChunkPool(pChunkPool)
+    {
+        writesComponents<Written>();
+        readsComponents<Read>();
+    }
+
+    const char* getName() const override { return m_name; }
+
+protected:
+    void onUpdate(ECS::Registry* registry, const RealtimeTick& tick) override
+    {
+        auto stepChunk = [] (U32 count, const RGUID*, Written* pWritten, Read* pRead) -> void
+            {
+                for (U32 i = 0; i < count; ++i)
+                {
+                    step(pWritten[i].value, pRead[i].value);
+                }
+            };
+
+        if (m_pChunkPool)
+        {
+            registry->view<Written, Read>().forEachChunkParallel(m_pChunkPool, stepChunk);
+        }
+        else
+        {
+            registry->view<Written, Read>().forEachChunk(stepChunk);
+        }
+    }
+
+private:
+    const char* m_name;
+    ThreadPool* m_pChunkPool;
+};
+
+
+// Touches no components at all.
+class IdleSystem : public ECS::AbstractSystem
+{
+public:
+    IdleSystem(Bool declare) { if (declare) readsComponents<>(); }
+};
+
+
+// System i writes type i % 8 and reads type (i * 5 + 3) % 8, so some systems chain and the rest
+// are free to run side by side. The first system also splits its own work by chunk.
+template<std::size_t... Indices>
+static void makeSystems(std::vector<ECS::AbstractSystem*>& systems, ThreadPool* pChunkPool, std::index_sequence<Indices...>)
+{
+    const int made[] =
+        {
+            (systems.push_back(new SyntheticSystem<DataComponent<Indices % kNumTypes>, DataComponent<(Indices * 5 + 3) % kNumTypes>>(kSystemNames[Indices], Indices ? nullptr : pChunkPool)), 0)...
+        };
+    (void)made;
+}
+
+
+template<std::size_t... Indices>
+static void populate(ECS::Registry& registry, std::index_sequence<Indices...>)
+{
+    const ResultCode added[] = { registry.addArchetypeRegistry<DataComponent<Indices>>()... };
+    (void)added;
+    for (U32 i = 0; i < kNumEntities; ++i)
+    {
+        const ResultCode made[] = { registry.makeComponent<DataComponent<Indices>>(RGUID(U64(i), 1ull))... };
+        (void)made;
+    }
+}
+
+
+template<std::size_t... Indices>
+static F32 checksum(ECS::Registry& registry, std::index_sequence<Indices...>)
+{
+    F32 sum = 0.0f;
+    const int summed[] =
+        {
+            (registry.view<DataComponent<Indices>>().forEach([&sum] (const RGUID&, DataComponent<Indices>& data) -> void { sum += data.value; }), 0)...
+        };
+    (void)summed;
+    return sum;
+}
+
+
+// Runs the synthetic workload for a few frames, returns the average frame time.
+static F32 runFrames(ThreadPool* pPool, F32& sum, JobGraphStats& average, Bool log)
+{
+    ECS::Registry registry;
+    populate(registry, std::make_index_sequence<kNumTypes>());
+
+    std::vector<ECS::AbstractSystem*> systems;
+    makeSystems(systems, pPool, std::make_index_sequence<kNumSystems>());
+
+    ECS::SystemScheduler scheduler;
+    scheduler.setSystems(systems);
+
+    RealtimeTick tick = RealtimeTick::getTick(JobType_Main);
+    average = { };
+    RealtimeStopWatch start;
+    for (U32 frame = 0; frame < kNumFrames; ++frame)
+    {
+        scheduler.update(&registry, tick, pPool);
+        if (scheduler.isParallel())
+        {
+            const JobGraphStats& stats  = scheduler.getGraph().getStats();
+            average.wallTimeMs         += stats.wallTimeMs / F32(kNumFrames);
+            average.criticalPathMs     += stats.criticalPathMs / F32(kNumFrames);
+            average.totalWorkMs        += stats.totalWorkMs / F32(kNumFrames);
+            average.utilization        += stats.utilization / F32(kNumFrames);
+            average.numThreads          = stats.numThreads;
+        }
+    }
+    const F32 frameMs = Test::measure(start) * 1000.0f / F32(kNumFrames);
+
+    if (log)
+    {
+        scheduler.logSchedule();
+
+        // Longest chain of systems that have to run one after another.
+        std::vector<U32> depths(scheduler.getNumSystems(), 1u);
+        U32 maxDepth = 0u;
+        for (U32 i = 0; i < scheduler.getNumSystems(); ++i)
+        {
+            for (U32 dependency : scheduler.getDependencies(i))
+            {
+                depths[i] = std::max(depths[i], depths[dependency] + 1u);
+            }
+            maxDepth = std::max(maxDepth, depths[i]);
+        }
+        R_INFO("SystemSchedulerTest", "Longest chain: %d of %d systems", maxDepth, scheduler.getNumSystems());
+    }
+
+    sum = checksum(registry, std::make_index_sequence<kNumTypes>());
+    for (ECS::AbstractSystem* pSystem : systems)
+    {
+        ECS::AbstractSystem::free(pSystem);
+    }
+    registry.cleanUp();
+    return frameMs;
+}
+
+
+// Conflicting systems wait on the nearest ones before them, and only the nearest.
+static Bool testDependencies()
+{
+    Bool success = true;
+    std::vector<ECS::AbstractSystem*> systems;
+    systems.push_back(new SyntheticSystem<DataComponent<0>, DataComponent<1>>("WritesA", nullptr));     // 0
+    systems.push_back(new SyntheticSystem<DataComponent<2>, DataComponent<0>>("ReadsA", nullptr));      // 1, after 0
+    systems.push_back(new SyntheticSystem<DataComponent<3>, DataComponent<1>>("Unrelated", nullptr));   // 2
+    systems.push_back(new SyntheticSystem<DataComponent<4>, DataComponent<2>>("ReadsReadsA", nullptr)); // 3, after 1 only
+    systems.push_back(new IdleSystem(true));                                                            // 4
+    systems.push_back(new IdleSystem(false));                                                           // 5, after 4, 3 and 2
+
+    ECS::SystemScheduler scheduler;
+    scheduler.setSystems(systems);
+
+    ECS::Registry registry;
+    populate(registry, std::make_index_sequence<kNumTypes>());
+    ThreadPool pool(2);
+    scheduler.update(&registry, RealtimeTick::getTick(JobType_Main), &pool);
+
+    const std::vector<U32> expected[] = { { }, { 0 }, { }, { 1 }, { }, { 4, 3, 2 } };
+    for (U32 i = 0; i < systems.size(); ++i)
+    {
+        if (scheduler.getDependencies(i) != expected[i])
+        {
+            R_ERROR("SystemSchedulerTest", "System %d has %d dependencies, expected %d!", i, scheduler.getDependencies(i).size(), expected[i].size());
+            success = false;
+        }
+    }
+
+    if (!scheduler.isParallel())
+    {
+        R_ERROR("SystemSchedulerTest", "Systems with declared access did not run on the pool!");
+        success = false;
+    }
+
+    for (ECS::AbstractSystem* pSystem : systems)
+    {
+        ECS::AbstractSystem::free(pSystem);
+    }
+    registry.cleanUp();
+    return success;
+}
+
+
+int main()
+{
+    Log::initializeLoggingSystem();
+    RealtimeTick::initializeWatch(1ull, JobType_Main);
+
+    Bool success = testDependencies();
+
+    F32 serialSum = 0.0f;
+    JobGraphStats serialStats = { };
+    const F32 serialMs = runFrames(nullptr, serialSum, serialStats, false);
+    R_INFO("SystemSchedulerTest", "%d systems, %d entities, %d component types", kNumSystems, kNumEntities, kNumTypes);
+    R_INFO("SystemSchedulerTest", "Serial:    %.3f ms/frame", serialMs);
+
+    const U32 workerCounts[] = { 1, 3, 7 };
+    for (U32 w = 0; w < sizeof(workerCounts) / sizeof(workerCounts[0]); ++w)
+    {
+        ThreadPool pool(workerCounts[w]);
+        F32 sum = 0.0f;
+        JobGraphStats stats = { };
+        const F32 frameMs = runFrames(&pool, sum, stats, (w == 0));
+        R_INFO("SystemSchedulerTest", "%d workers: %.3f ms/frame (%.2fx), critical path %.3f ms, total work %.3f ms, utilization %.0f%%", 
+            workerCounts[w], frameMs, serialMs / frameMs, stats.criticalPathMs, stats.totalWorkMs, stats.utilization * 100.0f);
+
+        // Conflicting systems keep their order, so results match running them one by one.
+        if (sum != serialSum)
+        {
+            R_ERROR("SystemSchedulerTest", "Checksum with %d workers does not match! serial=%f parallel=%f", workerCounts[w], serialSum, sum);
+            success = false;
+        }
+    }
+
+    return Test::finish("SystemSchedulerTest", success);
+}
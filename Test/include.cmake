@@ -20,9 +20,12 @@ set ( RECLUSE_D3D12_RELEASE_LIB ${CMAKE_SOURCE_DIR}/../Recluse/Lib/RecluseD3D12.
 
 set ( RECLUSE_THIRDPARTY_DIR ${CMAKE_SOURCE_DIR}/Thirdparty )
 
+# Helpers shared by the tests, timing and reporting results.
+set ( RECLUSE_TEST_COMMON_INCLUDE ${CMAKE_SOURCE_DIR}/Common )
+
 function(initialize_recluse_framework TARGET_NAME )
     message(STATUS "Recluse: Linking ${TARGET_NAME} with Recluse Framework")
-    include_directories(${RECLUSE_FRAMEWORK_INCLUDE} ${RECLUSE_GENERATED_INCLUDES})
+    include_directories(${RECLUSE_FRAMEWORK_INCLUDE} ${RECLUSE_GENERATED_INCLUDES} ${RECLUSE_TEST_COMMON_INCLUDE})
     target_link_libraries(${TARGET_NAME} debug ${RECLUSE_FRAMEWORK_DEBUG_LIB})
     target_link_libraries(${TARGET_NAME} optimized ${RECLUSE_FRAMEWORK_RELEASE_LIB})
 endfunction()